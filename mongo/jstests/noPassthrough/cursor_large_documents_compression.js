@@ -0,0 +1,113 @@
+// Reads documents of 4KB and more through find with a blocking sort and through aggregation,
+// whose results are sent from their own buffers rather than copied into the reply, and checks
+// them against the inserted data over uncompressed and compressed connections.
+(function() {
+    'use strict';
+
+    const numDocs = 150;
+
+    function makeDoc(i, numDocs) {
+        const size = 4 * 1024 + (i % 7) * 1024;
+        return {
+            _id: i,
+            k: (i * 37) % numDocs,
+            s: new Array(size + 1).join(String.fromCharCode(97 + i % 26))
+        };
+    }
+
+    // Also runs in shells started with network compression, so it only refers to its arguments.
+    function checkReads(testDB, makeDoc, numDocs) {
+        // Inverse of the permutation i -> k
+        const idForKey = [];
+        for (let i = 0; i < numDocs; i++) {
+            idForKey[makeDoc(i, numDocs).k] = i;
+        }
+
+        let results = testDB.coll.find().sort({k: -1}).batchSize(10).toArray();
+        assert.eq(numDocs, results.length);
+        results.forEach(function(doc, pos) {
+            assert.docEq(makeDoc(idForKey[numDocs - 1 - pos], numDocs),
+                         doc,
+                         "sorted find, position " + pos);
+        });
+
+        results = testDB.coll
+                      .aggregate([{$sort: {k: 1}}, {$addFields: {len: {$strLenCP: "$s"}}}],
+                                 {cursor: {batchSize: 5}})
+                      .toArray();
+        assert.eq(numDocs, results.length);
+        results.forEach(function(doc, pos) {
+            const expected = makeDoc(idForKey[pos], numDocs);
+            expected.len = expected.s.length;
+            assert.docEq(expected, doc, "aggregation, position " + pos);
+        });
+
+        results = testDB.coll
+                      .aggregate([
+                          {
+                            $group:
+                                {_id: {$mod: ["$_id", 3]}, ids: {$push: "$_id"}, s: {$max: "$s"}}
+                          },
+                          {$sort: {_id: 1}}
+                      ])
+                      .toArray();
+        assert.eq(3, results.length);
+        results.forEach(function(group) {
+            let maxS = "";
+            const ids = [];
+            for (let i = group._id; i < numDocs; i += 3) {
+                ids.push(i);
+                const s = makeDoc(i, numDocs).s;
+                if (s > maxS) {
+                    maxS = s;
+                }
+            }
+            assert.eq(ids, group.ids.sort(function(a, b) {
+                return a - b;
+            }));
+            assert.eq(maxS, group.s);
+        });
+
+        // Unsorted documents come straight from the collection and are copied
+        results = testDB.coll.find().sort({_id: 1}).batchSize(7).toArray();
+        assert.eq(numDocs, results.length);
+        results.forEach(function(doc, i) {
+            assert.docEq(makeDoc(i, numDocs), doc);
+        });
+    }
+
+    const conn = MongoRunner.runMongod({networkMessageCompressors: "snappy"});
+    assert.neq(null, conn, "mongod was unable to start up");
+    const testDB = conn.getDB("test");
+
+    const bulk = testDB.coll.initializeUnorderedBulkOp();
+    for (let i = 0; i < numDocs; i++) {
+        bulk.insert(makeDoc(i, numDocs));
+    }
+    assert.writeOK(bulk.execute());
+
+    function checkReadsWithCompression() {
+        clearRawMongoProgramOutput();
+        const exitCode = runMongoProgram(
+            "mongo",
+            "--port",
+            conn.port,
+            "--networkMessageCompressors=snappy",
+            "--eval",
+            "assert.eq(['snappy'], db.isMaster().compression);" + "(" + checkReads.toString() +
+                ")(db.getSiblingDB('test'), " + makeDoc.toString() + ", " + numDocs + ");");
+        assert.eq(0, exitCode, "reads over a compressed connection failed");
+    }
+
+    for (let minReferencedBytes of [4 * 1024, 0]) {
+        jsTest.log("Testing with cursorReplyMinReferencedDocumentBytes: " + minReferencedBytes);
+        assert.commandWorked(testDB.adminCommand(
+            {setParameter: 1, cursorReplyMinReferencedDocumentBytes: minReferencedBytes}));
+
+        assert.eq(undefined, testDB.isMaster().compression);
+        checkReads(testDB, makeDoc, numDocs);
+        checkReadsWithCompression();
+    }
+
+    MongoRunner.stopMongod(conn);
+}());
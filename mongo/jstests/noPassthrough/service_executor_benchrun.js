@@ -0,0 +1,74 @@
+/**
+ * Runs the same benchRun workload against mongod with each service executor and reports the
+ * throughput, as well as the 99th percentile latency of requests issued while the workload runs.
+ */
+(function() {
+    'use strict';
+
+    const kSeconds = 5;
+    const kParallel = 32;
+    const kLatencySamples = 1000;
+
+    function runWorkload(serviceExecutor) {
+        const conn = MongoRunner.runMongod({serviceExecutor: serviceExecutor});
+        assert.neq(null, conn, 'mongod failed to start with serviceExecutor=' + serviceExecutor);
+
+        const coll = conn.getDB('test').service_executor_benchrun;
+        const bulk = coll.initializeUnorderedBulkOp();
+        for (let i = 0; i < 1000; i++) {
+            bulk.insert({_id: i, x: 0});
+        }
+        assert.writeOK(bulk.execute());
+
+        const ops = [
+            {
+                op: 'findOne',
+                ns: coll.getFullName(),
+                query: {_id: {'#RAND_INT': [0, 1000]}},
+            },
+            {
+                op: 'update',
+                ns: coll.getFullName(),
+                query: {_id: {'#RAND_INT': [0, 1000]}},
+                update: {$inc: {x: 1}},
+            },
+        ];
+
+        // Sample latencies from this connection while benchRun keeps the server busy
+        const awaitLoad = startParallelShell(
+            'benchRun(' +
+                tojson({ops: ops, parallel: kParallel, seconds: kSeconds, host: conn.host}) + ');',
+            conn.port);
+
+        const latencies = [];
+        for (let i = 0; i < kLatencySamples; i++) {
+            const start = Date.now();
+            coll.findOne({_id: i});
+            latencies.push(Date.now() - start);
+        }
+        awaitLoad();
+
+        const res = benchRun({ops: ops, parallel: kParallel, seconds: kSeconds, host: conn.host});
+        assert.eq(0, res.errCount, tojson(res));
+
+        latencies.sort((a, b) => a - b);
+        const result = {
+            serviceExecutor: serviceExecutor,
+            opsPerSec: res.findOne + res.update,
+            p99LatencyMillis: latencies[Math.floor(latencies.length * 0.99)],
+            executorStats: conn.getDB('admin').serverStatus().network.serviceExecutorTaskStats,
+        };
+
+        MongoRunner.stopMongod(conn);
+        return result;
+    }
+
+    const results = ['synchronous', 'adaptive', 'reactor'].map(runWorkload);
+    results.forEach(function(result) {
+        jsTestLog('serviceExecutor ' + result.serviceExecutor + ': ' + tojson(result));
+    });
+
+    const reactorStats = results[2].executorStats;
+    assert.eq('reactor', reactorStats.executor, tojson(reactorStats));
+    assert.gt(reactorStats.totalExecuted, 0, tojson(reactorStats));
+}());
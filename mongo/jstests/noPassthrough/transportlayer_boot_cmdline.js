@@ -23,4 +23,17 @@
     if (m) {
         MongoRunner.stopMongod(m);
     }
+
+    m = MongoRunner.runMongod(
+        {dbpath: dbpath, transportLayer: 'legacy', serviceExecutor: 'reactor'});
+    assert.isnull(
+        m,
+        'MongoDB with transportLayer=legacy and serviceExecutor=reactor managed to startup which is an unsupported combination');
+    if (m) {
+        MongoRunner.stopMongod(m);
+    }
+
+    m = MongoRunner.runMongod({dbpath: dbpath, transportLayer: 'asio', serviceExecutor: 'reactor'});
+    assert(m, 'MongoDB with transportLayer=asio and serviceExecutor=reactor failed to start up');
+    MongoRunner.stopMongod(m);
 }());
@@ -0,0 +1,62 @@
+// Tests the serverStatus().wiredTiger.oplogVisibility section, which reports the journal flushes
+// that publish oplog visibility and the time operations spend waiting for it.
+(function() {
+    "use strict";
+
+    var storageEngine = jsTest.options().storageEngine || "wiredTiger";
+    if (storageEngine !== "wiredTiger") {
+        print('Skipping test because storageEngine is not "wiredTiger"');
+        return;
+    }
+
+    const flushDelayMicros = 50 * 1000;
+
+    var rst = new ReplSetTest({
+        nodes: 1,
+        nodeOptions: {setParameter: {wiredTigerOplogJournalFlushDelayMicros: flushDelayMicros}}
+    });
+    rst.startSet();
+    rst.initiate();
+
+    var primary = rst.getPrimary();
+    var testDB = primary.getDB("test");
+
+    function getOplogVisibility() {
+        var status = assert.commandWorked(testDB.adminCommand({serverStatus: 1}));
+        assert(status.wiredTiger.hasOwnProperty("oplogVisibility"), tojson(status.wiredTiger));
+        return status.wiredTiger.oplogVisibility;
+    }
+
+    var before = getOplogVisibility();
+    [
+      "journalFlushes",
+      "journalFlushTriggers",
+      "lastJournalFlushBatchSize",
+      "visibilityLagMicros",
+      "lastVisibilityLagMicros",
+      "visibilityWaits",
+      "visibilityWaitMicros"
+    ].forEach(function(field) {
+        assert(before.hasOwnProperty(field), "missing " + field + ": " + tojson(before));
+    });
+
+    const numInserts = 20;
+    for (var i = 0; i < numInserts; i++) {
+        assert.writeOK(testDB.coll.insert({_id: i}));
+    }
+
+    // A forward scan of the oplog waits for all earlier oplog writes to become visible.
+    assert.gte(primary.getDB("local").oplog.rs.find().itcount(), numInserts);
+
+    var after = getOplogVisibility();
+    assert.gte(after.journalFlushTriggers - before.journalFlushTriggers, numInserts, tojson(after));
+    assert.gt(after.journalFlushes, before.journalFlushes, tojson(after));
+    assert.lte(after.journalFlushes - before.journalFlushes,
+               after.journalFlushTriggers - before.journalFlushTriggers,
+               tojson(after));
+    assert.gte(after.lastVisibilityLagMicros, flushDelayMicros, tojson(after));
+    assert.gt(after.visibilityWaits, before.visibilityWaits, tojson(after));
+    assert.gte(after.visibilityWaitMicros, before.visibilityWaitMicros, tojson(after));
+
+    rst.stopSet();
+})();
@@ -0,0 +1,61 @@
+/**
+ * Tests that a chunk which needs several _migrateClone batches is cloned completely when the
+ * recipient fetches the batches on several threads, and that the moveChunk.to changelog entry
+ * reports the transfer rate of the clone and catch-up steps.
+ *
+ * @tags: [resource_intensive]
+ */
+(function() {
+    'use strict';
+
+    var st = new ShardingTest({
+        shards: 2,
+        other: {
+            shardOptions: {
+                setParameter: {migrateCloneFetcherThreads: 4, migrateCloneMaxBufferedBatches: 2}
+            }
+        }
+    });
+
+    var mongos = st.s0;
+    var coll = mongos.getCollection('test.foo');
+
+    assert.commandWorked(mongos.adminCommand({enableSharding: 'test'}));
+    st.ensurePrimaryShard('test', st.shard0.shardName);
+    assert.commandWorked(mongos.adminCommand({shardCollection: coll + '', key: {_id: 1}}));
+    assert.commandWorked(coll.createIndex({i: 1}));
+
+    // Around 50MB, which does not fit in fewer than four 16MB _migrateClone batches
+    var numDocs = 500;
+    var bigString = 'x'.repeat(100 * 1024);
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < numDocs; i++) {
+        bulk.insert({_id: i, i: numDocs - i, s: bigString});
+    }
+    assert.writeOK(bulk.execute());
+
+    assert.commandWorked(mongos.adminCommand(
+        {moveChunk: coll + '', find: {_id: 0}, to: st.shard1.shardName, _waitForDelete: true}));
+
+    var recipientColl = st.shard1.getCollection(coll + '');
+    assert.eq(numDocs, recipientColl.find().itcount());
+    assert.eq(numDocs, recipientColl.find().hint({i: 1}).itcount());
+    assert.eq(0, st.shard0.getCollection(coll + '').find().itcount());
+
+    recipientColl.find().sort({_id: 1}).forEach(function(doc) {
+        assert.eq(numDocs - doc._id, doc.i, tojson({_id: doc._id, i: doc.i}));
+        assert.eq(bigString, doc.s, 'wrong string in document ' + doc._id);
+    });
+
+    var entry = mongos.getDB('config')
+                    .changelog.find({what: 'moveChunk.to', ns: coll + ''})
+                    .sort({time: -1})
+                    .limit(1)
+                    .next();
+    assert(entry.details.hasOwnProperty('bytesPerSec'), tojson(entry));
+    assert.gt(entry.details.bytesPerSec['step 3 of 6'], 0, tojson(entry));
+    assert.gte(entry.details.bytesPerSec['step 4 of 6'], 0, tojson(entry));
+
+    st.stop();
+})();
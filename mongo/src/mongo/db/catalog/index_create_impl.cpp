@@ -47,8 +47,10 @@
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/fail_point.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
@@ -122,6 +124,183 @@ public:
 
 } exportedMaxIndexBuildMemoryUsageParameter;
 
+namespace {
+
+// The number of threads generating the keys of, and then bulk loading, the indexes of a
+// foreground build of several indexes. With 1, all of the work is done by the building thread.
+MONGO_EXPORT_SERVER_PARAMETER(internalIndexBuildParallelism, int, 4);
+
+/**
+ * Feeds the documents scanned by a foreground index build to the BulkBuilders of its indexes from
+ * worker threads, each worker generating the keys of a fixed subset of the indexes. The scanning
+ * thread queues owned copies of the documents in batches; the workers never use its
+ * OperationContext.
+ */
+class ParallelBulkKeyGenerator {
+    MONGO_DISALLOW_COPYING(ParallelBulkKeyGenerator);
+
+public:
+    struct Index {
+        IndexAccessMethod::BulkBuilder* bulk;
+        const MatchExpression* filterExpression;
+        const InsertDeleteOptions* options;
+    };
+
+    ParallelBulkKeyGenerator(std::vector<Index> indexes, size_t numWorkers)
+        : _indexes(std::move(indexes)), _numWorkers(numWorkers), _nextBatch(numWorkers, 0) {
+        for (size_t worker = 0; worker < _numWorkers; ++worker) {
+            _workers.emplace_back([this, worker] { _workerLoop(worker); });
+        }
+    }
+
+    ~ParallelBulkKeyGenerator() {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            if (_status.isOK()) {
+                // Nobody will look at the keys any more, skip whatever is still queued.
+                _status = {ErrorCodes::Interrupted, "index key generation abandoned"};
+            }
+        }
+        _stopWorkers();
+    }
+
+    /**
+     * Queues 'doc', which must be owned, blocking while the workers are too far behind. Returns
+     * the first error raised by key generation, if any.
+     */
+    Status add(BSONObj doc, const RecordId& loc) {
+        _currentBytes += doc.objsize();
+        _current.emplace_back(std::move(doc), loc);
+        if (_current.size() < kMaxBatchDocuments && _currentBytes < kMaxBatchBytes) {
+            return Status::OK();
+        }
+        return _flush();
+    }
+
+    /**
+     * Waits for the keys of all queued documents to be generated and stops the workers.
+     */
+    Status finish() {
+        Status status = _flush();
+        _stopWorkers();
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return status.isOK() ? _status : status;
+    }
+
+private:
+    using Batch = std::vector<std::pair<BSONObj, RecordId>>;
+
+    static constexpr size_t kMaxBatchDocuments = 256;
+    static constexpr int kMaxBatchBytes = 1024 * 1024;
+    static constexpr size_t kMaxQueuedBatches = 16;
+
+    Status _flush() {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _condition.wait(lk, [&] { return _batches.size() < kMaxQueuedBatches || !_status.isOK(); });
+        if (!_status.isOK()) {
+            return _status;
+        }
+        if (!_current.empty()) {
+            _batches.push_back(std::make_shared<const Batch>(std::move(_current)));
+            _current = Batch();
+            _currentBytes = 0;
+            _condition.notify_all();
+        }
+        return Status::OK();
+    }
+
+    void _stopWorkers() {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _done = true;
+        }
+        _condition.notify_all();
+        for (auto&& worker : _workers) {
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+    }
+
+    void _workerLoop(size_t worker) {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        while (true) {
+            _condition.wait(lk, [&] { return _nextBatch[worker] < _endBatch_inlock() || _done; });
+            if (_nextBatch[worker] == _endBatch_inlock()) {
+                return;
+            }
+            auto batch = _batches[_nextBatch[worker] - _firstBatch];
+            const bool failed = !_status.isOK();
+            lk.unlock();
+
+            Status status = failed ? Status::OK() : _generateKeys(worker, *batch);
+
+            lk.lock();
+            if (!status.isOK() && _status.isOK()) {
+                _status = status;
+            }
+            ++_nextBatch[worker];
+            // Release the batches every worker is done with.
+            const size_t consumed = *std::min_element(_nextBatch.begin(), _nextBatch.end());
+            while (_firstBatch < consumed) {
+                _batches.pop_front();
+                ++_firstBatch;
+            }
+            _condition.notify_all();
+        }
+    }
+
+    Status _generateKeys(size_t worker, const Batch& batch) {
+        try {
+            for (auto&& entry : batch) {
+                for (size_t i = worker; i < _indexes.size(); i += _numWorkers) {
+                    const auto& index = _indexes[i];
+                    if (index.filterExpression &&
+                        !index.filterExpression->matchesBSON(entry.first)) {
+                        continue;
+                    }
+                    int64_t unused;
+                    Status status = index.bulk->insert(
+                        nullptr, entry.first, entry.second, *index.options, &unused);
+                    if (!status.isOK()) {
+                        return status;
+                    }
+                }
+            }
+        } catch (...) {
+            return exceptionToStatus();
+        }
+        return Status::OK();
+    }
+
+    size_t _endBatch_inlock() const {
+        return _firstBatch + _batches.size();
+    }
+
+    const std::vector<Index> _indexes;
+    const size_t _numWorkers;
+
+    // Only used by the scanning thread.
+    Batch _current;
+    int _currentBytes = 0;
+
+    stdx::mutex _mutex;
+    stdx::condition_variable _condition;
+    std::deque<std::shared_ptr<const Batch>> _batches;
+    size_t _firstBatch = 0;          // Sequence number of _batches.front().
+    std::vector<size_t> _nextBatch;  // Sequence number of the next batch of each worker.
+    bool _done = false;
+    Status _status = Status::OK();
+
+    std::vector<stdx::thread> _workers;
+};
+
+constexpr size_t ParallelBulkKeyGenerator::kMaxBatchDocuments;
+constexpr int ParallelBulkKeyGenerator::kMaxBatchBytes;
+constexpr size_t ParallelBulkKeyGenerator::kMaxQueuedBatches;
+
+}  // namespace
+
 
 /**
  * On rollback sets MultiIndexBlockImpl::_needToCleanup to true.
@@ -466,6 +645,18 @@ Status MultiIndexBlockImpl::insertAllDocumentsInCollection(std::set<RecordId>* d
     auto exec =
         InternalPlanner::collectionScan(_opCtx, _collection->ns().ns(), _collection, yieldPolicy);
 
+    // With several indexes to bulk build, their keys are generated by worker threads while this
+    // thread scans the collection.
+    std::unique_ptr<ParallelBulkKeyGenerator> keyGenerator;
+    const size_t parallelism = _bulkBuildParallelism();
+    if (parallelism > 1) {
+        std::vector<ParallelBulkKeyGenerator::Index> indexes;
+        for (auto&& index : _indexes) {
+            indexes.push_back({index.bulk.get(), index.filterExpression, &index.options});
+        }
+        keyGenerator = stdx::make_unique<ParallelBulkKeyGenerator>(std::move(indexes), parallelism);
+    }
+
     Snapshotted<BSONObj> objToIndex;
     RecordId loc;
     PlanExecutor::ExecState state;
@@ -503,7 +694,8 @@ Status MultiIndexBlockImpl::insertAllDocumentsInCollection(std::set<RecordId>* d
 
             WriteUnitOfWork wunit(_opCtx);
 			//ÿݶӦһKVKVд洢
-            Status ret = insert(objToIndex.value(), loc);
+            Status ret = keyGenerator ? keyGenerator->add(objToIndex.value().getOwned(), loc)
+                                      : insert(objToIndex.value(), loc);
             if (_buildInBackground)
                 exec->saveState();
             if (ret.isOK()) {
@@ -566,6 +758,13 @@ Status MultiIndexBlockImpl::insertAllDocumentsInCollection(std::set<RecordId>* d
         invariant(!"the hangAfterStartingIndexBuildUnlocked failpoint can't be turned off");
     }
 
+    if (keyGenerator) {
+        Status keyStatus = keyGenerator->finish();
+        if (!keyStatus.isOK()) {
+            return keyStatus;
+        }
+    }
+
     progress->finished();
 
 	
@@ -640,6 +839,14 @@ MultiIndexBlockImpl::insertAllDocumentsInCollection---> |
 
 ////MultiIndexBlockImpl::insertAllDocumentsInCollection
 Status MultiIndexBlockImpl::doneInserting(std::set<RecordId>* dupsOut) {
+    const size_t parallelism = _bulkBuildParallelism();
+    if (parallelism > 1 &&
+        std::all_of(_indexes.begin(), _indexes.end(), [](const IndexToBuild& index) {
+            return index.real->canLoadBulkFromAnyThread();
+        })) {
+        return _doneInsertingInParallel(parallelism, dupsOut);
+    }
+
     for (size_t i = 0; i < _indexes.size(); i++) {
         if (_indexes[i].bulk == NULL) //Էbackgroud
             continue;
@@ -660,6 +867,119 @@ Status MultiIndexBlockImpl::doneInserting(std::set<RecordId>* dupsOut) {
     return Status::OK();
 }
 
+size_t MultiIndexBlockImpl::_bulkBuildParallelism() const {
+    const auto maxThreads = static_cast<size_t>(std::max(1, internalIndexBuildParallelism.load()));
+    if (_indexes.size() < 2 || maxThreads < 2) {
+        return 1;
+    }
+    for (auto&& index : _indexes) {
+        if (!index.bulk) {
+            return 1;
+        }
+    }
+    return std::min(maxThreads, _indexes.size());
+}
+
+Status MultiIndexBlockImpl::_doneInsertingInParallel(size_t parallelism,
+                                                     std::set<RecordId>* dupsOut) {
+    Timer timer;
+    std::vector<std::unique_ptr<IndexAccessMethod::BulkLoad>> loads;
+    long long totalKeys = 0;
+    for (auto&& index : _indexes) {
+        loads.push_back(
+            index.real->beginBulkLoad(_opCtx, std::move(index.bulk), index.options.dupsAllowed));
+        totalKeys += loads.back()->numKeys();
+    }
+
+    stdx::unique_lock<Client> lk(*_opCtx->getClient());
+    ProgressMeterHolder progress(
+        CurOp::get(_opCtx)->setMessage_inlock("Index Bulk Build: (2/3) btree bottom up",
+                                              "Index: (2/3) BTree Bottom Up Progress",
+                                              totalKeys,
+                                              10));
+    lk.unlock();
+
+    // Each worker loads whole indexes, taking the next one not yet started. This thread keeps the
+    // OperationContext: it reports progress and aborts the workers if the build is interrupted.
+    AtomicBool abort(false);
+    AtomicInt64 keysLoaded(0);
+    AtomicWord<size_t> nextLoad(0);
+    std::vector<Status> statuses(loads.size(), Status::OK());
+    std::vector<std::set<RecordId>> dups(loads.size());
+
+    stdx::mutex mutex;
+    stdx::condition_variable workerDone;
+    size_t numRunning = parallelism;
+
+    std::vector<stdx::thread> workers;
+    for (size_t w = 0; w < parallelism; ++w) {
+        workers.emplace_back([&] {
+            for (size_t i = nextLoad.fetchAndAdd(1); i < loads.size();
+                 i = nextLoad.fetchAndAdd(1)) {
+                try {
+                    statuses[i] = _indexes[i].real->loadBulkFromAnyThread(
+                        loads[i].get(), abort, &keysLoaded, dupsOut ? &dups[i] : nullptr);
+                } catch (...) {
+                    statuses[i] = exceptionToStatus();
+                }
+                if (!statuses[i].isOK()) {
+                    abort.store(true);
+                }
+            }
+            stdx::lock_guard<stdx::mutex> lk(mutex);
+            --numRunning;
+            workerDone.notify_all();
+        });
+    }
+
+    Status interruptStatus = Status::OK();
+    {
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        long long reported = 0;
+        while (numRunning) {
+            workerDone.wait_for(lk, Milliseconds(100).toSystemDuration());
+            const long long loaded = keysLoaded.load();
+            progress->hit(loaded - reported);
+            reported = loaded;
+            if (_allowInterruption && interruptStatus.isOK()) {
+                interruptStatus = _opCtx->checkForInterruptNoAssert();
+                if (!interruptStatus.isOK()) {
+                    abort.store(true);
+                }
+            }
+        }
+    }
+    for (auto&& worker : workers) {
+        worker.join();
+    }
+
+    if (_allowInterruption && interruptStatus.isOK()) {
+        // The workers may all have finished before this thread got to check.
+        interruptStatus = _opCtx->checkForInterruptNoAssert();
+    }
+    if (!interruptStatus.isOK()) {
+        return interruptStatus;
+    }
+    for (auto&& status : statuses) {
+        if (!status.isOK()) {
+            return status;
+        }
+    }
+    progress->finished();
+
+    LOG(timer.seconds() > 10 ? 0 : 1) << "\t done building bottom layer of " << loads.size()
+                                      << " indexes with " << parallelism
+                                      << " threads, going to commit";
+
+    for (size_t i = 0; i < loads.size(); ++i) {
+        if (dupsOut) {
+            dupsOut->insert(dups[i].begin(), dups[i].end());
+        }
+        _indexes[i].real->finishBulkLoad(_opCtx, std::move(loads[i]), _allowInterruption);
+    }
+    return Status::OK();
+}
+
 void MultiIndexBlockImpl::abortWithoutCleanup() {
     _indexes.clear();
     _needToCleanup = false;
@@ -220,6 +220,18 @@ private:
     class SetNeedToCleanupOnRollback;
     class CleanupIndexesVectorOnRollback;
 
+    /**
+     * Returns the number of threads generating keys and bulk loading the indexes, or 1 if the
+     * indexes are built by the calling thread alone.
+     */
+    size_t _bulkBuildParallelism() const;
+
+    /**
+     * Same as doneInserting(), adding the sorted keys of several indexes to the storage engine
+     * concurrently.
+     */
+    Status _doneInsertingInParallel(size_t parallelism, std::set<RecordId>* dupsOut);
+
     //MultiIndexBlockImpl._indexesΪͣ_indexes
     //MultiIndexBlockImpl::initʼ
     struct IndexToBuild {
@@ -373,7 +373,7 @@ at src/mongo/db/commands/find_cmd.cpp:311
         const QueryRequest& originalQR = exec->getCanonicalQuery()->getQueryRequest();
 
         // Stream query results, adding them to a BSONArray as we go.
-        CursorResponseBuilder firstBatch(/*isInitialResponse*/ true, &result);
+        CursorResponseBuilder firstBatch(/*isInitialResponse*/ true, &result, opCtx);
         BSONObj obj;
         PlanExecutor::ExecState state = PlanExecutor::ADVANCED;
         long long numResults = 0;
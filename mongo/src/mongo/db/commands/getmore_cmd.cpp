@@ -321,7 +321,7 @@ public:
         }
 
         CursorId respondWithId = 0;
-        CursorResponseBuilder nextBatch(/*isInitialResponse*/ false, &result);
+        CursorResponseBuilder nextBatch(/*isInitialResponse*/ false, &result, opCtx);
         BSONObj obj;
         PlanExecutor::ExecState state = PlanExecutor::ADVANCED;
         long long numResults = 0;
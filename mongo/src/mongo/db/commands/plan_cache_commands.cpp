@@ -35,6 +35,7 @@
 
 #include "mongo/base/init.h"
 #include "mongo/base/status.h"
+#include "mongo/bson/util/bson_extract.h"
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
@@ -476,22 +477,30 @@ Status PlanCacheListQueryShapes::runPlanCacheCommand(OperationContext* opCtx,
                                                      const string& ns,
                                                      const BSONObj& cmdObj,
                                                      BSONObjBuilder* bob) {
+    bool includeStats = false;
+    Status status = bsonExtractBooleanFieldWithDefault(cmdObj, "stats", false, &includeStats);
+    if (!status.isOK()) {
+        return status;
+    }
+
     // This is a read lock. The query cache is owned by the collection.
     AutoGetCollectionForReadCommand ctx(opCtx, NamespaceString(ns));
 
     PlanCache* planCache;
-    Status status = getPlanCache(opCtx, ctx.getCollection(), ns, &planCache);
+    status = getPlanCache(opCtx, ctx.getCollection(), ns, &planCache);
     if (!status.isOK()) {
         // No collection - return results with empty shapes array.
         BSONArrayBuilder arrayBuilder(bob->subarrayStart("shapes"));
         arrayBuilder.doneFast();
         return Status::OK();
     }
-    return list(*planCache, bob);
+    return list(*planCache, bob, includeStats);
 }
 
 // static
-Status PlanCacheListQueryShapes::list(const PlanCache& planCache, BSONObjBuilder* bob) {
+Status PlanCacheListQueryShapes::list(const PlanCache& planCache,
+                                      BSONObjBuilder* bob,
+                                      bool includeStats) {
     invariant(bob);
 
     // Fetch all cached solutions from plan cache.
@@ -510,6 +519,10 @@ Status PlanCacheListQueryShapes::list(const PlanCache& planCache, BSONObjBuilder
         if (!entry->collation.isEmpty()) {
             shapeBuilder.append("collation", entry->collation);
         }
+        if (includeStats) {
+            shapeBuilder.append("hits", static_cast<long long>(entry->hits));
+            shapeBuilder.append("replans", static_cast<long long>(entry->replans));
+        }
         shapeBuilder.doneFast();
 
         // Release resources for cached solution after extracting query shape.
@@ -517,6 +530,17 @@ Status PlanCacheListQueryShapes::list(const PlanCache& planCache, BSONObjBuilder
     }
     arrayBuilder.doneFast();
 
+    if (includeStats) {
+        const PlanCache::Stats stats = planCache.getStats();
+        BSONObjBuilder statsBuilder(bob->subobjStart("stats"));
+        statsBuilder.append("partitions", static_cast<long long>(planCache.numPartitions()));
+        statsBuilder.append("hits", static_cast<long long>(stats.hits));
+        statsBuilder.append("misses", static_cast<long long>(stats.misses));
+        statsBuilder.append("replans", static_cast<long long>(stats.replans));
+        statsBuilder.append("evictions", static_cast<long long>(stats.evictions));
+        statsBuilder.doneFast();
+    }
+
     return Status::OK();
 }
 
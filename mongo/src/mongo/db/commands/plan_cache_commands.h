@@ -106,8 +106,10 @@ private:
 /**
  * planCacheListQueryShapes
  *
- * { planCacheListQueryShapes: <collection> }
+ * { planCacheListQueryShapes: <collection>, stats: <bool> }
  *
+ * If 'stats' is true, each shape additionally reports its hit and replan counts, and the
+ * collection's cache-wide hit/miss/replan/eviction counters are returned under 'stats'.
  */
 //SetupPlanCacheCommandsж
 class PlanCacheListQueryShapes : public PlanCacheCommand {
@@ -122,7 +124,7 @@ public:
      * Looks up cache keys for collection's plan cache.
      * Inserts keys for query into BSON builder.
      */
-    static Status list(const PlanCache& planCache, BSONObjBuilder* bob);
+    static Status list(const PlanCache& planCache, BSONObjBuilder* bob, bool includeStats = false);
 };
 
 /**
@@ -94,7 +94,7 @@ bool handleCursorCommand(OperationContext* opCtx,
 
     long long batchSize = request.getBatchSize();
 
-    CursorResponseBuilder responseBuilder(true, &result);
+    CursorResponseBuilder responseBuilder(true, &result, opCtx);
     BSONObj next;
     for (int objCount = 0; objCount < batchSize; objCount++) {
         // The initial getNext() on a PipelineProxyStage may be very expensive so we don't
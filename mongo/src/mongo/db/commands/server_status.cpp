@@ -183,6 +183,21 @@ public:
         _sections[section->getSectionName()] = section;
     }
 
+    void appendSections(OperationContext* opCtx,
+                        const std::vector<std::string>& sectionNames,
+                        BSONObjBuilder* result) {
+        _runCalled = true;
+
+        for (const auto& name : sectionNames) {
+            auto it = _sections.find(name);
+            if (it == _sections.end()) {
+                continue;
+            }
+
+            it->second->appendSection(opCtx, BSONElement(), result);
+        }
+    }
+
 private:
     const Date_t _started;
     bool _runCalled;
@@ -213,6 +228,12 @@ ServerStatusSection::ServerStatusSection(const string& sectionName) : _sectionNa
     CmdServerStatusInstantiator::getInstance().addSection(this);
 }
 
+void appendServerStatusSections(OperationContext* opCtx,
+                                const std::vector<std::string>& sectionNames,
+                                BSONObjBuilder* result) {
+    CmdServerStatusInstantiator::getInstance().appendSections(opCtx, sectionNames, result);
+}
+
 ////globalOpCounterServerStatusSection
 OpCounterServerStatusSection::OpCounterServerStatusSection(const string& sectionName,
                                                            OpCounters* counters)
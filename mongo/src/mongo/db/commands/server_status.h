@@ -124,4 +124,14 @@ private:
     //globalOpCounterServerStatusSection
     const OpCounters* _counters;
 };
+
+/**
+ * Appends the named sections to 'result' as the serverStatus command would, without any of its
+ * other output. Names which are not a section are ignored, and privileges are not checked.
+ *
+ * Used to sample a few sections much more often than the whole of serverStatus.
+ */
+void appendServerStatusSections(OperationContext* opCtx,
+                                const std::vector<std::string>& sectionNames,
+                                BSONObjBuilder* result);
 }
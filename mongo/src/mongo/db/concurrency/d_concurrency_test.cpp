@@ -55,6 +55,9 @@ const int kMaxPerfThreads = 16;    // max number of threads to use for lock perf
 const int kMaxStressThreads = 32;  // max number of threads to use for lock stress
 const int kMinPerfMillis = 30;     // min duration for reliable timing
 
+// Max number of threads to use for global and database intent lock perf
+const int kMaxIntentPerfThreads = 64;
+
 /**
  * A RAII object that instantiates a TicketHolder that limits number of allowed global lock
  * acquisitions to numTickets. The opCtx must live as long as the UseGlobalThrottling instance.
@@ -1050,6 +1053,26 @@ TEST_F(DConcurrencyTestFixture, PerformanceCollectionIntentExclusiveLock) {
         kMaxPerfThreads);
 }
 
+// Global and database intent locks are taken by nearly every operation, so measure their cost
+// well past the number of partitions a small machine would have.
+TEST_F(DConcurrencyTestFixture, PerformanceDBIntentSharedLock) {
+    std::vector<std::pair<ServiceContext::UniqueClient, ServiceContext::UniqueOperationContext>>
+        clients = makeKClientsWithLockers<DefaultLockerImpl>(kMaxIntentPerfThreads);
+    ForceSupportsDocLocking supported(true);
+    perfTest(
+        [&](int threadId) { Lock::DBLock dlk(clients[threadId].second.get(), "test", MODE_IS); },
+        kMaxIntentPerfThreads);
+}
+
+TEST_F(DConcurrencyTestFixture, PerformanceDBIntentExclusiveLock) {
+    std::vector<std::pair<ServiceContext::UniqueClient, ServiceContext::UniqueOperationContext>>
+        clients = makeKClientsWithLockers<DefaultLockerImpl>(kMaxIntentPerfThreads);
+    ForceSupportsDocLocking supported(true);
+    perfTest(
+        [&](int threadId) { Lock::DBLock dlk(clients[threadId].second.get(), "test", MODE_IX); },
+        kMaxIntentPerfThreads);
+}
+
 TEST_F(DConcurrencyTestFixture, PerformanceMMAPv1CollectionSharedLock) {
     std::vector<std::pair<ServiceContext::UniqueClient, ServiceContext::UniqueOperationContext>>
         clients = makeKClientsWithLockers<DefaultLockerImpl>(kMaxPerfThreads);
@@ -118,6 +118,8 @@ featdoc:PRIMARY>
 
 #include "mongo/db/concurrency/lock_manager.h"
 
+#include <memory>
+#include <new>
 #include <third_party/murmurhash3/MurmurHash3.h>
 
 #include "mongo/base/data_type_endian.h"
@@ -127,11 +129,16 @@ featdoc:PRIMARY>
 #include "mongo/config.h"
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/concurrency/locker.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
 #include "mongo/util/stringutils.h"
 #include "mongo/util/timer.h"
 
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
 namespace mongo {
 namespace {
 
@@ -570,9 +577,8 @@ void LockHead::migratePartitionedLockHeads() {
         LockManager::Partition* partition = partitions.back();
         stdx::lock_guard<SimpleMutex> scopedLock(partition->mutex);
 
-        LockManager::Partition::Map::iterator it = partition->data.find(resourceId);
-        if (it != partition->data.end()) {
-            PartitionedLockHead* partitionedLock = it->second;
+        PartitionedLockHead* partitionedLock = partition->find(resourceId);
+        if (partitionedLock) {
 
             while (!partitionedLock->grantedList.empty()) {
                 LockRequest* request = partitionedLock->grantedList._front;
@@ -585,8 +591,7 @@ void LockHead::migratePartitionedLockHeads() {
                 LockResult res = newRequest(request);
                 invariant(res == LOCK_OK);  // Lock must still be granted
             }
-            partition->data.erase(it);
-            delete partitionedLock;
+            partition->erase(resourceId);
         }
         // Don't pop-back to early as otherwise the lock will be considered not partioned in
         // newRequest().
@@ -605,12 +610,27 @@ const unsigned LockManager::_numLockBuckets(128); //
 
 // Balance scalability of intent locks against potential added cost of conflicting locks.
 // The exact value doesn't appear very important, but should be power of two
-const unsigned LockManager::_numPartitions = 32;
+namespace {
+// Lower bound for the number of intent lock partitions on machines with few CPUs.
+const unsigned kMinNumPartitions = 32;
+}  // namespace
 
 //LockManager::LockManager()  _numLockBucketsĬ128
-LockManager::LockManager() {
+LockManager::LockManager()
+    : _numPartitions(std::max(kMinNumPartitions, stdx::thread::hardware_concurrency())) {
     _lockBuckets = new LockBucket[_numLockBuckets]; //128
-    _partitions = new Partition[_numPartitions]; //32
+
+    // Array new does not honor the cache line alignment of Partition before C++17, so the
+    // partitions are constructed in storage that is aligned by hand.
+    const size_t partitionsSize = sizeof(Partition) * _numPartitions;
+    size_t storageSize = partitionsSize + alignof(Partition);
+    _partitionStorage = new char[storageSize];
+    void* alignedStorage = _partitionStorage;
+    invariant(std::align(alignof(Partition), partitionsSize, alignedStorage, storageSize));
+    _partitions = static_cast<Partition*>(alignedStorage);
+    for (unsigned i = 0; i < _numPartitions; i++) {
+        new (&_partitions[i]) Partition();
+    }
 }
 
 LockManager::~LockManager() {
@@ -622,7 +642,11 @@ LockManager::~LockManager() {
     }
 
     delete[] _lockBuckets;
-    delete[] _partitions;
+
+    for (unsigned i = 0; i < _numPartitions; i++) {
+        _partitions[i].~Partition();
+    }
+    delete[] _partitionStorage;
 }
 
 //LockerImpl<>::lockBegin
@@ -640,6 +664,7 @@ LockResult LockManager::lock(ResourceId resId, LockRequest* request, LockMode mo
     if (request->partitioned) { //
     	//lock id࣬lockӦôǸ_partitions
     	//ڸú߼PartitionedLockHead
+        _assignPartition(request);
         Partition* partition = _getPartition(request); //ҶӦ
         stdx::lock_guard<SimpleMutex> scopedLock(partition->mutex);
 
@@ -1051,7 +1076,18 @@ LockManager::LockBucket* LockManager::_getBucket(ResourceId resId) const {
 
 //lock id࣬lockӦôǸ_partitions
 LockManager::Partition* LockManager::_getPartition(LockRequest* request) const {
-    return &_partitions[request->locker->getId() % _numPartitions]; 
+    return &_partitions[request->partitionId];
+}
+
+void LockManager::_assignPartition(LockRequest* request) const {
+#if defined(__linux__)
+    const int cpu = sched_getcpu();
+    if (cpu >= 0) {
+        request->partitionId = static_cast<unsigned>(cpu) % _numPartitions;
+        return;
+    }
+#endif
+    request->partitionId = request->locker->getId() % _numPartitions;
 }
 
 void LockManager::dump() const {
@@ -1269,13 +1305,58 @@ void LockManager::_dumpBucket(const LockBucket* bucket) const {
 
 //LockManager::lockã鿴resIdǷڸPartitionѾ
 //ÿresIdӦһPartitionedLockHeadṹLockManager._partitions[]
+LockManager::Partition::~Partition() {
+    for (auto&& slot : slots) {
+        delete slot.lock;
+    }
+    for (auto&& entry : data) {
+        delete entry.second;
+    }
+}
+
 PartitionedLockHead* LockManager::Partition::find(ResourceId resId) {
+    if (usesSlot(resId)) {
+        for (auto&& slot : slots) {
+            if (slot.resId == resId) {
+                return slot.lock;
+            }
+        }
+    }
+
     Map::iterator it = data.find(resId); //dataΪ<ResourceId, PartitionedLockHead>  findOrInsertеMap::value_type(resId, lock)
     return it == data.end() ? nullptr : it->second;
 }
 
 //ResourceIdӦPartitionedLockHeadѾڣֱӷأnew󷵻
 PartitionedLockHead* LockManager::Partition::findOrInsert(ResourceId resId) {
+    if (usesSlot(resId)) {
+        Slot* freeSlot = nullptr;
+        for (auto&& slot : slots) {
+            if (slot.resId == resId) {
+                return slot.lock;
+            }
+            if (!freeSlot && !slot.resId.isValid()) {
+                freeSlot = &slot;
+            }
+        }
+
+        // The resource may have been put in the map while all slots were taken.
+        if (!freeSlot || data.count(resId)) {
+            return findOrInsertInMap(resId);
+        }
+
+        if (!freeSlot->lock) {
+            freeSlot->lock = new PartitionedLockHead();
+        }
+        freeSlot->lock->initNew(resId);
+        freeSlot->resId = resId;
+        return freeSlot->lock;
+    }
+
+    return findOrInsertInMap(resId);
+}
+
+PartitionedLockHead* LockManager::Partition::findOrInsertInMap(ResourceId resId) {
     PartitionedLockHead* lock;
     Map::iterator it = data.find(resId);
     if (it == data.end()) {
@@ -1289,6 +1370,28 @@ PartitionedLockHead* LockManager::Partition::findOrInsert(ResourceId resId) {
     return lock;
 }
 
+void LockManager::Partition::erase(ResourceId resId) {
+    if (usesSlot(resId)) {
+        for (auto&& slot : slots) {
+            if (slot.resId == resId) {
+                invariant(slot.lock->grantedList.empty());
+                slot.resId = ResourceId();
+                return;
+            }
+        }
+    }
+
+    Map::iterator it = data.find(resId);
+    invariant(it != data.end());
+    invariant(it->second->grantedList.empty());
+    delete it->second;
+    data.erase(it);
+}
+
+bool LockManager::Partition::usesSlot(ResourceId resId) {
+    return resId.getType() == RESOURCE_GLOBAL || resId.getType() == RESOURCE_DATABASE;
+}
+
 //LockManager._lockBuckets[]Ϊ
 //LockManager::lock  ҵֱӷأûҵinsertһLockHead
 LockHead* LockManager::LockBucket::findOrInsert(ResourceId resId) {
@@ -1529,6 +1632,7 @@ void LockRequest::initNew(Locker* locker, LockGrantNotification* notify) {
     next = nullptr;
     status = STATUS_NEW;
     partitioned = false;
+    partitionId = 0;
     mode = MODE_NONE;
     convertMode = MODE_NONE;
 }
@@ -42,6 +42,7 @@
 #include "mongo/platform/unordered_map.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/stdx/new.h"
 #include "mongo/util/concurrency/mutex.h"
 
 namespace mongo {
@@ -245,12 +246,38 @@ private:
     // contention on the regular LockHead in the lock manager.
     //ÿresIdӦһPartitionedLockHeadṹLockManager._partitions[]
     //LockManager._partitions[]λͣοLockManager::lock
-    struct Partition {
+    struct alignas(stdx::hardware_destructive_interference_size) Partition {
+        ~Partition();
+
         PartitionedLockHead* find(ResourceId resId);
         PartitionedLockHead* findOrInsert(ResourceId resId);
+
+        /**
+         * Removes the PartitionedLockHead of a resource, which must not have granted requests.
+         */
+        void erase(ResourceId resId);
+
+        PartitionedLockHead* findOrInsertInMap(ResourceId resId);
+
+        /**
+         * Returns true for the resources that are kept in 'slots' rather than in 'data'.
+         */
+        static bool usesSlot(ResourceId resId);
+
         typedef unordered_map<ResourceId, PartitionedLockHead*> Map;
         SimpleMutex mutex;
 
+        // Nearly every operation takes the global and a database lock in an intent mode, so those
+        // resources live in a small inline array instead of the hash map. A slot with an invalid
+        // resId is free, but keeps its PartitionedLockHead from a previous use, so partitioning
+        // the resource again after a migration does not allocate.
+        struct Slot {
+            ResourceId resId;
+            PartitionedLockHead* lock = nullptr;
+        };
+        static const size_t kNumSlots = 8;
+        Slot slots[kNumSlots];
+
         //̿ԲοLockHead::migratePartitionedLockHeads()
         //LockManager::Partition::find  LockManager::Partition::findOrInsert
         Map data; //dataΪ<ResourceId, PartitionedLockHead>  
@@ -268,6 +295,13 @@ private:
      */
     Partition* _getPartition(LockRequest* request) const;
 
+    /**
+     * Chooses the Partition for a new intent request: the one belonging to the CPU the calling
+     * thread runs on, so lockers running on different CPUs do not share a partition mutex. The
+     * choice is saved in the request, so that unlock finds the same partition.
+     */
+    void _assignPartition(LockRequest* request) const;
+
     /**
      * Prints the contents of a bucket to the log.
      */
@@ -323,13 +357,17 @@ private:
     LockBucket* _lockBuckets; //
 
     //_partitions = new Partition[_numPartitions]; //32
-    static const unsigned _numPartitions;
+    // At least one partition per CPU, see _assignPartition.
+    const unsigned _numPartitions;
     //ÿresIdӦһPartitionedLockHeadṹLockManager._partitions[]
     
     //ǰȫҲǰȫpartitionsڸԴMODE_X MODE_S
     // ҪΪ_lockBucketsͳһǰ_partitionsҪȫϲ_lockBuckets
     //οLockManager::lock
     Partition* _partitions; //
+
+    // Raw storage the partitions are constructed in, see the LockManager constructor.
+    char* _partitionStorage;
 };
 
 
@@ -759,6 +759,14 @@ struct LockRequest { // һ
     //request->partitioned = (mode == MODE_IX || mode == MODE_IS);   ֵŻΪtrue
     bool partitioned;
 
+    // Index of the LockManager partition used for this request if it is partitioned. Chosen when
+    // the request is first locked and never changed afterwards.
+    //
+    // Written by LockManager on Locker thread
+    // Read by LockManager on any thread
+    // No synchronization
+    unsigned partitionId;
+
     // How many times has LockManager::lock been called for this request. Locks are released when
     // their recursive count drops to zero.
     //
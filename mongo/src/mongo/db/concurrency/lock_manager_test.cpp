@@ -28,7 +28,11 @@
 
 #include "mongo/db/concurrency/lock_manager_defs.h"
 #include "mongo/db/concurrency/lock_manager_test_help.h"
+#include "mongo/stdx/memory.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/mongoutils/str.h"
+
+#include <vector>
 
 namespace mongo {
 
@@ -951,4 +955,38 @@ TEST(LockManager, Fairness) {
     ASSERT(lockMgr.unlock(&requestIX1));
 }
 
+TEST(LockManager, IntentLocksOnManyDatabasesMigrateAndRepartition) {
+    LockManager lockMgr;
+
+    // More databases than a partition keeps inline, so some spill over to the partition's map.
+    const int kNumDatabases = 20;
+    std::vector<ResourceId> resIds;
+    for (int i = 0; i < kNumDatabases; i++) {
+        resIds.emplace_back(RESOURCE_DATABASE, std::string(str::stream() << "TestDB" << i));
+    }
+
+    MMAPV1LockerImpl lockerIX;
+    MMAPV1LockerImpl lockerX;
+
+    for (int round = 0; round < 2; round++) {
+        std::vector<std::unique_ptr<LockRequestCombo>> intentRequests;
+        for (auto&& resId : resIds) {
+            intentRequests.emplace_back(stdx::make_unique<LockRequestCombo>(&lockerIX));
+            ASSERT_EQ(LOCK_OK, lockMgr.lock(resId, intentRequests.back().get(), MODE_IX));
+        }
+
+        // A conflicting request migrates the partitioned intent lock and has to wait for it.
+        for (int i = 0; i < kNumDatabases; i++) {
+            LockRequestCombo requestX(&lockerX);
+            ASSERT_EQ(LOCK_WAITING, lockMgr.lock(resIds[i], &requestX, MODE_X));
+
+            ASSERT(lockMgr.unlock(intentRequests[i].get()));
+            ASSERT_EQ(LOCK_OK, requestX.lastResult);
+            ASSERT_EQ(1, requestX.numNotifies);
+
+            ASSERT(lockMgr.unlock(&requestX));
+        }
+    }
+}
+
 }  // namespace mongo
@@ -67,6 +67,7 @@
 #include "mongo/db/dbdirectclient.h"
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/dbmessage.h"
+#include "mongo/db/exec/parallel_collection_scan.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/ftdc/ftdc_mongod.h"
 #include "mongo/db/generic_cursor_manager.h"
@@ -1324,6 +1325,9 @@ void shutdownTask() {
 
     serviceContext->setKillAllOperations();
 
+    // Wait for the workers of killed parallel collection scans, which use the storage engine.
+    ParallelCollectionScan::shutdownWorkerPool(serviceContext);
+
     // Shut down the background periodic task runner
     if (auto runner = serviceContext->getPeriodicRunner()) {
         runner->shutdown();
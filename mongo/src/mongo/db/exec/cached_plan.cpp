@@ -216,6 +216,7 @@ Status CachedPlanStage::replan(PlanYieldPolicy* yieldPolicy, bool shouldCache) {
     _children.clear();
 
     _specificStats.replanned = true;
+    _collection->infoCache()->getPlanCache()->notifyOfReplan(*_canonicalQuery);
 
     // Use the query planning module to plan the whole query.
     std::vector<QuerySolution*> rawSolutions;
@@ -102,8 +102,16 @@ CollectionScan::CollectionScan(OperationContext* opCtx,
     // Explain reports the direction of the collection scan.
     _specificStats.direction = params.direction;
     _specificStats.maxTs = params.maxTs;
+    _specificStats.projectedFields = params.projectedFields;
     invariant(!_params.shouldTrackLatestOplogTimestamp || _params.collection->ns().isOplog());
 
+    // The end condition is tested against the returned document, which must then be whole.
+    invariant(_params.projectedFields.empty() || !params.maxTs);
+    for (size_t i = 0; i < _params.projectedFields.size(); ++i) {
+        _projectedFieldIndex[_params.projectedFields[i]] = i;
+    }
+    _projectedFieldSeen.resize(_params.projectedFields.size());
+
     if (params.maxTs) {
         _endConditionBSON = BSON("$gte" << *(params.maxTs));
         _endCondition = stdx::make_unique<GTEMatchExpression>();
@@ -251,6 +259,10 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {//PlanStage::wo
         }
     }
 
+    if (!_params.projectedFields.empty()) {
+        return returnProjectedIfMatches(record->data.releaseToBson(), out);
+    }
+
 	//WorkingSetҵһõλ¼,WorkingSetMemberlocֶΪ¼idֶ,
 	//objֶμ¼bsonĵ
     WorkingSetID id = _workingSet->allocate();
@@ -265,6 +277,99 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {//PlanStage::wo
     return returnIfMatches(member, id, out); //CollectionScan::returnIfMatches
 }
 
+bool CollectionScan::supportsBatchedWork() const {
+    return !_params.tailable && !_params.shouldTrackLatestOplogTimestamp && !_params.maxTs &&
+        !_params.stopApplyingFilterAfterFirstMatch && _params.start.isNull() &&
+        0 == _params.maxScan;
+}
+
+PlanStage::StageState CollectionScan::doWorkBatch(size_t maxWorks,
+                                                  std::vector<WorkingSetID>* results,
+                                                  WorkingSetID* out) {
+    if (_commonStats.isEOF) {
+        recordBatchedWork(1, 0, 0);
+        return PlanStage::IS_EOF;
+    }
+
+    if (!_cursor) {
+        // Let the single-document path deal with creating the cursor.
+        StageState state = doWork(out);
+        recordBatchedWork(1, 0, PlanStage::NEED_TIME == state ? 1 : 0);
+        invariant(PlanStage::ADVANCED != state);
+        return state;
+    }
+
+    const size_t resultsBefore = results->size();
+    const SnapshotId snapshotId = getOpCtx()->recoveryUnit()->getSnapshotId();
+    StageState state = PlanStage::NEED_TIME;
+    size_t works = 0;
+    size_t needTime = 0;
+
+    while (works < maxWorks) {
+        boost::optional<Record> record;
+        try {
+            if (auto fetcher = _cursor->fetcherForNext()) {
+                if (results->size() > resultsBefore) {
+                    // Hand back what we have. The fetch is requested again on the next call.
+                    break;
+                }
+                WorkingSetMember* member = _workingSet->get(_wsidForFetch);
+                member->setFetcher(fetcher.release());
+                *out = _wsidForFetch;
+                state = PlanStage::NEED_YIELD;
+                ++works;
+                break;
+            }
+            record = _cursor->next();
+        } catch (const WriteConflictException&) {
+            if (results->size() > resultsBefore) {
+                break;
+            }
+            *out = WorkingSet::INVALID_ID;
+            state = PlanStage::NEED_YIELD;
+            ++works;
+            break;
+        }
+
+        ++works;
+        if (!record) {
+            _commonStats.isEOF = true;
+            state = PlanStage::IS_EOF;
+            break;
+        }
+
+        _lastSeenId = record->id;
+        ++_specificStats.docsTested;
+
+        // The record's data is only valid until the cursor moves again, so the filter is applied
+        // in place and only matching documents are copied into the working set.
+        BSONObj doc = record->data.releaseToBson();
+        if (_filter && !_filter->matchesBSON(doc)) {
+            ++needTime;
+            continue;
+        }
+
+        WorkingSetID id = _workingSet->allocate();
+        WorkingSetMember* member = _workingSet->get(id);
+        if (!_params.projectedFields.empty()) {
+            member->obj = {SnapshotId(), projectRecord(doc)};
+            member->transitionToOwnedObj();
+        } else {
+            member->recordId = record->id;
+            member->obj = {snapshotId, doc.isOwned() ? doc : doc.getOwned()};
+            _workingSet->transitionToRecordIdAndObj(id);
+        }
+        results->push_back(id);
+    }
+
+    const size_t advanced = results->size() - resultsBefore;
+    recordBatchedWork(works, advanced, needTime);
+    if (advanced > 0) {
+        return PlanStage::ADVANCED;
+    }
+    return state;
+}
+
 Status CollectionScan::setLatestOplogEntryTimestamp(const Record& record) {
     auto tsElem = record.data.toBson()[repl::OpTime::kTimestampFieldName];
     if (tsElem.type() != BSONType::bsonTimestamp) {
@@ -278,6 +383,55 @@ Status CollectionScan::setLatestOplogEntryTimestamp(const Record& record) {
     return Status::OK();
 }
 
+PlanStage::StageState CollectionScan::returnProjectedIfMatches(const BSONObj& record,
+                                                               WorkingSetID* out) {
+    ++_specificStats.docsTested;
+
+    if (_filter && !_filter->matchesBSON(record)) {
+        return PlanStage::NEED_TIME;
+    }
+    if (_params.stopApplyingFilterAfterFirstMatch) {
+        _filter = nullptr;
+    }
+
+    // The projected object is not the record, so the member carries no RecordId.
+    WorkingSetID id = _workingSet->allocate();
+    WorkingSetMember* member = _workingSet->get(id);
+    member->obj = Snapshotted<BSONObj>(SnapshotId(), projectRecord(record));
+    member->transitionToOwnedObj();
+    *out = id;
+    return PlanStage::ADVANCED;
+}
+
+BSONObj CollectionScan::projectRecord(const BSONObj& record) {
+    std::fill(_projectedFieldSeen.begin(), _projectedFieldSeen.end(), 0);
+    size_t remaining = _projectedFieldSeen.size();
+
+    BSONObjBuilder bob;
+    const char* parsedUpTo = record.objdata() + sizeof(int32_t);
+    BSONObjIterator it(record);
+    while (remaining && it.more()) {
+        BSONElement elt = it.next();
+        parsedUpTo = elt.rawdata() + elt.size();
+
+        auto field = _projectedFieldIndex.find(elt.fieldNameStringData());
+        if (_projectedFieldIndex.end() == field) {
+            continue;
+        }
+        bob.append(elt);
+        if (!_projectedFieldSeen[field->second]) {
+            _projectedFieldSeen[field->second] = 1;
+            --remaining;
+        }
+    }
+
+    // The fields after the last projected one, up to the terminating EOO, were never parsed.
+    if (!remaining) {
+        _specificStats.bytesSkipped += record.objdata() + record.objsize() - 1 - parsedUpTo;
+    }
+    return bob.obj();
+}
+
 //鿴ȫɨļ¼ǷǵCollectionScanPlanStagefilter.
 //򷵻ظPlanExecutorgetNext,.
 PlanStage::StageState CollectionScan::returnIfMatches(WorkingSetMember* member,
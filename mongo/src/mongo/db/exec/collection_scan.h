@@ -34,6 +34,7 @@
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/matcher/expression_leaf.h"
 #include "mongo/db/record_id.h"
+#include "mongo/util/string_map.h"
 
 namespace mongo {
 
@@ -58,6 +59,15 @@ public:
     StageState doWork(WorkingSetID* out) final;
     bool isEOF() final;
 
+    /**
+     * Plain forward or backward scans can produce results a batch at a time. Tailable scans,
+     * $maxScan and the oplog-specific options keep using the single-document path.
+     */
+    bool supportsBatchedWork() const final;
+    StageState doWorkBatch(size_t maxWorks,
+                           std::vector<WorkingSetID>* results,
+                           WorkingSetID* out) final;
+
     void doInvalidate(OperationContext* opCtx, const RecordId& dl, InvalidationType type) final;
     void doSaveState() final;
     void doRestoreState() final;
@@ -91,6 +101,19 @@ private:
      * extracted.
      */
     Status setLatestOplogEntryTimestamp(const Record& record);
+
+    /**
+     * Used instead of returnIfMatches() when _params.projectedFields is set. Applies the filter to
+     * 'record' in place and, if it matches, returns a new member holding only the projected
+     * fields.
+     */
+    StageState returnProjectedIfMatches(const BSONObj& record, WorkingSetID* out);
+
+    /**
+     * Copies the projected fields of 'record' into a new owned object, stopping once all of them
+     * have been seen.
+     */
+    BSONObj projectRecord(const BSONObj& record);
     /*
     WorkingSetID id = _workingSet->allocate();
     WorkingSetMember* member = _workingSet->get(id);
@@ -124,6 +147,12 @@ private:
     // timestamp seen in the collection.  Otherwise, this is a null timestamp.
     Timestamp _latestOplogEntryTimestamp;
 
+    // Maps each projected field to its position in _params.projectedFields.
+    StringMap<size_t> _projectedFieldIndex;
+
+    // Scratch space for projectRecord(), recording which projected fields have been seen.
+    std::vector<char> _projectedFieldSeen;
+
     // Stats   CollectionScanӦstageͳ
     CollectionScanStats _specificStats;
 };
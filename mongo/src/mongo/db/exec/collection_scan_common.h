@@ -28,6 +28,9 @@
 
 #pragma once
 
+#include <string>
+#include <vector>
+
 #include "mongo/bson/timestamp.h"
 #include "mongo/db/record_id.h"
 
@@ -71,6 +74,11 @@ struct CollectionScanParams {
 
     // If non-zero, how many documents will we look at?
     size_t maxScan = 0; //db.collection.find( { $query: { <query> }, $maxScan: <number> } 
+
+    // If non-empty, each matching record is returned as an owned object holding only these
+    // top-level fields, and the record is not read past the last of them. Set by the stage
+    // builder when a simple inclusion projection sits directly on the scan.
+    std::vector<std::string> projectedFields;
 };
 
 }  // namespace mongo
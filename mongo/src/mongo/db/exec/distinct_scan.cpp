@@ -37,6 +37,9 @@
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/stdx/memory.h"
 
+#include <algorithm>
+#include <limits>
+
 namespace mongo {
 
 using std::unique_ptr;
@@ -81,7 +84,7 @@ PlanStage::StageState DistinctScan::doWork(WorkingSetID* out) {
     try {
         if (!_cursor)
             _cursor = _iam->newCursor(getOpCtx(), _params.direction == 1);
-        kv = _cursor->seek(_seekPoint);
+        kv = _cursor->seek(_seekPoint, SortedDataInterface::Cursor::kWantLoc);
     } catch (const WriteConflictException&) {
         *out = WorkingSet::INVALID_ID;
         return PlanStage::NEED_YIELD;
@@ -94,7 +97,14 @@ PlanStage::StageState DistinctScan::doWork(WorkingSetID* out) {
 
     ++_specificStats.keysExamined;
 
-    switch (_checker.checkKey(kv->key, &_seekPoint)) {
+    // The key is only decoded when it is outside of the current intervals or is returned.
+    const KeyString* keyString = _cursor->currentKeyString();
+    const IndexBoundsChecker::KeyState keyState =
+        keyString && _checker.isInCurrentIntervals(*keyString)
+        ? IndexBoundsChecker::VALID
+        : _checker.checkKey(_cursor->currentKey(), &_seekPoint);
+
+    switch (keyState) {
         case IndexBoundsChecker::MUST_ADVANCE:
             // Try again next time. The checker has adjusted the _seekPoint.
             return PlanStage::NEED_TIME;
@@ -107,8 +117,11 @@ PlanStage::StageState DistinctScan::doWork(WorkingSetID* out) {
 
         case IndexBoundsChecker::VALID:
             // Return this key. Adjust the _seekPoint so that it is exclusive on the field we
-            // are using.
-
+            // are using. The seek point only needs the fields up to that one.
+            kv->key = _cursor->currentKey(
+                _params.keyFieldsToDecode
+                    ? std::max(*_params.keyFieldsToDecode, size_t(_params.fieldNo + 1))
+                    : std::numeric_limits<size_t>::max());
             if (!kv->key.isOwned())
                 kv->key = kv->key.getOwned();
             _seekPoint.keyPrefix = kv->key;
@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
 
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/index/index_access_method.h"
@@ -61,6 +62,10 @@ struct DistinctParams {
     // If we distinct over 'a' the position is 0.
     // If we distinct over 'b' the position is 1.
     int fieldNo;
+
+    // How many leading fields of each returned key are used by the stages above, if not all of
+    // them. The fields up to 'fieldNo' are always decoded.
+    boost::optional<size_t> keyFieldsToDecode;
 };
 
 /**
@@ -43,6 +43,8 @@
 #include "mongo/stdx/memory.h"
 #include "mongo/util/log.h"
 
+#include <limits>
+
 namespace {
 
 // Return a value in the set {-1, 0, 1} to represent the sign of parameter i.
@@ -70,6 +72,7 @@ IndexScan::IndexScan(OperationContext* opCtx,
       _scanState(INITIALIZING),
       _filter(filter),
       _shouldDedup(true),
+      _keyFieldsToDecode(std::numeric_limits<size_t>::max()),
       _forward(params.direction == 1),
       _params(params),
       _startKeyInclusive(IndexBounds::isStartIncludedInBound(params.bounds.boundInclusion)),
@@ -126,6 +129,11 @@ boost::optional<IndexKeyEntry> IndexScan::initIndexScan() {
         _shouldDedup = _params.descriptor->isMultikey(getOpCtx());
     }
 
+    // The filter and the key metadata look at the whole key.
+    if (_params.keyFieldsToDecode && !_filter && !_params.addKeyMetadata) {
+        _keyFieldsToDecode = *_params.keyFieldsToDecode;
+    }
+
     // Perform the possibly heavy-duty initialization of the underlying index cursor.
     //WiredTigerIndexUniqueCursorṹ
     _indexCursor = _iam->newCursor(getOpCtx(), _forward); //WiredTigerIndexUnique::newCursor   
@@ -141,7 +149,8 @@ boost::optional<IndexKeyEntry> IndexScan::initIndexScan() {
 		//WiredTigerIndexCursorBase::setEndPosition
         _indexCursor->setEndPosition(_endKey, _endKeyInclusive);
 		//WiredTigerIndexCursorBase::seek  ȷҪkeyλ
-        return _indexCursor->seek(_startKey, _startKeyInclusive);
+        return _indexCursor->seek(
+            _startKey, _startKeyInclusive, SortedDataInterface::Cursor::kWantLoc);
     } else {
         // For single intervals, we can use an optimized scan which checks against the position
         // of an end cursor.  For all other index scans, we fall back on using
@@ -149,14 +158,16 @@ boost::optional<IndexKeyEntry> IndexScan::initIndexScan() {
         if (IndexBoundsBuilder::isSingleInterval(
                 _params.bounds, &_startKey, &_startKeyInclusive, &_endKey, &_endKeyInclusive)) {
             _indexCursor->setEndPosition(_endKey, _endKeyInclusive); //WiredTigerIndexCursorBase::setEndPosition
-            return _indexCursor->seek(_startKey, _startKeyInclusive); //WiredTigerIndexCursorBase::seek
+            return _indexCursor->seek(_startKey,
+                                      _startKeyInclusive,
+                                      SortedDataInterface::Cursor::kWantLoc); //WiredTigerIndexCursorBase::seek
         } else {
             _checker.reset(new IndexBoundsChecker(&_params.bounds, _keyPattern, _params.direction));
 
             if (!_checker->getStartSeekPoint(&_seekPoint))
                 return boost::none;
 			//WiredTigerIndexCursorBase::seek  ȷҪkeyλ
-            return _indexCursor->seek(_seekPoint);
+            return _indexCursor->seek(_seekPoint, SortedDataInterface::Cursor::kWantLoc);
         }
     }
 }
@@ -207,11 +218,11 @@ PlanStage::StageState IndexScan::doWork(WorkingSetID* out) { //PlanStage::work
                 kv = initIndexScan();
                 break;
             case GETTING_NEXT:
-                kv = _indexCursor->next(); //WiredTigerIndexCursorBase::next  ûдΣĬkKeyAndLoc SortedDataInterface::Cursor
+                kv = _indexCursor->next(SortedDataInterface::Cursor::kWantLoc); //WiredTigerIndexCursorBase::next  ûдΣĬkKeyAndLoc SortedDataInterface::Cursor
                 break;
             case NEED_SEEK:
                 ++_specificStats.seeks;
-                kv = _indexCursor->seek(_seekPoint);
+                kv = _indexCursor->seek(_seekPoint, SortedDataInterface::Cursor::kWantLoc);
                 break;
             case HIT_END:
                 return PlanStage::IS_EOF;
@@ -224,7 +235,7 @@ PlanStage::StageState IndexScan::doWork(WorkingSetID* out) { //PlanStage::work
     if (kv) {
         // In debug mode, check that the cursor isn't lying to us.
         if (kDebugBuild && !_startKey.isEmpty()) {
-            int cmp = kv->key.woCompare(_startKey,
+            int cmp = _indexCursor->currentKey().woCompare(_startKey,
                                         Ordering::make(_params.descriptor->keyPattern()),
                                         /*compareFieldNames*/ false);
             if (cmp == 0)
@@ -233,7 +244,7 @@ PlanStage::StageState IndexScan::doWork(WorkingSetID* out) { //PlanStage::work
         }
 
         if (kDebugBuild && !_endKey.isEmpty()) {
-            int cmp = kv->key.woCompare(_endKey,
+            int cmp = _indexCursor->currentKey().woCompare(_endKey,
                                         Ordering::make(_params.descriptor->keyPattern()),
                                         /*compareFieldNames*/ false);
             if (cmp == 0)
@@ -249,18 +260,22 @@ PlanStage::StageState IndexScan::doWork(WorkingSetID* out) { //PlanStage::work
     }
 
     if (kv && _checker) {
-		//
-        switch (_checker->checkKey(kv->key, &_seekPoint)) {
-            case IndexBoundsChecker::VALID: 
-                break;
-
-            case IndexBoundsChecker::DONE:
-                kv = boost::none;
-                break;
-
-            case IndexBoundsChecker::MUST_ADVANCE:
-                _scanState = NEED_SEEK;
-                return PlanStage::NEED_TIME;
+        // Most keys are within the current intervals, which is checked on the encoded key. The
+        // others are decoded for the checker to find where the scan goes next.
+        const KeyString* keyString = _indexCursor->currentKeyString();
+        if (!keyString || !_checker->isInCurrentIntervals(*keyString)) {
+            switch (_checker->checkKey(_indexCursor->currentKey(), &_seekPoint)) {
+                case IndexBoundsChecker::VALID:
+                    break;
+
+                case IndexBoundsChecker::DONE:
+                    kv = boost::none;
+                    break;
+
+                case IndexBoundsChecker::MUST_ADVANCE:
+                    _scanState = NEED_SEEK;
+                    return PlanStage::NEED_TIME;
+            }
         }
     }
 
@@ -282,6 +297,8 @@ PlanStage::StageState IndexScan::doWork(WorkingSetID* out) { //PlanStage::work
         }
     }
 
+    kv->key = _indexCursor->currentKey(_keyFieldsToDecode);
+
     if (_filter) { //filter : ѯSQLwhereʽ
         if (!Filter::passes(kv->key, _keyPattern, _filter)) {
             return PlanStage::NEED_TIME;
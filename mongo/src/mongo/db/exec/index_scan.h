@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
 
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/index/index_access_method.h"
@@ -62,6 +63,11 @@ struct IndexScanParams {
 
     // Do we want to add the key as metadata?
     bool addKeyMetadata;
+
+    // How many leading fields of each returned key are used by the stages above, if not all of
+    // them. The other fields are not decoded, and are left out of the key. Ignored when there is a
+    // filter or when the key is added as metadata.
+    boost::optional<size_t> keyFieldsToDecode;
 };
 
 /**
@@ -142,6 +148,10 @@ private:
     bool _shouldDedup;
     unordered_set<RecordId, RecordId::Hasher> _returned;
 
+    // The index cursor is only asked for the RecordId of each entry. The key is decoded with
+    // currentKey(), keeping this many leading fields, once the entry is known to be returned.
+    size_t _keyFieldsToDecode;
+
     const bool _forward;
     const IndexScanParams _params;
 
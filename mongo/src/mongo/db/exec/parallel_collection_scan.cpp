@@ -0,0 +1,479 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/parallel_collection_scan.h"
+
+#include <deque>
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/client.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/exec/multi_iterator.h"
+#include "mongo/db/exec/working_set.h"
+#include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/matcher/expression.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/pipeline/expression_context.h"
+#include "mongo/db/query/collation/collator_interface.h"
+#include "mongo/db/query/plan_executor.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/service_context.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+
+using std::unique_ptr;
+using stdx::make_unique;
+
+const char* ParallelCollectionScan::kStageType = "PARALLEL_COLLSCAN";
+
+namespace {
+
+// Workers stop reading once this many documents are waiting to be returned, so a slow consumer
+// does not make the scan buffer the collection.
+const size_t kMaxBufferedResults = 4096;
+
+// The number of documents a worker examines each time it takes the collection lock.
+const size_t kDocsPerBatch = 512;
+
+// How long doWork() waits for results before returning NEED_TIME, which gives the PlanExecutor a
+// chance to yield.
+const Milliseconds kWaitForResults(1);
+
+/**
+ * The thread pool running the workers of every parallel scan. It is started on first use.
+ */
+struct WorkerPool {
+    stdx::mutex mutex;
+    std::unique_ptr<ThreadPool> pool;
+    bool shutdown = false;
+};
+
+const auto getWorkerPool = ServiceContext::declareDecoration<WorkerPool>();
+
+/**
+ * Schedules 'task' on the worker pool of 'serviceContext', starting the pool if needed.
+ */
+Status scheduleWorker(ServiceContext* serviceContext, ThreadPool::Task task) {
+    auto& workerPool = getWorkerPool(serviceContext);
+    stdx::lock_guard<stdx::mutex> lk(workerPool.mutex);
+    if (workerPool.shutdown) {
+        return {ErrorCodes::ShutdownInProgress, "parallel collection scan worker pool shut down"};
+    }
+
+    if (!workerPool.pool) {
+        ThreadPool::Options options;
+        options.poolName = "parallelCollScan";
+        options.minThreads = 0;
+        options.maxThreads =
+            static_cast<size_t>(std::max(1, internalQueryParallelCollectionScanMaxThreads));
+        // Every worker runs an operation of its own.
+        options.onCreateThread = [](const std::string& threadName) {
+            Client::initThread(threadName.c_str());
+        };
+        workerPool.pool = make_unique<ThreadPool>(options);
+        workerPool.pool->startup();
+    }
+
+    return workerPool.pool->schedule(std::move(task));
+}
+
+}  // namespace
+
+struct ParallelCollectionScan::SharedState {
+    stdx::mutex mutex;
+
+    // Signaled when results are added or a worker finishes.
+    stdx::condition_variable resultsReady;
+
+    // Signaled when results are consumed or the scan is abandoned.
+    stdx::condition_variable spaceAvailable;
+
+    // Ranges not yet claimed by a worker. They are detached from any OperationContext.
+    std::deque<unique_ptr<RecordCursor>> ranges;
+
+    std::deque<BSONObj> results;
+
+    size_t activeWorkers = 0;
+    size_t docsTested = 0;
+
+    // The first error hit by a worker. It ends the scan.
+    Status status = Status::OK();
+
+    // Set when the stage is disposed of or a worker fails.
+    bool shutdown = false;
+};
+
+ParallelCollectionScan::ParallelCollectionScan(OperationContext* opCtx,
+                                               const Collection* collection,
+                                               size_t maxWorkers,
+                                               WorkingSet* workingSet,
+                                               const MatchExpression* filter,
+                                               const CollatorInterface* collator)
+    : PlanStage(kStageType, opCtx),
+      _collection(collection),
+      _workingSet(workingSet),
+      _filter(filter),
+      _collator(collator),
+      _maxWorkers(maxWorkers),
+      _state(std::make_shared<SharedState>()) {
+    invariant(_collection);
+    invariant(_maxWorkers > 0);
+}
+
+ParallelCollectionScan::~ParallelCollectionScan() {
+    doDispose();
+}
+
+// static
+bool ParallelCollectionScan::canRunInParallel(const MatchExpression* filter) {
+    if (!filter) {
+        return true;
+    }
+
+    switch (filter->matchType()) {
+        case MatchExpression::WHERE:
+        case MatchExpression::EXPRESSION:
+        case MatchExpression::TEXT:
+        case MatchExpression::GEO_NEAR:
+            return false;
+        default:
+            break;
+    }
+
+    for (size_t i = 0; i < filter->numChildren(); ++i) {
+        if (!canRunInParallel(filter->getChild(i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ParallelCollectionScan::startWorkers() {
+    auto ranges = _collection->getManyCursors(getOpCtx());
+
+    const size_t numWorkers = std::min(_maxWorkers, ranges.size());
+    _specificStats.numRanges = ranges.size();
+    _specificStats.numWorkers = numWorkers;
+
+    {
+        stdx::lock_guard<stdx::mutex> lk(_state->mutex);
+        for (auto&& range : ranges) {
+            // Each range is reattached to the OperationContext of the worker that reads it.
+            range->save();
+            range->detachFromOperationContext();
+            _state->ranges.push_back(std::move(range));
+        }
+        _state->activeWorkers = numWorkers;
+    }
+
+    LOG(1) << "Scanning " << _collection->ns() << " in " << _specificStats.numRanges
+           << " ranges using " << numWorkers << " workers";
+
+    BSONObj filterSpec;
+    if (_filter) {
+        BSONObjBuilder bob;
+        _filter->serialize(&bob);
+        filterSpec = bob.obj();
+    }
+
+    for (size_t i = 0; i < numWorkers; ++i) {
+        std::shared_ptr<CollatorInterface> collator(_collator ? _collator->clone() : nullptr);
+        Status status = scheduleWorker(getOpCtx()->getServiceContext(),
+                                       [ state = _state,
+                                         nss = _collection->ns(),
+                                         uuid = _collection->uuid(),
+                                         filterSpec,
+                                         collator ] {
+                                           runWorker(state, nss, uuid, filterSpec, collator);
+                                       });
+        if (!status.isOK()) {
+            // The workers that were not scheduled will never report back.
+            stdx::lock_guard<stdx::mutex> lk(_state->mutex);
+            _state->activeWorkers -= numWorkers - i;
+            if (_state->status.isOK()) {
+                _state->status = status;
+                _state->shutdown = true;
+            }
+            _state->resultsReady.notify_all();
+            _state->spaceAvailable.notify_all();
+            break;
+        }
+    }
+}
+
+// static
+void ParallelCollectionScan::shutdownWorkerPool(ServiceContext* serviceContext) {
+    auto& workerPool = getWorkerPool(serviceContext);
+    std::unique_ptr<ThreadPool> pool;
+    {
+        stdx::lock_guard<stdx::mutex> lk(workerPool.mutex);
+        workerPool.shutdown = true;
+        pool = std::move(workerPool.pool);
+    }
+
+    if (pool) {
+        // Operations were killed, so the workers stop at their next interrupt check.
+        pool->shutdown();
+        pool->join();
+    }
+}
+
+// static
+void ParallelCollectionScan::runWorker(std::shared_ptr<SharedState> state,
+                                       NamespaceString nss,
+                                       OptionalCollectionUUID uuid,
+                                       BSONObj filterSpec,
+                                       std::shared_ptr<CollatorInterface> collator) {
+    auto opCtx = cc().makeOperationContext();
+
+    Status status = Status::OK();
+    try {
+        // The filter and everything it refers to, 'collator' included, is owned by this worker.
+        boost::intrusive_ptr<ExpressionContext> expCtx(
+            new ExpressionContext(opCtx.get(), collator.get()));
+        unique_ptr<MatchExpression> filter;
+        if (!filterSpec.isEmpty()) {
+            filter = uassertStatusOK(MatchExpressionParser::parse(filterSpec, expCtx));
+        }
+
+        while (true) {
+            unique_ptr<RecordCursor> range;
+            {
+                stdx::lock_guard<stdx::mutex> lk(state->mutex);
+                if (state->shutdown || state->ranges.empty()) {
+                    break;
+                }
+                range = std::move(state->ranges.front());
+                state->ranges.pop_front();
+            }
+
+            scanRange(opCtx.get(), state.get(), nss, uuid, filter.get(), std::move(range));
+        }
+    } catch (const DBException& ex) {
+        status = ex.toStatus();
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(state->mutex);
+    if (!status.isOK() && state->status.isOK()) {
+        state->status = status;
+        state->shutdown = true;
+    }
+    --state->activeWorkers;
+    state->resultsReady.notify_all();
+    state->spaceAvailable.notify_all();
+}
+
+// static
+void ParallelCollectionScan::scanRange(OperationContext* opCtx,
+                                       SharedState* state,
+                                       const NamespaceString& nss,
+                                       const OptionalCollectionUUID& uuid,
+                                       const MatchExpression* filter,
+                                       unique_ptr<RecordCursor> range) {
+    unique_ptr<PlanExecutor, PlanExecutor::Deleter> exec;
+
+    // The executor must be disposed of under the collection lock.
+    ON_BLOCK_EXIT([&] {
+        if (exec) {
+            AutoGetCollection autoColl(opCtx, nss, MODE_IS);
+            exec.reset();
+        }
+    });
+
+    while (true) {
+        // Wait for room before taking any locks, so that a consumer which stops asking for results
+        // never leaves a worker holding the collection lock.
+        {
+            stdx::unique_lock<stdx::mutex> lk(state->mutex);
+            opCtx->waitForConditionOrInterrupt(state->spaceAvailable, lk, [&] {
+                return state->shutdown || state->results.size() < kMaxBufferedResults;
+            });
+            if (state->shutdown) {
+                return;
+            }
+        }
+
+        opCtx->checkForInterrupt();
+
+        AutoGetCollection autoColl(opCtx, nss, MODE_IS);
+        Collection* collection = autoColl.getCollection();
+        uassert(ErrorCodes::QueryPlanKilled,
+                str::stream() << "collection dropped during parallel scan: " << nss.ns(),
+                collection && collection->uuid() == uuid);
+
+        if (!exec) {
+            range->reattachToOperationContext(opCtx);
+            range->restore();
+
+            auto ws = make_unique<WorkingSet>();
+            auto mis = make_unique<MultiIteratorStage>(opCtx, ws.get(), collection);
+            mis->addIterator(std::move(range));
+            exec = uassertStatusOK(PlanExecutor::make(
+                opCtx, std::move(ws), std::move(mis), collection, PlanExecutor::YIELD_AUTO));
+        } else {
+            uassertStatusOK(exec->restoreState());
+        }
+
+        std::vector<BSONObj> batch;
+        size_t docsTested = 0;
+        BSONObj obj;
+        PlanExecutor::ExecState execState = PlanExecutor::ADVANCED;
+        while (docsTested < kDocsPerBatch &&
+               (execState = exec->getNext(&obj, nullptr)) == PlanExecutor::ADVANCED) {
+            ++docsTested;
+            if (!filter || filter->matchesBSON(obj)) {
+                batch.push_back(obj.getOwned());
+            }
+        }
+
+        if (execState == PlanExecutor::FAILURE || execState == PlanExecutor::DEAD) {
+            uassertStatusOK(WorkingSetCommon::getMemberObjectStatus(obj));
+        }
+
+        {
+            stdx::lock_guard<stdx::mutex> lk(state->mutex);
+            state->docsTested += docsTested;
+            for (auto&& doc : batch) {
+                state->results.push_back(std::move(doc));
+            }
+            if (!batch.empty()) {
+                state->resultsReady.notify_one();
+            }
+        }
+
+        if (execState == PlanExecutor::IS_EOF) {
+            exec.reset();
+            return;
+        }
+
+        // Release the collection lock between batches, as a yield would.
+        exec->saveState();
+        opCtx->recoveryUnit()->abandonSnapshot();
+    }
+}
+
+PlanStage::StageState ParallelCollectionScan::doWork(WorkingSetID* out) {
+    if (!_started) {
+        try {
+            startWorkers();
+        } catch (const WriteConflictException&) {
+            // Nothing was started, so we can simply try again after yielding.
+            *out = WorkingSet::INVALID_ID;
+            return NEED_YIELD;
+        }
+        _started = true;
+    }
+
+    BSONObj obj;
+    {
+        stdx::unique_lock<stdx::mutex> lk(_state->mutex);
+        if (_state->results.empty() && _state->activeWorkers > 0 && _state->status.isOK()) {
+            // Don't wait for long: returning NEED_TIME lets the PlanExecutor yield its locks.
+            _state->resultsReady.wait_for(lk, kWaitForResults.toSystemDuration());
+        }
+
+        _specificStats.docsTested = _state->docsTested;
+
+        if (!_state->status.isOK()) {
+            *out = WorkingSetCommon::allocateStatusMember(_workingSet, _state->status);
+            return PlanStage::FAILURE;
+        }
+
+        if (_state->results.empty()) {
+            return _state->activeWorkers > 0 ? PlanStage::NEED_TIME : PlanStage::IS_EOF;
+        }
+
+        obj = std::move(_state->results.front());
+        _state->results.pop_front();
+        if (_state->results.size() == kMaxBufferedResults / 2) {
+            _state->spaceAvailable.notify_all();
+        }
+    }
+
+    *out = _workingSet->allocate();
+    WorkingSetMember* member = _workingSet->get(*out);
+    member->obj = Snapshotted<BSONObj>(SnapshotId(), obj);
+    member->transitionToOwnedObj();
+    return PlanStage::ADVANCED;
+}
+
+bool ParallelCollectionScan::isEOF() {
+    if (!_started) {
+        return false;
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(_state->mutex);
+    return _state->activeWorkers == 0 && _state->results.empty() && _state->status.isOK();
+}
+
+void ParallelCollectionScan::doDispose() {
+    // The workers are not waited for: one may be waiting for a lock held by whoever is disposing of
+    // us. They exit as soon as they see the scan was abandoned, and own everything they use until
+    // then.
+    stdx::lock_guard<stdx::mutex> lk(_state->mutex);
+    _state->shutdown = true;
+    _state->results.clear();
+    _state->spaceAvailable.notify_all();
+}
+
+unique_ptr<PlanStageStats> ParallelCollectionScan::getStats() {
+    // Add a BSON representation of the filter to the stats tree, if there is one.
+    if (NULL != _filter) {
+        BSONObjBuilder bob;
+        _filter->serialize(&bob);
+        _commonStats.filter = bob.obj();
+    }
+
+    {
+        stdx::lock_guard<stdx::mutex> lk(_state->mutex);
+        _specificStats.docsTested = _state->docsTested;
+    }
+
+    unique_ptr<PlanStageStats> ret =
+        make_unique<PlanStageStats>(_commonStats, STAGE_PARALLEL_COLLSCAN);
+    ret->specific = make_unique<ParallelCollectionScanStats>(_specificStats);
+    return ret;
+}
+
+const SpecificStats* ParallelCollectionScan::getSpecificStats() const {
+    return &_specificStats;
+}
+
+}  // namespace mongo
@@ -0,0 +1,142 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+
+#include "mongo/db/catalog/collection_options.h"
+#include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/exec/plan_stats.h"
+#include "mongo/db/namespace_string.h"
+
+namespace mongo {
+
+class CollatorInterface;
+class Collection;
+class MatchExpression;
+class OperationContext;
+class RecordCursor;
+class ServiceContext;
+class WorkingSet;
+
+/**
+ * Scans a collection with several worker threads. The collection is split into disjoint ranges
+ * with Collection::getManyCursors(), and each worker reads ranges under its own OperationContext,
+ * applies the filter and passes the matching documents back to this stage as owned objects.
+ *
+ * Workers run on a thread pool shared by all parallel scans, so the number of threads is bounded
+ * server-wide. Each worker parses its own copy of the filter from an owned BSON serialization,
+ * with its own clone of 'collator', so that it never points into the query: the stage does not
+ * wait for its workers and one may still be matching a batch after the stage and its query are
+ * gone. The pool is joined at shutdown by shutdownWorkerPool().
+ *
+ * Documents come back in no particular order and without RecordIds, so this stage is only used in
+ * place of a CollectionScan for read-only plans that need neither. Workers only hold the
+ * collection lock while reading a batch, and the stage never blocks for long waiting on them, so
+ * the PlanExecutor running it keeps yielding as usual.
+ */
+class ParallelCollectionScan final : public PlanStage {
+public:
+    ParallelCollectionScan(OperationContext* opCtx,
+                           const Collection* collection,
+                           size_t maxWorkers,
+                           WorkingSet* workingSet,
+                           const MatchExpression* filter,
+                           const CollatorInterface* collator);
+
+    ~ParallelCollectionScan();
+
+    /**
+     * Returns whether 'filter' can be evaluated by the worker threads. Filters which evaluate
+     * JavaScript or aggregation expressions keep state that may not be shared across threads.
+     */
+    static bool canRunInParallel(const MatchExpression* filter);
+
+    /**
+     * Stops the thread pool shared by the workers of all parallel scans and waits for the workers
+     * to finish. Scans started afterwards fail. Must be called after all operations were killed.
+     */
+    static void shutdownWorkerPool(ServiceContext* serviceContext);
+
+    StageState doWork(WorkingSetID* out) final;
+    bool isEOF() final;
+
+    void doDispose() final;
+
+    StageType stageType() const final {
+        return STAGE_PARALLEL_COLLSCAN;
+    }
+
+    std::unique_ptr<PlanStageStats> getStats() final;
+
+    const SpecificStats* getSpecificStats() const final;
+
+    static const char* kStageType;
+
+private:
+    struct SharedState;
+
+    /**
+     * Splits the collection into ranges and starts the workers.
+     */
+    void startWorkers();
+
+    /**
+     * Reads ranges until there are none left or the scan is abandoned. Workers share their state
+     * with the stage through 'state' so that they can outlive it: a worker waiting for the
+     * collection lock behind a drop notices that the stage is gone once it gets the lock.
+     */
+    static void runWorker(std::shared_ptr<SharedState> state,
+                          NamespaceString nss,
+                          OptionalCollectionUUID uuid,
+                          BSONObj filterSpec,
+                          std::shared_ptr<CollatorInterface> collator);
+
+    static void scanRange(OperationContext* opCtx,
+                          SharedState* state,
+                          const NamespaceString& nss,
+                          const OptionalCollectionUUID& uuid,
+                          const MatchExpression* filter,
+                          std::unique_ptr<RecordCursor> range);
+
+    // Not owned by us. Only used on the thread running the stage.
+    const Collection* _collection;
+    WorkingSet* _workingSet;
+    const MatchExpression* _filter;
+    const CollatorInterface* _collator;
+
+    const size_t _maxWorkers;
+    bool _started = false;
+
+    std::shared_ptr<SharedState> _state;
+
+    ParallelCollectionScanStats _specificStats;
+};
+
+}  // namespace mongo
@@ -122,6 +122,50 @@ PlanStage::StageState PlanStage::work(WorkingSetID* out) {   //
     return workResult;
 }
 
+PlanStage::StageState PlanStage::workBatch(size_t maxWorks,
+                                           std::vector<WorkingSetID>* results,
+                                           WorkingSetID* out) {
+    invariant(_opCtx);
+    invariant(maxWorks > 0);
+    const size_t resultsBefore = results->size();
+
+    if (supportsBatchedWork()) {
+        ScopedTimer timer(getClock(), &_commonStats.executionTimeMillis);
+        StageState state = doWorkBatch(maxWorks, results, out);
+        if (StageState::NEED_YIELD == state) {
+            ++_commonStats.needYield;
+        }
+        invariant((StageState::ADVANCED == state) == (results->size() > resultsBefore));
+        return state;
+    }
+
+    // Fallback: drive the single-result interface until the budget is used up or something other
+    // than a result or NEED_TIME comes back.
+    if (_pendingBatchState) {
+        StageState state = _pendingBatchState->first;
+        *out = _pendingBatchState->second;
+        _pendingBatchState = boost::none;
+        return state;
+    }
+
+    for (size_t works = 0; works < maxWorks; ++works) {
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        StageState state = work(&id);
+        if (StageState::ADVANCED == state) {
+            results->push_back(id);
+        } else if (StageState::NEED_TIME != state) {
+            if (results->size() == resultsBefore) {
+                *out = id;
+                return state;
+            }
+            // Hand back the results we have, and report this state on the next call.
+            _pendingBatchState = std::make_pair(state, id);
+            return StageState::ADVANCED;
+        }
+    }
+    return results->size() > resultsBefore ? StageState::ADVANCED : StageState::NEED_TIME;
+}
+
 void PlanStage::saveState() {
     ++_commonStats.yields;
     for (auto&& child : _children) {
@@ -28,12 +28,15 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "mongo/db/exec/plan_stats.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/invalidation_type.h"
+#include "mongo/util/assert_util.h"
 
 namespace mongo {
 
@@ -189,6 +192,29 @@ public:
      */
     StageState work(WorkingSetID* out);
 
+    /**
+     * Batched variant of work(). Performs up to 'maxWorks' units of work and appends every
+     * result produced to 'results'.
+     *
+     * Returns ADVANCED if at least one result was appended. Otherwise returns the state of the
+     * last unit of work performed, with '*out' set exactly as work() would have set it; NEED_TIME
+     * means the budget was used up without producing a result. A stage that hits a non-ADVANCED
+     * state after producing results stops early and returns ADVANCED; the state is reported again
+     * by the next call.
+     *
+     * Stages for which supportsBatchedWork() is false fall back to calling work() in a loop.
+     */
+    StageState workBatch(size_t maxWorks, std::vector<WorkingSetID>* results, WorkingSetID* out);
+
+    /**
+     * Returns true if this stage, and every stage below it whose output it consumes, implements
+     * doWorkBatch() natively. The PlanExecutor only drives a plan through workBatch() if its root
+     * returns true.
+     */
+    virtual bool supportsBatchedWork() const {
+        return false;
+    }
+
     /**
      * Returns true if no more work can be done on the query / out of results.
      */
@@ -348,6 +374,27 @@ protected:
      */ //Ӧ//IndexScan::doWork()  CollectionScan::doWork(ȫɨ)  
     virtual StageState doWork(WorkingSetID* out) = 0;
 
+    /**
+     * Performs a batch of work. See comment at workBatch() above. Only called if
+     * supportsBatchedWork() returns true. Implementations are responsible for accounting for the
+     * units of work they perform by calling recordBatchedWork().
+     */
+    virtual StageState doWorkBatch(size_t maxWorks,
+                                   std::vector<WorkingSetID>* results,
+                                   WorkingSetID* out) {
+        MONGO_UNREACHABLE;
+    }
+
+    /**
+     * Adds the outcome of a batch of work to the common stats. 'works' counts every unit of work
+     * performed, of which 'advanced' produced a result and 'needTime' produced nothing.
+     */
+    void recordBatchedWork(size_t works, size_t advanced, size_t needTime) {
+        _commonStats.works += works;
+        _commonStats.advanced += advanced;
+        _commonStats.needTime += needTime;
+    }
+
     /**
      * Saves any stage-specific state required to resume where it was if the underlying data
      * changes.
@@ -400,6 +447,10 @@ protected:
 
 private:
     OperationContext* _opCtx;
+
+    // A non-ADVANCED state, and its out parameter, which the workBatch() fallback got from work()
+    // after it had already produced results. Returned by the next call to workBatch().
+    boost::optional<std::pair<StageState, WorkingSetID>> _pendingBatchState;
 };
 
 }  // namespace mongo
@@ -288,7 +288,7 @@ struct CachedPlanStats : public SpecificStats {
 
 //CollectionScanӦstageͳ
 struct CollectionScanStats : public SpecificStats {
-    CollectionScanStats() : docsTested(0), direction(1) {}
+    CollectionScanStats() : docsTested(0), direction(1), bytesSkipped(0) {}
 
     SpecificStats* clone() const final {
         CollectionScanStats* specific = new CollectionScanStats(*this);
@@ -307,6 +307,12 @@ struct CollectionScanStats : public SpecificStats {
     // sees a document that does not pass the filter and has a "ts" Timestamp field greater than
     // 'maxTs'.
     boost::optional<Timestamp> maxTs;
+
+    // The top-level fields extracted from each record when a projection was pushed into the scan.
+    std::vector<std::string> projectedFields;
+
+    // Record bytes after the last projected field, which the scan did not have to parse.
+    long long bytesSkipped;
 };
 
 struct CountStats : public SpecificStats {
@@ -607,6 +613,19 @@ struct OrStats : public SpecificStats {
     size_t recordIdsForgotten;
 };
 
+struct ParallelCollectionScanStats : public SpecificStats {
+    SpecificStats* clone() const final {
+        return new ParallelCollectionScanStats(*this);
+    }
+
+    // How many documents did the workers check against the filter?
+    size_t docsTested = 0;
+
+    // The number of ranges the collection was split into, and the number of workers reading them.
+    size_t numRanges = 0;
+    size_t numWorkers = 0;
+};
+
 struct ProjectionStats : public SpecificStats {
     ProjectionStats() {}
 
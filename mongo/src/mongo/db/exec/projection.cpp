@@ -56,9 +56,13 @@ ProjectionStage::ProjectionStage(OperationContext* opCtx,
                                  const ProjectionStageParams& params,
                                  WorkingSet* ws,
                                  PlanStage* child)
-    : PlanStage(kStageType, opCtx), _ws(ws), _projImpl(params.projImpl) {
+    : PlanStage(kStageType, opCtx),
+      _ws(ws),
+      _projImpl(params.projImpl),
+      _childProjects(params.childProjects) {
     _children.emplace_back(child);
     _projObj = params.projObj;
+    invariant(!_childProjects || ProjectionStageParams::SIMPLE_DOC == _projImpl);
 
     if (ProjectionStageParams::NO_FAST_PATH == _projImpl) {
         _exec.reset(
@@ -148,6 +152,11 @@ Status ProjectionStage::transform(WorkingSetMember* member) {
         return _exec->transform(member);
     }
 
+    if (_childProjects) {
+        invariant(WorkingSetMember::OWNED_OBJ == member->getState());
+        return Status::OK();
+    }
+
     BSONObjBuilder bob;
 
     // Note that even if our fast path analysis is bug-free something that is
@@ -227,6 +236,44 @@ PlanStage::StageState ProjectionStage::doWork(WorkingSetID* out) {
     return status;
 }
 
+PlanStage::StageState ProjectionStage::doWorkBatch(size_t maxWorks,
+                                                   std::vector<WorkingSetID>* results,
+                                                   WorkingSetID* out) {
+    const size_t resultsBefore = results->size();
+    WorkingSetID id = WorkingSet::INVALID_ID;
+    StageState status = child()->workBatch(maxWorks, results, &id);
+
+    if (PlanStage::ADVANCED == status) {
+        // Project the whole block in one pass.
+        const size_t advanced = results->size() - resultsBefore;
+        for (size_t i = resultsBefore; i < results->size(); ++i) {
+            Status projStatus = transform(_ws->get((*results)[i]));
+            if (!projStatus.isOK()) {
+                warning() << "Couldn't execute projection, status = " << redact(projStatus);
+                for (size_t j = resultsBefore; j < results->size(); ++j) {
+                    _ws->free((*results)[j]);
+                }
+                results->resize(resultsBefore);
+                recordBatchedWork(i - resultsBefore + 1, 0, 0);
+                *out = WorkingSetCommon::allocateStatusMember(_ws, projStatus);
+                return PlanStage::FAILURE;
+            }
+        }
+        recordBatchedWork(advanced, advanced, 0);
+        return PlanStage::ADVANCED;
+    }
+
+    recordBatchedWork(1, 0, PlanStage::NEED_TIME == status ? 1 : 0);
+    *out = id;
+    if ((PlanStage::FAILURE == status || PlanStage::DEAD == status) &&
+        WorkingSet::INVALID_ID == id) {
+        Status status(ErrorCodes::InternalError,
+                      "projection stage failed to read in results from child");
+        *out = WorkingSetCommon::allocateStatusMember(_ws, status);
+    }
+    return status;
+}
+
 unique_ptr<PlanStageStats> ProjectionStage::getStats() {
     _commonStats.isEOF = isEOF();
     unique_ptr<PlanStageStats> ret = make_unique<PlanStageStats>(_commonStats, STAGE_PROJECTION);
@@ -70,6 +70,10 @@ struct ProjectionStageParams {
     // The collator this operation should use to compare strings. If null, the collation is a simple
     // binary compare.
     const CollatorInterface* collator = nullptr;
+
+    // SIMPLE_DOC only: the child already returns owned objects holding just the projected fields
+    // (see CollectionScanParams::projectedFields), so they are passed through unchanged.
+    bool childProjects = false;
 };
 
 /**
@@ -85,6 +89,13 @@ public:
     bool isEOF() final;
     StageState doWork(WorkingSetID* out) final;
 
+    bool supportsBatchedWork() const final {
+        return child()->supportsBatchedWork();
+    }
+    StageState doWorkBatch(size_t maxWorks,
+                           std::vector<WorkingSetID>* results,
+                           WorkingSetID* out) final;
+
     StageType stageType() const final {
         return STAGE_PROJECTION;
     }
@@ -127,6 +138,7 @@ private:
 
     // Fast paths:
     ProjectionStageParams::ProjectionImplementation _projImpl;
+    const bool _childProjects;
 
     // Used by all projection implementations.
     BSONObj _projObj;
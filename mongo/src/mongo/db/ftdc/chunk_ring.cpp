@@ -0,0 +1,163 @@
+/**
+ * Copyright (C) 2017 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/ftdc/chunk_ring.h"
+
+#include <boost/optional.hpp>
+
+#include "mongo/db/ftdc/constants.h"
+#include "mongo/db/ftdc/decompressor.h"
+#include "mongo/db/ftdc/util.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+namespace {
+
+// Rough upper bound on the size of one value in a query result, used to refuse queries whose
+// result would not fit in a BSON document before building it.
+const std::size_t kMaxBytesPerValue = 16;
+
+}  // namespace
+
+void FTDCChunkRing::addChunk(const BSONObj& chunk) {
+    stdx::lock_guard<stdx::mutex> lock(_mutex);
+
+    _chunks.push_back(chunk.getOwned());
+    _bytes += chunk.objsize();
+    _interimChunk = BSONObj();
+
+    while (_bytes > _maxBytes && _chunks.size() > 1) {
+        _bytes -= _chunks.front().objsize();
+        _chunks.pop_front();
+    }
+}
+
+void FTDCChunkRing::setInterimChunk(const BSONObj& chunk) {
+    stdx::lock_guard<stdx::mutex> lock(_mutex);
+    _interimChunk = chunk.getOwned();
+}
+
+Status FTDCChunkRing::query(Date_t start,
+                            Date_t end,
+                            const std::vector<std::string>& paths,
+                            BSONObjBuilder* builder) const {
+    // Pick the chunks which may have samples in range. A chunk's samples were all collected before
+    // the first sample of the next chunk.
+    std::vector<BSONObj> chunks;
+    {
+        stdx::lock_guard<stdx::mutex> lock(_mutex);
+
+        for (size_t i = 0; i < _chunks.size(); ++i) {
+            if (_chunks[i][kFTDCIdField].Date() > end) {
+                break;
+            }
+
+            const BSONObj& next = (i + 1 < _chunks.size()) ? _chunks[i + 1] : _interimChunk;
+            if (!next.isEmpty() && next[kFTDCIdField].Date() <= start) {
+                continue;
+            }
+
+            chunks.push_back(_chunks[i]);
+        }
+
+        if (!_interimChunk.isEmpty() && _interimChunk[kFTDCIdField].Date() <= end) {
+            chunks.push_back(_interimChunk);
+        }
+    }
+
+    // The first column is the collection start time of each sample.
+    std::vector<std::string> columnPaths;
+    columnPaths.reserve(paths.size() + 1);
+    columnPaths.emplace_back(kFTDCCollectStartField);
+    columnPaths.insert(columnPaths.end(), paths.begin(), paths.end());
+
+    std::vector<long long> times;
+    std::vector<std::vector<boost::optional<long long>>> values(paths.size());
+
+    FTDCDecompressor decompressor;
+    for (const auto& chunk : chunks) {
+        auto swColumns =
+            FTDCBSONUtil::getMetricColumnsFromMetricDoc(chunk, columnPaths, &decompressor);
+        if (!swColumns.isOK()) {
+            return swColumns.getStatus();
+        }
+
+        const auto& columns = swColumns.getValue();
+        const auto& startColumn = columns.front();
+
+        for (size_t sample = 0; sample < startColumn.size(); ++sample) {
+            auto time = static_cast<long long>(startColumn[sample]);
+            if (time < start.toMillisSinceEpoch() || time > end.toMillisSinceEpoch()) {
+                continue;
+            }
+
+            times.push_back(time);
+            for (size_t i = 0; i < paths.size(); ++i) {
+                const auto& column = columns[i + 1];
+                values[i].push_back(column.empty()
+                                        ? boost::none
+                                        : boost::make_optional(
+                                              static_cast<long long>(column[sample])));
+            }
+        }
+    }
+
+    if (times.size() * (paths.size() + 1) * kMaxBytesPerValue >
+        static_cast<std::size_t>(BSONObjMaxUserSize)) {
+        return {ErrorCodes::InvalidLength,
+                str::stream() << "Query for " << paths.size() << " metrics matched "
+                              << times.size()
+                              << " samples, which is too many to return. Narrow the time range."};
+    }
+
+    {
+        BSONArrayBuilder startBuilder(builder->subarrayStart(kFTDCCollectStartField));
+        for (auto time : times) {
+            startBuilder.append(Date_t::fromMillisSinceEpoch(time));
+        }
+    }
+
+    BSONObjBuilder metricsBuilder(builder->subobjStart("metrics"));
+    for (size_t i = 0; i < paths.size(); ++i) {
+        BSONArrayBuilder columnBuilder(metricsBuilder.subarrayStart(paths[i]));
+        for (const auto& value : values[i]) {
+            if (value) {
+                columnBuilder.append(*value);
+            } else {
+                columnBuilder.appendNull();
+            }
+        }
+    }
+
+    return Status::OK();
+}
+
+}  // namespace mongo
@@ -0,0 +1,107 @@
+/**
+ * Copyright (C) 2017 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+/**
+ * Keeps the most recent compressed metric chunks in memory so that they can be queried without
+ * reading the FTDC files back.
+ *
+ * Chunks are kept in the same BSON form as they are written to the archive file, and are only
+ * inflated when queried. The oldest chunks are dropped once the ring holds more than its byte
+ * limit. The samples which have not made it into a complete chunk yet are covered by the most
+ * recent interim chunk, which is replaced each time the interim file is written.
+ *
+ * Thread-safe.
+ */
+class FTDCChunkRing {
+    MONGO_DISALLOW_COPYING(FTDCChunkRing);
+
+public:
+    explicit FTDCChunkRing(std::size_t maxBytes) : _maxBytes(maxBytes) {}
+
+    /**
+     * Add a complete metric chunk document, as created by
+     * FTDCBSONUtil::createBSONMetricChunkDocument. Discards the interim chunk since its samples are
+     * included in this one.
+     */
+    void addChunk(const BSONObj& chunk);
+
+    /**
+     * Replace the interim chunk, which holds the samples collected since the last complete chunk.
+     */
+    void setInterimChunk(const BSONObj& chunk);
+
+    /**
+     * Appends the values of the metrics named by 'paths' for each sample collected in
+     * [start, end] to 'builder' in columnar form:
+     * {
+     *    "start" : [ Date_t, ... ],      <- Time at which each sample was collected
+     *    "metrics" : {
+     *       "path" : [ NumberLong, ... ] <- null for samples which do not have this metric
+     *       ...
+     *    }
+     * }
+     *
+     * Only the requested metrics are inflated from each chunk.
+     */
+    Status query(Date_t start,
+                 Date_t end,
+                 const std::vector<std::string>& paths,
+                 BSONObjBuilder* builder) const;
+
+private:
+    // Protects all members below.
+    mutable stdx::mutex _mutex;
+
+    const std::size_t _maxBytes;
+
+    // Complete chunks, oldest first
+    std::deque<BSONObj> _chunks;
+
+    // Sum of the sizes of '_chunks'
+    std::size_t _bytes{0};
+
+    // Samples since the last complete chunk, may be empty
+    BSONObj _interimChunk;
+};
+
+}  // namespace mongo
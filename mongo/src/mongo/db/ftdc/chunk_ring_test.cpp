@@ -0,0 +1,169 @@
+/**
+ * Copyright (C) 2017 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <limits>
+#include <vector>
+
+#include "mongo/bson/bsonmisc.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/ftdc/chunk_ring.h"
+#include "mongo/db/ftdc/compressor.h"
+#include "mongo/db/ftdc/config.h"
+#include "mongo/db/ftdc/util.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const Date_t kEpoch = Date_t::fromMillisSinceEpoch(1000 * 1000);
+
+Date_t sampleTime(int i) {
+    return kEpoch + Seconds(i);
+}
+
+/**
+ * Compresses the samples into 'ring' the same way FTDCFileWriter does, leaving the samples of the
+ * last incomplete chunk as the interim chunk.
+ */
+void addSamples(FTDCChunkRing* ring, const FTDCConfig& config, const std::vector<BSONObj>& samples) {
+    FTDCCompressor compressor(&config);
+
+    for (const auto& sample : samples) {
+        auto date = sample["start"].Date();
+        auto swChunk = compressor.addSample(sample, date);
+        ASSERT_OK(swChunk.getStatus());
+
+        if (swChunk.getValue().is_initialized()) {
+            const auto& chunk = swChunk.getValue().get();
+            ring->addChunk(
+                FTDCBSONUtil::createBSONMetricChunkDocument(std::get<0>(chunk), std::get<2>(chunk)));
+        }
+    }
+
+    if (compressor.hasDataToFlush()) {
+        auto swBuf = compressor.getCompressedSamples();
+        ASSERT_OK(swBuf.getStatus());
+        ring->setInterimChunk(FTDCBSONUtil::createBSONMetricChunkDocument(
+            std::get<0>(swBuf.getValue()), std::get<1>(swBuf.getValue())));
+    }
+}
+
+BSONObj query(const FTDCChunkRing& ring,
+              Date_t start,
+              Date_t end,
+              const std::vector<std::string>& paths) {
+    BSONObjBuilder builder;
+    ASSERT_OK(ring.query(start, end, paths, &builder));
+    return builder.obj();
+}
+
+// Query a range which spans complete chunks, a schema change and the interim chunk, with a metric
+// which only some of the samples have.
+TEST(FTDCChunkRingTest, QueryReturnsRequestedColumnsInRange) {
+    FTDCConfig config;
+    config.maxSamplesPerArchiveMetricChunk = 3;
+
+    std::vector<BSONObj> samples;
+    for (int i = 0; i < 10; i++) {
+        samples.push_back(BSON("start" << sampleTime(i) << "a" << BSON("b" << i << "c" << 7)));
+    }
+    for (int i = 10; i < 16; i++) {
+        samples.push_back(BSON("start" << sampleTime(i) << "a" << BSON("b" << i << "c" << 7)
+                                       << "ts"
+                                       << Timestamp(i, 1)));
+    }
+
+    FTDCChunkRing ring(std::numeric_limits<std::size_t>::max());
+    addSamples(&ring, config, samples);
+
+    auto result = query(ring, sampleTime(2), sampleTime(13), {"a.b", "ts.t", "missing"});
+
+    std::vector<BSONElement> start = result["start"].Array();
+    std::vector<BSONElement> b = result["metrics"]["a.b"].Array();
+    std::vector<BSONElement> ts = result["metrics"]["ts.t"].Array();
+    std::vector<BSONElement> missing = result["metrics"]["missing"].Array();
+
+    ASSERT_EQUALS(12U, start.size());
+    ASSERT_EQUALS(12U, b.size());
+    ASSERT_EQUALS(12U, ts.size());
+    ASSERT_EQUALS(12U, missing.size());
+
+    for (int i = 0; i < 12; i++) {
+        ASSERT_EQUALS(sampleTime(i + 2), start[i].Date());
+        ASSERT_EQUALS(i + 2, b[i].numberLong());
+        if (i + 2 < 10) {
+            ASSERT_TRUE(ts[i].isNull());
+        } else {
+            ASSERT_EQUALS(i + 2, ts[i].numberLong());
+        }
+        ASSERT_TRUE(missing[i].isNull());
+    }
+}
+
+TEST(FTDCChunkRingTest, DropsOldestChunksOverSizeLimit) {
+    FTDCConfig config;
+    config.maxSamplesPerArchiveMetricChunk = 4;
+
+    std::vector<BSONObj> samples;
+    for (int i = 0; i < 40; i++) {
+        samples.push_back(BSON("start" << sampleTime(i) << "a" << i * i));
+    }
+
+    // Measure one chunk to size the ring to hold two of them.
+    FTDCCompressor compressor(&config);
+    int chunkSize = 0;
+    for (int i = 0; i < 5 && chunkSize == 0; i++) {
+        auto swChunk = compressor.addSample(samples[i], sampleTime(i));
+        ASSERT_OK(swChunk.getStatus());
+        if (swChunk.getValue().is_initialized()) {
+            chunkSize = FTDCBSONUtil::createBSONMetricChunkDocument(
+                            std::get<0>(swChunk.getValue().get()), sampleTime(0))
+                            .objsize();
+        }
+    }
+    ASSERT_GREATER_THAN(chunkSize, 0);
+
+    FTDCChunkRing ring(chunkSize * 2 + chunkSize / 2);
+    addSamples(&ring, config, samples);
+
+    auto result = query(ring, Date_t(), sampleTime(40), {"a"});
+    std::vector<BSONElement> start = result["start"].Array();
+    std::vector<BSONElement> a = result["metrics"]["a"].Array();
+
+    // Each chunk holds a reference sample and four deltas, and the last chunk is complete.
+    ASSERT_EQUALS(10U, start.size());
+    ASSERT_EQUALS(sampleTime(30), start.front().Date());
+    ASSERT_EQUALS(30 * 30, a.front().numberLong());
+    ASSERT_EQUALS(39 * 39, a.back().numberLong());
+}
+
+}  // namespace
+}  // namespace mongo
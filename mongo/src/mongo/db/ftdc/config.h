@@ -46,7 +46,8 @@ struct FTDCConfig {
           maxFileSizeBytes(kMaxFileSizeBytesDefault),
           period(kPeriodMillisDefault),
           maxSamplesPerArchiveMetricChunk(kMaxSamplesPerArchiveMetricChunkDefault),
-          maxSamplesPerInterimMetricChunk(kMaxSamplesPerInterimMetricChunkDefault) {}
+          maxSamplesPerInterimMetricChunk(kMaxSamplesPerInterimMetricChunkDefault),
+          highFrequencyPeriod(kHighFrequencyPeriodMillisDefault) {}
 
     /**
      * True if FTDC is collecting data. False otherwise
@@ -83,9 +84,18 @@ struct FTDCConfig {
      */
     std::uint32_t maxSamplesPerInterimMetricChunk;
 
+    /**
+     * Period at which to run the high frequency collectors, or zero to not run them.
+     *
+     * Their samples are only kept in memory for queries, so they do not add to the size of the
+     * FTDC files.
+     */
+    Milliseconds highFrequencyPeriod;
+
     static const bool kEnabledDefault = true;
 
     static const std::int64_t kPeriodMillisDefault;
+    static const std::int64_t kHighFrequencyPeriodMillisDefault = 0;
     static const std::uint64_t kMaxDirectorySizeBytesDefault = 200 * 1024 * 1024;
     static const std::uint64_t kMaxFileSizeBytesDefault = 10 * 1024 * 1024;
 
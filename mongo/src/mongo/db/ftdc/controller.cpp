@@ -32,6 +32,8 @@
 
 #include "mongo/db/ftdc/controller.h"
 
+#include <algorithm>
+
 #include "mongo/db/client.h"
 #include "mongo/db/ftdc/collector.h"
 #include "mongo/db/ftdc/util.h"
@@ -101,6 +103,12 @@ void FTDCController::setMaxSamplesPerInterimMetricChunk(size_t size) {
     _condvar.notify_one();
 }
 
+void FTDCController::setHighFrequencyPeriod(Milliseconds millis) {
+    stdx::lock_guard<stdx::mutex> lock(_mutex);
+    _configTemp.highFrequencyPeriod = millis;
+    _condvar.notify_one();
+}
+
 Status FTDCController::setDirectory(const boost::filesystem::path& path) {
     stdx::lock_guard<stdx::mutex> lock(_mutex);
 
@@ -136,6 +144,24 @@ void FTDCController::addOnRotateCollector(std::unique_ptr<FTDCCollectorInterface
     }
 }
 
+void FTDCController::addHighFrequencyCollector(std::unique_ptr<FTDCCollectorInterface> collector) {
+    {
+        stdx::lock_guard<stdx::mutex> lock(_mutex);
+        invariant(_state == State::kNotStarted);
+
+        _highFrequencyCollectors.add(std::move(collector));
+    }
+}
+
+Status FTDCController::queryRecentMetrics(Date_t start,
+                                          Date_t end,
+                                          const std::vector<std::string>& paths,
+                                          bool highFrequency,
+                                          BSONObjBuilder* builder) const {
+    return (highFrequency ? _highFrequencyChunks : _recentChunks)
+        .query(start, end, paths, builder);
+}
+
 BSONObj FTDCController::getMostRecentPeriodicDocument() {
     {
         stdx::lock_guard<stdx::mutex> lock(_mutex);
@@ -211,13 +237,23 @@ void FTDCController::doLoop() {
             // Get next time to run at
             auto next_time = FTDCUtil::roundTime(now, _config.period);
 
+            // The high frequency collectors run on their own period, which is usually shorter, so
+            // wake up for whichever comes first.
+            auto next_high_frequency_time = Date_t::max();
+            if (_config.highFrequencyPeriod > Milliseconds(0) &&
+                !_highFrequencyCollectors.empty()) {
+                next_high_frequency_time = FTDCUtil::roundTime(now, _config.highFrequencyPeriod);
+            }
+
+            auto wake_time = std::min(next_time, next_high_frequency_time);
+
             // Wait for the next run or signal to shutdown
             {
                 stdx::unique_lock<stdx::mutex> lock(_mutex);
                 MONGO_IDLE_THREAD_BLOCK;
 
                 // We ignore spurious wakeups by just doing an iteration of the loop
-                auto status = _condvar.wait_until(lock, next_time.toSystemTimePoint());
+                auto status = _condvar.wait_until(lock, wake_time.toSystemTimePoint());
 
                 // Are we done running?
                 if (_state == State::kStopRequested) {
@@ -238,6 +274,15 @@ void FTDCController::doLoop() {
                 }
             }
 
+            if (_config.enabled && next_high_frequency_time == wake_time) {
+                collectHighFrequencySample(client);
+            }
+
+            // Only the high frequency collectors were due
+            if (next_time != wake_time) {
+                continue;
+            }
+
             // TODO: consider only running this thread if we are enabled
             // for now, we just keep an idle thread as it is simpler
             if (_config.enabled) {
@@ -248,6 +293,7 @@ void FTDCController::doLoop() {
                         FTDCFileManager::create(&_config, _path, &_rotateCollectors, client);
 
                     _mgr = uassertStatusOK(std::move(swMgr));
+                    _mgr->setChunkRing(&_recentChunks);
                 }
 
 				//FTDCCollectorCollection::collect
@@ -272,4 +318,31 @@ void FTDCController::doLoop() {
     }
 }
 
+void FTDCController::collectHighFrequencySample(Client* client) {
+    if (!_highFrequencyCompressor) {
+        _highFrequencyCompressor = stdx::make_unique<FTDCCompressor>(&_config);
+    }
+
+    auto collectSample = _highFrequencyCollectors.collect(client);
+
+    auto swChunk =
+        _highFrequencyCompressor->addSample(std::get<0>(collectSample), std::get<1>(collectSample));
+    uassertStatusOK(swChunk.getStatus());
+
+    if (swChunk.getValue().is_initialized()) {
+        const auto& chunk = swChunk.getValue().get();
+        _highFrequencyChunks.addChunk(
+            FTDCBSONUtil::createBSONMetricChunkDocument(std::get<0>(chunk), std::get<2>(chunk)));
+        return;
+    }
+
+    // Keep the samples since the last complete chunk queryable, as the interim file does on disk.
+    auto sampleCount = _highFrequencyCompressor->getSampleCount();
+    if (sampleCount != 0 && (sampleCount % _config.maxSamplesPerInterimMetricChunk) == 0) {
+        auto swBuf = uassertStatusOK(_highFrequencyCompressor->getCompressedSamples());
+        _highFrequencyChunks.setInterimChunk(
+            FTDCBSONUtil::createBSONMetricChunkDocument(std::get<0>(swBuf), std::get<1>(swBuf)));
+    }
+}
+
 }  // namespace mongo
@@ -31,9 +31,13 @@
 #include <boost/filesystem/path.hpp>
 #include <cstdint>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "mongo/base/disallow_copying.h"
+#include "mongo/db/ftdc/chunk_ring.h"
 #include "mongo/db/ftdc/collector.h"
+#include "mongo/db/ftdc/compressor.h"
 #include "mongo/db/ftdc/config.h"
 #include "mongo/db/ftdc/file_manager.h"
 #include "mongo/db/jsobj.h"
@@ -98,6 +102,11 @@ public:
      */
     void setMaxSamplesPerInterimMetricChunk(size_t size);
 
+    /**
+     * Set the period for the high frequency collectors, zero disables them.
+     */
+    void setHighFrequencyPeriod(Milliseconds millis);
+
     /*
      * Set the path to store FTDC files if not already set.
      *
@@ -117,6 +126,13 @@ public:
      */
     void addOnRotateCollector(std::unique_ptr<FTDCCollectorInterface> collector);
 
+    /**
+     * Add a collector to collect on the high frequency period. i.e. a few serverStatus sections
+     *
+     * These samples are kept in memory only, and can be read with queryRecentMetrics.
+     */
+    void addHighFrequencyCollector(std::unique_ptr<FTDCCollectorInterface> collector);
+
     /**
      * Start the controller.
      *
@@ -141,12 +157,32 @@ public:
      */
     BSONObj getMostRecentPeriodicDocument();
 
+    /**
+     * Get the values of the named metrics collected in [start, end] from the chunks kept in
+     * memory, either from the periodic or from the high frequency collectors. See
+     * FTDCChunkRing::query for the format.
+     */
+    Status queryRecentMetrics(Date_t start,
+                              Date_t end,
+                              const std::vector<std::string>& paths,
+                              bool highFrequency,
+                              BSONObjBuilder* builder) const;
+
+    // Maximum size of the compressed chunks kept in memory for each of the periodic and high
+    // frequency collectors.
+    static const std::size_t kMaxRecentChunkBytes = 16 * 1024 * 1024;
+
 private:
     /**
      * Do periodic statistics collection, and all other work on the background thread.
      */
     void doLoop();
 
+    /**
+     * Collect a sample from the high frequency collectors and compress it into memory.
+     */
+    void collectHighFrequencySample(Client* client);
+
 private:
     /**
     * Private enum to track state.
@@ -209,6 +245,18 @@ private:
     // File manager that manages file rotation, and logging
     std::unique_ptr<FTDCFileManager> _mgr;
 
+    // Recent chunks written by the file manager
+    FTDCChunkRing _recentChunks{kMaxRecentChunkBytes};
+
+    // Set of high frequency collectors
+    FTDCCollectorCollection _highFrequencyCollectors;
+
+    // Compressor for the high frequency samples, only used on the background thread
+    std::unique_ptr<FTDCCompressor> _highFrequencyCompressor;
+
+    // Recent chunks from the high frequency collectors
+    FTDCChunkRing _highFrequencyChunks{kMaxRecentChunkBytes};
+
     // Background collection and writing thread
     stdx::thread _thread;
 };
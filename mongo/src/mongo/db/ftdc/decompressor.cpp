@@ -30,6 +30,8 @@
 
 #include "mongo/db/ftdc/decompressor.h"
 
+#include <algorithm>
+
 #include "mongo/base/data_range_cursor.h"
 #include "mongo/base/data_type_validated.h"
 #include "mongo/db/ftdc/compressor.h"
@@ -41,13 +43,17 @@
 
 namespace mongo {
 
-StatusWith<std::vector<BSONObj>> FTDCDecompressor::uncompress(ConstDataRange buf) {
+Status FTDCDecompressor::_readChunk(ConstDataRange buf,
+                                     BSONObj* ref,
+                                     std::uint32_t* metricsCount,
+                                     std::uint32_t* sampleCount,
+                                     ConstDataRangeCursor* deltas) {
     ConstDataRangeCursor compressedDataRange(buf);
 
     // Read the length of the uncompressed buffer
     auto swUncompressedLength = compressedDataRange.readAndAdvance<LittleEndian<std::uint32_t>>();
     if (!swUncompressedLength.isOK()) {
-        return {swUncompressedLength.getStatus()};
+        return swUncompressedLength.getStatus();
     }
 
     // Now uncompress the data
@@ -61,7 +67,7 @@ StatusWith<std::vector<BSONObj>> FTDCDecompressor::uncompress(ConstDataRange buf
     auto statusUncompress = _compressor.uncompress(compressedDataRange, uncompressedLength);
 
     if (!statusUncompress.isOK()) {
-        return {statusUncompress.getStatus()};
+        return statusUncompress.getStatus();
     }
 
     ConstDataRangeCursor cdc = statusUncompress.getValue();
@@ -69,33 +75,48 @@ StatusWith<std::vector<BSONObj>> FTDCDecompressor::uncompress(ConstDataRange buf
     // The document is not part of any checksum so we must validate it is correct
     auto swRef = cdc.readAndAdvance<Validated<BSONObj>>();
     if (!swRef.isOK()) {
-        return {swRef.getStatus()};
+        return swRef.getStatus();
     }
 
-    BSONObj ref = swRef.getValue();
+    *ref = swRef.getValue();
 
     // Read count of metrics
     auto swMetricsCount = cdc.readAndAdvance<LittleEndian<std::uint32_t>>();
     if (!swMetricsCount.isOK()) {
-        return {swMetricsCount.getStatus()};
+        return swMetricsCount.getStatus();
     }
 
-    std::uint32_t metricsCount = swMetricsCount.getValue();
+    *metricsCount = swMetricsCount.getValue();
 
     // Read count of samples
     auto swSampleCount = cdc.readAndAdvance<LittleEndian<std::uint32_t>>();
     if (!swSampleCount.isOK()) {
-        return {swSampleCount.getStatus()};
+        return swSampleCount.getStatus();
     }
 
-    std::uint32_t sampleCount = swSampleCount.getValue();
+    *sampleCount = swSampleCount.getValue();
 
     // Limit size of the buffer we need for metrics and samples
-    if (metricsCount * sampleCount > 1000000) {
+    if (*metricsCount * *sampleCount > 1000000) {
         return Status(ErrorCodes::InvalidLength,
                       "Metrics Count and Sample Count have exceeded the allowable range.");
     }
 
+    *deltas = cdc;
+    return Status::OK();
+}
+
+StatusWith<std::vector<BSONObj>> FTDCDecompressor::uncompress(ConstDataRange buf) {
+    BSONObj ref;
+    std::uint32_t metricsCount;
+    std::uint32_t sampleCount;
+    ConstDataRangeCursor cdc(nullptr, nullptr);
+
+    Status status = _readChunk(buf, &ref, &metricsCount, &sampleCount, &cdc);
+    if (!status.isOK()) {
+        return status;
+    }
+
     std::vector<std::uint64_t> metrics;
 
     metrics.reserve(metricsCount);
@@ -180,4 +201,90 @@ StatusWith<std::vector<BSONObj>> FTDCDecompressor::uncompress(ConstDataRange buf
     return {docs};
 }
 
+StatusWith<std::vector<std::vector<std::uint64_t>>> FTDCDecompressor::uncompressColumns(
+    ConstDataRange buf, const std::vector<std::string>& paths) {
+    BSONObj ref;
+    std::uint32_t metricsCount;
+    std::uint32_t sampleCount;
+    ConstDataRangeCursor cdrc(nullptr, nullptr);
+
+    Status status = _readChunk(buf, &ref, &metricsCount, &sampleCount, &cdrc);
+    if (!status.isOK()) {
+        return status;
+    }
+
+    std::vector<std::uint64_t> metrics;
+    metrics.reserve(metricsCount);
+    (void)FTDCBSONUtil::extractMetricsFromDocument(ref, ref, &metrics);
+
+    std::vector<std::string> names;
+    names.reserve(metricsCount);
+    status = FTDCBSONUtil::extractMetricNamesFromDocument(ref, &names);
+    if (!status.isOK()) {
+        return status;
+    }
+
+    if (metrics.size() != metricsCount || names.size() != metricsCount) {
+        return {ErrorCodes::BadValue,
+                "The metrics in the reference document and metrics count do not match"};
+    }
+
+    // Map each metric to the column that wants it, if any.
+    std::vector<int> columnForMetric(metricsCount, -1);
+    for (size_t column = 0; column < paths.size(); ++column) {
+        auto it = std::find(names.begin(), names.end(), paths[column]);
+        if (it != names.end()) {
+            columnForMetric[it - names.begin()] = column;
+        }
+    }
+
+    std::vector<std::vector<std::uint64_t>> columns(paths.size());
+    for (std::uint32_t i = 0; i < metricsCount; i++) {
+        if (columnForMetric[i] >= 0) {
+            columns[columnForMetric[i]].reserve(1 + sampleCount);
+            columns[columnForMetric[i]].push_back(metrics[i]);
+        }
+    }
+
+    // The deltas of every metric still have to be decoded since they are variable length, and runs
+    // of zeroes may span metrics, but only the wanted ones are stored and summed.
+    std::uint64_t zeroesCount = 0;
+
+    for (std::uint32_t i = 0; i < metricsCount; i++) {
+        auto column = columnForMetric[i] >= 0 ? &columns[columnForMetric[i]] : nullptr;
+
+        for (std::uint32_t j = 0; j < sampleCount; j++) {
+            std::uint64_t delta = 0;
+
+            if (zeroesCount) {
+                zeroesCount--;
+            } else {
+                auto swDelta = cdrc.readAndAdvance<FTDCVarInt>();
+
+                if (!swDelta.isOK()) {
+                    return swDelta.getStatus();
+                }
+
+                delta = swDelta.getValue();
+
+                if (delta == 0) {
+                    auto swZero = cdrc.readAndAdvance<FTDCVarInt>();
+
+                    if (!swZero.isOK()) {
+                        return swZero.getStatus();
+                    }
+
+                    zeroesCount = swZero.getValue();
+                }
+            }
+
+            if (column) {
+                column->push_back(column->back() + delta);
+            }
+        }
+    }
+
+    return {std::move(columns)};
+}
+
 }  // namespace mongo
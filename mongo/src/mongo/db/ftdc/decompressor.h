@@ -28,9 +28,12 @@
 
 #pragma once
 
+#include <cstdint>
+#include <string>
 #include <vector>
 
 #include "mongo/base/data_range.h"
+#include "mongo/base/data_range_cursor.h"
 #include "mongo/base/disallow_copying.h"
 #include "mongo/base/status_with.h"
 #include "mongo/db/ftdc/block_compressor.h"
@@ -56,6 +59,28 @@ public:
      */
     StatusWith<std::vector<BSONObj>> uncompress(ConstDataRange buf);
 
+    /**
+     * Inflates only the named metrics of a compressed chunk, without reconstructing the samples as
+     * BSON documents. Metric names are dotted paths as produced by
+     * FTDCBSONUtil::extractMetricNamesFromDocument.
+     *
+     * Returns one column per path with N values, where N = sample count + 1 as for uncompress().
+     * The column is empty if the chunk does not contain that metric.
+     */
+    StatusWith<std::vector<std::vector<std::uint64_t>>> uncompressColumns(
+        ConstDataRange buf, const std::vector<std::string>& paths);
+
+private:
+    /**
+     * Inflates a chunk and reads its header. On success, 'deltas' is positioned at the start of
+     * the varint encoded deltas, and remains valid until the next call.
+     */
+    Status _readChunk(ConstDataRange buf,
+                      BSONObj* ref,
+                      std::uint32_t* metricsCount,
+                      std::uint32_t* sampleCount,
+                      ConstDataRangeCursor* deltas);
+
 private:
     BlockCompressor _compressor;
 };
@@ -89,6 +89,13 @@ public:
      */
     Status close();
 
+    /**
+     * Hand each metric chunk that is written to 'ring' as well. See FTDCFileWriter::setChunkRing.
+     */
+    void setChunkRing(FTDCChunkRing* ring) {
+        _writer.setChunkRing(ring);
+    }
+
 public:
     /**
      * Generate a new file name for the archive.
@@ -37,6 +37,7 @@
 #include <string>
 
 #include "mongo/base/string_data.h"
+#include "mongo/db/ftdc/chunk_ring.h"
 #include "mongo/db/ftdc/compressor.h"
 #include "mongo/db/ftdc/config.h"
 #include "mongo/db/ftdc/util.h"
@@ -172,6 +173,10 @@ Status FTDCFileWriter::writeSample(const BSONObj& sample, Date_t date) {
 
         BSONObj o = FTDCBSONUtil::createBSONMetricChunkDocument(std::get<0>(swBuf.getValue()),
                                                                 std::get<1>(swBuf.getValue()));
+        if (_chunkRing) {
+            _chunkRing->setInterimChunk(o);
+        }
+
         return writeInterimFileBuffer({o.objdata(), static_cast<size_t>(o.objsize())});
     }
 
@@ -189,6 +194,10 @@ Status FTDCFileWriter::flush(const boost::optional<ConstDataRange>& range, Date_
 
             BSONObj o = FTDCBSONUtil::createBSONMetricChunkDocument(std::get<0>(swBuf.getValue()),
                                                                     std::get<1>(swBuf.getValue()));
+            if (_chunkRing) {
+                _chunkRing->addChunk(o);
+            }
+
             Status s = writeArchiveFileBuffer({o.objdata(), static_cast<size_t>(o.objsize())});
 
             if (!s.isOK()) {
@@ -197,6 +206,10 @@ Status FTDCFileWriter::flush(const boost::optional<ConstDataRange>& range, Date_
         }
     } else {
         BSONObj o = FTDCBSONUtil::createBSONMetricChunkDocument(range.get(), date);
+        if (_chunkRing) {
+            _chunkRing->addChunk(o);
+        }
+
         Status s = writeArchiveFileBuffer({o.objdata(), static_cast<size_t>(o.objsize())});
 
         if (!s.isOK()) {
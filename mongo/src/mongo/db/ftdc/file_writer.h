@@ -40,6 +40,8 @@
 
 namespace mongo {
 
+class FTDCChunkRing;
+
 /**
  * Manages writing to an append only archive file, and an interim file.
  *  - The archive file is designed to write complete metric chunks.
@@ -92,6 +94,14 @@ public:
         return _size + _sizeInterim;
     }
 
+    /**
+     * Also hand each metric chunk written to the archive and interim files to 'ring', so that
+     * recent samples can be queried without reading the files. Not owned.
+     */
+    void setChunkRing(FTDCChunkRing* ring) {
+        _chunkRing = ring;
+    }
+
 public:
     /**
      * Test hook that closes the files without moving interim results to the archive log.
@@ -139,6 +149,9 @@ private:
 
     // Size of interim file
     std::size_t _sizeInterim{0};
+
+    // Recent chunks for queries, may be null
+    FTDCChunkRing* _chunkRing{nullptr};
 };
 
 }  // namespace mongo
@@ -29,6 +29,7 @@
 #include "mongo/platform/basic.h"
 
 #include "mongo/base/init.h"
+#include "mongo/bson/util/bson_extract.h"
 #include "mongo/db/auth/action_type.h"
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/client.h"
@@ -36,6 +37,8 @@
 #include "mongo/db/ftdc/controller.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/service_context.h"
+#include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
 namespace {
@@ -44,6 +47,16 @@ namespace {
  * Get the most recent document FTDC collected from its periodic collectors.
  *
  * Document will be empty if FTDC has never run.
+ *
+ * If "metrics" is given, instead get the values of those metrics from the samples kept in memory:
+ * {
+ *    getDiagnosticData : 1,
+ *    metrics : [ "serverStatus.opcounters.insert", ... ],  <- dotted paths in the FTDC sample
+ *    start : Date_t,                                       <- optional, defaults to the epoch
+ *    end : Date_t,                                         <- optional, defaults to now
+ *    highFrequency : bool                                  <- optional, read the samples of the
+ *                                                             high frequency collectors instead
+ * }
  */
 class GetDiagnosticDataCommand final : public BasicCommand {
 public:
@@ -92,15 +105,64 @@ public:
              const std::string& db,
              const BSONObj& cmdObj,
              BSONObjBuilder& result) override {
+        auto controller = FTDCController::get(opCtx->getServiceContext());
+
+        if (!cmdObj.hasField(kMetricsFieldName)) {
+            result.append("data", controller->getMostRecentPeriodicDocument());
+            return true;
+        }
+
+        BSONElement metricsElement;
+        uassertStatusOK(
+            bsonExtractTypedField(cmdObj, kMetricsFieldName, BSONType::Array, &metricsElement));
 
-        result.append(
-            "data",
-            FTDCController::get(opCtx->getServiceContext())->getMostRecentPeriodicDocument());
+        std::vector<std::string> paths;
+        for (auto&& path : metricsElement.Obj()) {
+            uassert(ErrorCodes::TypeMismatch,
+                    str::stream() << "'" << kMetricsFieldName << "' must be an array of strings",
+                    path.type() == String);
+            paths.push_back(path.str());
+        }
+
+        auto start = Date_t();
+        if (cmdObj.hasField(kStartFieldName)) {
+            BSONElement startElement;
+            uassertStatusOK(
+                bsonExtractTypedField(cmdObj, kStartFieldName, BSONType::Date, &startElement));
+            start = startElement.Date();
+        }
+
+        auto end = opCtx->getServiceContext()->getPreciseClockSource()->now();
+        if (cmdObj.hasField(kEndFieldName)) {
+            BSONElement endElement;
+            uassertStatusOK(
+                bsonExtractTypedField(cmdObj, kEndFieldName, BSONType::Date, &endElement));
+            end = endElement.Date();
+        }
+
+        bool highFrequency;
+        uassertStatusOK(bsonExtractBooleanFieldWithDefault(
+            cmdObj, kHighFrequencyFieldName, false, &highFrequency));
+
+        BSONObjBuilder seriesBuilder(result.subobjStart("series"));
+        uassertStatusOK(
+            controller->queryRecentMetrics(start, end, paths, highFrequency, &seriesBuilder));
 
         return true;
     }
+
+private:
+    static constexpr StringData kMetricsFieldName = "metrics"_sd;
+    static constexpr StringData kStartFieldName = "start"_sd;
+    static constexpr StringData kEndFieldName = "end"_sd;
+    static constexpr StringData kHighFrequencyFieldName = "highFrequency"_sd;
 };
 
+constexpr StringData GetDiagnosticDataCommand::kMetricsFieldName;
+constexpr StringData GetDiagnosticDataCommand::kStartFieldName;
+constexpr StringData GetDiagnosticDataCommand::kEndFieldName;
+constexpr StringData GetDiagnosticDataCommand::kHighFrequencyFieldName;
+
 Command* ftdcCommand;
 
 MONGO_INITIALIZER(CreateDiagnosticDataCommand)(InitializerContext* context) {
@@ -30,6 +30,7 @@
 
 #include "mongo/db/ftdc/ftdc_server.h"
 
+#include <algorithm>
 #include <boost/filesystem.hpp>
 #include <fstream>
 #include <memory>
@@ -37,6 +38,7 @@
 #include "mongo/base/status.h"
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/commands.h"
+#include "mongo/db/commands/server_status.h"
 #include "mongo/db/ftdc/collector.h"
 #include "mongo/db/ftdc/config.h"
 #include "mongo/db/ftdc/controller.h"
@@ -45,6 +47,8 @@
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/stringutils.h"
 
 namespace mongo {
 
@@ -241,6 +245,64 @@ public:
     }
 
 } exportedFTDCInterimChunkSizeParameter;
+
+AtomicInt32 localHighFrequencyPeriodMillis(FTDCConfig::kHighFrequencyPeriodMillisDefault);
+
+class ExportedFTDCHighFrequencyPeriodParameter
+    : public ExportedServerParameter<std::int32_t, ServerParameterType::kStartupAndRuntime> {
+public:
+    ExportedFTDCHighFrequencyPeriodParameter()
+        : ExportedServerParameter<std::int32_t, ServerParameterType::kStartupAndRuntime>(
+              ServerParameterSet::getGlobal(),
+              "diagnosticDataCollectionHighFrequencyPeriodMillis",
+              &localHighFrequencyPeriodMillis) {}
+
+    virtual Status validate(const std::int32_t& potentialNewValue) {
+        if (potentialNewValue != 0 && potentialNewValue < 10) {
+            return Status(ErrorCodes::BadValue,
+                          "diagnosticDataCollectionHighFrequencyPeriodMillis must be 0 or greater "
+                          "than or equal to 10ms");
+        }
+
+        auto controller = getGlobalFTDCController();
+        if (controller) {
+            controller->setHighFrequencyPeriod(Milliseconds(potentialNewValue));
+        }
+
+        return Status::OK();
+    }
+
+} exportedFTDCHighFrequencyPeriodParameter;
+
+std::string localHighFrequencySections = "locks,wiredTiger.cache";
+
+class ExportedFTDCHighFrequencySectionsParameter
+    : public ExportedServerParameter<std::string, ServerParameterType::kStartupOnly> {
+public:
+    ExportedFTDCHighFrequencySectionsParameter()
+        : ExportedServerParameter<std::string, ServerParameterType::kStartupOnly>(
+              ServerParameterSet::getGlobal(),
+              "diagnosticDataCollectionHighFrequencySections",
+              &localHighFrequencySections) {}
+
+    virtual Status validate(const std::string& potentialNewValue) {
+        std::vector<std::string> paths;
+        splitStringDelim(potentialNewValue, &paths, ',');
+        for (const auto& path : paths) {
+            if (path.empty() || std::count(path.begin(), path.end(), '.') > 1) {
+                return Status(ErrorCodes::BadValue,
+                              str::stream() << "diagnosticDataCollectionHighFrequencySections must "
+                                               "be a comma separated list of serverStatus "
+                                               "sections or section.field names, got '"
+                                            << path
+                                            << "'");
+            }
+        }
+
+        return Status::OK();
+    }
+
+} exportedFTDCHighFrequencySectionsParameter;
 }  // namespace
 
 FTDCSimpleInternalCommandCollector::FTDCSimpleInternalCommandCollector(StringData command,
@@ -261,6 +323,64 @@ std::string FTDCSimpleInternalCommandCollector::name() const {
     return _name;
 }
 
+FTDCServerStatusSectionsCollector::FTDCServerStatusSectionsCollector(
+    const std::vector<std::string>& paths) {
+    std::vector<bool> wholeSection;
+
+    for (const auto& path : paths) {
+        auto dot = path.find('.');
+        auto sectionName = path.substr(0, dot);
+
+        auto it = std::find(_sectionNames.begin(), _sectionNames.end(), sectionName);
+        if (it == _sectionNames.end()) {
+            _sectionNames.push_back(sectionName);
+            _fieldNames.emplace_back();
+            wholeSection.push_back(false);
+            it = _sectionNames.end() - 1;
+        }
+
+        size_t i = it - _sectionNames.begin();
+        if (dot == std::string::npos) {
+            // The whole section wins over any of its fields.
+            wholeSection[i] = true;
+            _fieldNames[i].clear();
+        } else if (!wholeSection[i]) {
+            _fieldNames[i].push_back(path.substr(dot + 1));
+        }
+    }
+}
+
+void FTDCServerStatusSectionsCollector::collect(OperationContext* opCtx,
+                                                BSONObjBuilder& builder) {
+    BSONObjBuilder sectionsBuilder;
+    appendServerStatusSections(opCtx, _sectionNames, &sectionsBuilder);
+    BSONObj sections = sectionsBuilder.obj();
+
+    for (size_t i = 0; i < _sectionNames.size(); ++i) {
+        BSONElement section = sections[_sectionNames[i]];
+        if (section.eoo()) {
+            continue;
+        }
+
+        if (_fieldNames[i].empty() || section.type() != Object) {
+            builder.append(section);
+            continue;
+        }
+
+        BSONObjBuilder sectionBuilder(builder.subobjStart(_sectionNames[i]));
+        for (const auto& fieldName : _fieldNames[i]) {
+            BSONElement field = section.Obj()[fieldName];
+            if (!field.eoo()) {
+                sectionBuilder.append(field);
+            }
+        }
+    }
+}
+
+std::string FTDCServerStatusSectionsCollector::name() const {
+    return "serverStatus";
+}
+
 // Register the FTDC system
 // Note: This must be run before the server parameters are parsed during startup
 // so that the FTDCController is initialized.
@@ -278,6 +398,7 @@ void startFTDC(boost::filesystem::path& path,
     config.maxDirectorySizeBytes = localMaxDirectorySizeMB.load() * 1024 * 1024;
     config.maxSamplesPerArchiveMetricChunk = localMaxSamplesPerArchiveMetricChunk.load();
     config.maxSamplesPerInterimMetricChunk = localMaxSamplesPerInterimMetricChunk.load();
+    config.highFrequencyPeriod = Milliseconds(localHighFrequencyPeriodMillis.load());
 
     auto controller = stdx::make_unique<FTDCController>(path, config);
 
@@ -301,6 +422,16 @@ void startFTDC(boost::filesystem::path& path,
 
     registerCollectors(controller.get());
 
+    // Install high frequency collectors
+    // These are collected on the high frequency period in FTDCConfig when it is set, and are only
+    // kept in memory.
+    std::vector<std::string> highFrequencyPaths;
+    splitStringDelim(localHighFrequencySections, &highFrequencyPaths, ',');
+    if (!highFrequencyPaths.empty()) {
+        controller->addHighFrequencyCollector(
+            stdx::make_unique<FTDCServerStatusSectionsCollector>(highFrequencyPaths));
+    }
+
     // Install System Metric Collector as a periodic collector
     installSystemMetricsCollector(controller.get());
 
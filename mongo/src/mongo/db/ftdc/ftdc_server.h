@@ -29,6 +29,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/commands.h"
@@ -96,4 +97,26 @@ private:
     const OpMsgRequest _request;
 };
 
+/**
+ * An FTDC Collector for a few serverStatus sections, cheap enough to run on a much shorter period
+ * than the whole of serverStatus.
+ *
+ * Each path names either a section, i.e. "locks", or a section and one of its top level fields,
+ * i.e. "wiredTiger.cache".
+ */
+class FTDCServerStatusSectionsCollector final : public FTDCCollectorInterface {
+public:
+    explicit FTDCServerStatusSectionsCollector(const std::vector<std::string>& paths);
+
+    void collect(OperationContext* opCtx, BSONObjBuilder& builder) override;
+    std::string name() const override;
+
+private:
+    // Sections to generate, in order
+    std::vector<std::string> _sectionNames;
+
+    // Fields to keep for each section in '_sectionNames', all of them if empty
+    std::vector<std::vector<std::string>> _fieldNames;
+};
+
 }  // namespace mongo
@@ -236,6 +236,57 @@ StatusWith<bool> extractMetricsFromDocument(const BSONObj& referenceDoc,
     return extractMetricsFromDocument(referenceDoc, currentDoc, metrics, true, 0);
 }
 
+namespace {
+Status extractMetricNamesFromDocument(const BSONObj& referenceDoc,
+                                      const std::string& prefix,
+                                      std::vector<std::string>* names,
+                                      size_t recursion) {
+    if (recursion > kMaxRecursion) {
+        return {ErrorCodes::BadValue, "Recursion limit reached."};
+    }
+
+    BSONObjIterator iterator(referenceDoc);
+    while (iterator.more()) {
+        BSONElement currentElement = iterator.next();
+        std::string name = prefix + currentElement.fieldName();
+
+        switch (currentElement.type()) {
+            case NumberDouble:
+            case NumberInt:
+            case NumberLong:
+            case NumberDecimal:
+            case Bool:
+            case Date:
+                names->emplace_back(std::move(name));
+                break;
+
+            case bsonTimestamp:
+                names->emplace_back(name + ".t");
+                names->emplace_back(name + ".i");
+                break;
+
+            case Object:
+            case Array: {
+                auto s = extractMetricNamesFromDocument(
+                    currentElement.Obj(), name + ".", names, recursion + 1);
+                if (!s.isOK()) {
+                    return s;
+                }
+            } break;
+
+            default:
+                break;
+        }
+    }
+
+    return Status::OK();
+}
+}  // namespace
+
+Status extractMetricNamesFromDocument(const BSONObj& referenceDoc, std::vector<std::string>* names) {
+    return extractMetricNamesFromDocument(referenceDoc, "", names, 0);
+}
+
 namespace {
 Status constructDocumentFromMetrics(const BSONObj& referenceDocument,
                                     BSONObjBuilder& builder,
@@ -433,6 +484,25 @@ StatusWith<std::vector<BSONObj>> getMetricsFromMetricDoc(const BSONObj& obj,
     return decompressor->uncompress({buffer, static_cast<std::size_t>(length)});
 }
 
+StatusWith<std::vector<std::vector<std::uint64_t>>> getMetricColumnsFromMetricDoc(
+    const BSONObj& obj, const std::vector<std::string>& paths, FTDCDecompressor* decompressor) {
+    BSONElement element;
+
+    Status status = bsonExtractTypedField(obj, kFTDCDataField, BSONType::BinData, &element);
+    if (!status.isOK()) {
+        return {status};
+    }
+
+    int length;
+    const char* buffer = element.binData(length);
+    if (length < 0) {
+        return {ErrorCodes::BadValue,
+                str::stream() << "Field " << std::string(kFTDCTypeField) << " is not a BinData."};
+    }
+
+    return decompressor->uncompressColumns({buffer, static_cast<std::size_t>(length)}, paths);
+}
+
 }  // namespace FTDCBSONUtil
 
 }  // namespace mongo
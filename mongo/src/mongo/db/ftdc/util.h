@@ -97,6 +97,12 @@ StatusWith<bool> extractMetricsFromDocument(const BSONObj& referenceDoc,
                                             const BSONObj& doc,
                                             std::vector<std::uint64_t>* metrics);
 
+/**
+ * Get the dotted path of each metric in a document, in the order extractMetricsFromDocument
+ * returns their values. A timestamp is two metrics, named "<path>.t" and "<path>.i".
+ */
+Status extractMetricNamesFromDocument(const BSONObj& referenceDoc, std::vector<std::string>* names);
+
 /**
  * Construct a document from a reference document and array of metrics.
  *
@@ -168,6 +174,13 @@ StatusWith<BSONObj> getBSONDocumentFromMetadataDoc(const BSONObj& obj);
  */
 StatusWith<std::vector<BSONObj>> getMetricsFromMetricDoc(const BSONObj& obj,
                                                          FTDCDecompressor* decompressor);
+
+/**
+ * Get the values of the named metrics from the compressed chunk of a metric document, without
+ * inflating the samples into documents. See FTDCDecompressor::uncompressColumns.
+ */
+StatusWith<std::vector<std::vector<std::uint64_t>>> getMetricColumnsFromMetricDoc(
+    const BSONObj& obj, const std::vector<std::string>& paths, FTDCDecompressor* decompressor);
 }  // namespace FTDCBSONUtil
 
 
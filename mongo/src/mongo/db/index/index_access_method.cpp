@@ -79,6 +79,11 @@ bool isMultikeyFromPaths(const MultikeyPaths& multikeyPaths) {
 
 MONGO_EXPORT_SERVER_PARAMETER(failIndexKeyTooLong, bool, true);
 
+// Number of sorted runs an index build may sort and write in the background while the
+// collection scan keeps feeding keys. Zero spills on the index build thread. Each run being
+// written holds up to the index build memory limit on top of the run being filled.
+MONGO_EXPORT_SERVER_PARAMETER(internalIndexBuildSorterMaxParallelSpills, int, 1);
+
 //
 // Comparison for external sorter interface
 //
@@ -483,7 +488,8 @@ IndexAccessMethod::BulkBuilder::BulkBuilder(const IndexAccessMethod* index,
           SortOptions()
               .TempDir(storageGlobalParams.dbpath + "/_tmp")
               .ExtSortAllowed()
-              .MaxMemoryUsageBytes(maxMemoryUsageBytes),
+              .MaxMemoryUsageBytes(maxMemoryUsageBytes)
+              .MaxParallelSpills(std::max(0, internalIndexBuildSorterMaxParallelSpills.load())),
           BtreeExternalSortComparison(descriptor->keyPattern(), descriptor->version()))),
       _real(index) {}
 
@@ -561,34 +567,19 @@ Status IndexAccessMethod::commitBulk(OperationContext* opCtx,
                                      set<RecordId>* dupsToDrop) {
     Timer timer;
 
-	//IndexAccessMethod::BulkBuilder::insertдbulkȡʹ
-    std::unique_ptr<BulkBuilder::Sorter::Iterator> i(bulk->_sorter->done());
+    auto load = beginBulkLoad(opCtx, std::move(bulk), dupsAllowed);
 
     stdx::unique_lock<Client> lk(*opCtx->getClient());
 	//2021-03-14T14:24:29.000+0800 I - [conn167]   Index: (2/3) BTree Bottom Up Progress: 17232100/54386432 31%
     ProgressMeterHolder pm(
         CurOp::get(opCtx)->setMessage_inlock("Index Bulk Build: (2/3) btree bottom up",
                                              "Index: (2/3) BTree Bottom Up Progress",
-                                             bulk->_keysInserted,
+                                             load->numKeys(),
                                              //10ӡһ
                                              10));
     lk.unlock();
 
-	//һWiredTigerIndex::BulkBuilder
-    std::unique_ptr<SortedDataBuilderInterface> builder;
-
-    writeConflictRetry(opCtx, "setting index multikey flag", "", [&] {
-        WriteUnitOfWork wunit(opCtx);
-
-        if (bulk->_everGeneratedMultipleKeys || isMultikeyFromPaths(bulk->_indexMultikeyPaths)) {
-            _btreeState->setMultikey(opCtx, bulk->_indexMultikeyPaths);
-        }
-
-        builder.reset(_newInterface->getBulkBuilder(opCtx, dupsAllowed));
-        wunit.commit();
-    });
-
-    while (i->more()) {
+    while (load->_keys->more()) {
         if (mayInterrupt) {
             opCtx->checkForInterrupt();
         }
@@ -600,33 +591,11 @@ Status IndexAccessMethod::commitBulk(OperationContext* opCtx,
         // up by the index system.
         opCtx->recoveryUnit()->setRollbackWritesDisabled();
 
-        // Get the next datum and add it to the builder.
-        //ȡ_sorterźKV
-        BulkBuilder::Sorter::Data d = i->next();
-		//WiredTigerIndex::BulkBuilder::addKey bulkʽд洢
-        Status status = builder->addKey(d.first, d.second);
-
+        Status status = _addBulkKey(load.get(), dupsToDrop);
         if (!status.isOK()) {
-            // Overlong key that's OK to skip?
-            if (status.code() == ErrorCodes::KeyTooLong && ignoreKeyTooLong(opCtx)) {
-                continue;
-            }
-
-            // Check if this is a duplicate that's OK to skip
-            if (status.code() == ErrorCodes::DuplicateKey) {
-                invariant(!dupsAllowed);  // shouldn't be getting DupKey errors if dupsAllowed.
-
-                if (dupsToDrop) {
-                    dupsToDrop->insert(d.second);
-                    continue;
-                }
-            }
-
             return status;
         }
 
-        // If we're here either it's a dup and we're cool with it or the addKey went just
-        // fine.
         //´ӡϢ:  ȴӡ
 //2021-03-14T14:24:29.000+0800 I - [conn167]   Index: (2/3) BTree Bottom Up Progress: 17232100/54386432 31%
         pm.hit();
@@ -635,17 +604,95 @@ Status IndexAccessMethod::commitBulk(OperationContext* opCtx,
 
     pm.finished();
 
+    LOG(timer.seconds() > 10 ? 0 : 1) << "\t done building bottom layer, going to commit";
+
+    finishBulkLoad(opCtx, std::move(load), mayInterrupt);
+    return Status::OK();
+}
+
+std::unique_ptr<IndexAccessMethod::BulkLoad> IndexAccessMethod::beginBulkLoad(
+    OperationContext* opCtx, std::unique_ptr<BulkBuilder> bulk, bool dupsAllowed) {
+    auto load = stdx::make_unique<BulkLoad>();
+    load->_numKeys = bulk->_keysInserted;
+    load->_dupsAllowed = dupsAllowed;
+    load->_ignoreKeyTooLong = ignoreKeyTooLong(opCtx);
+	//IndexAccessMethod::BulkBuilder::insertдbulkȡʹ
+    load->_keys.reset(bulk->_sorter->done());
+
+	//һWiredTigerIndex::BulkBuilder
+    writeConflictRetry(opCtx, "setting index multikey flag", "", [&] {
+        WriteUnitOfWork wunit(opCtx);
+
+        if (bulk->_everGeneratedMultipleKeys || isMultikeyFromPaths(bulk->_indexMultikeyPaths)) {
+            _btreeState->setMultikey(opCtx, bulk->_indexMultikeyPaths);
+        }
+
+        load->_builder.reset(_newInterface->getBulkBuilder(opCtx, dupsAllowed));
+        wunit.commit();
+    });
+    return load;
+}
+
+Status IndexAccessMethod::loadBulkFromAnyThread(BulkLoad* load,
+                                                const AtomicBool& abort,
+                                                AtomicInt64* keysLoaded,
+                                                set<RecordId>* dupsToDrop) {
+    invariant(canLoadBulkFromAnyThread());
+    while (load->_keys->more()) {
+        if (abort.load()) {
+            return {ErrorCodes::Interrupted,
+                    str::stream() << "bulk load of index " << _descriptor->indexName()
+                                  << " was aborted"};
+        }
+
+        Status status = _addBulkKey(load, dupsToDrop);
+        if (!status.isOK()) {
+            return status;
+        }
+        keysLoaded->fetchAndAdd(1);
+    }
+    return Status::OK();
+}
+
+void IndexAccessMethod::finishBulkLoad(OperationContext* opCtx,
+                                       std::unique_ptr<BulkLoad> load,
+                                       bool mayInterrupt) {
     {
         stdx::lock_guard<Client> lk(*opCtx->getClient());
         CurOp::get(opCtx)->setMessage_inlock("Index Bulk Build: (3/3) btree-middle",
                                              "Index: (3/3) BTree Middle Progress");
     }
 
-    LOG(timer.seconds() > 10 ? 0 : 1) << "\t done building bottom layer, going to commit";
-
 	//WiredTigerIndex::BulkBuilder::commit
-    builder->commit(mayInterrupt);
-    return Status::OK();
+    load->_builder->commit(mayInterrupt);
+}
+
+Status IndexAccessMethod::_addBulkKey(BulkLoad* load, set<RecordId>* dupsToDrop) {
+    // Get the next datum and add it to the builder.
+    //ȡ_sorterźKV
+    BulkBuilder::Sorter::Data d = load->_keys->next();
+	//WiredTigerIndex::BulkBuilder::addKey bulkʽд洢
+    Status status = load->_builder->addKey(d.first, d.second);
+    if (status.isOK()) {
+        return status;
+    }
+
+    // Overlong key that's OK to skip?
+    if (status.code() == ErrorCodes::KeyTooLong && load->_ignoreKeyTooLong) {
+        return Status::OK();
+    }
+
+    // Check if this is a duplicate that's OK to skip
+    if (status.code() == ErrorCodes::DuplicateKey) {
+        invariant(!load->_dupsAllowed);  // shouldn't be getting DupKey errors if dupsAllowed.
+
+        if (dupsToDrop) {
+            dupsToDrop->insert(d.second);
+            return Status::OK();
+        }
+    }
+
+    return status;
 }
 
 //IndexAccessMethod::insertе,ȡKVݵK
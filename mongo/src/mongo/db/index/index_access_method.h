@@ -227,6 +227,8 @@ public:
     // Bulk operations support
     //
 
+    class BulkLoad;
+
     //IndexAccessMethod::initiateBulkгʼ
     class BulkBuilder {
     public:
@@ -241,6 +243,7 @@ public:
 
     private:
         friend class IndexAccessMethod;
+        friend class BulkLoad;
 
         using Sorter = mongo::Sorter<BSONObj, RecordId>;
 
@@ -290,6 +293,49 @@ public:
                       bool dupsAllowed,
                       std::set<RecordId>* dups);
 
+    /**
+     * The sorted keys of a bulk build on their way into the index, see beginBulkLoad().
+     */
+    class BulkLoad {
+    public:
+        int64_t numKeys() const {
+            return _numKeys;
+        }
+
+    private:
+        friend class IndexAccessMethod;
+
+        std::unique_ptr<BulkBuilder::Sorter::Iterator> _keys;
+        std::unique_ptr<SortedDataBuilderInterface> _builder;
+        int64_t _numKeys = 0;
+        bool _dupsAllowed = false;
+        bool _ignoreKeyTooLong = false;
+    };
+
+    /**
+     * Returns true if the storage engine lets loadBulkFromAnyThread() be used for this index.
+     */
+    bool canLoadBulkFromAnyThread() const {
+        return _newInterface->canAddBulkKeysFromAnyThread();
+    }
+
+    /**
+     * The steps of commitBulk(), exposed so that the keys of several indexes can be added
+     * concurrently. beginBulkLoad() and finishBulkLoad() must run on the thread owning 'opCtx'.
+     * loadBulkFromAnyThread() adds all the keys without using any OperationContext, increments
+     * 'keysLoaded' for each of them, and returns Interrupted as soon as 'abort' is set.
+     */
+    std::unique_ptr<BulkLoad> beginBulkLoad(OperationContext* opCtx,
+                                            std::unique_ptr<BulkBuilder> bulk,
+                                            bool dupsAllowed);
+    Status loadBulkFromAnyThread(BulkLoad* load,
+                                 const AtomicBool& abort,
+                                 AtomicInt64* keysLoaded,
+                                 std::set<RecordId>* dups);
+    void finishBulkLoad(OperationContext* opCtx,
+                        std::unique_ptr<BulkLoad> load,
+                        bool mayInterrupt);
+
     /**
      * Specifies whether getKeys should relax the index constraints or not.
      */
@@ -353,6 +399,12 @@ private:
                       const RecordId& loc,
                       bool dupsAllowed);
 
+    /**
+     * Adds the next sorted key of 'load' to the index. Overlong keys that may be ignored and, if
+     * 'dupsToDrop' is not null, duplicate keys are skipped.
+     */
+    Status _addBulkKey(BulkLoad* load, std::set<RecordId>* dupsToDrop);
+
     //IndexAccessMethod::IndexAccessMethodгʼֵ
     //KVDatabasekv_database_catalog_entryCatalogEntry::getIndexnew
     //wiredtiger洢ӦWiredTigerIndexUnique
@@ -38,6 +38,7 @@
 #include "mongo/db/pipeline/lite_parsed_document_source.h"
 #include "mongo/db/pipeline/value.h"
 #include "mongo/db/pipeline/value_comparator.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/stdx/memory.h"
 
 namespace mongo {
@@ -70,13 +71,18 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNext() {
         accum->reset();  // Prep accumulators for a new group.
     }
 
-    if (_spilled) {
-        return getNextSpilled();
-    } else if (_streaming) {
+    if (_streaming) {
         return getNextStreaming();
-    } else {
-        return getNextStandard();
     }
+
+    const bool partitionInProgress =
+        _sorterIterator || (_outputPartition && _groupsIterator != _outputPartition->groups.end());
+    if (!partitionInProgress && !prepareNextPartition()) {
+        dispose();
+        return GetNextResult::makeEOF();
+    }
+
+    return _sorterIterator ? getNextSpilled() : getNextStandard();
 }
 
 DocumentSource::GetNextResult DocumentSourceGroup::getNextSpilled() {
@@ -103,25 +109,31 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNextSpilled() {
         }
 
         if (!_sorterIterator->more()) {
-            dispose();
+            // This partition is done; the next call moves on to the following one.
+            _sorterIterator.reset();
             break;
         }
 
         _firstPartOfNextGroup = _sorterIterator->next();
     }
 
-    return makeDocument(_currentId, _currentAccumulators, pExpCtx->needsMerge);
+    return makeDocument(_currentId, _currentAccumulators.data(), pExpCtx->needsMerge);
 }
 
 DocumentSource::GetNextResult DocumentSourceGroup::getNextStandard() {
-    // Not spilled, and not streaming.
-    if (_groups->empty())
-        return GetNextResult::makeEOF();
-
-    Document out = makeDocument(groupsIterator->first, groupsIterator->second, pExpCtx->needsMerge);
+    // Returning a partition that did not spill, and not streaming.
+    const size_t numAccumulators = _accumulatedFields.size();
+    Document out = makeDocument(
+        _groupsIterator->first,
+        _outputPartition->accumulators.data() + _groupsIterator->second * numAccumulators,
+        pExpCtx->needsMerge);
 
-    if (++groupsIterator == _groups->end())
-        dispose();
+    if (++_groupsIterator == _outputPartition->groups.end()) {
+        // Release the partition's memory before moving on to the next one.
+        _outputPartition->groups.clear();
+        _outputPartition->accumulators = Accumulators();
+        _outputPartition = nullptr;
+    }
 
     return std::move(out);
 }
@@ -158,7 +170,7 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNextStreaming() {
         id = computeId(*_firstDocOfNextGroup);
     } while (pExpCtx->getValueComparator().evaluate(_currentId == id));
 
-    Document out = makeDocument(_currentId, _currentAccumulators, pExpCtx->needsMerge);
+    Document out = makeDocument(_currentId, _currentAccumulators.data(), pExpCtx->needsMerge);
     _currentId = std::move(id);
 
     return std::move(out);
@@ -166,11 +178,12 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNextStreaming() {
 
 void DocumentSourceGroup::doDispose() {
     // Free our resources.
-    _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
+    _partitions.clear();
     _sorterIterator.reset();
 
     // Make us look done.
-    groupsIterator = _groups->end();
+    _outputPartition = nullptr;
+    _nextOutputPartition = 0;
 
     _firstDocOfNextGroup = boost::none;
 }
@@ -224,6 +237,16 @@ Value DocumentSourceGroup::serialize(boost::optional<ExplainOptions::Verbosity>
     if (explain && findRelevantInputSort()) {
         return Value(DOC("$streamingGroup" << insides.freeze()));
     }
+
+    if (explain && *explain >= ExplainOptions::Verbosity::kExecStats) {
+        MutableDocument groupState;
+        groupState["numPartitions"] = Value(static_cast<long long>(_numPartitions));
+        groupState["spilledPartitions"] = Value(static_cast<long long>(_numSpilledPartitions));
+        groupState["spills"] = Value(static_cast<long long>(_numSpills));
+        groupState["memoryUsageBytes"] = Value(static_cast<long long>(_memoryUsageBytes));
+        groupState["peakMemoryUsageBytes"] = Value(static_cast<long long>(_peakMemoryUsageBytes));
+        return Value(DOC(getSourceName() << insides.freeze() << "groupState" << groupState.freeze()));
+    }
     return Value(DOC(getSourceName() << insides.freeze()));
 }
 
@@ -264,7 +287,6 @@ DocumentSourceGroup::DocumentSourceGroup(const intrusive_ptr<ExpressionContext>&
       _inputSort(BSONObj()),
       _streaming(false),
       _initialized(false),
-      _groups(pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>()),
       _spilled(false),
       _allowDiskUse(pExpCtx->allowDiskUse && !pExpCtx->inMongos) {}
 
@@ -358,6 +380,7 @@ intrusive_ptr<DocumentSource> DocumentSourceGroup::createFromBson(
 namespace {
 
 using GroupsMap = DocumentSourceGroup::GroupsMap;
+using GroupPartition = DocumentSourceGroup::GroupPartition;
 
 class SorterComparator {
 public:
@@ -478,7 +501,11 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
     }
 
 
-    // Barring any pausing, this loop exhausts 'pSource' and populates '_groups'.
+    if (_partitions.empty()) {
+        makePartitions();
+    }
+
+    // Barring any pausing, this loop exhausts 'pSource' and populates '_partitions'.
     GetNextResult input = pSource->getNext();
     for (; input.isAdvanced(); input = pSource->getNext()) {
         if (_memoryUsageBytes > _maxMemoryUsageBytes) {
@@ -486,8 +513,7 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
                     "Exceeded memory limit for $group, but didn't allow external sort."
                     " Pass allowDiskUse:true to opt in.",
                     _allowDiskUse);
-            _sortedFiles.push_back(spill());
-            _memoryUsageBytes = 0;
+            spillToFitMemoryLimit();
         }
 
         // We release the result document here so that it does not outlive the end of this loop
@@ -495,46 +521,54 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
         auto rootDocument = input.releaseDocument();
         Value id = computeId(rootDocument);
 
-        // Look for the _id value in the map. If it's not there, add a new entry with a blank
-        // accumulator. This is done in a somewhat odd way in order to avoid hashing 'id' and
-        // looking it up in '_groups' multiple times.
-        const size_t oldSize = _groups->size();
-        vector<intrusive_ptr<Accumulator>>& group = (*_groups)[id];
-        const bool inserted = _groups->size() != oldSize;
+        GroupPartition& partition = partitionFor(id);
+        const size_t oldPartitionMemoryUsageBytes = partition.memoryUsageBytes;
+
+        // Look for the _id value in the map. If it's not there, add a new entry with blank
+        // accumulators. This is done in a somewhat odd way in order to avoid hashing 'id' and
+        // looking it up in the partition multiple times.
+        const size_t oldSize = partition.groups.size();
+        size_t& slot = partition.groups[id];
+        const bool inserted = partition.groups.size() != oldSize;
 
         if (inserted) {
-            _memoryUsageBytes += id.getApproximateSize();
+            slot = oldSize;
+            partition.memoryUsageBytes += id.getApproximateSize();
 
             // Add the accumulators
-            group.reserve(numAccumulators);
             for (auto&& accumulatedField : _accumulatedFields) {
-                group.push_back(accumulatedField.makeAccumulator(pExpCtx));
-            }
-        } else {
-            for (auto&& groupObj : group) {
-                // subtract old mem usage. New usage added back after processing.
-                _memoryUsageBytes -= groupObj->memUsageForSorter();
+                partition.accumulators.push_back(accumulatedField.makeAccumulator(pExpCtx));
             }
         }
 
         /* tickle all the accumulators for the group we found */
-        dassert(numAccumulators == group.size());
+        dassert(partition.accumulators.size() == partition.groups.size() * numAccumulators);
+        intrusive_ptr<Accumulator>* group = partition.accumulators.data() + slot * numAccumulators;
 
         for (size_t i = 0; i < numAccumulators; i++) {
+            // subtract old mem usage. New usage added back after processing.
+            if (!inserted) {
+                partition.memoryUsageBytes -= group[i]->memUsageForSorter();
+            }
+
             group[i]->process(_accumulatedFields[i].expression->evaluate(rootDocument),
                               _doingMerge);
 
-            _memoryUsageBytes += group[i]->memUsageForSorter();
+            partition.memoryUsageBytes += group[i]->memUsageForSorter();
         }
 
+        _memoryUsageBytes =
+            _memoryUsageBytes - oldPartitionMemoryUsageBytes + partition.memoryUsageBytes;
+        _peakMemoryUsageBytes = std::max(_peakMemoryUsageBytes, _memoryUsageBytes);
+
         if (kDebugBuild && !storageGlobalParams.readOnly) {
             // In debug mode, spill every time we have a duplicate id to stress merge logic.
-            if (!inserted &&                 // is a dup
-                !pExpCtx->inMongos &&        // can't spill to disk in mongos
-                !_allowDiskUse &&            // don't change behavior when testing external sort
-                _sortedFiles.size() < 20) {  // don't open too many FDs
+            if (!inserted &&           // is a dup
+                !pExpCtx->inMongos &&  // can't spill to disk in mongos
+                !_allowDiskUse &&      // don't change behavior when testing external sort
+                _numSpills < 20) {     // don't open too many FDs
 
-                _sortedFiles.push_back(spill());
+                spill(&partition);
             }
         }
     }
@@ -547,32 +581,26 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
             return input;  // Propagate pause.
         }
         case DocumentSource::GetNextResult::ReturnStatus::kEOF: {
-            // Do any final steps necessary to prepare to output results.
-            if (!_sortedFiles.empty()) {
+            // Do any final steps necessary to prepare to output results. Partitions are returned
+            // one at a time by getNext(); those that spilled are merged from disk when reached.
+            _numSpilledPartitions = std::count_if(
+                _partitions.begin(), _partitions.end(), [](const GroupPartition& partition) {
+                    return !partition.spilledRuns.empty();
+                });
+
+            if (_numSpilledPartitions > 0) {
                 _spilled = true;
-                if (!_groups->empty()) {
-                    _sortedFiles.push_back(spill());
-                }
-
-                // We won't be using groups again so free its memory.
-                _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
-
-                _sorterIterator.reset(Sorter<Value, Value>::Iterator::merge(
-                    _sortedFiles, SortOptions(), SorterComparator(pExpCtx->getValueComparator())));
 
                 // prepare current to accumulate data
                 _currentAccumulators.reserve(numAccumulators);
                 for (auto&& accumulatedField : _accumulatedFields) {
                     _currentAccumulators.push_back(accumulatedField.makeAccumulator(pExpCtx));
                 }
-
-                verify(_sorterIterator->more());  // we put data in, we should get something out.
-                _firstPartOfNextGroup = _sorterIterator->next();
-            } else {
-                // start the group iterator
-                groupsIterator = _groups->begin();
             }
 
+            _nextOutputPartition = 0;
+            _outputPartition = nullptr;
+
             // This must happen last so that, unless control gets here, we will re-enter
             // initialization after getting a GetNextResult::ResultState::kPauseExecution.
             _initialized = true;
@@ -582,44 +610,118 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
     MONGO_UNREACHABLE;
 }
 
-shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
+bool DocumentSourceGroup::prepareNextPartition() {
+    while (_nextOutputPartition < _partitions.size()) {
+        GroupPartition& partition = _partitions[_nextOutputPartition++];
+
+        if (!partition.spilledRuns.empty()) {
+            if (!partition.groups.empty()) {
+                spill(&partition);
+            }
+
+            _sorterIterator.reset(
+                Sorter<Value, Value>::Iterator::merge(partition.spilledRuns,
+                                                      SortOptions(),
+                                                      SorterComparator(pExpCtx->getValueComparator())));
+            partition.spilledRuns.clear();
+
+            verify(_sorterIterator->more());  // we put data in, we should get something out.
+            _firstPartOfNextGroup = _sorterIterator->next();
+            return true;
+        }
+
+        if (!partition.groups.empty()) {
+            _outputPartition = &partition;
+            _groupsIterator = partition.groups.begin();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void DocumentSourceGroup::makePartitions() {
+    _numPartitions = std::max(1, internalDocumentSourceGroupPartitions.load());
+    _partitions.reserve(_numPartitions);
+    for (size_t i = 0; i < _numPartitions; ++i) {
+        _partitions.emplace_back(pExpCtx->getValueComparator().makeUnorderedValueMap<size_t>());
+    }
+}
+
+GroupPartition& DocumentSourceGroup::partitionFor(const Value& id) {
+    if (_partitions.size() == 1) {
+        return _partitions[0];
+    }
+
+    // The hash tables use the low bits of the same hash to pick buckets, so mix it before choosing
+    // a partition to keep each partition's table evenly filled.
+    const uint64_t hash = pExpCtx->getValueComparator().hash(id);
+    return _partitions[((hash * 0x9E3779B97F4A7C15ULL) >> 32) % _partitions.size()];
+}
+
+void DocumentSourceGroup::spillToFitMemoryLimit() {
+    vector<GroupPartition*> bySize;
+    for (auto&& partition : _partitions) {
+        if (!partition.groups.empty()) {
+            bySize.push_back(&partition);
+        }
+    }
+    std::sort(bySize.begin(), bySize.end(), [](const GroupPartition* lhs, const GroupPartition* rhs) {
+        return lhs->memoryUsageBytes > rhs->memoryUsageBytes;
+    });
+
+    for (auto&& partition : bySize) {
+        if (_memoryUsageBytes <= _maxMemoryUsageBytes / 2) {
+            break;
+        }
+        spill(partition);
+    }
+}
+
+void DocumentSourceGroup::spill(GroupPartition* partition) {
+    const size_t numAccumulators = _accumulatedFields.size();
+
     vector<const GroupsMap::value_type*> ptrs;  // using pointers to speed sorting
-    ptrs.reserve(_groups->size());
-    for (GroupsMap::const_iterator it = _groups->begin(), end = _groups->end(); it != end; ++it) {
-        ptrs.push_back(&*it);
+    ptrs.reserve(partition->groups.size());
+    for (auto&& group : partition->groups) {
+        ptrs.push_back(&group);
     }
 
     stable_sort(ptrs.begin(), ptrs.end(), SpillSTLComparator(pExpCtx->getValueComparator()));
 
     SortedFileWriter<Value, Value> writer(SortOptions().TempDir(pExpCtx->tempDir));
-    switch (_accumulatedFields.size()) {  // same as ptrs[i]->second.size() for all i.
-        case 0:                           // no values, essentially a distinct
-            for (size_t i = 0; i < ptrs.size(); i++) {
+    for (size_t i = 0; i < ptrs.size(); i++) {
+        const intrusive_ptr<Accumulator>* accums =
+            partition->accumulators.data() + ptrs[i]->second * numAccumulators;
+
+        switch (numAccumulators) {
+            case 0:  // no values, essentially a distinct
                 writer.addAlreadySorted(ptrs[i]->first, Value());
-            }
-            break;
+                break;
 
-        case 1:  // just one value, use optimized serialization as single Value
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                writer.addAlreadySorted(ptrs[i]->first,
-                                        ptrs[i]->second[0]->getValue(/*toBeMerged=*/true));
-            }
-            break;
+            case 1:  // just one value, use optimized serialization as single Value
+                writer.addAlreadySorted(ptrs[i]->first, accums[0]->getValue(/*toBeMerged=*/true));
+                break;
 
-        default:  // multiple values, serialize as array-typed Value
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                vector<Value> accums;
-                for (size_t j = 0; j < ptrs[i]->second.size(); j++) {
-                    accums.push_back(ptrs[i]->second[j]->getValue(/*toBeMerged=*/true));
+            default: {  // multiple values, serialize as array-typed Value
+                vector<Value> values;
+                values.reserve(numAccumulators);
+                for (size_t j = 0; j < numAccumulators; j++) {
+                    values.push_back(accums[j]->getValue(/*toBeMerged=*/true));
                 }
-                writer.addAlreadySorted(ptrs[i]->first, Value(std::move(accums)));
+                writer.addAlreadySorted(ptrs[i]->first, Value(std::move(values)));
+                break;
             }
-            break;
+        }
     }
 
-    _groups->clear();
+    partition->groups.clear();
+    partition->accumulators.clear();
+    _memoryUsageBytes -= partition->memoryUsageBytes;
+    partition->memoryUsageBytes = 0;
 
-    return shared_ptr<Sorter<Value, Value>::Iterator>(writer.done());
+    partition->spilledRuns.emplace_back(writer.done());
+    ++_numSpills;
 }
 
 boost::optional<BSONObj> DocumentSourceGroup::findRelevantInputSort() const {
@@ -695,7 +797,9 @@ BSONObjSet DocumentSourceGroup::getOutputSorts() {
                        // False negatives are OK.
     }
 
-    if (!(_streaming || _spilled)) {
+    // A spilled $group only returns its groups in _id order if they all went through a single
+    // merge, which is the case with one partition.
+    if (!(_streaming || (_spilled && _numPartitions == 1))) {
         return SimpleBSONObjComparator::kInstance.makeBSONObjSet();
     }
 
@@ -806,7 +910,7 @@ Value DocumentSourceGroup::expandId(const Value& val) {
 }
 
 Document DocumentSourceGroup::makeDocument(const Value& id,
-                                           const Accumulators& accums,
+                                           const intrusive_ptr<Accumulator>* accums,
                                            bool mergeableOutput) {
     const size_t n = _accumulatedFields.size();
     MutableDocument out(1 + n);
@@ -41,7 +41,24 @@ namespace mongo {
 class DocumentSourceGroup final : public DocumentSource, public SplittableDocumentSource {
 public:
     using Accumulators = std::vector<boost::intrusive_ptr<Accumulator>>;
-    using GroupsMap = ValueUnorderedMap<Accumulators>;
+
+    // Maps each group id to its slot within a GroupPartition.
+    using GroupsMap = ValueUnorderedMap<size_t>;
+
+    /**
+     * One hash partition of the groups of an unsorted $group. The accumulators of slot i are stored
+     * contiguously at [i * numAccumulators, (i + 1) * numAccumulators) in 'accumulators', so a new
+     * group costs no allocation beyond its accumulators and a partition is released or spilled as a
+     * unit.
+     */
+    struct GroupPartition {
+        explicit GroupPartition(GroupsMap groups) : groups(std::move(groups)) {}
+
+        GroupsMap groups;
+        Accumulators accumulators;
+        size_t memoryUsageBytes = 0;
+        std::vector<std::shared_ptr<Sorter<Value, Value>::Iterator>> spilledRuns;
+    };
 
     static const size_t kDefaultMaxMemoryUsageBytes = 100 * 1024 * 1024;
 
@@ -118,6 +135,20 @@ private:
     GetNextResult getNextSpilled();
     GetNextResult getNextStandard();
 
+    /**
+     * Positions the output on the next partition with groups left to return, merging its spilled
+     * runs if it has any. Returns false once every partition has been returned.
+     */
+    bool prepareNextPartition();
+
+    /**
+     * Creates the hash partitions. Deferred until initialize() since the groups must be built
+     * using the comparator of the final ExpressionContext.
+     */
+    void makePartitions();
+
+    GroupPartition& partitionFor(const Value& id);
+
     /**
      * Attempt to identify an input sort order that allows us to turn into a streaming $group. If we
      * find one, return it. Otherwise, return boost::none.
@@ -137,13 +168,25 @@ private:
     GetNextResult initialize();
 
     /**
-     * Spill groups map to disk and returns an iterator to the file. Note: Since a sorted $group
-     * does not exhaust the previous stage before returning, and thus does not maintain as large a
-     * store of documents at any one time, only an unsorted group can spill to disk.
+     * Spills the groups of 'partition' to disk, adding the file to its spilled runs. Note: Since a
+     * sorted $group does not exhaust the previous stage before returning, and thus does not
+     * maintain as large a store of documents at any one time, only an unsorted group can spill to
+     * disk.
      */
-    std::shared_ptr<Sorter<Value, Value>::Iterator> spill();
+    void spill(GroupPartition* partition);
 
-    Document makeDocument(const Value& id, const Accumulators& accums, bool mergeableOutput);
+    /**
+     * Spills partitions, largest first, until the groups held in memory use at most half of the
+     * memory limit.
+     */
+    void spillToFitMemoryLimit();
+
+    /**
+     * Builds an output document from 'id' and the accumulators starting at 'accums'.
+     */
+    Document makeDocument(const Value& id,
+                          const boost::intrusive_ptr<Accumulator>* accums,
+                          bool mergeableOutput);
 
     /**
      * Computes the internal representation of the group key.
@@ -171,18 +214,26 @@ private:
     Value _currentId;
     Accumulators _currentAccumulators;
 
-    // We use boost::optional to defer initialization until the ExpressionContext containing the
-    // correct comparator is injected, since the groups must be built using the comparator's
-    // definition of equality.
-    boost::optional<GroupsMap> _groups;
-
-    std::vector<std::shared_ptr<Sorter<Value, Value>::Iterator>> _sortedFiles;
+    // Groups are hash partitioned by id so that reaching the memory limit only spills the
+    // partitions holding the most state, and partitions that never spilled are returned straight
+    // from memory. With a single partition, spilling writes out every group and the output of a
+    // spilled $group is sorted by _id.
+    std::vector<GroupPartition> _partitions;
     bool _spilled;
 
-    // Only used when '_spilled' is false.
-    GroupsMap::iterator groupsIterator;
+    // Reported by explain.
+    size_t _numPartitions = 0;
+    size_t _numSpilledPartitions = 0;
+    size_t _numSpills = 0;
+    size_t _peakMemoryUsageBytes = 0;
+
+    // The next partition to return, and the position within the partition being returned if it
+    // did not spill.
+    size_t _nextOutputPartition = 0;
+    GroupPartition* _outputPartition = nullptr;
+    GroupsMap::iterator _groupsIterator;
 
-    // Only used when '_spilled' is true.
+    // Only used while returning a partition that spilled.
     std::unique_ptr<Sorter<Value, Value>::Iterator> _sorterIterator;
     const bool _allowDiskUse;
 
@@ -31,6 +31,7 @@
 #include <boost/intrusive_ptr.hpp>
 #include <deque>
 #include <map>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -47,12 +48,14 @@
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context_for_test.h"
 #include "mongo/db/pipeline/value_comparator.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_test_service_context.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/unordered_set.h"
 #include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -60,6 +63,7 @@ namespace {
 using boost::intrusive_ptr;
 using std::deque;
 using std::map;
+using std::set;
 using std::string;
 using std::vector;
 
@@ -189,6 +193,151 @@ TEST_F(DocumentSourceGroupTest, ShouldCorrectlyTrackMemoryUsageBetweenPauses) {
     ASSERT_THROWS_CODE(group->getNext(), AssertionException, 16945);
 }
 
+TEST_F(DocumentSourceGroupTest, ShouldOnlySpillPartitionsNeededToFitMemoryLimit) {
+    auto expCtx = getExpCtx();
+    const int oldNumPartitions = internalDocumentSourceGroupPartitions.load();
+    internalDocumentSourceGroupPartitions.store(4);
+    ON_BLOCK_EXIT([&] { internalDocumentSourceGroupPartitions.store(oldNumPartitions); });
+
+    TempDir tempDir("DocumentSourceGroupTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+    const size_t maxMemoryUsageBytes = 10000;
+
+    VariablesParseState vps = expCtx->variablesParseState;
+    AccumulationStatement pushStatement{"spaceHog",
+                                        ExpressionFieldPath::parse(expCtx, "$largeStr", vps),
+                                        AccumulationStatement::getFactory("$push")};
+    auto groupByExpression = ExpressionFieldPath::parse(expCtx, "$key", vps);
+    auto group = DocumentSourceGroup::create(
+        expCtx, groupByExpression, {pushStatement}, maxMemoryUsageBytes);
+
+    // Each group takes a little over a tenth of the memory limit, so the limit is exceeded once,
+    // after nine or ten groups. Spilling the largest partitions until at most half of the limit is
+    // used never needs the smallest of the four partitions, and the groups added afterwards stay
+    // below the limit.
+    const int numKeys = 12;
+    string largeStr(maxMemoryUsageBytes / 10, 'x');
+    deque<DocumentSource::GetNextResult> inputs;
+    for (int key = 0; key < numKeys; ++key) {
+        inputs.emplace_back(Document{{"key", key}, {"largeStr", largeStr}});
+    }
+    auto mock = DocumentSourceMock::create(inputs);
+    group->setSource(mock.get());
+
+    set<int> keys;
+    for (auto result = group->getNext(); result.isAdvanced(); result = group->getNext()) {
+        auto doc = result.releaseDocument();
+        ASSERT_EQ(doc["spaceHog"].getArrayLength(), 1UL);
+        ASSERT_TRUE(keys.insert(doc["_id"].coerceToInt()).second);
+    }
+    ASSERT_EQ(keys.size(), static_cast<size_t>(numKeys));
+
+    vector<Value> explain;
+    group->serializeToArray(explain, ExplainOptions::Verbosity::kExecStats);
+    ASSERT_EQ(explain.size(), 1UL);
+    auto groupState = explain[0].getDocument()["groupState"].getDocument();
+    ASSERT_VALUE_EQ(groupState["numPartitions"], Value(4LL));
+    const long long spilledPartitions = groupState["spilledPartitions"].getLong();
+    ASSERT_GT(spilledPartitions, 0LL);
+    ASSERT_LT(spilledPartitions, 4LL);
+    // Every partition spilled at most once.
+    ASSERT_EQ(groupState["spills"].getLong(), spilledPartitions);
+}
+
+TEST_F(DocumentSourceGroupTest, ShouldMergeGroupsSpilledFromSeveralPartitions) {
+    auto expCtx = getExpCtx();
+    const int oldNumPartitions = internalDocumentSourceGroupPartitions.load();
+    internalDocumentSourceGroupPartitions.store(4);
+    ON_BLOCK_EXIT([&] { internalDocumentSourceGroupPartitions.store(oldNumPartitions); });
+
+    // Allow the $group stage to spill to disk.
+    TempDir tempDir("DocumentSourceGroupTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+    const size_t maxMemoryUsageBytes = 10000;
+
+    VariablesParseState vps = expCtx->variablesParseState;
+    AccumulationStatement pushStatement{"spaceHog",
+                                        ExpressionFieldPath::parse(expCtx, "$largeStr", vps),
+                                        AccumulationStatement::getFactory("$push")};
+    AccumulationStatement countStatement{"count",
+                                         ExpressionConstant::create(expCtx, Value(1)),
+                                         AccumulationStatement::getFactory("$sum")};
+    auto groupByExpression = ExpressionFieldPath::parse(expCtx, "$key", vps);
+    auto group = DocumentSourceGroup::create(
+        expCtx, groupByExpression, {pushStatement, countStatement}, maxMemoryUsageBytes);
+
+    // Each key is seen twice, far enough apart that some of the groups have been spilled in
+    // between.
+    const int numKeys = 40;
+    string largeStr(maxMemoryUsageBytes / 20, 'x');
+    deque<DocumentSource::GetNextResult> inputs;
+    for (int pass = 0; pass < 2; ++pass) {
+        for (int key = 0; key < numKeys; ++key) {
+            inputs.emplace_back(Document{{"key", key}, {"largeStr", largeStr}});
+        }
+    }
+    auto mock = DocumentSourceMock::create(inputs);
+    group->setSource(mock.get());
+
+    map<int, int> counts;
+    for (auto result = group->getNext(); result.isAdvanced(); result = group->getNext()) {
+        auto doc = result.releaseDocument();
+        ASSERT_EQ(doc["spaceHog"].getArrayLength(), 2UL);
+        ASSERT_EQ(counts.count(doc["_id"].coerceToInt()), 0UL);
+        counts[doc["_id"].coerceToInt()] = doc["count"].coerceToInt();
+    }
+    ASSERT_TRUE(group->getNext().isEOF());
+
+    ASSERT_EQ(counts.size(), static_cast<size_t>(numKeys));
+    for (auto&& count : counts) {
+        ASSERT_EQ(count.second, 2);
+    }
+}
+
+TEST_F(DocumentSourceGroupTest, ShouldReportGroupStateInExecStatsExplain) {
+    auto expCtx = getExpCtx();
+    const int oldNumPartitions = internalDocumentSourceGroupPartitions.load();
+    internalDocumentSourceGroupPartitions.store(4);
+    ON_BLOCK_EXIT([&] { internalDocumentSourceGroupPartitions.store(oldNumPartitions); });
+
+    TempDir tempDir("DocumentSourceGroupTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+    const size_t maxMemoryUsageBytes = 1000;
+
+    VariablesParseState vps = expCtx->variablesParseState;
+    AccumulationStatement pushStatement{"spaceHog",
+                                        ExpressionFieldPath::parse(expCtx, "$largeStr", vps),
+                                        AccumulationStatement::getFactory("$push")};
+    auto groupByExpression = ExpressionFieldPath::parse(expCtx, "$_id", vps);
+    auto group = DocumentSourceGroup::create(
+        expCtx, groupByExpression, {pushStatement}, maxMemoryUsageBytes);
+
+    string largeStr(maxMemoryUsageBytes, 'x');
+    auto mock = DocumentSourceMock::create({Document{{"_id", 0}, {"largeStr", largeStr}},
+                                            Document{{"_id", 1}, {"largeStr", largeStr}},
+                                            Document{{"_id", 2}, {"largeStr", largeStr}}});
+    group->setSource(mock.get());
+    ASSERT_TRUE(group->getNext().isAdvanced());
+
+    vector<Value> explain;
+    group->serializeToArray(explain, ExplainOptions::Verbosity::kExecStats);
+    ASSERT_EQ(explain.size(), 1UL);
+    auto groupState = explain[0].getDocument()["groupState"].getDocument();
+    ASSERT_VALUE_EQ(groupState["numPartitions"], Value(4LL));
+    ASSERT_GT(groupState["spills"].getLong(), 0LL);
+    ASSERT_GT(groupState["spilledPartitions"].getLong(), 0LL);
+    ASSERT_GT(groupState["peakMemoryUsageBytes"].getLong(),
+              static_cast<long long>(maxMemoryUsageBytes));
+
+    // The group state is not part of the stage's queryPlanner explain output.
+    explain.clear();
+    group->serializeToArray(explain, ExplainOptions::Verbosity::kQueryPlanner);
+    ASSERT_TRUE(explain[0].getDocument()["groupState"].missing());
+}
+
 BSONObj toBson(const intrusive_ptr<DocumentSource>& source) {
     vector<Value> arr;
     source->serializeToArray(arr);
@@ -206,8 +206,35 @@ BSONObj buildEqualityOrQuery(const std::string& fieldName, const BSONArray& valu
 DocumentSource::GetNextResult DocumentSourceLookUp::getNext() {
     pExpCtx->checkForInterrupt();
 
+    if (!_joinStrategyChosen) {
+        chooseJoinStrategy();
+    }
+
     if (_unwindSrc) {
-        return unwindResult();
+        return _hashJoin ? unwindHashJoinResult() : unwindResult();
+    }
+
+    if (_hashJoin) {
+        std::vector<Value> results;
+        auto nextInput = getNextHashJoinInput(&results);
+        if (!nextInput.isAdvanced()) {
+            return nextInput;
+        }
+
+        int objsize = 0;
+        for (auto&& result : results) {
+            objsize += result.getApproximateSize();
+        }
+        uassert(40679,
+                str::stream() << "Total size of documents in " << _fromNs.coll()
+                              << " matching pipeline "
+                              << getUserPipelineDefinition()
+                              << " exceeds maximum document size",
+                objsize <= BSONObjMaxInternalSize);
+
+        MutableDocument output(nextInput.releaseDocument());
+        output.setNestedField(_as, Value(std::move(results)));
+        return output.freeze();
     }
 
     auto nextInput = pSource->getNext();
@@ -249,6 +276,105 @@ DocumentSource::GetNextResult DocumentSourceLookUp::getNext() {
     return output.freeze();
 }
 
+bool DocumentSourceLookUp::canUseHashJoin() const {
+    return !wasConstructedWithPipelineSyntax() && pExpCtx->subPipelineDepth == 0 &&
+        internalDocumentSourceLookupEnableHashJoin.load() &&
+        LookUpHashJoin::canJoinOn(*_foreignField);
+}
+
+void DocumentSourceLookUp::chooseJoinStrategy() {
+    _joinStrategyChosen = true;
+
+    if (!canUseHashJoin()) {
+        return;
+    }
+
+    const bool allowSpilling = pExpCtx->allowDiskUse && !pExpCtx->inMongos;
+    _hashJoin = stdx::make_unique<LookUpHashJoin>(
+        _fromExpCtx->getValueComparator(),
+        *_localField,
+        *_foreignField,
+        std::max(0, internalDocumentSourceLookupHashJoinMaxMemoryBytes.load()),
+        allowSpilling ? pExpCtx->tempDir : std::string());
+
+    // Read the whole foreign side once, restricted by any $match we have absorbed.
+    _resolvedPipeline.back() = BSON("$match" << _additionalFilter.value_or(BSONObj()));
+    auto pipeline = buildPipeline(Document());
+    while (auto foreignDoc = pipeline->getNext()) {
+        _hashJoin->addForeign(*foreignDoc);
+        if (_hashJoin->isAbandoned()) {
+            // Too large to hold in memory and spilling is not allowed; query per input document.
+            _hashJoin.reset();
+            return;
+        }
+    }
+    _hashJoin->freeze();
+}
+
+DocumentSource::GetNextResult DocumentSourceLookUp::getNextHashJoinInput(
+    std::vector<Value>* matches) {
+    invariant(_hashJoin);
+
+    if (_hashJoin->isInMemory()) {
+        auto nextInput = pSource->getNext();
+        if (!nextInput.isAdvanced()) {
+            return nextInput;
+        }
+
+        if (!_hashJoin->probe(nextInput.getDocument(), matches)) {
+            *matches = queryForeignMatches(nextInput.getDocument());
+        }
+        return nextInput;
+    }
+
+    // The foreign side spilled, so the join is blocking: buffer the whole input before returning
+    // anything.
+    if (!_hashJoin->probesFinished()) {
+        auto nextInput = pSource->getNext();
+        for (; nextInput.isAdvanced(); nextInput = pSource->getNext()) {
+            _hashJoin->addProbe(nextInput.releaseDocument());
+        }
+        if (nextInput.isPaused()) {
+            return nextInput;
+        }
+        _hashJoin->finishProbes();
+    }
+
+    auto result = _hashJoin->getNextSpilled();
+    if (!result) {
+        return GetNextResult::makeEOF();
+    }
+
+    if (result->resolved) {
+        *matches = std::move(result->matches);
+    } else {
+        *matches = queryForeignMatches(result->input);
+    }
+    return std::move(result->input);
+}
+
+std::vector<Value> DocumentSourceLookUp::queryForeignMatches(const Document& inputDoc) {
+    _resolvedPipeline.back() = makeMatchStageFromInput(
+        inputDoc, *_localField, _foreignField->fullPath(), _additionalFilter.value_or(BSONObj()));
+    auto pipeline = buildPipeline(inputDoc);
+
+    std::vector<Value> results;
+    while (auto result = pipeline->getNext()) {
+        results.emplace_back(std::move(*result));
+    }
+    return results;
+}
+
+StringData DocumentSourceLookUp::getJoinStrategyName() const {
+    if (!_joinStrategyChosen) {
+        return canUseHashJoin() ? "hashJoin"_sd : "nestedLoopJoin"_sd;
+    }
+    if (!_hashJoin) {
+        return "nestedLoopJoin"_sd;
+    }
+    return _hashJoin->isSpilled() ? "hashJoinSpilled"_sd : "hashJoin"_sd;
+}
+
 std::unique_ptr<Pipeline, Pipeline::Deleter> DocumentSourceLookUp::buildPipeline(
     const Document& inputDoc) {
     // Copy all 'let' variables into the foreign pipeline's expression context.
@@ -436,6 +562,8 @@ void DocumentSourceLookUp::doDispose() {
         _pipeline->dispose(pExpCtx->opCtx);
         _pipeline.reset();
     }
+    _hashJoin.reset();
+    _hashMatches.clear();
 }
 
 BSONObj DocumentSourceLookUp::makeMatchStageFromInput(const Document& input,
@@ -588,6 +716,48 @@ DocumentSource::GetNextResult DocumentSourceLookUp::unwindResult() {
     return output.freeze();
 }
 
+DocumentSource::GetNextResult DocumentSourceLookUp::unwindHashJoinResult() {
+    const boost::optional<FieldPath> indexPath(_unwindSrc->indexPath());
+
+    // Loop until we get a document that has at least one match, as unwindResult() does.
+    while (_hashMatchIndex >= _hashMatches.size()) {
+        _hashMatches.clear();
+        _hashMatchIndex = 0;
+
+        auto nextInput = getNextHashJoinInput(&_hashMatches);
+        if (!nextInput.isAdvanced()) {
+            return nextInput;
+        }
+
+        _input = nextInput.releaseDocument();
+        _cursorIndex = 0;
+
+        if (_unwindSrc->preserveNullAndEmptyArrays() && _hashMatches.empty()) {
+            MutableDocument output(std::move(*_input));
+            output.setNestedField(_as, Value());
+            if (indexPath) {
+                output.setNestedField(*indexPath, Value(BSONNULL));
+            }
+            return output.freeze();
+        }
+    }
+
+    invariant(bool(_input));
+    auto currentValue = std::move(_hashMatches[_hashMatchIndex++]);
+    const bool isLast = _hashMatchIndex == _hashMatches.size();
+
+    // Move input document into output if this is the last or only result, otherwise perform a copy.
+    MutableDocument output(isLast ? std::move(*_input) : *_input);
+    output.setNestedField(_as, std::move(currentValue));
+
+    if (indexPath) {
+        output.setNestedField(*indexPath, Value(_cursorIndex));
+    }
+
+    ++_cursorIndex;
+    return output.freeze();
+}
+
 void DocumentSourceLookUp::copyVariablesToExpCtx(const Variables& vars,
                                                  const VariablesParseState& vps,
                                                  ExpressionContext* expCtx) {
@@ -647,6 +817,10 @@ void DocumentSourceLookUp::serializeToArray(
 
     MutableDocument output(doc);
     if (explain) {
+        if (!wasConstructedWithPipelineSyntax()) {
+            output[getSourceName()]["strategy"] = Value(getJoinStrategyName());
+        }
+
         if (_unwindSrc) {
             const boost::optional<FieldPath> indexPath = _unwindSrc->indexPath();
             output[getSourceName()]["unwinding"] =
@@ -36,6 +36,7 @@
 #include "mongo/db/pipeline/document_source_unwind.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/lite_parsed_pipeline.h"
+#include "mongo/db/pipeline/lookup_hash_join.h"
 #include "mongo/db/pipeline/lookup_set_cache.h"
 #include "mongo/db/pipeline/value_comparator.h"
 
@@ -244,6 +245,38 @@ private:
 
     GetNextResult unwindResult();
 
+    /**
+     * Returns true if this stage may read the foreign side into a LookUpHashJoin instead of
+     * querying it per input document. Only top-level localField/foreignField lookups qualify, since
+     * a $lookup inside a sub-pipeline would rebuild its table for every outer document.
+     */
+    bool canUseHashJoin() const;
+
+    /**
+     * Called on the first getNext(). Builds '_hashJoin' from the foreign side if the hash join
+     * strategy is enabled and applicable, and leaves it null if the stage should query per input
+     * document instead.
+     */
+    void chooseJoinStrategy();
+
+    /**
+     * Returns the next input document, filling 'matches' with the foreign documents it joins with.
+     * May only be called when '_hashJoin' is set.
+     */
+    GetNextResult getNextHashJoinInput(std::vector<Value>* matches);
+
+    /**
+     * Runs the foreign query for a single input document and returns its results.
+     */
+    std::vector<Value> queryForeignMatches(const Document& inputDoc);
+
+    GetNextResult unwindHashJoinResult();
+
+    /**
+     * Returns the join strategy reported by explain.
+     */
+    StringData getJoinStrategyName() const;
+
     /**
      * Copies 'vars' and 'vps' to the Variables and VariablesParseState objects in 'expCtx'. These
      * copies provide access to 'let' defined variables in sub-pipeline execution.
@@ -332,6 +365,17 @@ private:
     std::unique_ptr<Pipeline, Pipeline::Deleter> _pipeline;
     boost::optional<Document> _input;
     boost::optional<Document> _nextValue;
+
+    // Set once the first getNext() call has decided between querying per input document and the
+    // hash join. '_hashJoin' is non-null only if the hash join was chosen and has not been
+    // abandoned.
+    bool _joinStrategyChosen = false;
+    std::unique_ptr<LookUpHashJoin> _hashJoin;
+
+    // Matches of '_input' not yet returned, when '_unwindSrc' is not null and the hash join is in
+    // use.
+    std::vector<Value> _hashMatches;
+    size_t _hashMatchIndex = 0;
 };
 
 }  // namespace mongo
@@ -47,6 +47,8 @@
 #include "mongo/db/repl/replication_coordinator_mock.h"
 #include "mongo/db/repl/storage_interface_mock.h"
 #include "mongo/db/server_options.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -663,6 +665,129 @@ TEST_F(DocumentSourceLookUpTest, ShouldPropagatePausesWhileUnwinding) {
     lookup->dispose();
 }
 
+/**
+ * Runs {$lookup: {from: "foreign", localField: "a", foreignField: "x", as: "joined"}} over
+ * 'localDocs' against 'foreignDocs', and returns the output documents followed by the join strategy
+ * reported by explain once execution has finished.
+ */
+std::pair<vector<Document>, std::string> runLocalForeignLookup(
+    const intrusive_ptr<ExpressionContextForTest>& expCtx,
+    deque<DocumentSource::GetNextResult> localDocs,
+    deque<DocumentSource::GetNextResult> foreignDocs) {
+    NamespaceString fromNs("test", "foreign");
+    expCtx->setResolvedNamespace(fromNs, {fromNs, std::vector<BSONObj>{}});
+
+    auto lookupSpec = Document{{"$lookup",
+                                Document{{"from", fromNs.coll()},
+                                         {"localField", "a"_sd},
+                                         {"foreignField", "x"_sd},
+                                         {"as", "joined"_sd}}}}
+                          .toBson();
+    auto parsed = DocumentSourceLookUp::createFromBson(lookupSpec.firstElement(), expCtx);
+    auto lookup = static_cast<DocumentSourceLookUp*>(parsed.get());
+
+    auto mockLocalSource = DocumentSourceMock::create(std::move(localDocs));
+    lookup->setSource(mockLocalSource.get());
+    lookup->injectMongoProcessInterface(
+        std::make_shared<MockMongoProcessInterface>(std::move(foreignDocs)));
+
+    vector<Document> results;
+    for (auto next = lookup->getNext(); !next.isEOF(); next = lookup->getNext()) {
+        ASSERT_TRUE(next.isAdvanced());
+        results.push_back(next.releaseDocument());
+    }
+
+    vector<Value> explain;
+    lookup->serializeToArray(explain, kExplain);
+    auto strategy = explain[0]["$lookup"]["strategy"].getString();
+
+    lookup->dispose();
+    return {std::move(results), std::move(strategy)};
+}
+
+deque<DocumentSource::GetNextResult> hashJoinForeignDocs() {
+    return {Document{{"_id", 0}, {"x", vector<Value>{Value(1), Value(2)}}},
+            Document{{"_id", 1}, {"x", 2}},
+            Document{{"_id", 2}, {"x", BSONNULL}},
+            Document{{"_id", 3}, {"x", 4.0}}};
+}
+
+deque<DocumentSource::GetNextResult> hashJoinLocalDocs() {
+    return {Document{{"a", 1}},
+            Document{{"a", 2}},
+            Document{{"a", vector<Value>{Value(1), Value(2)}}},
+            Document{{"a", 3}},
+            Document{{"a", BSONNULL}},
+            Document{{"a", 4LL}}};
+}
+
+void assertHashJoinResults(const vector<Document>& results) {
+    auto joinedIds = [](const Document& doc) {
+        vector<Value> ids;
+        for (auto&& joined : doc["joined"].getArray()) {
+            ids.push_back(joined["_id"]);
+        }
+        return Value(ids);
+    };
+
+    ASSERT_EQ(results.size(), 6U);
+    ASSERT_VALUE_EQ(results[0]["a"], Value(1));
+    ASSERT_VALUE_EQ(joinedIds(results[0]), Value(vector<Value>{Value(0)}));
+    ASSERT_VALUE_EQ(joinedIds(results[1]), Value(vector<Value>{Value(0), Value(1)}));
+    // Each foreign document is returned once even if several local values select it.
+    ASSERT_VALUE_EQ(joinedIds(results[2]), Value(vector<Value>{Value(0), Value(1)}));
+    ASSERT_VALUE_EQ(joinedIds(results[3]), Value(vector<Value>{}));
+    // Null local values are answered by querying the foreign side.
+    ASSERT_VALUE_EQ(joinedIds(results[4]), Value(vector<Value>{Value(2)}));
+    ASSERT_VALUE_EQ(joinedIds(results[5]), Value(vector<Value>{Value(3)}));
+}
+
+TEST_F(DocumentSourceLookUpTest, HashJoinProducesSameResultsAsPerDocumentQueries) {
+    auto nestedLoop = runLocalForeignLookup(getExpCtx(), hashJoinLocalDocs(), hashJoinForeignDocs());
+    ASSERT_EQ(nestedLoop.second, "nestedLoopJoin");
+    assertHashJoinResults(nestedLoop.first);
+
+    internalDocumentSourceLookupEnableHashJoin.store(true);
+    ON_BLOCK_EXIT([] { internalDocumentSourceLookupEnableHashJoin.store(false); });
+
+    auto hashJoin = runLocalForeignLookup(getExpCtx(), hashJoinLocalDocs(), hashJoinForeignDocs());
+    ASSERT_EQ(hashJoin.second, "hashJoin");
+    assertHashJoinResults(hashJoin.first);
+}
+
+TEST_F(DocumentSourceLookUpTest, HashJoinSpillsWhenForeignSideExceedsMemoryLimit) {
+    internalDocumentSourceLookupEnableHashJoin.store(true);
+    const auto originalMaxMemory = internalDocumentSourceLookupHashJoinMaxMemoryBytes.load();
+    internalDocumentSourceLookupHashJoinMaxMemoryBytes.store(1);
+    ON_BLOCK_EXIT([originalMaxMemory] {
+        internalDocumentSourceLookupEnableHashJoin.store(false);
+        internalDocumentSourceLookupHashJoinMaxMemoryBytes.store(originalMaxMemory);
+    });
+
+    unittest::TempDir tempDir("DocumentSourceLookUpTest");
+    auto expCtx = getExpCtx();
+    expCtx->allowDiskUse = true;
+    expCtx->tempDir = tempDir.path();
+
+    auto spilled = runLocalForeignLookup(expCtx, hashJoinLocalDocs(), hashJoinForeignDocs());
+    ASSERT_EQ(spilled.second, "hashJoinSpilled");
+    assertHashJoinResults(spilled.first);
+}
+
+TEST_F(DocumentSourceLookUpTest, HashJoinFallsBackToQueriesIfItCannotSpill) {
+    internalDocumentSourceLookupEnableHashJoin.store(true);
+    const auto originalMaxMemory = internalDocumentSourceLookupHashJoinMaxMemoryBytes.load();
+    internalDocumentSourceLookupHashJoinMaxMemoryBytes.store(1);
+    ON_BLOCK_EXIT([originalMaxMemory] {
+        internalDocumentSourceLookupEnableHashJoin.store(false);
+        internalDocumentSourceLookupHashJoinMaxMemoryBytes.store(originalMaxMemory);
+    });
+
+    auto fallback = runLocalForeignLookup(getExpCtx(), hashJoinLocalDocs(), hashJoinForeignDocs());
+    ASSERT_EQ(fallback.second, "nestedLoopJoin");
+    assertHashJoinResults(fallback.first);
+}
+
 TEST_F(DocumentSourceLookUpTest, LookupReportsAsFieldIsModified) {
     auto expCtx = getExpCtx();
     NamespaceString fromNs("test", "foreign");
@@ -38,6 +38,7 @@
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/lite_parsed_document_source.h"
 #include "mongo/db/pipeline/value.h"
+#include "mongo/db/query/query_knobs.h"
 
 namespace mongo {
 
@@ -309,6 +310,8 @@ SortOptions DocumentSourceSort::makeSortOptions() const {
     if (pExpCtx->allowDiskUse && !pExpCtx->inMongos) {
         opts.extSortAllowed = true;
         opts.tempDir = pExpCtx->tempDir;
+        opts.maxParallelSpills =
+            std::max(0, internalDocumentSourceSortMaxParallelSpills.load());
     }
 
     return opts;
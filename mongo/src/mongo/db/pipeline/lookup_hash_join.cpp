@@ -0,0 +1,340 @@
+/**
+ * Copyright (C) 2018 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/lookup_hash_join.h"
+
+#include <algorithm>
+
+#include "mongo/db/pipeline/document_path_support.h"
+#include "mongo/util/stringutils.h"
+
+namespace mongo {
+
+namespace {
+
+/**
+ * Orders Sorter entries by key using a ValueComparator, so that join values are grouped according
+ * to the collation of the foreign side.
+ */
+class KeyComparator {
+public:
+    explicit KeyComparator(const ValueComparator& comparator) : _comparator(comparator) {}
+
+    template <typename Data>
+    int operator()(const Data& lhs, const Data& rhs) const {
+        return _comparator.compare(lhs.first, rhs.first);
+    }
+
+private:
+    const ValueComparator _comparator;
+};
+
+// Field names used to pair a document with its position when it travels through a Sorter.
+const StringData kIdField = "i"_sd;
+const StringData kDocField = "d"_sd;
+const StringData kResolvedField = "r"_sd;
+
+}  // namespace
+
+bool LookUpHashJoin::canJoinOn(const FieldPath& foreignField) {
+    for (size_t i = 0; i < foreignField.getPathLength(); ++i) {
+        if (parseUnsignedBase10Integer(foreignField.getFieldName(i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+LookUpHashJoin::LookUpHashJoin(const ValueComparator& comparator,
+                               FieldPath localField,
+                               FieldPath foreignField,
+                               size_t maxMemoryUsageBytes,
+                               std::string tempDir)
+    : _comparator(comparator),
+      _localField(std::move(localField)),
+      _foreignField(std::move(foreignField)),
+      _maxMemoryUsageBytes(maxMemoryUsageBytes),
+      _tempDir(std::move(tempDir)),
+      _table(_comparator.makeUnorderedValueMap<std::vector<size_t>>()) {}
+
+LookUpHashJoin::~LookUpHashJoin() = default;
+
+bool LookUpHashJoin::getProbeKeys(const Document& localDoc, std::vector<Value>* keys) const {
+    bool answerable = true;
+    document_path_support::visitAllValuesAtPath(localDoc, _localField, [&](const Value& value) {
+        switch (value.getType()) {
+            case BSONType::jstNULL:
+            case BSONType::Undefined:
+            case BSONType::Array:
+            case BSONType::RegEx:
+                answerable = false;
+                break;
+            default:
+                keys->push_back(value);
+        }
+    });
+
+    // A missing local value joins with foreign documents whose value is null or missing.
+    return answerable && !keys->empty();
+}
+
+void LookUpHashJoin::getBuildKeys(const Document& foreignDoc, std::vector<Value>* keys) const {
+    document_path_support::visitAllValuesAtPath(
+        foreignDoc, _foreignField, [&](const Value& value) { keys->push_back(value); });
+}
+
+SortOptions LookUpHashJoin::makeSortOptions() const {
+    return SortOptions().TempDir(_tempDir).ExtSortAllowed().MaxMemoryUsageBytes(
+        _maxMemoryUsageBytes);
+}
+
+void LookUpHashJoin::addForeign(const Document& foreignDoc) {
+    invariant(_status == JoinStatus::kBuilding ||
+              (_status == JoinStatus::kSpilled && !_foreignIter));
+
+    const long long id = _foreignCount++;
+
+    if (_status == JoinStatus::kSpilled) {
+        addForeignToSorter(id, foreignDoc);
+        return;
+    }
+
+    std::vector<Value> keys;
+    getBuildKeys(foreignDoc, &keys);
+
+    _foreignDocs.push_back(foreignDoc);
+    _memoryUsageBytes += foreignDoc.getApproximateSize();
+
+    for (auto&& key : keys) {
+        auto& ids = _table[key];
+        // A document listing the same value twice must only be returned once per match.
+        if (ids.empty() || ids.back() != static_cast<size_t>(id)) {
+            ids.push_back(id);
+            _memoryUsageBytes += key.getApproximateSize() + sizeof(size_t);
+        }
+    }
+
+    if (_memoryUsageBytes > _maxMemoryUsageBytes) {
+        if (_tempDir.empty()) {
+            abandon();
+        } else {
+            spill();
+        }
+    }
+}
+
+void LookUpHashJoin::addForeignToSorter(long long id, const Document& foreignDoc) {
+    std::vector<Value> keys;
+    getBuildKeys(foreignDoc, &keys);
+    if (keys.empty()) {
+        // No probe can match a document without a join value.
+        return;
+    }
+
+    const Document entry{{kIdField, id}, {kDocField, foreignDoc}};
+    for (auto&& key : keys) {
+        _foreignSorter->add(key, entry);
+    }
+}
+
+void LookUpHashJoin::spill() {
+    invariant(_status == JoinStatus::kBuilding);
+
+    _foreignSorter.reset(ForeignSorter::make(makeSortOptions(), KeyComparator(_comparator)));
+    for (size_t id = 0; id < _foreignDocs.size(); ++id) {
+        addForeignToSorter(id, _foreignDocs[id]);
+    }
+
+    _table.clear();
+    _foreignDocs.clear();
+    _foreignDocs.shrink_to_fit();
+    _memoryUsageBytes = 0;
+
+    _probeKeySorter.reset(
+        ProbeKeySorter::make(makeSortOptions(), KeyComparator(_comparator)));
+    _inputSorter.reset(ForeignSorter::make(makeSortOptions(), KeyComparator(ValueComparator())));
+    _status = JoinStatus::kSpilled;
+}
+
+void LookUpHashJoin::freeze() {
+    if (_status == JoinStatus::kBuilding) {
+        _status = JoinStatus::kInMemory;
+    } else if (_status == JoinStatus::kSpilled) {
+        invariant(!_foreignIter);
+        _foreignIter.reset(_foreignSorter->done());
+        _foreignSorter.reset();
+    }
+}
+
+void LookUpHashJoin::abandon() {
+    _table.clear();
+    _foreignDocs.clear();
+    _foreignDocs.shrink_to_fit();
+    _memoryUsageBytes = 0;
+
+    _foreignSorter.reset();
+    _probeKeySorter.reset();
+    _inputSorter.reset();
+    _foreignIter.reset();
+    _inputIter.reset();
+    _matchIter.reset();
+    _nextMatch = boost::none;
+
+    _status = JoinStatus::kAbandoned;
+}
+
+bool LookUpHashJoin::probe(const Document& input, std::vector<Value>* matches) const {
+    invariant(_status == JoinStatus::kInMemory);
+
+    std::vector<Value> keys;
+    if (!getProbeKeys(input, &keys)) {
+        return false;
+    }
+
+    std::vector<size_t> ids;
+    for (auto&& key : keys) {
+        auto it = _table.find(key);
+        if (it != _table.end()) {
+            ids.insert(ids.end(), it->second.begin(), it->second.end());
+        }
+    }
+
+    // Several local values may select the same foreign document, which an $in query would have
+    // returned once.
+    if (keys.size() > 1) {
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    }
+
+    matches->reserve(matches->size() + ids.size());
+    for (auto id : ids) {
+        matches->emplace_back(_foreignDocs[id]);
+    }
+    return true;
+}
+
+void LookUpHashJoin::addProbe(Document input) {
+    invariant(_status == JoinStatus::kSpilled && _foreignIter && !_inputIter);
+
+    const Value seq(_inputCount++);
+
+    std::vector<Value> keys;
+    const bool resolved = getProbeKeys(input, &keys);
+    if (resolved) {
+        for (auto&& key : keys) {
+            _probeKeySorter->add(key, seq);
+        }
+    }
+
+    _inputSorter->add(seq, Document{{kResolvedField, resolved}, {kDocField, std::move(input)}});
+}
+
+void LookUpHashJoin::finishProbes() {
+    invariant(_status == JoinStatus::kSpilled && _foreignIter && !_inputIter);
+
+    // Merge the foreign side with the input join values, both in join value order. Each match is
+    // recorded under (input position, foreign position) so that sorting the matches puts them back
+    // in input order, with the matches of one input in the order the foreign side was read.
+    std::unique_ptr<ForeignSorter> matchSorter(
+        ForeignSorter::make(makeSortOptions(), KeyComparator(ValueComparator())));
+    std::unique_ptr<ProbeKeySorter::Iterator> probeIter(_probeKeySorter->done());
+    _probeKeySorter.reset();
+
+    boost::optional<std::pair<Value, Document>> nextForeign;
+    if (_foreignIter->more()) {
+        nextForeign = _foreignIter->next();
+    }
+
+    boost::optional<Value> groupKey;
+    std::vector<Document> group;
+    while (probeIter->more()) {
+        auto probe = probeIter->next();
+
+        if (!groupKey || _comparator.compare(*groupKey, probe.first) != 0) {
+            group.clear();
+            while (nextForeign && _comparator.compare(nextForeign->first, probe.first) < 0) {
+                nextForeign = _foreignIter->more() ? boost::make_optional(_foreignIter->next())
+                                                   : boost::none;
+            }
+            while (nextForeign && _comparator.compare(nextForeign->first, probe.first) == 0) {
+                group.push_back(std::move(nextForeign->second));
+                nextForeign = _foreignIter->more() ? boost::make_optional(_foreignIter->next())
+                                                   : boost::none;
+            }
+            groupKey = probe.first;
+        }
+
+        for (auto&& entry : group) {
+            matchSorter->add(Value(std::vector<Value>{probe.second, entry[kIdField]}),
+                             entry[kDocField].getDocument());
+        }
+    }
+
+    _foreignIter.reset();
+    _matchIter.reset(matchSorter->done());
+    _inputIter.reset(_inputSorter->done());
+    _inputSorter.reset();
+}
+
+boost::optional<LookUpHashJoin::SpilledResult> LookUpHashJoin::getNextSpilled() {
+    invariant(_status == JoinStatus::kSpilled && _inputIter);
+
+    if (!_inputIter->more()) {
+        return boost::none;
+    }
+
+    auto input = _inputIter->next();
+    const Value& seq = input.first;
+
+    SpilledResult result;
+    result.input = input.second[kDocField].getDocument();
+    result.resolved = input.second[kResolvedField].getBool();
+
+    if (!_nextMatch && _matchIter->more()) {
+        _nextMatch = _matchIter->next();
+    }
+
+    boost::optional<Value> lastId;
+    while (_nextMatch && _nextMatch->first[0].getLong() == seq.getLong()) {
+        const Value& id = _nextMatch->first[1];
+        if (!lastId || lastId->getLong() != id.getLong()) {
+            result.matches.emplace_back(std::move(_nextMatch->second));
+            lastId = id;
+        }
+        _nextMatch = _matchIter->more() ? boost::make_optional(_matchIter->next()) : boost::none;
+    }
+
+    return result;
+}
+
+}  // namespace mongo
+
+#include "mongo/db/sorter/sorter.cpp"
+// Explicit instantiation unneeded since we aren't exposing Sorter outside of this file.
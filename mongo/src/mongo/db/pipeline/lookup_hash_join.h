@@ -0,0 +1,220 @@
+/**
+ * Copyright (C) 2018 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/field_path.h"
+#include "mongo/db/pipeline/value.h"
+#include "mongo/db/pipeline/value_comparator.h"
+#include "mongo/db/sorter/sorter.h"
+
+namespace mongo {
+
+/**
+ * Implements the hash join strategy used by $lookup stages with localField/foreignField syntax.
+ * The foreign side is read once into a hash table keyed by the values at 'foreignField', and each
+ * input document is then answered by probing the table with the values at its 'localField'
+ * instead of issuing a query against the foreign collection.
+ *
+ * The join is in one of four states. A new join is 'kBuilding'. Once the foreign side has been
+ * read, freeze() moves it to 'kInMemory', unless the table outgrew its memory limit while
+ * building. In that case the foreign side has been moved into a Sorter keyed by join value and
+ * the join is 'kSpilled': input documents are buffered with addProbe(), joined with a sort-merge
+ * pass by finishProbes(), and returned in their original order by getNextSpilled(). If spilling
+ * is not permitted, outgrowing the limit abandons the join instead and the caller should fall
+ * back to querying per input document.
+ *
+ * Input documents whose local values cannot be answered from the table (missing or null values,
+ * nested arrays or regular expressions, all of which have query semantics that plain equality does
+ * not reproduce) are reported as unresolved so that the caller can query for them instead.
+ */
+class LookUpHashJoin {
+    MONGO_DISALLOW_COPYING(LookUpHashJoin);
+
+public:
+    enum class JoinStatus { kBuilding, kInMemory, kSpilled, kAbandoned };
+
+    /**
+     * An input document buffered by a spilled join, along with its matches. 'resolved' is false if
+     * the matches could not be computed from the foreign side and must be queried for.
+     */
+    struct SpilledResult {
+        Document input;
+        bool resolved = false;
+        std::vector<Value> matches;
+    };
+
+    /**
+     * Returns true if the hash join can reproduce the semantics of an equality query on
+     * 'foreignField'. Paths with numeric components are excluded since the query system may treat
+     * them as array positions.
+     */
+    static bool canJoinOn(const FieldPath& foreignField);
+
+    /**
+     * 'comparator' must reflect the collation of the foreign side. If 'tempDir' is empty, the join
+     * is abandoned rather than spilled once it exceeds 'maxMemoryUsageBytes'.
+     */
+    LookUpHashJoin(const ValueComparator& comparator,
+                   FieldPath localField,
+                   FieldPath foreignField,
+                   size_t maxMemoryUsageBytes,
+                   std::string tempDir);
+
+    ~LookUpHashJoin();
+
+    /**
+     * Adds a document from the foreign side. May only be called while 'kBuilding' or, after the
+     * table has spilled, while 'kSpilled' and before freeze().
+     */
+    void addForeign(const Document& foreignDoc);
+
+    /**
+     * Signals that the whole foreign side has been added.
+     */
+    void freeze();
+
+    /**
+     * Abandons the join and releases everything it holds.
+     */
+    void abandon();
+
+    /**
+     * Fills 'matches' with the foreign documents joining with 'input' in the order they were
+     * added. Returns false, leaving 'matches' untouched, if 'input' must be queried for instead.
+     * May only be called while 'kInMemory'.
+     */
+    bool probe(const Document& input, std::vector<Value>* matches) const;
+
+    /**
+     * Buffers an input document to be joined by finishProbes(). May only be called while
+     * 'kSpilled', after freeze() and before finishProbes().
+     */
+    void addProbe(Document input);
+
+    /**
+     * Joins the buffered input documents with the foreign side.
+     */
+    void finishProbes();
+
+    /**
+     * Returns the next buffered input document, in the order they were added, or boost::none once
+     * they have all been returned. May only be called after finishProbes().
+     */
+    boost::optional<SpilledResult> getNextSpilled();
+
+    JoinStatus status() const {
+        return _status;
+    }
+
+    bool isInMemory() const {
+        return _status == JoinStatus::kInMemory;
+    }
+
+    bool isSpilled() const {
+        return _status == JoinStatus::kSpilled;
+    }
+
+    bool isAbandoned() const {
+        return _status == JoinStatus::kAbandoned;
+    }
+
+    bool probesFinished() const {
+        return static_cast<bool>(_inputIter);
+    }
+
+    size_t memoryUsageBytes() const {
+        return _memoryUsageBytes;
+    }
+
+    long long foreignCount() const {
+        return _foreignCount;
+    }
+
+private:
+    using ForeignSorter = Sorter<Value, Document>;
+    using ProbeKeySorter = Sorter<Value, Value>;
+
+    /**
+     * Appends the join values of 'localDoc' to 'keys'. Returns false if any of them cannot be
+     * answered with an equality lookup.
+     */
+    bool getProbeKeys(const Document& localDoc, std::vector<Value>* keys) const;
+
+    /**
+     * Appends the join values of 'foreignDoc' to 'keys'.
+     */
+    void getBuildKeys(const Document& foreignDoc, std::vector<Value>* keys) const;
+
+    SortOptions makeSortOptions() const;
+
+    /**
+     * Moves the in-memory table into '_foreignSorter' and switches to 'kSpilled'.
+     */
+    void spill();
+
+    void addForeignToSorter(long long id, const Document& foreignDoc);
+
+    JoinStatus _status = JoinStatus::kBuilding;
+
+    const ValueComparator _comparator;
+    const FieldPath _localField;
+    const FieldPath _foreignField;
+    const size_t _maxMemoryUsageBytes;
+    const std::string _tempDir;
+
+    size_t _memoryUsageBytes = 0;
+    long long _foreignCount = 0;
+
+    // In-memory table: the foreign documents in the order they were added, and for each join value
+    // the ascending positions of the documents containing it.
+    std::vector<Document> _foreignDocs;
+    ValueUnorderedMap<std::vector<size_t>> _table;
+
+    // Spilled join state. The foreign side is sorted by join value, as are the join values of the
+    // buffered input documents. Merging the two produces the matches for each input document,
+    // which are sorted back into input order and combined with the inputs on the way out.
+    std::unique_ptr<ForeignSorter> _foreignSorter;
+    std::unique_ptr<ProbeKeySorter> _probeKeySorter;
+    std::unique_ptr<ForeignSorter> _inputSorter;
+    long long _inputCount = 0;
+
+    std::unique_ptr<ForeignSorter::Iterator> _foreignIter;
+    std::unique_ptr<ForeignSorter::Iterator> _inputIter;
+    std::unique_ptr<ForeignSorter::Iterator> _matchIter;
+    boost::optional<std::pair<Value, Document>> _nextMatch;
+};
+
+}  // namespace mongo
@@ -33,8 +33,10 @@
 #include "mongo/db/query/cursor_response.h"
 
 #include "mongo/bson/bsontypes.h"
+#include "mongo/db/operation_context.h"
 #include "mongo/rpc/get_status_from_command_result.h"
 #include "mongo/s/chunk_version.h"
+#include "mongo/util/net/op_msg.h"
 
 namespace mongo {
 
@@ -47,17 +49,68 @@ const char kBatchField[] = "nextBatch";
 const char kBatchFieldInitial[] = "firstBatch";
 const char kInternalLatestOplogTimestampField[] = "$_internalLatestOplogTimestamp";
 
+struct BatchReferences {
+    OpMsgBuilder* builder = nullptr;
+    int minObjectSize = 0;
+};
+
+const auto getBatchReferences = OperationContext::declareDecoration<BatchReferences>();
+
 }  // namespace
 
+ScopedCursorBatchReferences::ScopedCursorBatchReferences(OperationContext* opCtx,
+                                                         OpMsgBuilder* builder,
+                                                         int minObjectSize)
+    : _opCtx(opCtx),
+      _prevBuilder(getBatchReferences(opCtx).builder),
+      _prevMinObjectSize(getBatchReferences(opCtx).minObjectSize) {
+    getBatchReferences(opCtx) = {builder, minObjectSize};
+}
+
+ScopedCursorBatchReferences::~ScopedCursorBatchReferences() {
+    getBatchReferences(_opCtx) = {_prevBuilder, _prevMinObjectSize};
+}
+
+void ScopedCursorBatchReferences::discardAll(OperationContext* opCtx) {
+    if (auto builder = getBatchReferences(opCtx).builder)
+        builder->discardReferencesFrom(0);
+}
+
 CursorResponseBuilder::CursorResponseBuilder(bool isInitialResponse,
-                                             BSONObjBuilder* commandResponse)
+                                             BSONObjBuilder* commandResponse,
+                                             OperationContext* opCtx)
     : _responseInitialLen(commandResponse->bb().len()),
       _commandResponse(commandResponse),
       _cursorObject(commandResponse->subobjStart(kCursorField)),
-      _batch(_cursorObject.subarrayStart(isInitialResponse ? kBatchFieldInitial : kBatchField)) {}
+      _batch(_cursorObject.subarrayStart(isInitialResponse ? kBatchFieldInitial : kBatchField)) {
+    if (!opCtx)
+        return;
+
+    // Each sub-builder has just written its type byte and field name and reserved its length.
+    _cursorLengthOffset = _responseInitialLen + 1 + sizeof(kCursorField);
+    _batchLengthOffset = commandResponse->bb().len() - sizeof(int32_t);
+
+    // Only the outermost reply is sent straight to the network; replies built for a
+    // DBDirectClient, or into a scratch builder, use their own buffers and fail this check.
+    const auto& references = getBatchReferences(opCtx);
+    if (references.builder && references.minObjectSize > 0 &&
+        references.builder->isBuildingInto(commandResponse->bb())) {
+        _referenceTarget = references.builder;
+        _minReferencedObjectSize = references.minObjectSize;
+    }
+}
+
+void CursorResponseBuilder::_appendReferenced(const BSONObj& obj) {
+    _referenceTarget->appendReferencedObject(&_batch, obj);
+    _referencedBytes += obj.objsize() - BSONObj::kMinBSONLength;
+}
 
 void CursorResponseBuilder::done(CursorId cursorId, StringData cursorNamespace) {
     invariant(_active);
+    if (_referencedBytes) {
+        _referenceTarget->addReferencingContainer(_batchLengthOffset);
+        _referenceTarget->addReferencingContainer(_cursorLengthOffset);
+    }
     _batch.doneFast();
     _cursorObject.append(kIdField, cursorId);
     _cursorObject.append(kNsField, cursorNamespace);
@@ -73,6 +126,8 @@ void CursorResponseBuilder::abandon() {
     _batch.doneFast();
     _cursorObject.doneFast();
     _commandResponse->bb().setlen(_responseInitialLen);  // Removes everything we've added.
+    if (_referenceTarget)
+        _referenceTarget->discardReferencesFrom(_responseInitialLen);
     _active = false;
 }
 
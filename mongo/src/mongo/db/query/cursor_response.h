@@ -38,6 +38,34 @@
 
 namespace mongo {
 
+class OperationContext;
+class OpMsgBuilder;
+
+/**
+ * While in scope, CursorResponseBuilders constructed with 'opCtx' that build into 'builder' append
+ * owned documents of at least 'minObjectSize' bytes by reference instead of copying them into the
+ * reply (see OpMsgBuilder::appendReferencedObject()). Only install this for replies that are
+ * handed directly to the transport layer.
+ */
+class ScopedCursorBatchReferences {
+    MONGO_DISALLOW_COPYING(ScopedCursorBatchReferences);
+
+public:
+    ScopedCursorBatchReferences(OperationContext* opCtx, OpMsgBuilder* builder, int minObjectSize);
+    ~ScopedCursorBatchReferences();
+
+    /**
+     * Drops all references made so far on 'opCtx'. Must be called by anyone who empties the reply
+     * body after a CursorResponseBuilder has completed.
+     */
+    static void discardAll(OperationContext* opCtx);
+
+private:
+    OperationContext* const _opCtx;
+    OpMsgBuilder* const _prevBuilder;
+    const int _prevMinObjectSize;
+};
+
 /**
  * Builds the cursor field and the _latestOplogTimestamp field for a reply to a cursor-generating
  * command in place.
@@ -53,8 +81,13 @@ public:
      *
      * If the builder goes out of scope without a call to done(), any data appended to the
      * builder will be removed.
+     *
+     * Passing 'opCtx' lets the batch reference large owned documents rather than copy them, if a
+     * ScopedCursorBatchReferences for 'commandResponse' is active.
      */
-    CursorResponseBuilder(bool isInitialResponse, BSONObjBuilder* commandResponse);
+    CursorResponseBuilder(bool isInitialResponse,
+                          BSONObjBuilder* commandResponse,
+                          OperationContext* opCtx = nullptr);
 
     ~CursorResponseBuilder() {
         if (_active)
@@ -63,11 +96,15 @@ public:
 
     size_t bytesUsed() const {
         invariant(_active);
-        return _batch.len();
+        return _batch.len() + _referencedBytes;
     }
 
     void append(const BSONObj& obj) {
         invariant(_active);
+        if (_referenceTarget && obj.isOwned() && obj.objsize() >= _minReferencedObjectSize) {
+            _appendReferenced(obj);
+            return;
+        }
         _batch.append(obj);
     }
 
@@ -89,12 +126,23 @@ public:
     void abandon();
 
 private:
+    void _appendReferenced(const BSONObj& obj);
+
     const int _responseInitialLen;  // Must be the first member so its initializer runs first.
     bool _active = true;
     BSONObjBuilder* const _commandResponse;
     BSONObjBuilder _cursorObject;
     BSONArrayBuilder _batch;
     Timestamp _latestOplogTimestamp;
+
+    // Set when documents may be referenced rather than copied into the batch.
+    OpMsgBuilder* _referenceTarget = nullptr;
+    int _minReferencedObjectSize = 0;
+    int _cursorLengthOffset = 0;
+    int _batchLengthOffset = 0;
+
+    // Bytes referenced documents add to the batch beyond their placeholders in the buffer.
+    size_t _referencedBytes = 0;
 };
 
 /**
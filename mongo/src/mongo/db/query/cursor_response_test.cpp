@@ -30,7 +30,11 @@
 
 #include "mongo/db/query/cursor_response.h"
 
+#include <algorithm>
+
+#include "mongo/db/query/query_test_service_context.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/net/op_msg.h"
 
 namespace mongo {
 
@@ -330,6 +334,204 @@ TEST(CursorResponseTest, serializeLatestOplogEntry) {
     ASSERT_EQ(*reparsedResponse.getLastOplogTimestamp(), Timestamp(1, 2));
 }
 
+/**
+ * Returns where each segment of 'msg' on the wire starts.
+ */
+std::vector<const char*> wireSegments(const Message& msg) {
+    std::vector<const char*> segments;
+    msg.forEachWireSegment([&](const char* data, size_t size) { segments.push_back(data); });
+    return segments;
+}
+
+/**
+ * Builds a reply with an initial cursor batch holding 'docs' into 'builder', the way find does.
+ */
+void buildCursorReply(OperationContext* opCtx,
+                      OpMsgBuilder* builder,
+                      const std::vector<BSONObj>& docs,
+                      size_t* bytesUsed = nullptr) {
+    auto body = builder->beginBody();
+    CursorResponseBuilder cursorBuilder(true, &body, opCtx);
+    for (const auto& doc : docs) {
+        cursorBuilder.append(doc);
+    }
+    if (bytesUsed) {
+        *bytesUsed = cursorBuilder.bytesUsed();
+    }
+    cursorBuilder.done(CursorId(123), "db.coll");
+    body.append("ok", 1.0);
+}
+
+BSONObj parseReply(const Message& msg) {
+    return OpMsg::parse(msg.flatten()).body.getOwned();
+}
+
+const BSONObj kLargeDoc = BSON("_id" << 1 << "s" << std::string(5000, 'a'));
+const BSONObj kSmallDoc = BSON("_id" << 2);
+const BSONObj kOtherLargeDoc = BSON("_id" << 3 << "s" << std::string(6000, 'b'));
+
+TEST(CursorResponseBuilderTest, ReferencesLargeOwnedDocuments) {
+    QueryTestServiceContext serviceContext;
+    auto opCtx = serviceContext.makeOperationContext();
+
+    // An unowned view of a large document must still be copied, as its memory may not outlive the
+    // command
+    const BSONObj unownedLargeDoc(kOtherLargeDoc.objdata());
+    ASSERT_FALSE(unownedLargeDoc.isOwned());
+
+    const std::vector<BSONObj> docs = {kLargeDoc, kSmallDoc, unownedLargeDoc, kLargeDoc};
+
+    OpMsgBuilder builder;
+    size_t bytesUsed;
+    {
+        ScopedCursorBatchReferences references(opCtx.get(), &builder, 4096);
+        buildCursorReply(opCtx.get(), &builder, docs, &bytesUsed);
+    }
+    auto msg = builder.finish();
+
+    // Both copies of the large owned document are sent from its own buffer, between the parts
+    // of the reply's buffer before, between and after them
+    ASSERT(msg.hasReferencedData());
+    const auto segments = wireSegments(msg);
+    ASSERT_EQ(5U, segments.size());
+    ASSERT(segments[1] == kLargeDoc.objdata());
+    ASSERT(segments[3] == kLargeDoc.objdata());
+    ASSERT_EQ(0, std::count(segments.begin(), segments.end(), kOtherLargeDoc.objdata()));
+
+    // The batch size accounts for the referenced documents as if they had been copied
+    OpMsgBuilder copyingBuilder;
+    size_t copiedBytesUsed;
+    buildCursorReply(opCtx.get(), &copyingBuilder, docs, &copiedBytesUsed);
+    ASSERT_EQ(copiedBytesUsed, bytesUsed);
+
+    auto copiedMsg = copyingBuilder.finish();
+    ASSERT_FALSE(copiedMsg.hasReferencedData());
+    ASSERT_EQ(copiedMsg.size(), msg.size());
+
+    const auto reply = parseReply(msg);
+    ASSERT_BSONOBJ_EQ(parseReply(copiedMsg), reply);
+
+    auto response = unittest::assertGet(CursorResponse::parseFromBSON(reply));
+    ASSERT_EQ(CursorId(123), response.getCursorId());
+    ASSERT_EQ(docs.size(), response.getBatch().size());
+    for (size_t i = 0; i < docs.size(); i++) {
+        ASSERT_BSONOBJ_EQ(docs[i], response.getBatch()[i]);
+    }
+}
+
+TEST(CursorResponseBuilderTest, CopiesWithoutScopedReferencesOrIntoOtherBuffers) {
+    QueryTestServiceContext serviceContext;
+    auto opCtx = serviceContext.makeOperationContext();
+
+    {
+        OpMsgBuilder builder;
+        buildCursorReply(opCtx.get(), &builder, {kLargeDoc});
+        ASSERT_FALSE(builder.finish().hasReferencedData());
+    }
+
+    {
+        // No OperationContext to find the references through
+        OpMsgBuilder builder;
+        {
+            ScopedCursorBatchReferences references(opCtx.get(), &builder, 4096);
+            auto body = builder.beginBody();
+            CursorResponseBuilder cursorBuilder(true, &body);
+            cursorBuilder.append(kLargeDoc);
+            cursorBuilder.done(CursorId(0), "db.coll");
+        }
+        ASSERT_FALSE(builder.finish().hasReferencedData());
+    }
+
+    {
+        // A reply built into a buffer other than the one being sent, as for DBDirectClient
+        OpMsgBuilder builder;
+        ScopedCursorBatchReferences references(opCtx.get(), &builder, 4096);
+
+        BSONObjBuilder scratch;
+        {
+            CursorResponseBuilder cursorBuilder(true, &scratch, opCtx.get());
+            cursorBuilder.append(kLargeDoc);
+            cursorBuilder.done(CursorId(0), "db.coll");
+        }
+        scratch.append("ok", 1);
+        auto response = unittest::assertGet(CursorResponse::parseFromBSON(scratch.obj()));
+        ASSERT_EQ(1U, response.getBatch().size());
+        ASSERT_BSONOBJ_EQ(kLargeDoc, response.getBatch()[0]);
+
+        builder.setBody(BSON("ok" << 1));
+        ASSERT_FALSE(builder.finish().hasReferencedData());
+    }
+
+    {
+        // A nested scope for another reply is undone when it exits
+        OpMsgBuilder builder;
+        ScopedCursorBatchReferences references(opCtx.get(), &builder, 4096);
+        {
+            OpMsgBuilder nestedBuilder;
+            ScopedCursorBatchReferences nestedReferences(opCtx.get(), &nestedBuilder, 4096);
+        }
+        buildCursorReply(opCtx.get(), &builder, {kLargeDoc});
+        ASSERT(builder.finish().hasReferencedData());
+    }
+}
+
+TEST(CursorResponseBuilderTest, AbandonDropsReferences) {
+    QueryTestServiceContext serviceContext;
+    auto opCtx = serviceContext.makeOperationContext();
+
+    OpMsgBuilder builder;
+    {
+        ScopedCursorBatchReferences references(opCtx.get(), &builder, 4096);
+        auto body = builder.beginBody();
+        body.append("a", 1);
+        {
+            CursorResponseBuilder cursorBuilder(true, &body, opCtx.get());
+            cursorBuilder.append(kLargeDoc);
+            cursorBuilder.append(kSmallDoc);
+            cursorBuilder.abandon();
+        }
+        {
+            // Going out of scope without done() abandons as well
+            CursorResponseBuilder cursorBuilder(true, &body, opCtx.get());
+            cursorBuilder.append(kOtherLargeDoc);
+        }
+        body.append("ok", 0.0);
+    }
+    auto msg = builder.finish();
+
+    ASSERT_FALSE(msg.hasReferencedData());
+    ASSERT_BSONOBJ_EQ(BSON("a" << 1 << "ok" << 0.0), parseReply(msg));
+}
+
+TEST(CursorResponseBuilderTest, DiscardAllDropsReferencesOfCompletedBatches) {
+    QueryTestServiceContext serviceContext;
+    auto opCtx = serviceContext.makeOperationContext();
+
+    OpMsgBuilder builder;
+    {
+        ScopedCursorBatchReferences references(opCtx.get(), &builder, 4096);
+        auto body = builder.beginBody();
+        {
+            CursorResponseBuilder cursorBuilder(true, &body, opCtx.get());
+            cursorBuilder.append(kLargeDoc);
+            cursorBuilder.append(kOtherLargeDoc);
+            cursorBuilder.done(CursorId(123), "db.coll");
+        }
+
+        // As when a command's reply is replaced by an error after it has been built
+        body.resetToEmpty();
+        ScopedCursorBatchReferences::discardAll(opCtx.get());
+        body.append("ok", 0.0);
+        body.append("errmsg", "failed");
+    }
+    auto msg = builder.finish();
+
+    ASSERT_FALSE(msg.hasReferencedData());
+    ASSERT_BSONOBJ_EQ(BSON("ok" << 0.0 << "errmsg"
+                                << "failed"),
+                      parseReply(msg));
+}
+
 }  // namespace
 
 }  // namespace mongo
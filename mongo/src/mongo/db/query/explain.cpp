@@ -154,6 +154,10 @@ size_t getDocsExamined(StageType type, const SpecificStats* specific) {
     if (STAGE_COLLSCAN == type) {
         const CollectionScanStats* spec = static_cast<const CollectionScanStats*>(specific);
         return spec->docsTested;
+    } else if (STAGE_PARALLEL_COLLSCAN == type) {
+        const ParallelCollectionScanStats* spec =
+            static_cast<const ParallelCollectionScanStats*>(specific);
+        return spec->docsTested;
     } else if (STAGE_FETCH == type) {
         const FetchStats* spec = static_cast<const FetchStats*>(specific);
         return spec->docsExamined;
@@ -384,8 +388,22 @@ void Explain::statsToBSON(const PlanStageStats& stats,
         if (spec->maxTs) {
             bob->append("maxTs", *(spec->maxTs));
         }
+        if (!spec->projectedFields.empty()) {
+            bob->append("projectedFields", spec->projectedFields);
+        }
+        if (verbosity >= ExplainOptions::Verbosity::kExecStats) {
+            bob->appendNumber("docsExamined", spec->docsTested);
+            if (!spec->projectedFields.empty()) {
+                bob->appendNumber("bytesSkipped", spec->bytesSkipped);
+            }
+        }
+    } else if (STAGE_PARALLEL_COLLSCAN == stats.stageType) {
+        ParallelCollectionScanStats* spec =
+            static_cast<ParallelCollectionScanStats*>(stats.specific.get());
         if (verbosity >= ExplainOptions::Verbosity::kExecStats) {
             bob->appendNumber("docsExamined", spec->docsTested);
+            bob->appendNumber("numRanges", spec->numRanges);
+            bob->appendNumber("numWorkers", spec->numWorkers);
         }
     } else if (STAGE_COUNT == stats.stageType) {
         CountStats* spec = static_cast<CountStats*>(stats.specific.get());
@@ -782,6 +782,10 @@ StatusWith<unique_ptr<PlanExecutor, PlanExecutor::Deleter>>
         return getOplogStartHack(opCtx, collection, std::move(canonicalQuery), plannerOptions);
     }
 
+    // Find and aggregate only consume the documents, so an unsorted collection scan may be split
+    // across threads.
+    plannerOptions |= QueryPlannerParams::ALLOW_PARALLEL_COLLSCAN;
+
     if (ShardingState::get(opCtx)->needCollectionMetadata(opCtx, nss.ns())) {
 		//ƬģʽϸñǻͷڱƬݲӦڱƬɾ
         plannerOptions |= QueryPlannerParams::INCLUDE_SHARD_FILTER;
@@ -33,6 +33,7 @@
 #include <utility>
 
 #include "mongo/bson/simple_bsonobj_comparator.h"
+#include "mongo/stdx/memory.h"
 
 namespace mongo {
 
@@ -73,6 +74,18 @@ IndexBoundsChecker::Location intervalCmp(const Interval& interval,
     return IndexBoundsChecker::WITHIN;
 }
 
+/**
+ * Returns true if 'interval' is [MinKey, MaxKey] or [MaxKey, MinKey].
+ */
+bool isAllValues(const Interval& interval) {
+    if (!interval.startInclusive || !interval.endInclusive) {
+        return false;
+    }
+    const BSONType startType = interval.start.type();
+    const BSONType endType = interval.end.type();
+    return (startType == MinKey && endType == MaxKey) || (startType == MaxKey && endType == MinKey);
+}
+
 }  // namespace
 
 // For debugging.
@@ -378,7 +391,10 @@ bool IndexBounds::isValidFor(const BSONObj& keyPattern, int direction) {
 IndexBoundsChecker::IndexBoundsChecker(const IndexBounds* bounds,
                                        const BSONObj& keyPattern,
                                        int scanDirection)
-    : _bounds(bounds), _curInterval(bounds->fields.size(), 0) {
+    : _bounds(bounds),
+      _curInterval(bounds->fields.size(), 0),
+      _ordering(Ordering::make(keyPattern)),
+      _scanDirection(scanDirection) {
     BSONObjIterator it(keyPattern);
     while (it.more()) {
         int indexDirection = it.next().number() >= 0 ? 1 : -1;
@@ -493,6 +509,9 @@ IndexBoundsChecker::KeyState IndexBoundsChecker::checkKey(const BSONObj& key, In
         return VALID;
     }
 
+    // The current intervals may change below, so they have to be encoded again.
+    _intervalsEncoded = false;
+
     // Field number 'firstNonContainedField' of the index key is before its current interval.
     if (BEHIND == orientation) {
         // It's behind our current interval, but our current interval could be wrong.  Start all
@@ -596,6 +615,70 @@ IndexBoundsChecker::KeyState IndexBoundsChecker::checkKey(const BSONObj& key, In
     return VALID;
 }
 
+bool IndexBoundsChecker::isInCurrentIntervals(const KeyString& key) {
+    if (!_intervalsEncoded || (_lowKey && _lowKey->version != key.version)) {
+        encodeCurrentIntervals(key.version);
+    }
+    if (!_lowKey) {
+        return false;
+    }
+
+    // The bounds end with a discriminator, so they never compare equal to a key.
+    return _lowKey->compare(key) < 0 && key.compare(*_highKey) < 0;
+}
+
+void IndexBoundsChecker::encodeCurrentIntervals(KeyString::Version version) {
+    _intervalsEncoded = true;
+    _lowKey.reset();
+    _highKey.reset();
+
+    // The keys within the current intervals are contiguous in the index if every field before
+    // the first non-point interval is a point and every field after it takes all values. These
+    // later fields are left out of the bounds, whose discriminators then place them before or
+    // after every key sharing the encoded prefix.
+    BSONObjBuilder startBob;
+    BSONObjBuilder endBob;
+    bool startInclusive = true;
+    bool endInclusive = true;
+    size_t field = 0;
+    for (; field < _curInterval.size(); ++field) {
+        const Interval& interval = _bounds->fields[field].intervals[_curInterval[field]];
+        startBob.appendAs(interval.start, "");
+        endBob.appendAs(interval.end, "");
+        if (!interval.isPoint()) {
+            startInclusive = interval.startInclusive;
+            endInclusive = interval.endInclusive;
+            ++field;
+            break;
+        }
+    }
+    for (; field < _curInterval.size(); ++field) {
+        if (!isAllValues(_bounds->fields[field].intervals[_curInterval[field]])) {
+            return;
+        }
+    }
+
+    // Start and end are in scan order, so a backward scan starts at the high end of the index.
+    const BSONObj startKey = startBob.obj();
+    const BSONObj endKey = endBob.obj();
+    const bool forward = _scanDirection == 1;
+    const BSONObj& lowKey = forward ? startKey : endKey;
+    const BSONObj& highKey = forward ? endKey : startKey;
+    const bool lowInclusive = forward ? startInclusive : endInclusive;
+    const bool highInclusive = forward ? endInclusive : startInclusive;
+
+    _lowKey = stdx::make_unique<KeyString>(
+        version,
+        lowKey,
+        _ordering,
+        lowInclusive ? KeyString::kExclusiveBefore : KeyString::kExclusiveAfter);
+    _highKey = stdx::make_unique<KeyString>(
+        version,
+        highKey,
+        _ordering,
+        highInclusive ? KeyString::kExclusiveAfter : KeyString::kExclusiveBefore);
+}
+
 namespace {
 
 /**
@@ -28,12 +28,14 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "mongo/db/jsobj.h"
 #include "mongo/db/query/interval.h"
 #include "mongo/db/storage/index_entry_comparison.h"
+#include "mongo/db/storage/key_string.h"
 
 namespace mongo {
 
@@ -222,6 +224,17 @@ public:
      */
     KeyState checkKey(const BSONObj& currentKey, IndexSeekPoint* query);
 
+    /**
+     * Returns true if 'key', the KeyString of an index entry, is within the interval each field
+     * is currently in, in which case checkKey() would return VALID for it without changing any
+     * state. The bounds of the current intervals are encoded once, when they are first needed.
+     *
+     * Returns false if the key is outside of these intervals, or if the keys within them do not
+     * form a single range of the index. The caller must then decode the key and pass it to
+     * checkKey().
+     */
+    bool isInCurrentIntervals(const KeyString& key);
+
     /**
      * Relative position of a key to an interval.
      * Exposed for testing only.
@@ -272,6 +285,13 @@ private:
      */
     bool spaceLeftToAdvance(size_t fieldsToCheck, const std::vector<BSONElement>& keyValues);
 
+    /**
+     * Encodes the lowest and highest KeyStrings, in index order, that bracket the keys within
+     * the current interval of every field, or leaves them unset if those keys are not contiguous
+     * in the index.
+     */
+    void encodeCurrentIntervals(KeyString::Version version);
+
     // The actual bounds.  Must outlive this object.  Not owned by us.
     const IndexBounds* _bounds;
 
@@ -280,6 +300,15 @@ private:
 
     // Direction of scan * direction of indexing.
     std::vector<int> _expectedDirection;
+
+    // Used by isInCurrentIntervals(). The keys within the current intervals are those that
+    // compare between _lowKey and _highKey. Both are unset when no such range exists, and
+    // _intervalsEncoded is cleared whenever _curInterval may change.
+    const Ordering _ordering;
+    const int _scanDirection;
+    bool _intervalsEncoded = false;
+    std::unique_ptr<KeyString> _lowKey;
+    std::unique_ptr<KeyString> _highKey;
 };
 
 }  // namespace mongo
@@ -840,6 +840,130 @@ TEST(IndexBoundsCheckerTest, CheckEndBackwards) {
     ASSERT(seekPoint.prefixExclusive);
 }
 
+//
+// IndexBoundsChecker::isInCurrentIntervals
+//
+
+bool isInCurrentIntervals(IndexBoundsChecker* it, const BSONObj& key, const BSONObj& keyPattern) {
+    KeyString keyString(KeyString::Version::V1, key, Ordering::make(keyPattern), RecordId(1));
+    return it->isInCurrentIntervals(keyString);
+}
+
+TEST(IndexBoundsCheckerTest, IsInCurrentIntervalsPoints) {
+    OrderedIntervalList aList("a");
+    aList.intervals.push_back(Interval(BSON("" << 1 << "" << 1), true, true));
+    aList.intervals.push_back(Interval(BSON("" << 5 << "" << 5), true, true));
+
+    OrderedIntervalList bList("b");
+    bList.intervals.push_back(Interval(BSON("" << 2 << "" << 2), true, true));
+
+    IndexBounds bounds;
+    bounds.fields.push_back(aList);
+    bounds.fields.push_back(bList);
+
+    BSONObj idx = BSON("a" << 1 << "b" << 1);
+    ASSERT(bounds.isValidFor(idx, 1));
+    IndexBoundsChecker it(&bounds, idx, 1);
+
+    ASSERT(isInCurrentIntervals(&it, BSON("" << 1 << "" << 2), idx));
+    ASSERT(isInCurrentIntervals(&it, BSON("" << 1.0 << "" << 2LL), idx));
+    ASSERT_FALSE(isInCurrentIntervals(&it, BSON("" << 1 << "" << 3), idx));
+    ASSERT_FALSE(isInCurrentIntervals(&it, BSON("" << 5 << "" << 2), idx));
+
+    // Moving to the next interval of 'a' changes the encoded bounds.
+    IndexSeekPoint seekPoint;
+    ASSERT_EQUALS(it.checkKey(BSON("" << 5 << "" << 2), &seekPoint), IndexBoundsChecker::VALID);
+    ASSERT(isInCurrentIntervals(&it, BSON("" << 5 << "" << 2), idx));
+    ASSERT_FALSE(isInCurrentIntervals(&it, BSON("" << 1 << "" << 2), idx));
+}
+
+TEST(IndexBoundsCheckerTest, IsInCurrentIntervalsRangeThenAllValues) {
+    OrderedIntervalList aList("a");
+    aList.intervals.push_back(Interval(BSON("" << 1 << "" << 1), true, true));
+
+    OrderedIntervalList bList("b");
+    bList.intervals.push_back(Interval(BSON("" << 3 << "" << 7), false, true));
+
+    OrderedIntervalList cList("c");
+    cList.intervals.push_back(Interval(BSON("" << MINKEY << "" << MAXKEY), true, true));
+
+    IndexBounds bounds;
+    bounds.fields.push_back(aList);
+    bounds.fields.push_back(bList);
+    bounds.fields.push_back(cList);
+
+    BSONObj idx = BSON("a" << 1 << "b" << 1 << "c" << 1);
+    ASSERT(bounds.isValidFor(idx, 1));
+    IndexBoundsChecker it(&bounds, idx, 1);
+
+    // The start of 'b' is excluded whatever the value of 'c'.
+    ASSERT_FALSE(isInCurrentIntervals(&it, BSON("" << 1 << "" << 3 << "" << 100), idx));
+    ASSERT(isInCurrentIntervals(&it, BSON("" << 1 << "" << 3.5 << "" << MINKEY), idx));
+    ASSERT(isInCurrentIntervals(&it, BSON("" << 1 << "" << 7 << "" << MAXKEY), idx));
+    ASSERT(isInCurrentIntervals(&it, BSON("" << 1 << "" << 7 << "" << "x"), idx));
+    ASSERT_FALSE(isInCurrentIntervals(&it, BSON("" << 1 << "" << 7.5 << "" << 0), idx));
+    ASSERT_FALSE(isInCurrentIntervals(&it, BSON("" << 2 << "" << 5 << "" << 0), idx));
+}
+
+TEST(IndexBoundsCheckerTest, IsInCurrentIntervalsNotContiguous) {
+    OrderedIntervalList aList("a");
+    aList.intervals.push_back(Interval(BSON("" << 0 << "" << 10), true, true));
+
+    OrderedIntervalList bList("b");
+    bList.intervals.push_back(Interval(BSON("" << 2 << "" << 2), true, true));
+
+    IndexBounds bounds;
+    bounds.fields.push_back(aList);
+    bounds.fields.push_back(bList);
+
+    BSONObj idx = BSON("a" << 1 << "b" << 1);
+    ASSERT(bounds.isValidFor(idx, 1));
+    IndexBoundsChecker it(&bounds, idx, 1);
+
+    // Keys between {5, 2} and {6, 2} are outside of the bounds, so the checker has to decide.
+    ASSERT_FALSE(isInCurrentIntervals(&it, BSON("" << 5 << "" << 2), idx));
+    IndexSeekPoint seekPoint;
+    ASSERT_EQUALS(it.checkKey(BSON("" << 5 << "" << 2), &seekPoint), IndexBoundsChecker::VALID);
+}
+
+TEST(IndexBoundsCheckerTest, IsInCurrentIntervalsBackwards) {
+    OrderedIntervalList aList("a");
+    aList.intervals.push_back(Interval(BSON("" << 20 << "" << 7), true, false));
+
+    OrderedIntervalList bList("b");
+    bList.intervals.push_back(Interval(BSON("" << MAXKEY << "" << MINKEY), true, true));
+
+    IndexBounds bounds;
+    bounds.fields.push_back(aList);
+    bounds.fields.push_back(bList);
+
+    BSONObj idx = BSON("a" << 1 << "b" << 1);
+    ASSERT(bounds.isValidFor(idx, -1));
+    IndexBoundsChecker it(&bounds, idx, -1);
+
+    ASSERT_FALSE(isInCurrentIntervals(&it, BSON("" << 21 << "" << 0), idx));
+    ASSERT(isInCurrentIntervals(&it, BSON("" << 20 << "" << MAXKEY), idx));
+    ASSERT(isInCurrentIntervals(&it, BSON("" << 8 << "" << 0), idx));
+    ASSERT_FALSE(isInCurrentIntervals(&it, BSON("" << 7 << "" << MAXKEY), idx));
+}
+
+TEST(IndexBoundsCheckerTest, IsInCurrentIntervalsDescendingIndex) {
+    OrderedIntervalList aList("a");
+    aList.intervals.push_back(Interval(BSON("" << 20 << "" << 7), false, true));
+
+    IndexBounds bounds;
+    bounds.fields.push_back(aList);
+
+    BSONObj idx = BSON("a" << -1);
+    ASSERT(bounds.isValidFor(idx, 1));
+    IndexBoundsChecker it(&bounds, idx, 1);
+
+    ASSERT_FALSE(isInCurrentIntervals(&it, BSON("" << 20), idx));
+    ASSERT(isInCurrentIntervals(&it, BSON("" << 19), idx));
+    ASSERT(isInCurrentIntervals(&it, BSON("" << 7), idx));
+    ASSERT_FALSE(isInCurrentIntervals(&it, BSON("" << 6), idx));
+}
+
 //
 // IndexBoundsChecker::findIntervalForField
 //
@@ -37,8 +37,10 @@
 #include <memory>
 #include <vector>
 
+#include "mongo/base/counter.h"
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/client/dbclientinterface.h"  // For QueryOption_foobar
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/matcher/expression_array.h"
 #include "mongo/db/matcher/expression_geo.h"
 #include "mongo/db/query/collation/collator_interface.h"
@@ -53,6 +55,21 @@
 namespace mongo {
 namespace {
 
+// Server-wide plan cache counters, aggregated over the plan caches of all collections.
+Counter64 planCacheHitsCounter;
+Counter64 planCacheMissesCounter;
+Counter64 planCacheReplansCounter;
+Counter64 planCacheEvictionsCounter;
+
+ServerStatusMetricField<Counter64> displayPlanCacheHits("query.planCache.hits",
+                                                        &planCacheHitsCounter);
+ServerStatusMetricField<Counter64> displayPlanCacheMisses("query.planCache.misses",
+                                                          &planCacheMissesCounter);
+ServerStatusMetricField<Counter64> displayPlanCacheReplans("query.planCache.replans",
+                                                           &planCacheReplansCounter);
+ServerStatusMetricField<Counter64> displayPlanCacheEvictions("query.planCache.evictions",
+                                                             &planCacheEvictionsCounter);
+
 // Delimiters for cache key encoding.
 const char kEncodeDiscriminatorsBegin = '<';
 const char kEncodeDiscriminatorsEnd = '>';
@@ -436,6 +453,8 @@ PlanCacheEntry* PlanCacheEntry::clone() const {
     entry->timeOfCreation = timeOfCreation;
 
     // Copy performance stats.
+    entry->hits = hits;
+    entry->replans = replans;
     for (size_t i = 0; i < feedback.size(); ++i) {
         PlanCacheEntryFeedback* fb = new PlanCacheEntryFeedback();
         fb->stats.reset(feedback[i]->stats->clone());
@@ -560,9 +579,20 @@ std::string SolutionCacheData::toString() const {
 // PlanCache
 //
 
-PlanCache::PlanCache() : _cache(internalQueryCacheSize.load()) {}
+PlanCache::PlanCache() : PlanCache("") {}
+
+PlanCache::PlanCache(const std::string& ns) : _ns(ns) {
+    const size_t numPartitions = std::max(1, internalQueryCachePartitions.load());
+    const size_t cacheSize = std::max(1, internalQueryCacheSize.load());
 
-PlanCache::PlanCache(const std::string& ns) : _cache(internalQueryCacheSize.load()), _ns(ns) {}
+    // Round up so that the partitions together hold at least 'internalQueryCacheSize' entries.
+    const size_t partitionSize = (cacheSize + numPartitions - 1) / numPartitions;
+
+    _partitions.reserve(numPartitions);
+    for (size_t i = 0; i < numPartitions; ++i) {
+        _partitions.push_back(stdx::make_unique<Partition>(partitionSize));
+    }
+}
 
 PlanCache::~PlanCache() {}
 
@@ -745,10 +775,23 @@ Status PlanCache::add(const CanonicalQuery& query,
     }
     entry->projection = projBuilder.obj();
 
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    std::unique_ptr<PlanCacheEntry> evictedEntry = _cache.add(computeKey(query), entry);
+    PlanCacheKey key = computeKey(query);
+    Partition& partition = _partitionFor(key);
+
+    stdx::lock_guard<stdx::mutex> cacheLock(partition.mutex);
+
+    // If this shape is being re-added (for instance after a replan), keep its history.
+    PlanCacheEntry* oldEntry;
+    if (partition.cache.get(key, &oldEntry).isOK()) {
+        entry->hits = oldEntry->hits;
+        entry->replans = oldEntry->replans;
+    }
+
+    std::unique_ptr<PlanCacheEntry> evictedEntry = partition.cache.add(key, entry);
 
     if (NULL != evictedEntry.get()) {
+        partition.stats.evictions++;
+        planCacheEvictionsCounter.increment();
         LOG(1) << _ns << ": plan cache maximum size exceeded - "
                << "removed least recently used entry " << redact(evictedEntry->toString());
     }
@@ -764,15 +807,22 @@ Status PlanCache::get(const CanonicalQuery& query, CachedSolution** crOut) const
     PlanCacheKey key = computeKey(query);
     verify(crOut);
 
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
+    Partition& partition = _partitionFor(key);
+    stdx::lock_guard<stdx::mutex> cacheLock(partition.mutex);
     PlanCacheEntry* entry;
 	//_cacheӸkeyȡPlanCacheEntry
-    Status cacheStatus = _cache.get(key, &entry);
+    Status cacheStatus = partition.cache.get(key, &entry);
     if (!cacheStatus.isOK()) {
+        partition.stats.misses++;
+        planCacheMissesCounter.increment();
         return cacheStatus;
     }
     invariant(entry);
 
+    entry->hits++;
+    partition.stats.hits++;
+    planCacheHitsCounter.increment();
+
     *crOut = new CachedSolution(key, *entry);
 
     return Status::OK();
@@ -878,10 +928,11 @@ Status PlanCache::feedback(const CanonicalQuery& cq, PlanCacheEntryFeedback* fee
     }
     std::unique_ptr<PlanCacheEntryFeedback> autoFeedback(feedback);
     PlanCacheKey ck = computeKey(cq);
+    Partition& partition = _partitionFor(ck);
 
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
+    stdx::lock_guard<stdx::mutex> cacheLock(partition.mutex);
     PlanCacheEntry* entry;
-    Status cacheStatus = _cache.get(ck, &entry);
+    Status cacheStatus = partition.cache.get(ck, &entry);
     if (!cacheStatus.isOK()) {
         return cacheStatus;
     }
@@ -896,13 +947,48 @@ Status PlanCache::feedback(const CanonicalQuery& cq, PlanCacheEntryFeedback* fee
 }
 
 Status PlanCache::remove(const CanonicalQuery& canonicalQuery) {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    return _cache.remove(computeKey(canonicalQuery));
+    PlanCacheKey key = computeKey(canonicalQuery);
+    Partition& partition = _partitionFor(key);
+    stdx::lock_guard<stdx::mutex> cacheLock(partition.mutex);
+    return partition.cache.remove(key);
 }
 
 void PlanCache::clear() {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    _cache.clear();
+    for (auto&& partition : _partitions) {
+        stdx::lock_guard<stdx::mutex> cacheLock(partition->mutex);
+        partition->cache.clear();
+    }
+}
+
+void PlanCache::notifyOfReplan(const CanonicalQuery& cq) {
+    PlanCacheKey key = computeKey(cq);
+    Partition& partition = _partitionFor(key);
+
+    stdx::lock_guard<stdx::mutex> cacheLock(partition.mutex);
+    partition.stats.replans++;
+    planCacheReplansCounter.increment();
+
+    // Attributing the replan to the shape is best-effort: the entry may already be gone.
+    PlanCacheEntry* entry;
+    if (partition.cache.get(key, &entry).isOK()) {
+        entry->replans++;
+    }
+}
+
+PlanCache::Stats PlanCache::getStats() const {
+    Stats total;
+    for (auto&& partition : _partitions) {
+        stdx::lock_guard<stdx::mutex> cacheLock(partition->mutex);
+        total.hits += partition->stats.hits;
+        total.misses += partition->stats.misses;
+        total.replans += partition->stats.replans;
+        total.evictions += partition->stats.evictions;
+    }
+    return total;
+}
+
+PlanCache::Partition& PlanCache::_partitionFor(const PlanCacheKey& key) const {
+    return *_partitions[std::hash<PlanCacheKey>()(key) % _partitions.size()];
 }
 
 //computeKey(cq)ΪgetPlansByQueryеĲѯdb.xx.getPlanCache().getPlansByQuery({"query" : {"create_time" : { "$gte" : "2020-12-27 00:00:00","$lte" : "2021-01-26 23:59:59"}},"sort" : { },"projection" : {}})
@@ -919,9 +1005,10 @@ Status PlanCache::getEntry(const CanonicalQuery& query, PlanCacheEntry** entryOu
     PlanCacheKey key = computeKey(query);
     verify(entryOut);
 
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
+    Partition& partition = _partitionFor(key);
+    stdx::lock_guard<stdx::mutex> cacheLock(partition.mutex);
     PlanCacheEntry* entry;
-    Status cacheStatus = _cache.get(key, &entry);
+    Status cacheStatus = partition.cache.get(key, &entry);
     if (!cacheStatus.isOK()) {
         return cacheStatus;
     }
@@ -934,12 +1021,14 @@ Status PlanCache::getEntry(const CanonicalQuery& query, PlanCacheEntry** entryOu
 
 //ȡеPlanCacheEntryϢ
 std::vector<PlanCacheEntry*> PlanCache::getAllEntries() const {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
     std::vector<PlanCacheEntry*> entries;
     typedef std::list<std::pair<PlanCacheKey, PlanCacheEntry*>>::const_iterator ConstIterator;
-    for (ConstIterator i = _cache.begin(); i != _cache.end(); i++) {
-        PlanCacheEntry* entry = i->second;
-        entries.push_back(entry->clone());
+    for (auto&& partition : _partitions) {
+        stdx::lock_guard<stdx::mutex> cacheLock(partition->mutex);
+        for (ConstIterator i = partition->cache.begin(); i != partition->cache.end(); i++) {
+            PlanCacheEntry* entry = i->second;
+            entries.push_back(entry->clone());
+        }
     }
 
     return entries;
@@ -948,13 +1037,19 @@ std::vector<PlanCacheEntry*> PlanCache::getAllEntries() const {
 //computeKey(cq)ΪgetPlansByQueryеĲѯdb.xx.getPlanCache().getPlansByQuery({"query" : {"create_time" : { "$gte" : "2020-12-27 00:00:00","$lte" : "2021-01-26 23:59:59"}},"sort" : { },"projection" : {}})
 //鿴planǷcqPlanCacheListPlans::listе
 bool PlanCache::contains(const CanonicalQuery& cq) const {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    return _cache.hasKey(computeKey(cq));
+    PlanCacheKey key = computeKey(cq);
+    Partition& partition = _partitionFor(key);
+    stdx::lock_guard<stdx::mutex> cacheLock(partition.mutex);
+    return partition.cache.hasKey(key);
 }
 
 size_t PlanCache::size() const {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    return _cache.size();
+    size_t total = 0;
+    for (auto&& partition : _partitions) {
+        stdx::lock_guard<stdx::mutex> cacheLock(partition->mutex);
+        total += partition->cache.size();
+    }
+    return total;
 }
 
 //CollectionInfoCacheImpl::updatePlanCacheIndexEntriesеã
@@ -29,7 +29,9 @@
 #pragma once
 
 #include <boost/optional/optional.hpp>
+#include <memory>
 #include <set>
+#include <vector>
 
 #include "mongo/db/exec/plan_stats.h"
 #include "mongo/db/query/canonical_query.h"
@@ -518,6 +520,14 @@ public:
     //PlanCacheListPlans::listͨPlanCacheListPlans
     //ԴCachedPlanStage::updatePlanCache()
     std::vector<PlanCacheEntryFeedback*> feedback;
+
+    // Number of times the planner retrieved this entry, and number of times a plan for this
+    // shape was evicted by the CachedPlanStage and replanned. Both carry over when add() replaces
+    // the entry with a new one for the same shape, but are lost with the entry when it is removed
+    // or evicted, as happens when a replan finds a single solution, which is not cached. Only the
+    // cache-wide Stats keep those counts. Protected by the owning partition's mutex.
+    uint64_t hits = 0;
+    uint64_t replans = 0;
 };
 
 /**
@@ -701,6 +711,35 @@ public:
      */
     size_t size() const;
 
+    /**
+     * Records that a cached plan for 'cq' performed poorly and the query was replanned.  The
+     * count is attributed to the cache entry for the shape, if one still exists, and to the
+     * cache-wide counters.
+     */
+    void notifyOfReplan(const CanonicalQuery& cq);
+
+    /**
+     * Cache-wide counters for this collection's plan cache.
+     */
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t replans = 0;
+        uint64_t evictions = 0;
+    };
+
+    /**
+     * Returns a snapshot of the cache-wide counters, summed over all partitions.
+     */
+    Stats getStats() const;
+
+    /**
+     * Returns the number of independently locked partitions the cache is split into.
+     */
+    size_t numPartitions() const {
+        return _partitions.size();
+    }
+
     /**
      * Updates internal state kept about the collection's indexes.  Must be called when the set
      * of indexes on the associated collection have changed.
@@ -713,14 +752,29 @@ private:
     void encodeKeyForMatch(const MatchExpression* tree, StringBuilder* keyBuilder) const;
     void encodeKeyForSort(const BSONObj& sortObj, StringBuilder* keyBuilder) const;
     void encodeKeyForProj(const BSONObj& projObj, StringBuilder* keyBuilder) const;
-    
+
+    /**
+     * An independently locked slice of the cache. Entries are assigned to a partition by the
+     * hash of their PlanCacheKey, so that lookups of different query shapes on a hot collection
+     * do not serialize on a single mutex. Each partition maintains its own LRU order.
+     */
+    struct Partition {
+        explicit Partition(size_t maxSize) : cache(maxSize) {}
+
+        // Protects 'cache' and 'stats'.
+        mutable stdx::mutex mutex;
+        LRUKeyValue<PlanCacheKey, PlanCacheEntry> cache;
+        mutable Stats stats;
+    };
+
+    Partition& _partitionFor(const PlanCacheKey& key) const;
+
     //PlanCacheEntryPlanCacheKey浽֧LRU
     //ĳPlanCacheEntry, οPlanCache::get  PlanCache::getAllEntries()
     ////MultiPlanStage::pickBestPlanаѵ÷ָߵĺѡӵplancache
-    LRUKeyValue<PlanCacheKey, PlanCacheEntry> _cache;
-
-    // Protects _cache.
-    mutable stdx::mutex _cacheMutex;
+    //
+    // The LRUKeyValue for each shape lives in the partition selected by _partitionFor().
+    std::vector<std::unique_ptr<Partition>> _partitions;
 
     // Full namespace of collection.
     std::string _ns;
@@ -449,6 +449,103 @@ TEST(PlanCacheTest, AddValidSolution) {
     ASSERT_EQUALS(planCache.size(), 1U);
 }
 
+TEST(PlanCacheTest, StatsCountHitsMissesAndReplans) {
+    PlanCache planCache;
+    unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+    QuerySolution qs;
+    qs.cacheData.reset(new SolutionCacheData());
+    qs.cacheData->tree.reset(new PlanCacheIndexTree());
+    std::vector<QuerySolution*> solns;
+    solns.push_back(&qs);
+    QueryTestServiceContext serviceContext;
+
+    CachedSolution* rawCS;
+    ASSERT_NOT_OK(planCache.get(*cq, &rawCS));
+    ASSERT_OK(planCache.add(*cq, solns, createDecision(1U), Date_t{}));
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_OK(planCache.get(*cq, &rawCS));
+        delete rawCS;
+    }
+    planCache.notifyOfReplan(*cq);
+
+    PlanCache::Stats stats = planCache.getStats();
+    ASSERT_EQUALS(stats.hits, 3U);
+    ASSERT_EQUALS(stats.misses, 1U);
+    ASSERT_EQUALS(stats.replans, 1U);
+    ASSERT_EQUALS(stats.evictions, 0U);
+
+    // Re-adding the same shape, as happens after a replan, keeps the per-shape counters.
+    ASSERT_OK(planCache.add(*cq, solns, createDecision(1U), Date_t{}));
+    PlanCacheEntry* rawEntry;
+    ASSERT_OK(planCache.getEntry(*cq, &rawEntry));
+    unique_ptr<PlanCacheEntry> entry(rawEntry);
+    ASSERT_EQUALS(entry->hits, 3U);
+    ASSERT_EQUALS(entry->replans, 1U);
+}
+
+TEST(PlanCacheTest, RemovingEntryDropsPerShapeCountersButKeepsCacheWideStats) {
+    PlanCache planCache;
+    unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+    QuerySolution qs;
+    qs.cacheData.reset(new SolutionCacheData());
+    qs.cacheData->tree.reset(new PlanCacheIndexTree());
+    std::vector<QuerySolution*> solns;
+    solns.push_back(&qs);
+    QueryTestServiceContext serviceContext;
+
+    ASSERT_OK(planCache.add(*cq, solns, createDecision(1U), Date_t{}));
+    CachedSolution* rawCS;
+    ASSERT_OK(planCache.get(*cq, &rawCS));
+    delete rawCS;
+
+    // A replan which finds a single solution records the replan, then removes the entry.
+    planCache.notifyOfReplan(*cq);
+    ASSERT_OK(planCache.remove(*cq));
+
+    PlanCache::Stats stats = planCache.getStats();
+    ASSERT_EQUALS(stats.hits, 1U);
+    ASSERT_EQUALS(stats.replans, 1U);
+
+    ASSERT_OK(planCache.add(*cq, solns, createDecision(1U), Date_t{}));
+    PlanCacheEntry* rawEntry;
+    ASSERT_OK(planCache.getEntry(*cq, &rawEntry));
+    unique_ptr<PlanCacheEntry> entry(rawEntry);
+    ASSERT_EQUALS(entry->hits, 0U);
+    ASSERT_EQUALS(entry->replans, 0U);
+}
+
+TEST(PlanCacheTest, PartitionedCacheEvictsWithinPartition) {
+    const int oldCacheSize = internalQueryCacheSize.load();
+    const int oldPartitions = internalQueryCachePartitions.load();
+    ON_BLOCK_EXIT([&] {
+        internalQueryCacheSize.store(oldCacheSize);
+        internalQueryCachePartitions.store(oldPartitions);
+    });
+    internalQueryCacheSize.store(4);
+    internalQueryCachePartitions.store(2);
+
+    PlanCache planCache;
+    ASSERT_EQUALS(planCache.numPartitions(), 2U);
+
+    QuerySolution qs;
+    qs.cacheData.reset(new SolutionCacheData());
+    qs.cacheData->tree.reset(new PlanCacheIndexTree());
+    std::vector<QuerySolution*> solns;
+    solns.push_back(&qs);
+    QueryTestServiceContext serviceContext;
+
+    const std::vector<std::string> queries = {
+        "{a: 1}", "{b: 1}", "{c: 1}", "{d: 1}", "{e: 1}", "{f: 1}", "{g: 1}", "{h: 1}"};
+    for (auto&& query : queries) {
+        unique_ptr<CanonicalQuery> cq(canonicalize(query.c_str()));
+        ASSERT_OK(planCache.add(*cq, solns, createDecision(1U), Date_t{}));
+    }
+
+    // Each partition holds at most two entries; everything else was evicted.
+    ASSERT_LTE(planCache.size(), 4U);
+    ASSERT_EQUALS(planCache.getStats().evictions, queries.size() - planCache.size());
+}
+
 /**
  * Each test in the CachePlanSelectionTest suite goes through
  * the following flow:
@@ -415,6 +415,16 @@ void PlanExecutor::reattachToOperationContext(OperationContext* opCtx) {
 void PlanExecutor::invalidate(OperationContext* opCtx, const RecordId& dl, InvalidationType type) {
     if (!isMarkedAsKilled()) {
         _root->invalidate(opCtx, dl, type);
+
+        // Batched results already own their documents; just forget the RecordId of a deleted one.
+        if (INVALIDATION_DELETION == type) {
+            for (size_t i = _batchedResultsPos; i < _batchedResults.size(); ++i) {
+                WorkingSetMember* member = _workingSet->get(_batchedResults[i]);
+                if (member->hasRecordId() && member->recordId == dl && member->hasOwnedObj()) {
+                    _workingSet->transitionToOwnedObj(_batchedResults[i]);
+                }
+            }
+        }
     }
 }
 
@@ -604,29 +614,50 @@ PlanExecutor::ExecState PlanExecutor::getNextImpl(Snapshotted<BSONObj>* objOut,
     }
 
 	//ȡµĽ
+    const int batchedWorkSize = internalQueryExecBatchedWorkSize.load();
+    const bool useBatchedWork = batchedWorkSize > 0 && _root->supportsBatchedWork();
+
     for (;;) {
-        // These are the conditions which can cause us to yield:
-        //   1) The yield policy's timer elapsed, or
-        //   2) some stage requested a yield due to a document fetch, or
-        //   3) we need to yield and retry due to a WriteConflictException.
-        // In all cases, the actual yielding happens here.
-        //жǷҪóCPUkill  óCPU
-        if (_yieldPolicy->shouldYield()) {
-            auto yieldStatus = _yieldPolicy->yield(fetcher.get());
-            if (!yieldStatus.isOK()) {
-                return swallowTimeoutIfAwaitData(yieldStatus, objOut);
-            }
-        }
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        PlanStage::StageState code;
 
-        // We're done using the fetcher, so it should be freed. We don't want to
-        // use the same RecordFetcher twice.
-        fetcher.reset();
+        // Hand out results left over from the previous batch before working the plan again.
+        // Nothing yields while results are outstanding.
+        if (_batchedResultsPos < _batchedResults.size()) {
+            id = _batchedResults[_batchedResultsPos++];
+            code = PlanStage::ADVANCED;
+        } else {
+            // These are the conditions which can cause us to yield:
+            //   1) The yield policy's timer elapsed, or
+            //   2) some stage requested a yield due to a document fetch, or
+            //   3) we need to yield and retry due to a WriteConflictException.
+            // In all cases, the actual yielding happens here.
+            //жǷҪóCPUkill  óCPU
+            if (_yieldPolicy->shouldYield()) {
+                auto yieldStatus = _yieldPolicy->yield(fetcher.get());
+                if (!yieldStatus.isOK()) {
+                    return swallowTimeoutIfAwaitData(yieldStatus, objOut);
+                }
+            }
 
-        WorkingSetID id = WorkingSet::INVALID_ID;
-		//PlanStage::work
-		//жһִMultiPlanStage::doWork
-		//ֻһһFetchStage::doWork
-        PlanStage::StageState code = _root->work(&id); //PlanStage::work  ִвѯƻ
+            // We're done using the fetcher, so it should be freed. We don't want to
+            // use the same RecordFetcher twice.
+            fetcher.reset();
+
+            //PlanStage::work
+            //жһִMultiPlanStage::doWork
+            //ֻһһFetchStage::doWork
+            if (useBatchedWork) {
+                _batchedResults.clear();
+                _batchedResultsPos = 0;
+                code = _root->workBatch(batchedWorkSize, &_batchedResults, &id);
+                if (PlanStage::ADVANCED == code) {
+                    id = _batchedResults[_batchedResultsPos++];
+                }
+            } else {
+                code = _root->work(&id); //PlanStage::work  ִвѯƻ
+            }
+        }
 
         if (code != PlanStage::NEED_YIELD)
             writeConflictsInARow = 0;
@@ -716,7 +747,8 @@ PlanExecutor::ExecState PlanExecutor::getNextImpl(Snapshotted<BSONObj>* objOut,
 
 bool PlanExecutor::isEOF() {
     invariant(_currentState == kUsable);
-    return isMarkedAsKilled() || (_stash.empty() && _root->isEOF());
+    return isMarkedAsKilled() ||
+        (_stash.empty() && _batchedResultsPos == _batchedResults.size() && _root->isEOF());
 }
 
 void PlanExecutor::markAsKilled(string reason) {
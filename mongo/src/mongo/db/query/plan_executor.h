@@ -30,9 +30,11 @@
 
 #include <boost/optional.hpp>
 #include <queue>
+#include <vector>
 
 #include "mongo/base/status.h"
 #include "mongo/db/catalog/util/partitioned.h"
+#include "mongo/db/exec/working_set.h"
 #include "mongo/db/invalidation_type.h"
 #include "mongo/db/query/query_solution.h"
 #include "mongo/db/storage/snapshot.h"
@@ -583,6 +585,12 @@ private:
     // stages.
     std::queue<BSONObj> _stash;
 
+    // Results produced by the last call to PlanStage::workBatch() on '_root' that have not been
+    // handed out yet, starting at '_batchedResultsPos'. Drained before the plan is worked again,
+    // and in particular before any yield.
+    std::vector<WorkingSetID> _batchedResults;
+    size_t _batchedResultsPos = 0;
+
     //planִ״̬Ϣ
     enum { kUsable, kSaved, kDetached, kDisposed } _currentState = kUsable;
 
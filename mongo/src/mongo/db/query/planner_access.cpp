@@ -169,13 +169,21 @@ std::unique_ptr<QuerySolutionNode> QueryPlannerAccess::makeCollectionScan(
     // The sort can specify $natural as well. The sort direction should override the hint
     // direction if both are specified.
     const BSONObj& sortObj = query.getQueryRequest().getSort();
+    bool naturalOrder = false;
     if (!sortObj.isEmpty()) {
         BSONElement natural = dps::extractElementAtPath(sortObj, "$natural");
         if (!natural.eoo()) {
             csn->direction = natural.numberInt() >= 0 ? 1 : -1;
+            naturalOrder = true;
         }
     }
 
+    // A parallel scan returns documents in no particular order and without their RecordIds.
+    const QueryRequest& qr = query.getQueryRequest();
+    csn->allowParallel = (params.options & QueryPlannerParams::ALLOW_PARALLEL_COLLSCAN) &&
+        !tailable && !naturalOrder && !csn->maxScan && !csn->shouldTrackLatestOplogTimestamp &&
+        qr.getHint().isEmpty() && !qr.isSnapshot() && !qr.showRecordId() && !qr.isOplogReplay();
+
     return std::move(csn);
 }
 
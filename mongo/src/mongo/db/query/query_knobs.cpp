@@ -41,6 +41,8 @@ MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanEvaluationMaxResults, int, 101);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheSize, int, 5000);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryCachePartitions, int, 16);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheFeedbacksStored, int, 20);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheEvictionRatio, double, 10.0);
@@ -67,6 +69,14 @@ MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecMaxBlockingSortBytes, int, 32 * 1
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecYieldIterations, int, 128);
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecYieldPeriodMS, int, 10);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecBatchedWorkSize, int, 0);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryParallelCollectionScanMaxWorkers, int, 1);
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryParallelCollectionScanMinDocsPerWorker, int, 10000);
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(internalQueryParallelCollectionScanMaxThreads, int, 16);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryCollectionScanProjectionPushdown, bool, true);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryFacetBufferSizeBytes, int, 100 * 1024 * 1024);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalInsertMaxBatchSize,
@@ -77,6 +87,16 @@ MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceCursorBatchSizeBytes, int, 4
 
 MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceLookupCacheSizeBytes, int, 100 * 1024 * 1024);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceLookupEnableHashJoin, bool, false);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceLookupHashJoinMaxMemoryBytes,
+                              int,
+                              100 * 1024 * 1024);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceSortMaxParallelSpills, int, 0);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceGroupPartitions, int, 16);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerGenerateCoveredWholeIndexScans, bool, false);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryIgnoreUnknownJSONSchemaKeywords, bool, false);
@@ -65,6 +65,10 @@ extern AtomicBool internalQueryPlannerEnableHashIntersection;
 // How many entries in the cache?
 extern AtomicInt32 internalQueryCacheSize;
 
+// How many independently locked partitions is each collection's plan cache split into? Read when
+// the cache is created. The 'internalQueryCacheSize' budget is divided evenly among them.
+extern AtomicInt32 internalQueryCachePartitions;
+
 // How many feedback entries do we collect before possibly evicting from the cache based on bad
 // performance?
 extern AtomicInt32 internalQueryCacheFeedbacksStored;
@@ -117,6 +121,25 @@ extern AtomicInt32 internalQueryExecYieldIterations;
 //Ϸӳǵǰ̻߳ȡݵΪ˶Ҫ yield
 extern AtomicInt32 internalQueryExecYieldPeriodMS;
 
+// If positive, plans whose stages all support batched execution are driven by PlanExecutor
+// through PlanStage::workBatch(), performing up to this many units of work per call. Zero keeps
+// every plan on the one-result-per-work() path.
+extern AtomicInt32 internalQueryExecBatchedWorkSize;
+
+// Unsorted collection scans for find and aggregate may be split across up to this many worker
+// threads. One disables parallel scans. Each worker gets at least
+// internalQueryParallelCollectionScanMinDocsPerWorker documents, so small collections are still
+// scanned by a single thread.
+extern AtomicInt32 internalQueryParallelCollectionScanMaxWorkers;
+extern AtomicInt32 internalQueryParallelCollectionScanMinDocsPerWorker;
+
+// The workers of all parallel collection scans share a pool of at most this many threads.
+extern int internalQueryParallelCollectionScanMaxThreads;
+
+// Lets a simple inclusion projection directly over a collection scan be applied by the scan
+// itself, which then extracts only the projected fields from each record.
+extern AtomicBool internalQueryCollectionScanProjectionPushdown;
+
 // Limit the size that we write without yielding to 16MB / 64 (max expected number of indexes)
 const int64_t insertVectorMaxBytes = 256 * 1024;
 
@@ -129,5 +152,22 @@ extern AtomicInt32 internalDocumentSourceCursorBatchSizeBytes;
 
 extern AtomicInt32 internalDocumentSourceLookupCacheSizeBytes;
 
+// Allows $lookup stages with localField/foreignField syntax to read the foreign collection once
+// into a hash table rather than querying it for every input document.
+extern AtomicBool internalDocumentSourceLookupEnableHashJoin;
+
+// Memory limit for a $lookup hash table. A larger foreign side spills to disk if the pipeline
+// allows it, and otherwise falls back to querying per input document.
+extern AtomicInt32 internalDocumentSourceLookupHashJoinMaxMemoryBytes;
+
+// Number of sorted runs a spilling $sort may write in the background while it keeps consuming
+// input. Each of these spills holds up to the stage's memory limit on top of the run being filled.
+extern AtomicInt32 internalDocumentSourceSortMaxParallelSpills;
+
+// Number of hash partitions an unsorted $group divides its groups into. When the memory limit is
+// reached only the largest partitions are spilled. With one partition every group is spilled and
+// a spilled $group returns its results in _id order.
+extern AtomicInt32 internalDocumentSourceGroupPartitions;
+
 extern AtomicBool internalQueryProhibitBlockingMergeOnMongoS;
 }  // namespace mongo
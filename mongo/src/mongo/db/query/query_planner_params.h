@@ -111,6 +111,11 @@ struct QueryPlannerParams {
 
         // Set this to track the most recent timestamp seen by this cursor while scanning the oplog.
         TRACK_LATEST_OPLOG_TS = 1 << 12,
+
+        // Set this if the caller neither needs RecordIds nor relies on the order of the results
+        // of an unsorted collection scan, so that a large collection may be scanned by several
+        // threads. See internalQueryParallelCollectionScanMaxWorkers.
+        ALLOW_PARALLEL_COLLSCAN = 1 << 13,
     };
 
     // See Options enum above.
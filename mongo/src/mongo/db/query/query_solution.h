@@ -335,6 +335,9 @@ struct CollectionScanNode : public QuerySolutionNode {
     // maxScan option to .find() limits how many docs we look at.
     //db.collection.find( { $query: { <query> }, $maxScan: <number> } )
     int maxScan;
+    // May this scan be split across threads? Set when the results need neither RecordIds nor
+    // the collection's natural order.
+    bool allowParallel = false;
 };
 
 
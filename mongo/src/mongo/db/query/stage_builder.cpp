@@ -49,6 +49,7 @@
 #include "mongo/db/exec/limit.h"
 #include "mongo/db/exec/merge_sort.h"
 #include "mongo/db/exec/or.h"
+#include "mongo/db/exec/parallel_collection_scan.h"
 #include "mongo/db/exec/projection.h"
 #include "mongo/db/exec/shard_filter.h"
 #include "mongo/db/exec/skip.h"
@@ -57,6 +58,7 @@
 #include "mongo/db/exec/text.h"
 #include "mongo/db/index/fts_access_method.h"
 #include "mongo/db/matcher/extensions_callback_real.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/log.h"
@@ -65,6 +67,156 @@ namespace mongo {
 
 using std::unique_ptr;
 using stdx::make_unique;
+
+namespace {
+
+/**
+ * Returns how many worker threads may scan the collection for 'csn', or zero if it should be
+ * scanned by a plain CollectionScan.
+ */
+size_t parallelCollectionScanWorkers(OperationContext* opCtx,
+                                     const Collection* collection,
+                                     const CollectionScanNode* csn) {
+    const int maxWorkers = internalQueryParallelCollectionScanMaxWorkers.load();
+    const long long minDocsPerWorker =
+        std::max(1, internalQueryParallelCollectionScanMinDocsPerWorker.load());
+    if (!csn->allowParallel || maxWorkers < 2 || !collection || collection->isCapped()) {
+        return 0;
+    }
+
+    // Workers read from their own snapshots, which cannot be tied to the majority commit point.
+    if (opCtx->recoveryUnit()->isReadingFromMajorityCommittedSnapshot()) {
+        return 0;
+    }
+
+    // Workers take IS locks under their own operation contexts while this operation waits for
+    // their results by yielding. A yield releases nothing inside a write unit of work or while the
+    // global lock is held recursively, and an X lock held here is never released to the workers,
+    // so either way the scan would wait on itself.
+    Locker* locker = opCtx->lockState();
+    if (locker->inAWriteUnitOfWork() || locker->isGlobalLockedRecursively()) {
+        return 0;
+    }
+    Locker::LockerInfo lockerInfo;
+    locker->getLockerInfo(&lockerInfo);
+    for (const auto& lock : lockerInfo.locks) {
+        if (lock.mode == MODE_X) {
+            return 0;
+        }
+    }
+
+    if (!ParallelCollectionScan::canRunInParallel(csn->filter.get())) {
+        return 0;
+    }
+
+    const long long workers =
+        std::min<long long>(maxWorkers, collection->numRecords(opCtx) / minDocsPerWorker);
+    return workers < 2 ? 0 : workers;
+}
+
+/**
+ * Builds the scan for 'csn'. If 'projectedFields' is non-empty and a plain CollectionScan is used,
+ * the scan returns only those fields and '*projected' is set to true.
+ */
+PlanStage* buildCollectionScan(OperationContext* opCtx,
+                               Collection* collection,
+                               const CollectionScanNode* csn,
+                               const CollatorInterface* collator,
+                               WorkingSet* ws,
+                               std::vector<std::string> projectedFields,
+                               bool* projected) {
+    *projected = false;
+    if (const size_t maxWorkers = parallelCollectionScanWorkers(opCtx, collection, csn)) {
+        return new ParallelCollectionScan(
+            opCtx, collection, maxWorkers, ws, csn->filter.get(), collator);
+    }
+
+    CollectionScanParams params;
+    params.collection = collection;
+    params.tailable = csn->tailable;
+    params.shouldTrackLatestOplogTimestamp = csn->shouldTrackLatestOplogTimestamp;
+    params.direction =
+        (csn->direction == 1) ? CollectionScanParams::FORWARD : CollectionScanParams::BACKWARD;
+    params.maxScan = csn->maxScan;
+    if (!projectedFields.empty() && !csn->tailable && !csn->shouldTrackLatestOplogTimestamp) {
+        params.projectedFields = std::move(projectedFields);
+        *projected = true;
+    }
+    return new CollectionScan(opCtx, params, ws, csn->filter.get());
+}
+
+/**
+ * Builds the scan for 'ixn'. If set, 'keyFieldsToDecode' is the number of leading key fields the
+ * stages above use.
+ */
+PlanStage* buildIndexScan(OperationContext* opCtx,
+                          Collection* collection,
+                          const IndexScanNode* ixn,
+                          WorkingSet* ws,
+                          boost::optional<size_t> keyFieldsToDecode) {
+    if (nullptr == collection) {
+        warning() << "Can't ixscan null namespace";
+        return nullptr;
+    }
+
+    IndexScanParams params;
+
+    params.descriptor = collection->getIndexCatalog()->findIndexByName(opCtx, ixn->index.name);
+    invariant(params.descriptor);
+
+    params.bounds = ixn->bounds;
+    params.direction = ixn->direction;
+    params.maxScan = ixn->maxScan;
+    params.addKeyMetadata = ixn->addKeyMetadata;
+    params.keyFieldsToDecode = keyFieldsToDecode;
+    return new IndexScan(opCtx, params, ws, ixn->filter.get());
+}
+
+/**
+ * Builds the scan for 'dn'. If set, 'keyFieldsToDecode' is the number of leading key fields the
+ * stages above use.
+ */
+PlanStage* buildDistinctScan(OperationContext* opCtx,
+                             Collection* collection,
+                             const DistinctNode* dn,
+                             WorkingSet* ws,
+                             boost::optional<size_t> keyFieldsToDecode) {
+    if (nullptr == collection) {
+        warning() << "Can't distinct-scan null namespace";
+        return nullptr;
+    }
+
+    DistinctParams params;
+
+    params.descriptor = collection->getIndexCatalog()->findIndexByName(opCtx, dn->index.name);
+    invariant(params.descriptor);
+    params.direction = dn->direction;
+    params.bounds = dn->bounds;
+    params.fieldNo = dn->fieldNo;
+    params.keyFieldsToDecode = keyFieldsToDecode;
+    return new DistinctScan(opCtx, params, ws);
+}
+
+/**
+ * Returns how many leading fields of the index key the covered projection 'pn' reads, which is one
+ * past the last field it includes.
+ */
+size_t coveredKeyFieldsNeeded(const ProjectionNode* pn) {
+    ProjectionStage::FieldSet includedFields;
+    ProjectionStage::getSimpleInclusionFields(pn->projection, &includedFields);
+
+    size_t needed = 0;
+    size_t position = 0;
+    for (auto&& elt : pn->coveredKeyObj) {
+        ++position;
+        if (includedFields.find(elt.fieldNameStringData()) != includedFields.end()) {
+            needed = position;
+        }
+    }
+    return needed;
+}
+
+}  // namespace
 //prepareExecution->StageBuilder::build  prepareExecutionĶ
 //עbuildStagesеݹãͿ԰QuerySolutionchild QuerySolutionһ
 PlanStage* buildStages(OperationContext* opCtx,     //úڵݹ
@@ -76,34 +228,13 @@ PlanStage* buildStages(OperationContext* opCtx,     //
     switch (root->getType()) {
         case STAGE_COLLSCAN: { 
             const CollectionScanNode* csn = static_cast<const CollectionScanNode*>(root);
-            CollectionScanParams params;
-            params.collection = collection;
-            params.tailable = csn->tailable;
-            params.shouldTrackLatestOplogTimestamp = csn->shouldTrackLatestOplogTimestamp;
-            params.direction = (csn->direction == 1) ? CollectionScanParams::FORWARD
-                                                     : CollectionScanParams::BACKWARD;
-            params.maxScan = csn->maxScan;
-            return new CollectionScan(opCtx, params, ws, csn->filter.get());
+            bool projected;
+            return buildCollectionScan(
+                opCtx, collection, csn, cq.getCollator(), ws, {}, &projected);
         }
         case STAGE_IXSCAN: {
             const IndexScanNode* ixn = static_cast<const IndexScanNode*>(root);
-
-            if (nullptr == collection) {
-                warning() << "Can't ixscan null namespace";
-                return nullptr;
-            }
-
-            IndexScanParams params;
-
-            params.descriptor =
-                collection->getIndexCatalog()->findIndexByName(opCtx, ixn->index.name);
-            invariant(params.descriptor);
-
-            params.bounds = ixn->bounds;
-            params.direction = ixn->direction;
-            params.maxScan = ixn->maxScan;
-            params.addKeyMetadata = ixn->addKeyMetadata;
-            return new IndexScan(opCtx, params, ws, ixn->filter.get());
+            return buildIndexScan(opCtx, collection, ixn, ws, boost::none);
         }
         case STAGE_FETCH: {
             const FetchNode* fn = static_cast<const FetchNode*>(root);
@@ -139,13 +270,51 @@ PlanStage* buildStages(OperationContext* opCtx,     //
         }
         case STAGE_PROJECTION: {
             const ProjectionNode* pn = static_cast<const ProjectionNode*>(root);
-			//עеݹ
-            PlanStage* childStage = buildStages(opCtx, collection, cq, qsol, pn->children[0], ws);
+            ProjectionStageParams params;
+            PlanStage* childStage = nullptr;
+            if (ProjectionNode::SIMPLE_DOC == pn->projType &&
+                STAGE_COLLSCAN == pn->children[0]->getType() &&
+                internalQueryCollectionScanProjectionPushdown.load()) {
+                // Let the scan extract the projected fields from each record, so that whole
+                // documents are neither copied nor parsed past the last field we need.
+                ProjectionStage::FieldSet includedFields;
+                ProjectionStage::getSimpleInclusionFields(pn->projection, &includedFields);
+                std::vector<std::string> projectedFields;
+                for (auto&& field : includedFields) {
+                    projectedFields.push_back(field.first);
+                }
+                std::sort(projectedFields.begin(), projectedFields.end());
+                childStage = buildCollectionScan(
+                    opCtx,
+                    collection,
+                    static_cast<const CollectionScanNode*>(pn->children[0]),
+                    cq.getCollator(),
+                    ws,
+                    std::move(projectedFields),
+                    &params.childProjects);
+            } else if (ProjectionNode::COVERED_ONE_INDEX == pn->projType &&
+                       STAGE_IXSCAN == pn->children[0]->getType()) {
+                // The projection only reads the key fields up to the last one it includes.
+                childStage = buildIndexScan(opCtx,
+                                            collection,
+                                            static_cast<const IndexScanNode*>(pn->children[0]),
+                                            ws,
+                                            coveredKeyFieldsNeeded(pn));
+            } else if (ProjectionNode::COVERED_ONE_INDEX == pn->projType &&
+                       STAGE_DISTINCT_SCAN == pn->children[0]->getType()) {
+                childStage = buildDistinctScan(opCtx,
+                                               collection,
+                                               static_cast<const DistinctNode*>(pn->children[0]),
+                                               ws,
+                                               coveredKeyFieldsNeeded(pn));
+            } else {
+			    //עеݹ
+                childStage = buildStages(opCtx, collection, cq, qsol, pn->children[0], ws);
+            }
             if (nullptr == childStage) {
                 return nullptr;
             }
 
-            ProjectionStageParams params;
             params.projObj = pn->projection;
             params.collator = cq.getCollator();
 
@@ -319,21 +488,7 @@ PlanStage* buildStages(OperationContext* opCtx,     //
         }
         case STAGE_DISTINCT_SCAN: {
             const DistinctNode* dn = static_cast<const DistinctNode*>(root);
-
-            if (nullptr == collection) {
-                warning() << "Can't distinct-scan null namespace";
-                return nullptr;
-            }
-
-            DistinctParams params;
-
-            params.descriptor =
-                collection->getIndexCatalog()->findIndexByName(opCtx, dn->index.name);
-            invariant(params.descriptor);
-            params.direction = dn->direction;
-            params.bounds = dn->bounds;
-            params.fieldNo = dn->fieldNo;
-            return new DistinctScan(opCtx, params, ws);
+            return buildDistinctScan(opCtx, collection, dn, ws, boost::none);
         }
         case STAGE_COUNT_SCAN: {
             const CountScanNode* csn = static_cast<const CountScanNode*>(root);
@@ -377,6 +532,7 @@ PlanStage* buildStages(OperationContext* opCtx,     //
         case STAGE_MULTI_ITERATOR:
         case STAGE_MULTI_PLAN: //MultiPlanStageprepareExecution->MultiPlanStage::addPlanʼ
         case STAGE_OPLOG_START:
+        case STAGE_PARALLEL_COLLSCAN:
         case STAGE_PIPELINE_PROXY:
         case STAGE_QUEUED_DATA:
         case STAGE_SUBPLAN:
@@ -102,11 +102,15 @@ enum StageType { //
     STAGE_OPLOG_START,
     //ӦQuerySolutionNodeΪOrNodeӦstageΪOrStage
     STAGE_OR,
+
+    // Collection scan split across worker threads.
+    STAGE_PARALLEL_COLLSCAN,
+
     //ӦQuerySolutionNodeΪProjectionNode,ӦstageΪProjectionStage
     STAGE_PROJECTION,
 
     // Stage for running aggregation pipelines.
-    STAGE_PIPELINE_PROXY, //25
+    STAGE_PIPELINE_PROXY, //26
 
     STAGE_QUEUED_DATA,
     //ӦQuerySolutionNodeΪShardingFilterNodeӦstageΪShardFilterStage
@@ -114,9 +118,9 @@ enum StageType { //
     //ӦQuerySolutionNodeΪSkipNodeӦstageΪSkipStage
     STAGE_SKIP,
     //ӦQuerySolutionNodeΪSortNodeӦstageΪSTAGE_SORT
-    STAGE_SORT,  //29 SortStage
+    STAGE_SORT,  //30 SortStage
     //ӦQuerySolutionNodeΪSortKeyGeneratorNodeӦstageΪSortKeyGeneratorStage
-    STAGE_SORT_KEY_GENERATOR, //30  SortKeyGeneratorStage
+    STAGE_SORT_KEY_GENERATOR, //31  SortKeyGeneratorStage
     //ӦQuerySolutionNodeΪMergeSortNodeӦstageΪMergeSortStage
     STAGE_SORT_MERGE,
     //ע:STAGE_SUBPLANûжӦQuerySolutionNodeӦstageΪSubplanStage
@@ -126,7 +130,7 @@ enum StageType { //
     //ӦQuerySolutionNodeΪTextNodeӦstageΪTextStage
     STAGE_TEXT,
     STAGE_TEXT_OR,
-    STAGE_TEXT_MATCH, //35
+    STAGE_TEXT_MATCH, //36
 
     STAGE_UNKNOWN,
 
@@ -35,6 +35,7 @@
 #include <utility>
 
 #include "mongo/base/string_data.h"
+#include "mongo/bson/simple_bsonelement_comparator.h"
 #include "mongo/bson/util/bson_extract.h"
 #include "mongo/client/remote_command_retry_scheduler.h"
 #include "mongo/db/catalog/collection_options.h"
@@ -68,6 +69,45 @@ MONGO_EXPORT_SERVER_PARAMETER(numInitialSyncCollectionCountAttempts, int, 3);
 MONGO_EXPORT_SERVER_PARAMETER(numInitialSyncListIndexesAttempts, int, 3);
 // The number of attempts for the find command, which gets the data.
 MONGO_EXPORT_SERVER_PARAMETER(numInitialSyncCollectionFindAttempts, int, 3);
+// The minimum number of documents for a collection to be cloned as several '_id' ranges, one
+// cursor each, when more than one cloning cursor is allowed.
+MONGO_EXPORT_SERVER_PARAMETER(initialSyncCollectionRangeCloneMinDocuments, int, 1000 * 1000);
+
+// The number of '_id' values sampled on the sync source for each range to clone.
+const int kIdSamplesPerRange = 32;
+
+/**
+ * Sorts the sampled '_id' values and picks up to 'numRanges' - 1 evenly spaced distinct values
+ * among them. Each split point is returned as an object {_id: <value>} usable as a 'min' or
+ * 'max' bound on the '_id' index.
+ */
+std::vector<BSONObj> chooseIdSplitPoints(const std::vector<BSONObj>& samples, int numRanges) {
+    std::vector<BSONElement> ids;
+    ids.reserve(samples.size());
+    for (auto&& sample : samples) {
+        auto id = sample["_id"];
+        if (!id.eoo()) {
+            ids.push_back(id);
+        }
+    }
+    const auto& comparator = SimpleBSONElementComparator::kInstance;
+    std::sort(ids.begin(), ids.end(), comparator.makeLessThan());
+    ids.erase(std::unique(ids.begin(), ids.end(), comparator.makeEqualTo()), ids.end());
+
+    std::vector<BSONObj> splitPoints;
+    size_t lastIndex = 0;
+    for (int i = 1; i < numRanges; ++i) {
+        size_t index = i * ids.size() / numRanges;
+        if (index == 0 || index == lastIndex) {
+            continue;
+        }
+        BSONObjBuilder bob;
+        bob.appendAs(ids[index], "_id");
+        splitPoints.push_back(bob.obj());
+        lastIndex = index;
+    }
+    return splitPoints;
+}
 }  // namespace
 
 // Failpoint which causes initial sync to hang before establishing its cursor to clone the
@@ -250,6 +290,12 @@ void CollectionCloner::_cancelRemainingWork_inlock() {
     if (_establishCollectionCursorsScheduler) {
         _establishCollectionCursorsScheduler->shutdown();
     }
+    if (_idSampleScheduler) {
+        _idSampleScheduler->shutdown();
+    }
+    for (auto&& scheduler : _idRangeCursorSchedulers) {
+        scheduler->shutdown();
+    }
     _dbWorkTaskRunner.cancel();
 }
 
@@ -462,6 +508,34 @@ void CollectionCloner::_beginCollectionCallback(const executor::TaskExecutor::Ca
 
     _collLoader = std::move(collectionBulkLoader.getValue());
 
+    MONGO_FAIL_POINT_BLOCK(initialSyncHangBeforeCollectionClone, options) {
+        const BSONObj& data = options.getData();
+        if (data["namespace"].String() == _destNss.ns()) {
+            log() << "initial sync - initialSyncHangBeforeCollectionClone fail point "
+                     "enabled. Blocking until fail point is disabled.";
+            while (MONGO_FAIL_POINT(initialSyncHangBeforeCollectionClone) && !_isShuttingDown()) {
+                mongo::sleepsecs(1);
+            }
+        }
+    }
+
+    bool cloneByIdRanges;
+    {
+        LockGuard lk(_mutex);
+        cloneByIdRanges = _shouldCloneByIdRanges_inlock();
+    }
+    if (cloneByIdRanges) {
+        auto scheduleStatus = _scheduleIdSample();
+        if (scheduleStatus.isOK()) {
+            return;
+        }
+        LOG(1) << "Failed to sample _id values of collection " << _sourceNss.ns()
+               << ", cloning it without partitioning: " << redact(scheduleStatus);
+    }
+    _scheduleEstablishCollectionCursors();
+}
+
+void CollectionCloner::_scheduleEstablishCollectionCursors() {
     BSONObjBuilder cmdObj;
     EstablishCursorsCommand cursorCommand;
     // The 'find' command is used when the number of cloning cursors is 1 to ensure
@@ -485,17 +559,7 @@ void CollectionCloner::_beginCollectionCallback(const executor::TaskExecutor::Ca
     Client::initThreadIfNotAlready();
     auto opCtx = cc().getOperationContext();
 
-    MONGO_FAIL_POINT_BLOCK(initialSyncHangBeforeCollectionClone, options) {
-        const BSONObj& data = options.getData();
-        if (data["namespace"].String() == _destNss.ns()) {
-            log() << "initial sync - initialSyncHangBeforeCollectionClone fail point "
-                     "enabled. Blocking until fail point is disabled.";
-            while (MONGO_FAIL_POINT(initialSyncHangBeforeCollectionClone) && !_isShuttingDown()) {
-                mongo::sleepsecs(1);
-            }
-        }
-    }
-
+    UniqueLock lk(_mutex);
     _establishCollectionCursorsScheduler = stdx::make_unique<RemoteCommandRetryScheduler>(
         _executor,
         RemoteCommandRequest(_source,
@@ -517,11 +581,229 @@ void CollectionCloner::_beginCollectionCallback(const executor::TaskExecutor::Ca
 
     if (!scheduleStatus.isOK()) {
         _establishCollectionCursorsScheduler.reset();
+        lk.unlock();
         _finishCallback(scheduleStatus);
         return;
     }
 }
 
+bool CollectionCloner::_shouldCloneByIdRanges_inlock() const {
+    // Index bounds on a collated '_id' index are not comparable with the raw sampled values, and
+    // capped collections must be filled in natural order.
+    return _maxNumClonerCursors > 1 && !_idIndexSpec.isEmpty() && !_options.capped &&
+        _options.collation.isEmpty() &&
+        _stats.documentToCopy >=
+        static_cast<size_t>(initialSyncCollectionRangeCloneMinDocuments.load());
+}
+
+Status CollectionCloner::_scheduleIdSample() {
+    const int sampleSize = _maxNumClonerCursors * kIdSamplesPerRange;
+    // 'aggregate' does not accept a collection UUID, so the sample is always taken by name. Should
+    // the name no longer refer to this collection on the sync source, the ranges are only poorly
+    // balanced: together they still cover every '_id'.
+    auto cmdObj = BSON("aggregate" << _sourceNss.coll() << "pipeline"
+                                   << BSON_ARRAY(BSON("$sample" << BSON("size" << sampleSize))
+                                                 << BSON("$project" << BSON("_id" << 1)))
+                                   << "cursor"
+                                   << BSON("batchSize" << sampleSize));
+
+    LockGuard lk(_mutex);
+    _idSampleScheduler = stdx::make_unique<RemoteCommandRetryScheduler>(
+        _executor,
+        RemoteCommandRequest(_source,
+                             _sourceNss.db().toString(),
+                             cmdObj,
+                             ReadPreferenceSetting::secondaryPreferredMetadata(),
+                             nullptr,
+                             RemoteCommandRequest::kNoTimeout),
+        stdx::bind(&CollectionCloner::_idSampleCallback, this, stdx::placeholders::_1),
+        RemoteCommandRetryScheduler::makeRetryPolicy(
+            numInitialSyncCollectionFindAttempts.load(),
+            executor::RemoteCommandRequest::kNoTimeout,
+            RemoteCommandRetryScheduler::kAllRetriableErrors));
+    auto scheduleStatus = _idSampleScheduler->startup();
+    if (!scheduleStatus.isOK()) {
+        _idSampleScheduler.reset();
+    }
+    return scheduleStatus;
+}
+
+void CollectionCloner::_idSampleCallback(const RemoteCommandCallbackArgs& rcbd) {
+    if (_isShuttingDown()) {
+        _finishCallback({ErrorCodes::CallbackCanceled, "Cloner shutting down."});
+        return;
+    }
+
+    std::vector<BSONObj> splitPoints;
+    Status sampleStatus = [&] {
+        if (!rcbd.response.isOK()) {
+            return rcbd.response.status;
+        }
+        auto commandStatus = getStatusFromCommandResult(rcbd.response.data);
+        if (!commandStatus.isOK()) {
+            return commandStatus;
+        }
+        auto sample = CursorResponse::parseFromBSON(rcbd.response.data);
+        if (!sample.isOK()) {
+            return sample.getStatus();
+        }
+        splitPoints = chooseIdSplitPoints(sample.getValue().getBatch(), _maxNumClonerCursors);
+        return Status::OK();
+    }();
+
+    if (!sampleStatus.isOK() || splitPoints.empty()) {
+        LOG(1) << "Unable to choose _id ranges for collection " << _sourceNss.ns()
+               << ", cloning it without partitioning: " << redact(sampleStatus);
+        _scheduleEstablishCollectionCursors();
+        return;
+    }
+    _scheduleIdRangeCursors(splitPoints);
+}
+
+void CollectionCloner::_scheduleIdRangeCursors(const std::vector<BSONObj>& splitPoints) {
+    const auto keyPattern = _idIndexSpec["key"].Obj();
+    const size_t numRanges = splitPoints.size() + 1;
+
+    UniqueLock lk(_mutex);
+    _stats.idRanges = numRanges;
+    for (size_t i = 0; i < numRanges; ++i) {
+        BSONObjBuilder cmdObj;
+        cmdObj.appendElements(
+            makeCommandWithUUIDorCollectionName("find", _options.uuid, _sourceNss));
+        cmdObj.append("noCursorTimeout", true);
+        cmdObj.append("batchSize", 0);
+        cmdObj.append("hint", keyPattern);
+        // 'min' is inclusive and 'max' exclusive, so consecutive ranges neither overlap nor
+        // leave gaps. The first and last ranges are unbounded below and above.
+        if (i > 0) {
+            cmdObj.append("min", splitPoints[i - 1]);
+        }
+        if (i < splitPoints.size()) {
+            cmdObj.append("max", splitPoints[i]);
+        }
+        _idRangeCursorSchedulers.push_back(stdx::make_unique<RemoteCommandRetryScheduler>(
+            _executor,
+            RemoteCommandRequest(_source,
+                                 _sourceNss.db().toString(),
+                                 cmdObj.obj(),
+                                 ReadPreferenceSetting::secondaryPreferredMetadata(),
+                                 nullptr,
+                                 RemoteCommandRequest::kNoTimeout),
+            stdx::bind(&CollectionCloner::_idRangeCursorCallback, this, stdx::placeholders::_1),
+            RemoteCommandRetryScheduler::makeRetryPolicy(
+                numInitialSyncCollectionFindAttempts.load(),
+                executor::RemoteCommandRequest::kNoTimeout,
+                RemoteCommandRetryScheduler::kAllRetriableErrors)));
+    }
+    LOG(1) << "Cloning collection " << _sourceNss.ns() << " as " << numRanges << " _id ranges.";
+
+    for (auto&& scheduler : _idRangeCursorSchedulers) {
+        auto scheduleStatus = scheduler->startup();
+        if (!scheduleStatus.isOK()) {
+            _failIdRangeCursors_inlock(scheduleStatus);
+            if (_idRangeCursorsPending > 0) {
+                // The callback of the last range already scheduled finishes the cloner.
+                return;
+            }
+            lk.unlock();
+            _finishCallback(scheduleStatus);
+            return;
+        }
+        ++_idRangeCursorsPending;
+    }
+}
+
+void CollectionCloner::_idRangeCursorCallback(const RemoteCommandCallbackArgs& rcbd) {
+    auto cursorResponse = [&]() -> StatusWith<CursorResponse> {
+        if (!rcbd.response.isOK()) {
+            return rcbd.response.status;
+        }
+        auto commandStatus = getStatusFromCommandResult(rcbd.response.data);
+        if (!commandStatus.isOK()) {
+            return commandStatus;
+        }
+        return CursorResponse::parseFromBSON(rcbd.response.data);
+    }();
+
+    UniqueLock lk(_mutex);
+    invariant(_idRangeCursorsPending > 0);
+    --_idRangeCursorsPending;
+
+    if (_idRangeCursorsFailed) {
+        // Another range has failed; do not leave this range's cursor open on the source.
+        if (cursorResponse.isOK()) {
+            std::vector<CursorResponse> orphaned;
+            orphaned.push_back(std::move(cursorResponse.getValue()));
+            _killRemoteCursors_inlock(orphaned);
+        }
+    } else if (!cursorResponse.isOK() || _state == State::kShuttingDown) {
+        auto status = cursorResponse.getStatus();
+        if (status.isOK()) {
+            std::vector<CursorResponse> orphaned;
+            orphaned.push_back(std::move(cursorResponse.getValue()));
+            _killRemoteCursors_inlock(orphaned);
+            status = {ErrorCodes::CallbackCanceled, "Cloner shutting down."};
+        } else if (status == ErrorCodes::NamespaceNotFound) {
+            // The collection was dropped on the sync source, same as a single 'find' cursor.
+            status = Status::OK();
+        }
+        _failIdRangeCursors_inlock(status);
+    } else {
+        _idRangeCursors.push_back(std::move(cursorResponse.getValue()));
+    }
+
+    if (_idRangeCursorsPending > 0) {
+        return;
+    }
+    if (_idRangeCursorsFailed) {
+        // Only the last range callback may finish the cloner: the owner is free to destroy the
+        // cloner, and with it the other schedulers, as soon as it has finished.
+        auto status = _idRangeCursorsStatus;
+        lk.unlock();
+        _finishCallback(status);
+        return;
+    }
+    auto cursors = std::move(_idRangeCursors);
+    _idRangeCursors.clear();
+    lk.unlock();
+
+    LOG(1) << "Collection cloner running with " << cursors.size() << " _id range cursors.";
+    _startArm(std::move(cursors));
+}
+
+void CollectionCloner::_failIdRangeCursors_inlock(const Status& status) {
+    _idRangeCursorsFailed = true;
+    _idRangeCursorsStatus = status;
+    _killRemoteCursors_inlock(_idRangeCursors);
+    _idRangeCursors.clear();
+    for (auto&& scheduler : _idRangeCursorSchedulers) {
+        scheduler->shutdown();
+    }
+}
+
+void CollectionCloner::_killRemoteCursors_inlock(const std::vector<CursorResponse>& cursors) {
+    BSONArrayBuilder cursorIds;
+    for (auto&& cursor : cursors) {
+        if (cursor.getCursorId()) {
+            cursorIds.append(cursor.getCursorId());
+        }
+    }
+    if (cursorIds.arrSize() == 0) {
+        return;
+    }
+    RemoteCommandRequest request(
+        _source,
+        _sourceNss.db().toString(),
+        BSON("killCursors" << _sourceNss.coll() << "cursors" << cursorIds.arr()),
+        nullptr);
+    auto scheduleResult = _executor->scheduleRemoteCommand(
+        request, [](const executor::TaskExecutor::RemoteCommandCallbackArgs&) {});
+    if (!scheduleResult.isOK()) {
+        warning() << "Failed to kill cursors of collection " << _sourceNss.ns() << " on "
+                  << _source << ": " << redact(scheduleResult.getStatus());
+    }
+}
+
 Status CollectionCloner::_parseCursorResponse(BSONObj response,
                                               std::vector<CursorResponse>* cursors,
                                               EstablishCursorsCommand cursorCommand) {
@@ -613,7 +895,10 @@ void CollectionCloner::_establishCollectionCursorsCallback(const RemoteCommandCa
     }
     LOG(1) << "Collection cloner running with " << cursorResponses.size()
            << " cursors established.";
+    _startArm(std::move(cursorResponses));
+}
 
+void CollectionCloner::_startArm(std::vector<CursorResponse> cursorResponses) {
     // Initialize the 'AsyncResultsMerger'(ARM).
     std::vector<ClusterClientCursorParams::RemoteCursor> remoteCursors;
     for (auto&& cursorResponse : cursorResponses) {
@@ -806,7 +1091,11 @@ void CollectionCloner::_insertDocumentsCallback(
     }
     _documentsToInsert.swap(docs);
     _stats.documentsCopied += docs.size();
+    for (auto&& doc : docs) {
+        _stats.bytesCopied += doc.objsize();
+    }
     ++_stats.fetchBatches;
+    _stats.lastBatchInserted = _executor->now();
     _progressMeter.hit(int(docs.size()));
     invariant(_collLoader);
     const auto status = _collLoader->insertDocuments(docs.cbegin(), docs.cend());
@@ -900,6 +1189,10 @@ void CollectionCloner::Stats::append(BSONObjBuilder* builder) const {
     builder->appendNumber(kDocumentsCopiedFieldName, documentsCopied);
     builder->appendNumber("indexes", indexes);
     builder->appendNumber("fetchedBatches", fetchBatches);
+    builder->appendNumber("bytesCopied", static_cast<long long>(bytesCopied));
+    if (idRanges) {
+        builder->appendNumber("idRanges", static_cast<long long>(idRanges));
+    }
     if (start != Date_t()) {
         builder->appendDate("start", start);
         if (end != Date_t()) {
@@ -908,6 +1201,24 @@ void CollectionCloner::Stats::append(BSONObjBuilder* builder) const {
             long long elapsedMillis = duration_cast<Milliseconds>(elapsed).count();
             builder->appendNumber("elapsedMillis", elapsedMillis);
         }
+
+        // Throughput is measured up to the last inserted batch, and the remaining time is
+        // extrapolated from it while the collection is still being cloned.
+        const auto copyEnd = end != Date_t() ? end : lastBatchInserted;
+        const long long copyMillis =
+            copyEnd > start ? durationCount<Milliseconds>(copyEnd - start) : 0;
+        if (copyMillis > 0 && documentsCopied > 0) {
+            builder->appendNumber("documentsPerSecond",
+                                  static_cast<long long>(documentsCopied * 1000 / copyMillis));
+            builder->appendNumber("bytesPerSecond",
+                                  static_cast<long long>(bytesCopied * 1000 / copyMillis));
+            if (end == Date_t() && documentToCopy > documentsCopied) {
+                builder->appendNumber(
+                    "estimatedRemainingMillis",
+                    static_cast<long long>((documentToCopy - documentsCopied) * copyMillis /
+                                           documentsCopied));
+            }
+        }
     }
 }
 }  // namespace repl
@@ -83,6 +83,11 @@ public:
         size_t documentsCopied{0};
         size_t indexes{0};
         size_t fetchBatches{0};
+        size_t bytesCopied{0};
+        // Number of '_id' ranges cloned concurrently; 0 if the collection was not partitioned.
+        size_t idRanges{0};
+        // Time the most recent batch was inserted; used to report throughput while cloning.
+        Date_t lastBatchInserted;
 
         std::string toString() const;
         BSONObj toBSON() const;
@@ -199,6 +204,49 @@ private:
      */
     enum EstablishCursorsCommand { Find, ParallelCollScan };
 
+    /**
+     * Schedules the 'find' or 'parallelCollectionScan' command establishing the cursor(s) which
+     * clone the whole collection.
+     */
+    void _scheduleEstablishCollectionCursors();
+
+    /**
+     * Returns true if the collection is large enough, and has an '_id' index usable to split it,
+     * to be cloned as several '_id' ranges with one cursor each.
+     */
+    bool _shouldCloneByIdRanges_inlock() const;
+
+    /**
+     * Samples '_id' values on the sync source. The callback chooses the range boundaries from
+     * the sample and falls back to _scheduleEstablishCollectionCursors() if that is not possible.
+     */
+    Status _scheduleIdSample();
+    void _idSampleCallback(const RemoteCommandCallbackArgs& rcbd);
+
+    /**
+     * Establishes one 'find' cursor, bounded with 'min'/'max' on the '_id' index, for each range
+     * between consecutive split points.
+     */
+    void _scheduleIdRangeCursors(const std::vector<BSONObj>& splitPoints);
+    void _idRangeCursorCallback(const RemoteCommandCallbackArgs& rcbd);
+
+    /**
+     * Records that establishing the '_id' range cursors failed with 'status', kills the cursors
+     * established so far and shuts down the schedulers of the other ranges.
+     */
+    void _failIdRangeCursors_inlock(const Status& status);
+
+    /**
+     * Kills cursors established on the sync source which will not be handed to the
+     * 'AsyncResultsMerger'.
+     */
+    void _killRemoteCursors_inlock(const std::vector<CursorResponse>& cursors);
+
+    /**
+     * Hands the established cursors to a new 'AsyncResultsMerger' and starts fetching from it.
+     */
+    void _startArm(std::vector<CursorResponse> cursorResponses);
+
     /**
      * Parses the cursor responses from the 'find' or 'parallelCollectionScan' command
      * and passes them into the 'AsyncResultsMerger'.
@@ -304,6 +352,22 @@ private:
     // (M) Scheduler used to establish the initial cursor or set of cursors.
     std::unique_ptr<RemoteCommandRetryScheduler> _establishCollectionCursorsScheduler;
 
+    // (M) Scheduler used to sample '_id' values when the collection is cloned as '_id' ranges.
+    std::unique_ptr<RemoteCommandRetryScheduler> _idSampleScheduler;
+
+    // (M) The cursors of the '_id' ranges established so far and the number of range schedulers
+    // whose callback has yet to run. Once any range fails, the other schedulers are shut down, the
+    // remaining cursors are killed as they arrive and the cloner finishes with
+    // '_idRangeCursorsStatus' after the last callback, so that no callback outlives the cloner.
+    // These are declared before the schedulers so that they are destroyed after them.
+    std::vector<CursorResponse> _idRangeCursors;
+    std::size_t _idRangeCursorsPending = 0;
+    bool _idRangeCursorsFailed = false;
+    Status _idRangeCursorsStatus = Status::OK();
+
+    // (M) Schedulers establishing the cursor of each '_id' range.
+    std::vector<std::unique_ptr<RemoteCommandRetryScheduler>> _idRangeCursorSchedulers;
+
     // State transitions:
     // PreStart --> Running --> ShuttingDown --> Complete
     // It is possible to skip intermediate states. For example,
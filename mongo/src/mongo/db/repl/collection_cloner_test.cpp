@@ -2170,4 +2170,194 @@ TEST_F(ParallelCollectionClonerTest,
     ASSERT_EQUALS(ErrorCodes::OperationFailed, getStatus());
 }
 
+TEST_F(ParallelCollectionClonerTest, LargeCollectionIsClonedAsIdRangesWithOneCursorEach) {
+    ASSERT_OK(collectionCloner->startup());
+    ASSERT_TRUE(collectionCloner->isActive());
+
+    auto net = getNet();
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(net);
+        processNetworkResponse(createCountResponse(10 * 1000 * 1000));
+        processNetworkResponse(createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+    }
+    collectionCloner->waitForDbWorker();
+    ASSERT_TRUE(collectionStats.initCalled);
+
+    // Sampled _id values 0 to 11 split the collection into three ranges at 4 and 8.
+    BSONArrayBuilder sample;
+    for (int i = 11; i >= 0; --i) {
+        sample.append(BSON("_id" << i));
+    }
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(net);
+        assertRemoteCommandNameEquals(
+            "aggregate", net->scheduleSuccessfulResponse(createCursorResponse(0, sample.arr())));
+        net->runReadyNetworkOperations();
+    }
+
+    BSONArray emptyArray;
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(net);
+        const std::vector<BSONObj> expectedMin = {BSONObj(), BSON("_id" << 4), BSON("_id" << 8)};
+        const std::vector<BSONObj> expectedMax = {BSON("_id" << 4), BSON("_id" << 8), BSONObj()};
+        for (int i = 0; i < 3; ++i) {
+            ASSERT_TRUE(net->hasReadyRequests());
+            auto noi = net->getNextReadyRequest();
+            auto&& cmdObj = noi->getRequest().cmdObj;
+            ASSERT_EQUALS("find", std::string(cmdObj.firstElementFieldName()));
+            ASSERT_TRUE(cmdObj.getField("noCursorTimeout").trueValue());
+            ASSERT_BSONOBJ_EQ(BSON("_id" << 1), cmdObj["hint"].Obj());
+            ASSERT_BSONOBJ_EQ(expectedMin[i], cmdObj.getObjectField("min"));
+            ASSERT_BSONOBJ_EQ(expectedMax[i], cmdObj.getObjectField("max"));
+            scheduleNetworkResponse(noi, createCursorResponse(i + 1, emptyArray));
+        }
+        net->runReadyNetworkOperations();
+    }
+    collectionCloner->waitForDbWorker();
+    ASSERT_TRUE(collectionCloner->isActive());
+
+    auto exec = &getExecutor();
+    std::vector<BSONObj> docs;
+    collectionCloner->setScheduleDbWorkFn_forTest(
+        [&](const executor::TaskExecutor::CallbackFn& workFn) {
+            auto buffered = collectionCloner->getDocumentsToInsert_forTest();
+            docs.insert(docs.end(), buffered.begin(), buffered.end());
+            return exec->scheduleWork(workFn);
+        });
+
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(net);
+        processNetworkResponse(createFinalCursorResponse(BSON_ARRAY(BSON("_id" << 0))));
+        processNetworkResponse(createFinalCursorResponse(BSON_ARRAY(BSON("_id" << 4))));
+        processNetworkResponse(createFinalCursorResponse(BSON_ARRAY(BSON("_id" << 8))));
+    }
+
+    collectionCloner->join();
+    ASSERT_EQUALS(3U, docs.size());
+    ASSERT_EQUALS(3, collectionStats.insertCount);
+    ASSERT_TRUE(collectionStats.commitCalled);
+    ASSERT_EQUALS(3U, collectionCloner->getStats().idRanges);
+
+    ASSERT_OK(getStatus());
+    ASSERT_FALSE(collectionCloner->isActive());
+}
+
+TEST_F(ParallelCollectionClonerTest, FailedIdRangeFinishesClonerOnlyAfterOtherRangesCallBack) {
+    ASSERT_OK(collectionCloner->startup());
+    ASSERT_TRUE(collectionCloner->isActive());
+
+    auto net = getNet();
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(net);
+        processNetworkResponse(createCountResponse(10 * 1000 * 1000));
+        processNetworkResponse(createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+    }
+    collectionCloner->waitForDbWorker();
+    ASSERT_TRUE(collectionStats.initCalled);
+
+    BSONArrayBuilder sample;
+    for (int i = 11; i >= 0; --i) {
+        sample.append(BSON("_id" << i));
+    }
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(net);
+        assertRemoteCommandNameEquals(
+            "aggregate", net->scheduleSuccessfulResponse(createCursorResponse(0, sample.arr())));
+        net->runReadyNetworkOperations();
+    }
+
+    // The first range is established, the second fails and the response for the third is already
+    // on its way, so shutting down its scheduler cannot cancel it.
+    BSONArray emptyArray;
+    const Date_t thirdRangeResponseDate = net->now() + Seconds(10);
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(net);
+        ASSERT_TRUE(net->hasReadyRequests());
+        scheduleNetworkResponse(net->getNextReadyRequest(), createCursorResponse(1, emptyArray));
+        ASSERT_TRUE(net->hasReadyRequests());
+        scheduleNetworkResponse(
+            net->getNextReadyRequest(), ErrorCodes::OperationFailed, "range find failed");
+        ASSERT_TRUE(net->hasReadyRequests());
+        net->scheduleResponse(
+            net->getNextReadyRequest(),
+            thirdRangeResponseDate,
+            executor::RemoteCommandResponse(
+                createCursorResponse(3, emptyArray), BSONObj(), Milliseconds(0)));
+        net->runReadyNetworkOperations();
+
+        // The cursor of the first range is killed right away.
+        ASSERT_TRUE(net->hasReadyRequests());
+        auto&& killCmd = net->getNextReadyRequest()->getRequest().cmdObj;
+        ASSERT_EQUALS("killCursors", std::string(killCmd.firstElementFieldName()));
+        ASSERT_BSONOBJ_EQ(BSON("0" << 1LL), killCmd["cursors"].Obj());
+    }
+
+    // The cloner has not finished while a range scheduler still has a callback to run.
+    ASSERT_TRUE(collectionCloner->isActive());
+    ASSERT_EQUALS(getDetectableErrorStatus(), getStatus());
+
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(net);
+        net->runUntil(thirdRangeResponseDate);
+
+        // The cursor of the last range is killed as it arrives.
+        ASSERT_TRUE(net->hasReadyRequests());
+        auto&& killCmd = net->getNextReadyRequest()->getRequest().cmdObj;
+        ASSERT_EQUALS("killCursors", std::string(killCmd.firstElementFieldName()));
+        ASSERT_BSONOBJ_EQ(BSON("0" << 3LL), killCmd["cursors"].Obj());
+    }
+
+    collectionCloner->join();
+    ASSERT_EQUALS(ErrorCodes::OperationFailed, getStatus());
+    ASSERT_FALSE(collectionStats.commitCalled);
+    ASSERT_FALSE(collectionCloner->isActive());
+}
+
+TEST(CollectionClonerStatsTest, ReportsThroughputAndRemainingTimeWhileCloning) {
+    CollectionCloner::Stats stats;
+    stats.start = Date_t::fromMillisSinceEpoch(100 * 1000);
+    stats.lastBatchInserted = stats.start + Seconds(2);
+    stats.documentToCopy = 1000;
+    stats.documentsCopied = 250;
+    stats.bytesCopied = 25 * 1000;
+
+    auto obj = stats.toBSON();
+    ASSERT_EQUALS(25 * 1000, obj["bytesCopied"].numberLong());
+    ASSERT_EQUALS(125, obj["documentsPerSecond"].numberLong());
+    ASSERT_EQUALS(12500, obj["bytesPerSecond"].numberLong());
+    // 750 documents left at 125 documents per second.
+    ASSERT_EQUALS(6000, obj["estimatedRemainingMillis"].numberLong());
+    ASSERT_FALSE(obj.hasField("idRanges"));
+}
+
+TEST(CollectionClonerStatsTest, ReportsThroughputWithoutRemainingTimeOnceFinished) {
+    CollectionCloner::Stats stats;
+    stats.start = Date_t::fromMillisSinceEpoch(100 * 1000);
+    stats.lastBatchInserted = stats.start + Seconds(3);
+    stats.end = stats.start + Seconds(4);
+    stats.documentToCopy = 1000;
+    stats.documentsCopied = 1000;
+    stats.bytesCopied = 40 * 1000;
+    stats.idRanges = 3;
+
+    auto obj = stats.toBSON();
+    ASSERT_EQUALS(4000, obj["elapsedMillis"].numberLong());
+    ASSERT_EQUALS(250, obj["documentsPerSecond"].numberLong());
+    ASSERT_EQUALS(10 * 1000, obj["bytesPerSecond"].numberLong());
+    ASSERT_FALSE(obj.hasField("estimatedRemainingMillis"));
+    ASSERT_EQUALS(3, obj["idRanges"].numberLong());
+}
+
+TEST(CollectionClonerStatsTest, OmitsThroughputBeforeFirstBatch) {
+    CollectionCloner::Stats stats;
+    stats.start = Date_t::fromMillisSinceEpoch(100 * 1000);
+    stats.documentToCopy = 1000;
+
+    auto obj = stats.toBSON();
+    ASSERT_EQUALS(0, obj["bytesCopied"].numberLong());
+    ASSERT_FALSE(obj.hasField("documentsPerSecond"));
+    ASSERT_FALSE(obj.hasField("bytesPerSecond"));
+    ASSERT_FALSE(obj.hasField("estimatedRemainingMillis"));
+}
+
 }  // namespace
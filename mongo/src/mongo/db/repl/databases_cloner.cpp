@@ -61,6 +61,11 @@ using UniqueLock = stdx::unique_lock<stdx::mutex>;
 // The number of attempts for the listDatabases commands.
 MONGO_EXPORT_SERVER_PARAMETER(numInitialSyncListDatabasesAttempts, int, 3);
 
+// The number of databases cloned concurrently. Collections of a database are cloned one at a
+// time, since creating a collection for bulk loading locks its database exclusively, so this
+// also bounds the number of collections being cloned at once.
+MONGO_EXPORT_SERVER_PARAMETER(maxNumInitialSyncConcurrentDatabaseCloners, int, 1);
+
 }  // namespace
 
 
@@ -362,6 +367,7 @@ void DatabasesCloner::_onListDatabaseFinish(const CommandCallbackArgs& cbd) {
             // Start first database cloner.
             if (_databaseCloners.empty()) {
                 startStatus = dbCloner->startup();
+                _databaseClonersStarted = startStatus.isOK() ? 1 : 0;
             }
         } catch (...) {
             startStatus = exceptionToStatus();
@@ -384,6 +390,13 @@ void DatabasesCloner::_onListDatabaseFinish(const CommandCallbackArgs& cbd) {
         } else {
             _fail_inlock(&lk, _status);
         }
+        return;
+    }
+
+    auto startStatus = _startDatabaseCloners_inlock();
+    if (!startStatus.isOK()) {
+        warning() << "failed to start database cloners due to " << startStatus.toString();
+        _fail_inlock(&lk, startStatus);
     }
 }
 
@@ -399,6 +412,10 @@ RemoteCommandRetryScheduler* DatabasesCloner::_getListDatabasesScheduler() const
 
 void DatabasesCloner::_onEachDBCloneFinish(const Status& status, const std::string& name) {
     UniqueLock lk(_mutex);
+    if (!_isActive_inlock() || !_finishFn) {
+        // Another database being cloned concurrently has already failed, and shut this one down.
+        return;
+    }
     if (!status.isOK()) {
         warning() << "database '" << name << "' (" << (_stats.databasesCloned + 1) << " of "
                   << _databaseCloners.size() << ") clone failed due to " << status.toString();
@@ -434,18 +451,37 @@ void DatabasesCloner::_onEachDBCloneFinish(const Status& status, const std::stri
         return;
     }
 
-    // Start next database cloner.
-    auto&& dbCloner = _databaseCloners[_stats.databasesCloned];
-    auto startStatus = dbCloner->startup();
+    // Start next database cloner(s).
+    auto startStatus = _startDatabaseCloners_inlock();
     if (!startStatus.isOK()) {
-        warning() << "failed to schedule database '" << name << "' ("
-                  << (_stats.databasesCloned + 1) << " of " << _databaseCloners.size()
+        warning() << "failed to schedule database '"
+                  << _databaseCloners[_databaseClonersStarted]->getDBName() << "' ("
+                  << (_databaseClonersStarted + 1) << " of " << _databaseCloners.size()
                   << ") due to " << startStatus.toString();
         _fail_inlock(&lk, startStatus);
         return;
     }
 }
 
+Status DatabasesCloner::_startDatabaseCloners_inlock() {
+    const size_t maxInFlight = std::max(1, maxNumInitialSyncConcurrentDatabaseCloners.load());
+    while (_databaseClonersStarted < _databaseCloners.size() &&
+           _databaseClonersStarted - _stats.databasesCloned < maxInFlight) {
+        // The 'admin' database is cloned and validated before any other database, see
+        // _setAdminAsFirst().
+        if (_stats.databasesCloned == 0 && _databaseClonersStarted == 1 &&
+            StringData(_databaseCloners.front()->getDBName()).equalCaseInsensitive("admin")) {
+            break;
+        }
+        auto startStatus = _databaseCloners[_databaseClonersStarted]->startup();
+        if (!startStatus.isOK()) {
+            return startStatus;
+        }
+        ++_databaseClonersStarted;
+    }
+    return Status::OK();
+}
+
 void DatabasesCloner::_fail_inlock(UniqueLock* lk, Status status) {
     LOG(3) << "DatabasesCloner::_fail_inlock called";
     if (!_isActive_inlock()) {
@@ -453,11 +489,17 @@ void DatabasesCloner::_fail_inlock(UniqueLock* lk, Status status) {
     }
 
     _setStatus_inlock(status);
-    // TODO: shutdown outstanding work, like any cloners active
     invariant(_finishFn);
     auto finish = _finishFn;
     _finishFn = {};
+
+    // Other databases may still be cloning concurrently. Their completion callbacks find
+    // '_finishFn' cleared and do nothing.
+    auto databaseCloners = _databaseCloners;
     lk->unlock();
+    for (auto&& cloner : databaseCloners) {
+        cloner->shutdown();
+    }
 
     LOG(3) << "DatabasesCloner - calling _finishFn with status: " << _status;
     finish(status);
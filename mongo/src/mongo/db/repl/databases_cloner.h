@@ -144,6 +144,12 @@ private:
     /** Called each time a database clone is finished */
     void _onEachDBCloneFinish(const Status& status, const std::string& name);
 
+    /**
+     * Starts database cloners, in order, until the configured number of databases is being
+     * cloned concurrently. The 'admin' database is always cloned on its own.
+     */
+    Status _startDatabaseCloners_inlock();
+
     //  Callbacks
 
     void _onListDatabaseFinish(const CommandCallbackArgs& cbd);
@@ -186,6 +192,7 @@ private:
 
     std::unique_ptr<RemoteCommandRetryScheduler> _listDBsScheduler;  // (M) scheduler for listDBs.
     std::vector<std::shared_ptr<DatabaseCloner>> _databaseCloners;   // (M) database cloners by name
+    size_t _databaseClonersStarted{0};                               // (M)
     Stats _stats;                                                    // (M)
 
     // State transitions:
@@ -38,6 +38,7 @@
 #include "mongo/db/repl/oplog_entry.h"
 #include "mongo/db/repl/storage_interface.h"
 #include "mongo/db/repl/storage_interface_mock.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/executor/network_interface_mock.h"
 #include "mongo/executor/thread_pool_task_executor_test_fixture.h"
 #include "mongo/stdx/mutex.h"
@@ -898,6 +899,123 @@ TEST_F(DBsClonerTest, AdminDbValidationErrorShouldAbortTheCloner) {
     ASSERT_TRUE(isAdminDbValidFnCalled);
 }
 
+/**
+ * Sets 'maxNumInitialSyncConcurrentDatabaseCloners' for the lifetime of this object.
+ */
+class MaxConcurrentDatabaseClonersGuard {
+public:
+    explicit MaxConcurrentDatabaseClonersGuard(int value)
+        : _parameter(ServerParameterSet::getGlobal()
+                         ->getMap()
+                         .find("maxNumInitialSyncConcurrentDatabaseCloners")
+                         ->second) {
+        ASSERT_OK(_parameter->setFromString(std::to_string(value)));
+    }
+
+    ~MaxConcurrentDatabaseClonersGuard() {
+        _parameter->setFromString("1").transitional_ignore();
+    }
+
+private:
+    ServerParameter* _parameter;
+};
+
+BSONObj makeEmptyListCollectionsResponse(const std::string& dbname) {
+    return BSON("ok" << 1 << "cursor"
+                     << BSON("id" << 0LL << "ns" << (dbname + ".$cmd.listCollections")
+                                  << "firstBatch"
+                                  << BSONArray()));
+}
+
+TEST_F(DBsClonerTest, DatabasesAreClonedConcurrentlyUpToTheConfiguredLimit) {
+    MaxConcurrentDatabaseClonersGuard maxConcurrentDatabaseCloners(2);
+    Status result = getDetectableErrorStatus();
+    DatabasesCloner cloner{&getStorage(),
+                           &getExecutor(),
+                           &getDbWorkThreadPool(),
+                           HostAndPort{"local:1234"},
+                           [](const BSONObj&) { return true; },
+                           [&result](const Status& status) {
+                               log() << "setting result to " << status;
+                               result = status;
+                           }};
+
+    ASSERT_OK(cloner.startup());
+    ASSERT_TRUE(cloner.isActive());
+
+    auto net = getNet();
+    executor::NetworkInterfaceMock::InNetworkGuard guard(net);
+    scheduleNetworkResponse("listDatabases",
+                            fromjson("{ok:1, databases:[{name:'a'}, {name:'b'}, {name:'c'}]}"));
+    net->runReadyNetworkOperations();
+    ASSERT_TRUE(cloner.isActive());
+
+    // Databases 'a' and 'b' are cloned at the same time; 'c' waits for one of them to finish.
+    ASSERT_TRUE(net->hasReadyRequests());
+    auto listCollectionsA = net->getNextReadyRequest();
+    ASSERT_TRUE(net->hasReadyRequests());
+    auto listCollectionsB = net->getNextReadyRequest();
+    ASSERT_FALSE(net->hasReadyRequests());
+    ASSERT_EQUALS("a", listCollectionsA->getRequest().dbname);
+    ASSERT_EQUALS("b", listCollectionsB->getRequest().dbname);
+
+    scheduleNetworkResponse(listCollectionsB, makeEmptyListCollectionsResponse("b"));
+    net->runReadyNetworkOperations();
+    ASSERT_TRUE(cloner.isActive());
+
+    ASSERT_TRUE(net->hasReadyRequests());
+    auto listCollectionsC = net->getNextReadyRequest();
+    ASSERT_EQUALS("c", listCollectionsC->getRequest().dbname);
+
+    scheduleNetworkResponse(listCollectionsA, makeEmptyListCollectionsResponse("a"));
+    scheduleNetworkResponse(listCollectionsC, makeEmptyListCollectionsResponse("c"));
+    net->runReadyNetworkOperations();
+
+    cloner.join();
+    ASSERT_FALSE(cloner.isActive());
+    ASSERT_OK(result);
+    ASSERT_EQUALS(3U, cloner.getStats().databasesCloned);
+}
+
+TEST_F(DBsClonerTest, FailureOfOneConcurrentDatabaseShutsDownTheOthers) {
+    MaxConcurrentDatabaseClonersGuard maxConcurrentDatabaseCloners(2);
+    Status result = getDetectableErrorStatus();
+    int finishCalls = 0;
+    DatabasesCloner cloner{&getStorage(),
+                           &getExecutor(),
+                           &getDbWorkThreadPool(),
+                           HostAndPort{"local:1234"},
+                           [](const BSONObj&) { return true; },
+                           [&result, &finishCalls](const Status& status) {
+                               log() << "setting result to " << status;
+                               result = status;
+                               ++finishCalls;
+                           }};
+
+    ASSERT_OK(cloner.startup());
+    ASSERT_TRUE(cloner.isActive());
+
+    auto net = getNet();
+    executor::NetworkInterfaceMock::InNetworkGuard guard(net);
+    scheduleNetworkResponse("listDatabases",
+                            fromjson("{ok:1, databases:[{name:'a'}, {name:'b'}, {name:'c'}]}"));
+    net->runReadyNetworkOperations();
+    ASSERT_TRUE(cloner.isActive());
+
+    // Database 'a' fails while 'b' is still waiting for its listCollections response.
+    processNetworkResponse("listCollections", Status{ErrorCodes::NoSuchKey, "fake"});
+    ASSERT_EQUALS(ErrorCodes::NoSuchKey, result);
+    ASSERT_FALSE(cloner.isActive());
+
+    // The listCollections request for 'b' is canceled and 'c' is never started.
+    net->runReadyNetworkOperations();
+    ASSERT_FALSE(net->hasReadyRequests());
+
+    cloner.join();
+    ASSERT_EQUALS(1, finishCalls);
+    ASSERT_EQUALS(0U, cloner.getStats().databasesCloned);
+}
+
 TEST_F(DBsClonerTest, SingleDatabaseCopiesCompletely) {
     const Responses resps = {
         // Clone Start
@@ -87,6 +87,14 @@ public:
     // This member is not parsed from the BSON and is instead populated by fillWriterVectors.
     bool isForCappedCollection = false;
 
+    // These members are not parsed from the BSON and are instead populated by
+    // SyncTail::OpQueue::precomputeWriterHashes() while the previous batch is being applied.
+    // 'simpleCollationIdHash' is the hash of the _id under the simple collation and is only set for
+    // CRUD ops.
+    bool hasPrecomputedHashes = false;
+    uint32_t nsHash = 0;
+    size_t simpleCollationIdHash = 0;
+
     /**
      * Returns if the oplog entry is for a command operation.
      */
@@ -34,7 +34,9 @@
 #include "mongo/db/repl/sync_tail.h"
 
 #include "third_party/murmurhash3/MurmurHash3.h"
+#include <algorithm>
 #include <boost/functional/hash.hpp>
+#include <map>
 #include <memory>
 
 #include "mongo/base/counter.h"
@@ -48,6 +50,7 @@
 #include "mongo/db/catalog/uuid_catalog.h"
 #include "mongo/db/client.h"
 #include "mongo/db/commands/fsync.h"
+#include "mongo/db/commands/server_status.h"
 #include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
@@ -74,12 +77,15 @@
 #include "mongo/db/stats/timer_stats.h"
 #include "mongo/db/storage/recovery_unit.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/util/concurrency/thread_name.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/net/socket_exception.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/string_map.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -140,6 +146,32 @@ public:
     }
 } exportedBatchLimitOperationsParam;
 
+/**
+ * Number of writer vectors per writer thread that a batch is split into. The vectors are queued on
+ * the writer pool largest first, so a thread that finishes early takes the next vector off the
+ * queue instead of idling until the slowest writer is done.
+ */
+AtomicInt32 replWriterVectorsPerThread{4};
+
+class ExportedWriterVectorsPerThreadParameter
+    : public ExportedServerParameter<int, ServerParameterType::kStartupAndRuntime> {
+public:
+    ExportedWriterVectorsPerThreadParameter()
+        : ExportedServerParameter<int, ServerParameterType::kStartupAndRuntime>(
+              ServerParameterSet::getGlobal(),
+              "replWriterVectorsPerThread",
+              &replWriterVectorsPerThread) {}
+
+    virtual Status validate(const int& potentialNewValue) {
+        if (potentialNewValue < 1 || potentialNewValue > 64) {
+            return Status(ErrorCodes::BadValue,
+                          "replWriterVectorsPerThread must be between 1 and 64, inclusive");
+        }
+
+        return Status::OK();
+    }
+} exportedWriterVectorsPerThreadParam;
+
 // The oplog entries applied
 Counter64 opsAppliedStats;
 ServerStatusMetricField<Counter64> displayOpsApplied("repl.apply.ops", &opsAppliedStats);
@@ -153,6 +185,94 @@ ServerStatusMetricField<Counter64> displayAttemptsToBecomeSecondary(
 TimerStats applyBatchStats;
 ServerStatusMetricField<TimerStats> displayOpBatchesApplied("repl.apply.batches", &applyBatchStats);
 
+/**
+ * Per-writer and per-namespace oplog application counters. Writers update them once per writer
+ * vector rather than once per op, so the mutex is not contended.
+ */
+class OplogApplicationStats {
+public:
+    // Namespaces beyond this many are only counted in 'otherNamespaceOps'.
+    static const size_t kMaxNamespaces = 1000;
+
+    void recordWriterVector(const MultiApplier::OperationPtrs& ops, Microseconds elapsed) {
+        const auto writerName = getThreadName();
+
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        auto& writer = _writers[writerName.toString()];
+        writer.writerVectors++;
+        writer.ops += ops.size();
+        writer.micros += durationCount<Microseconds>(elapsed);
+
+        // Ops in a writer vector are mostly for the same namespace, so count runs of them.
+        size_t i = 0;
+        while (i < ops.size()) {
+            const auto& ns = ops[i]->getNamespace().ns();
+            size_t end = i + 1;
+            while (end < ops.size() && ops[end]->getNamespace().ns() == ns) {
+                end++;
+            }
+
+            auto it = _namespaces.find(ns);
+            if (it != _namespaces.end()) {
+                it->second += end - i;
+            } else if (_namespaces.size() < kMaxNamespaces) {
+                _namespaces[ns] = end - i;
+            } else {
+                _otherNamespaceOps += end - i;
+            }
+            i = end;
+        }
+    }
+
+    BSONObj toBSON() const {
+        BSONObjBuilder result;
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+        BSONObjBuilder writersBuilder(result.subobjStart("writers"));
+        for (auto&& writer : _writers) {
+            BSONObjBuilder writerBuilder(writersBuilder.subobjStart(writer.first));
+            writerBuilder.appendNumber("writerVectors", writer.second.writerVectors);
+            writerBuilder.appendNumber("ops", writer.second.ops);
+            writerBuilder.appendNumber("micros", writer.second.micros);
+        }
+        writersBuilder.doneFast();
+
+        BSONObjBuilder namespacesBuilder(result.subobjStart("namespaces"));
+        for (auto&& ns : _namespaces) {
+            namespacesBuilder.appendNumber(ns.first, ns.second);
+        }
+        namespacesBuilder.doneFast();
+
+        result.appendNumber("otherNamespaceOps", _otherNamespaceOps);
+        return result.obj();
+    }
+
+private:
+    struct WriterStats {
+        long long writerVectors = 0;
+        long long ops = 0;
+        long long micros = 0;
+    };
+
+    mutable stdx::mutex _mutex;
+    std::map<std::string, WriterStats> _writers;
+    StringMap<long long> _namespaces;
+    long long _otherNamespaceOps = 0;
+} oplogApplicationStats;
+
+class OplogApplicationServerStatusSection : public ServerStatusSection {
+public:
+    OplogApplicationServerStatusSection() : ServerStatusSection("oplogApplication") {}
+
+    bool includeByDefault() const {
+        return false;
+    }
+
+    BSONObj generateSection(OperationContext* opCtx, const BSONElement& configElement) const {
+        return oplogApplicationStats.toBSON();
+    }
+} oplogApplicationServerStatusSection;
+
 void initializePrefetchThread() {
     if (!Client::getCurrent()) {
         Client::initThreadIfNotAlready();
@@ -464,19 +584,37 @@ void prefetchOps(const MultiApplier::Operations& ops, OldThreadPool* prefetcherP
 
 // Doles out all the work to the writer pool threads.
 // Does not modify writerVectors, but passes non-const pointers to inner vectors into func.
+// There are usually more writer vectors than threads. They are scheduled largest first so that the
+// long ones are not left to run alone at the end of the batch, and any thread that runs out of work
+// picks up the next vector from the pool's queue.
 void applyOps(std::vector<MultiApplier::OperationPtrs>& writerVectors,
               OldThreadPool* writerPool,
               const MultiApplier::ApplyOperationFn& func,
               std::vector<Status>* statusVector) {
     invariant(writerVectors.size() == statusVector->size());
     TimerHolder timer(&applyBatchStats);
+
+    std::vector<size_t> order;
+    order.reserve(writerVectors.size());
     for (size_t i = 0; i < writerVectors.size(); i++) {
         if (!writerVectors[i].empty()) {
-            writerPool->schedule([&func, &writerVectors, statusVector, i] {
-                (*statusVector)[i] = func(&writerVectors[i]);
-            });
+            order.push_back(i);
         }
     }
+    std::stable_sort(order.begin(), order.end(), [&writerVectors](size_t lhs, size_t rhs) {
+        return writerVectors[lhs].size() > writerVectors[rhs].size();
+    });
+
+    for (auto i : order) {
+        writerPool->schedule([&func, &writerVectors, statusVector, i] {
+            // 'func' may consume the vector, so take the stats first.
+            auto& ops = writerVectors[i];
+            const MultiApplier::OperationPtrs opsForStats(ops);
+            Timer timer;
+            (*statusVector)[i] = func(&ops);
+            oplogApplicationStats.recordWriterVector(opsForStats, Microseconds(timer.micros()));
+        });
+    }
 }
 
 void initializeWriterThread() {
@@ -647,7 +785,10 @@ void fillWriterVectorsAndLatestSessionRecords(
     CachedCollectionProperties collPropertiesCache;
 
     for (auto&& op : *ops) {
-        StringMapTraits::HashedKey hashedNs(op.getNamespace().ns());
+        const auto& ns = op.getNamespace().ns();
+        StringMapTraits::HashedKey hashedNs = op.hasPrecomputedHashes
+            ? StringMapTraits::HashedKey(ns, op.nsHash)
+            : StringMapTraits::HashedKey(ns);
         uint32_t hash = hashedNs.hash();
 
         if (op.isCrudOpType()) {
@@ -659,10 +800,15 @@ void fillWriterVectorsAndLatestSessionRecords(
             // For capped collections, this is illegal, since capped collections must preserve
             // insertion order.
             if (supportsDocLocking && !collProperties.isCapped) {
-                BSONElement id = op.getIdElement();
-                BSONElementComparator elementHasher(BSONElementComparator::FieldNamesMode::kIgnore,
-                                                    collProperties.collator);
-                const size_t idHash = elementHasher.hash(id);
+                size_t idHash;
+                if (op.hasPrecomputedHashes && !collProperties.collator) {
+                    idHash = op.simpleCollationIdHash;
+                } else {
+                    BSONElement id = op.getIdElement();
+                    BSONElementComparator elementHasher(
+                        BSONElementComparator::FieldNamesMode::kIgnore, collProperties.collator);
+                    idHash = elementHasher.hash(id);
+                }
                 MurmurHash3_x86_32(&idHash, sizeof(idHash), hash, &hash);
             }
 
@@ -770,6 +916,18 @@ void tryToGoLiveAsASecondary(OperationContext* opCtx,
 }
 }
 
+void SyncTail::OpQueue::precomputeWriterHashes() {
+    const BSONElementComparator elementHasher(BSONElementComparator::FieldNamesMode::kIgnore,
+                                              nullptr);
+    for (auto&& op : _batch) {
+        op.nsHash = StringMapTraits::hash(op.getNamespace().ns());
+        if (op.isCrudOpType()) {
+            op.simpleCollationIdHash = elementHasher.hash(op.getIdElement());
+        }
+        op.hasPrecomputedHashes = true;
+    }
+}
+
 class SyncTail::OpQueueBatcher {
     MONGO_DISALLOW_COPYING(OpQueueBatcher);
 
@@ -849,6 +1007,10 @@ private:
                 continue;  // Don't emit empty batches.
             }
 
+            // The previous batch is usually still being applied, so do this now rather than on
+            // the applier thread once this batch has been taken.
+            ops.precomputeWriterHashes();
+
             stdx::unique_lock<stdx::mutex> lk(_mutex);
             // Block until the previous batch has been taken.
             _cv.wait(lk, [&] { return _ops.empty(); });
@@ -1513,7 +1675,9 @@ StatusWith<OpTime> multiApply(OperationContext* opCtx,
                 "attempting to replicate ops while primary"};
     }
 
-    std::vector<Status> statusVector(workerPool->getNumThreads(), Status::OK());
+    const size_t numWriterVectors =
+        workerPool->getNumThreads() * static_cast<size_t>(replWriterVectorsPerThread.load());
+    std::vector<Status> statusVector(numWriterVectors, Status::OK());
     {
         const bool pinOldestTimestamp = !serverGlobalParams.enableMajorityReadConcern;
         std::unique_ptr<RecoveryUnit> pinningTransaction;
@@ -1549,7 +1713,7 @@ StatusWith<OpTime> multiApply(OperationContext* opCtx,
         consistencyMarkers->setOplogTruncateAfterPoint(opCtx, ops.front().getTimestamp());
         scheduleWritesToOplog(opCtx, workerPool, ops);
 
-        std::vector<MultiApplier::OperationPtrs> writerVectors(workerPool->getNumThreads());
+        std::vector<MultiApplier::OperationPtrs> writerVectors(numWriterVectors);
         SessionRecordMap latestSessionRecords;
         fillWriterVectorsAndLatestSessionRecords(
             opCtx, &ops, &writerVectors, &latestSessionRecords);
@@ -169,6 +169,12 @@ public:
             _mustShutdown = true;
         }
 
+        /**
+         * Hashes the namespace and _id of each op so that fillWriterVectors does not have to. The
+         * OpQueueBatcher calls this while the previous batch is still being applied.
+         */
+        void precomputeWriterHashes();
+
         /**
          * Leaves this object in an unspecified state. Only assignment and destruction are valid.
          */
@@ -574,6 +574,65 @@ TEST_F(SyncTailTest, MultiApplyAssignsOperationsToWriterThreadsBasedOnNamespaceH
     ASSERT_BSONOBJ_EQ(op2.raw, operationsWrittenToOplog[1].doc);
 }
 
+TEST_F(SyncTailTest, MultiApplySplitsBatchIntoMoreWriterVectorsThanThreads) {
+    OldThreadPool writerPool(2);
+
+    stdx::mutex mutex;
+    std::vector<MultiApplier::Operations> operationsApplied;
+    auto applyOperationFn = [&mutex, &operationsApplied](
+        MultiApplier::OperationPtrs* operationsForWriterThreadToApply) -> Status {
+        stdx::lock_guard<stdx::mutex> lock(mutex);
+        operationsApplied.emplace_back();
+        for (auto&& opPtr : *operationsForWriterThreadToApply) {
+            operationsApplied.back().push_back(*opPtr);
+        }
+        return Status::OK();
+    };
+
+    // Two ops for each of 16 namespaces, with the hashes for half of them computed ahead of time
+    // as the batcher does.
+    SyncTail::OpQueue queue;
+    for (int i = 0; i < 32; i++) {
+        NamespaceString nss("test.t" + std::to_string(i % 16));
+        queue.emplace_back(makeInsertDocumentOplogEntry(
+                               {Timestamp(Seconds(i + 1), 0), 1LL}, nss, BSON("_id" << i))
+                               .raw);
+    }
+    queue.precomputeWriterHashes();
+    auto ops = queue.releaseBatch();
+    for (size_t i = 0; i < ops.size(); i += 2) {
+        ops[i].hasPrecomputedHashes = false;
+    }
+
+    auto lastOpTime =
+        unittest::assertGet(multiApply(_opCtx.get(), &writerPool, ops, applyOperationFn));
+    ASSERT_EQUALS(ops.back().getOpTime(), lastOpTime);
+
+    // The idle thread should have been able to pick up more work than one writer vector, and
+    // both ops for a namespace should have been applied in order by the same writer.
+    stdx::lock_guard<stdx::mutex> lock(mutex);
+    ASSERT_GREATER_THAN(operationsApplied.size(), 2U);
+    size_t numApplied = 0;
+    for (auto&& operationsAppliedByWriter : operationsApplied) {
+        numApplied += operationsAppliedByWriter.size();
+        for (size_t i = 0; i < operationsAppliedByWriter.size(); i++) {
+            const auto& nss = operationsAppliedByWriter[i].getNamespace();
+            size_t count = 0;
+            for (size_t j = 0; j < operationsAppliedByWriter.size(); j++) {
+                if (operationsAppliedByWriter[j].getNamespace() == nss) {
+                    if (j > i) {
+                        ASSERT_LESS_THAN(operationsAppliedByWriter[i].getOpTime(),
+                                         operationsAppliedByWriter[j].getOpTime());
+                    }
+                    count++;
+                }
+            }
+            ASSERT_EQUALS(2U, count);
+        }
+    }
+    ASSERT_EQUALS(ops.size(), numApplied);
+}
+
 TEST_F(SyncTailTest, MultiApplyUpdatesTheTransactionTable) {
     // Set up the transactions collection, which can only be done by the primary.
     ASSERT_OK(ReplicationCoordinator::get(_opCtx.get())->setFollowerMode(MemberState::RS_PRIMARY));
@@ -32,6 +32,8 @@
 
 #include "mongo/db/s/balancer/balancer_chunk_selection_policy_impl.h"
 
+#include <algorithm>
+#include <random>
 #include <set>
 #include <vector>
 
@@ -179,7 +181,7 @@ private:
 }  // namespace
 
 BalancerChunkSelectionPolicyImpl::BalancerChunkSelectionPolicyImpl(ClusterStatistics* clusterStats)
-    : _clusterStats(clusterStats) {}
+    : _clusterStats(clusterStats), _random(std::random_device{}()) {}
 
 BalancerChunkSelectionPolicyImpl::~BalancerChunkSelectionPolicyImpl() = default;
 
@@ -280,9 +282,22 @@ StatusWith<MigrateInfoVector> BalancerChunkSelectionPolicyImpl::selectChunksToMo
         return MigrateInfoVector{};
     }
 
+    // Visit the collections in a different order every round so that, since every shard may take
+    // part in at most one migration per round, no collection is starved by the ones before it
+    std::shuffle(collections.begin(), collections.end(), _random);
+
     MigrateInfoVector candidateChunks;
 
+    // Shards which are already donating or receiving a chunk in this round. Shared across all
+    // collections so that the returned migrations can all be executed in parallel.
+    std::set<ShardId> usedShards;
+
     for (const auto& coll : collections) {
+        // Every migration takes two shards, so stop as soon as no pair of unused shards remains
+        if (usedShards.size() + 1 >= shardStats.size()) {
+            break;
+        }
+
         if (coll.getDropped()) {
             continue;
         }
@@ -296,8 +311,8 @@ StatusWith<MigrateInfoVector> BalancerChunkSelectionPolicyImpl::selectChunksToMo
         }
 
 		//ѡҪǨƵchunk
-        auto candidatesStatus =
-            _getMigrateCandidatesForCollection(opCtx, nss, shardStats, aggressiveBalanceHint);
+        auto candidatesStatus = _getMigrateCandidatesForCollection(
+            opCtx, nss, shardStats, aggressiveBalanceHint, &usedShards);
         if (candidatesStatus == ErrorCodes::NamespaceNotFound) {
             // Namespace got dropped before we managed to get to it, so just skip it
             continue;
@@ -443,7 +458,8 @@ StatusWith<MigrateInfoVector> BalancerChunkSelectionPolicyImpl::_getMigrateCandi
     OperationContext* opCtx,
     const NamespaceString& nss,
     const ShardStatisticsVector& shardStats,
-    bool aggressiveBalanceHint) {
+    bool aggressiveBalanceHint,
+    std::set<ShardId>* usedShards) {
     auto routingInfoStatus =
         Grid::get(opCtx)->catalogCache()->getShardedCollectionRoutingInfoWithRefresh(opCtx, nss);
     if (!routingInfoStatus.isOK()) {
@@ -502,7 +518,7 @@ StatusWith<MigrateInfoVector> BalancerChunkSelectionPolicyImpl::_getMigrateCandi
         }
     }
 
-    return BalancerPolicy::balance(shardStats, distribution, aggressiveBalanceHint);
+    return BalancerPolicy::balance(shardStats, distribution, aggressiveBalanceHint, usedShards);
 }
 
 }  // namespace mongo
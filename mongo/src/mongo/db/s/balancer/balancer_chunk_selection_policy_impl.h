@@ -28,6 +28,9 @@
 
 #pragma once
 
+#include <random>
+#include <set>
+
 #include "mongo/db/s/balancer/balancer_chunk_selection_policy.h"
 
 namespace mongo {
@@ -63,17 +66,23 @@ private:
 
     /**
      * Synchronous method, which iterates the collection's chunks and uses the cluster statistics to
-     * figure out where to place them.
+     * figure out where to place them. Skips the shards in 'usedShards' and adds to it the shards
+     * which participate in the returned migrations.
      */
     StatusWith<MigrateInfoVector> _getMigrateCandidatesForCollection(
         OperationContext* opCtx,
         const NamespaceString& nss,
         const ShardStatisticsVector& shardStats,
-        bool aggressiveBalanceHint);
+        bool aggressiveBalanceHint,
+        std::set<ShardId>* usedShards);
 
     // Source for obtaining cluster statistics. Not owned and must not be destroyed before the
     // policy object is destroyed.
     ClusterStatistics* const _clusterStats;
+
+    // Used to vary the order in which collections are considered for balancing. Only accessed from
+    // the balancer thread.
+    std::minstd_rand _random;
 };
 
 }  // namespace mongo
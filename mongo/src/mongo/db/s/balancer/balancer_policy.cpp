@@ -53,6 +53,34 @@ namespace {
 const size_t kDefaultImbalanceThreshold = 2;
 const size_t kAggressiveImbalanceThreshold = 1;
 
+/**
+ * Returns the relative load of a shard as the sum of its share of the cluster's data and its share
+ * of the cluster's operation rate, so that the result is in the range [0, 2]. Used to choose
+ * between shards, which own the same number of chunks.
+ */
+double computeShardLoad(const ClusterStatistics::ShardStatistics& stat,
+                        uint64_t totalSizeMB,
+                        uint64_t totalOpsPerSec) {
+    double load = 0;
+    if (totalSizeMB) {
+        load += static_cast<double>(stat.currSizeMB) / totalSizeMB;
+    }
+    if (totalOpsPerSec) {
+        load += static_cast<double>(stat.opsPerSec) / totalOpsPerSec;
+    }
+    return load;
+}
+
+std::pair<uint64_t, uint64_t> computeClusterTotals(const ShardStatisticsVector& shardStats) {
+    uint64_t totalSizeMB = 0;
+    uint64_t totalOpsPerSec = 0;
+    for (const auto& stat : shardStats) {
+        totalSizeMB += stat.currSizeMB;
+        totalOpsPerSec += stat.opsPerSec;
+    }
+    return {totalSizeMB, totalOpsPerSec};
+}
+
 }  // namespace
 
 DistributionStatus::DistributionStatus(NamespaceString nss, ShardToChunksMap shardToChunksMap)
@@ -242,8 +270,11 @@ ShardId BalancerPolicy::_getLeastLoadedReceiverShard(const ShardStatisticsVector
                                                      const DistributionStatus& distribution,
                                                      const string& tag,
                                                      const set<ShardId>& excludedShards) {
+    const auto totals = computeClusterTotals(shardStats);
+
     ShardId best;
     unsigned minChunks = numeric_limits<unsigned>::max();
+    double minLoad = 0;
 
     for (const auto& stat : shardStats) {
         if (excludedShards.count(stat.shardId))
@@ -254,13 +285,17 @@ ShardId BalancerPolicy::_getLeastLoadedReceiverShard(const ShardStatisticsVector
             continue;
         }
 
+        // Among shards with the same number of chunks prefer the one with the least data and
+        // traffic
         unsigned myChunks = distribution.numberOfChunksInShard(stat.shardId);
-        if (myChunks >= minChunks) {
+        const double myLoad = computeShardLoad(stat, totals.first, totals.second);
+        if (myChunks > minChunks || (myChunks == minChunks && myLoad >= minLoad)) {
             continue;
         }
 
         best = stat.shardId;
         minChunks = myChunks;
+        minLoad = myLoad;
     }
 
     return best;
@@ -270,20 +305,28 @@ ShardId BalancerPolicy::_getMostOverloadedShard(const ShardStatisticsVector& sha
                                                 const DistributionStatus& distribution,
                                                 const string& chunkTag,
                                                 const set<ShardId>& excludedShards) {
+    const auto totals = computeClusterTotals(shardStats);
+
     ShardId worst;
     unsigned maxChunks = 0;
+    double maxLoad = 0;
 
     for (const auto& stat : shardStats) {
         if (excludedShards.count(stat.shardId))
             continue;
 
+        // Among shards with the same number of chunks prefer to offload the one with the most data
+        // and traffic
         const unsigned shardChunkCount =
             distribution.numberOfChunksInShardWithTag(stat.shardId, chunkTag);
-        if (shardChunkCount <= maxChunks)
+        const double shardLoad = computeShardLoad(stat, totals.first, totals.second);
+        if (shardChunkCount < maxChunks ||
+            (shardChunkCount == maxChunks && (!worst.isValid() || shardLoad <= maxLoad)))
             continue;
 
         worst = stat.shardId;
         maxChunks = shardChunkCount;
+        maxLoad = shardLoad;
     }
 
     return worst;
@@ -292,11 +335,19 @@ ShardId BalancerPolicy::_getMostOverloadedShard(const ShardStatisticsVector& sha
 vector<MigrateInfo> BalancerPolicy::balance(const ShardStatisticsVector& shardStats,
                                             const DistributionStatus& distribution,
                                             bool shouldAggressivelyBalance) {
+    set<ShardId> usedShards;
+    return balance(shardStats, distribution, shouldAggressivelyBalance, &usedShards);
+}
+
+vector<MigrateInfo> BalancerPolicy::balance(const ShardStatisticsVector& shardStats,
+                                            const DistributionStatus& distribution,
+                                            bool shouldAggressivelyBalance,
+                                            set<ShardId>* usedShardsPtr) {
     vector<MigrateInfo> migrations;
 
     // Set of shards, which have already been used for migrations. Used so we don't return multiple
     // migrations for the same shard.
-    set<ShardId> usedShards;
+    set<ShardId>& usedShards = *usedShardsPtr;
 
     // 1) Check for shards, which are in draining mode
     {
@@ -207,11 +207,24 @@ public:
      *
      * The shouldAggressivelyBalance parameter causes the threshold for chunk could disparity
      * between shards to be lowered.
+     *
+     * Among shards with the same number of chunks, donors with more data and traffic and receivers
+     * with less data and traffic are preferred.
      */
     static std::vector<MigrateInfo> balance(const ShardStatisticsVector& shardStats,
                                             const DistributionStatus& distribution,
                                             bool shouldAggressivelyBalance);
 
+    /**
+     * Same as above, but skips the shards in 'usedShards' and adds to it the shards which
+     * participate in the returned migrations. Passing the same set for several collections yields
+     * a round of migrations across all of them, none of which share a donor or recipient shard.
+     */
+    static std::vector<MigrateInfo> balance(const ShardStatisticsVector& shardStats,
+                                            const DistributionStatus& distribution,
+                                            bool shouldAggressivelyBalance,
+                                            std::set<ShardId>* usedShards);
+
     /**
      * Using the specified distribution information, returns a suggested better location for the
      * specified chunk if one is available.
@@ -36,6 +36,7 @@
 #include "mongo/s/catalog/type_chunk.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
 namespace {
@@ -553,6 +554,128 @@ TEST(BalancerPolicy, BalancerHandlesNoShardsWithTag) {
     ASSERT(BalancerPolicy::balance(cluster.first, distribution, false).empty());
 }
 
+TEST(BalancerPolicy, BalancerPrefersLeastLoadedReceiverAmongEqualChunkCounts) {
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 10, false, emptyTagSet, emptyShardVersion), 10},
+         {ShardStatistics(kShardId1, kNoMaxSize, 5, false, emptyTagSet, emptyShardVersion), 0},
+         {ShardStatistics(kShardId2, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0}});
+
+    const auto migrations(BalancerPolicy::balance(
+        cluster.first, DistributionStatus(kNamespace, cluster.second), false));
+    ASSERT_EQ(1U, migrations.size());
+    ASSERT_EQ(kShardId0, migrations[0].from);
+    ASSERT_EQ(kShardId2, migrations[0].to);
+}
+
+TEST(BalancerPolicy, BalancerPrefersBusiestDonorAmongEqualChunkCounts) {
+    auto cluster = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 5, false, emptyTagSet, emptyShardVersion), 5},
+         {ShardStatistics(kShardId1, kNoMaxSize, 5, false, emptyTagSet, emptyShardVersion), 5},
+         {ShardStatistics(kShardId2, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0}});
+    cluster.first[0].opsPerSec = 10;
+    cluster.first[1].opsPerSec = 100;
+
+    const auto migrations(BalancerPolicy::balance(
+        cluster.first, DistributionStatus(kNamespace, cluster.second), false));
+    ASSERT_EQ(1U, migrations.size());
+    ASSERT_EQ(kShardId1, migrations[0].from);
+    ASSERT_EQ(kShardId2, migrations[0].to);
+}
+
+TEST(BalancerPolicy, BalancerSharesUsedShardsAcrossCollections) {
+    auto clusterA = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 4},
+         {ShardStatistics(kShardId1, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0},
+         {ShardStatistics(kShardId2, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0},
+         {ShardStatistics(kShardId3, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0}});
+    auto clusterB = generateCluster(
+        {{ShardStatistics(kShardId0, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0},
+         {ShardStatistics(kShardId1, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0},
+         {ShardStatistics(kShardId2, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 4},
+         {ShardStatistics(kShardId3, kNoMaxSize, 0, false, emptyTagSet, emptyShardVersion), 0}});
+
+    std::set<ShardId> usedShards;
+
+    const auto migrationsA(BalancerPolicy::balance(
+        clusterA.first, DistributionStatus(kNamespace, clusterA.second), false, &usedShards));
+    ASSERT_EQ(1U, migrationsA.size());
+    ASSERT_EQ(kShardId0, migrationsA[0].from);
+    ASSERT_EQ(kShardId1, migrationsA[0].to);
+
+    const auto migrationsB(BalancerPolicy::balance(
+        clusterA.first, DistributionStatus(kNamespace, clusterB.second), false, &usedShards));
+    ASSERT_EQ(1U, migrationsB.size());
+    ASSERT_EQ(kShardId2, migrationsB[0].from);
+    ASSERT_EQ(kShardId3, migrationsB[0].to);
+
+    ASSERT_EQ(4U, usedShards.size());
+    ASSERT(BalancerPolicy::balance(
+               clusterA.first, DistributionStatus(kNamespace, clusterA.second), false, &usedShards)
+               .empty());
+}
+
+TEST(BalancerPolicy, BalancerConvergesOnLargeClusterWithParallelMigrations) {
+    const size_t kNumShards = 100;
+    const size_t kNumDonors = 10;
+    const size_t kChunksPerDonor = 100;
+
+    vector<std::pair<ShardStatistics, size_t>> shardsAndNumChunks;
+    for (size_t i = 0; i < kNumShards; i++) {
+        shardsAndNumChunks.emplace_back(
+            ShardStatistics(
+                ShardId(str::stream() << "shard" << i), kNoMaxSize, 0, false, emptyTagSet, ""),
+            i < kNumDonors ? kChunksPerDonor : 0);
+    }
+
+    auto cluster = generateCluster(shardsAndNumChunks);
+    auto& chunkMap = cluster.second;
+
+    // Simulate balancer rounds, applying every suggested migration before the next round
+    size_t numRounds = 0;
+    while (true) {
+        const auto migrations(BalancerPolicy::balance(
+            cluster.first, DistributionStatus(kNamespace, chunkMap), false));
+        if (migrations.empty())
+            break;
+
+        numRounds++;
+        ASSERT_LTE(numRounds, kNumDonors * kChunksPerDonor);
+
+        // All migrations of a round must be able to run in parallel
+        std::set<ShardId> usedShards;
+        for (const auto& migration : migrations) {
+            ASSERT(usedShards.insert(migration.from).second);
+            ASSERT(usedShards.insert(migration.to).second);
+
+            auto& donorChunks = chunkMap[migration.from];
+            auto it = std::find_if(donorChunks.begin(), donorChunks.end(), [&](const auto& chunk) {
+                return !chunk.getMin().woCompare(migration.minKey);
+            });
+            ASSERT(it != donorChunks.end());
+
+            ChunkType chunk = std::move(*it);
+            donorChunks.erase(it);
+            chunk.setShard(migration.to);
+            chunkMap[migration.to].push_back(std::move(chunk));
+        }
+
+        // Every donor gives away a chunk in every round
+        ASSERT_EQ(kNumDonors, migrations.size());
+    }
+
+    // The donors stop once they are within the imbalance threshold of the ideal of 10 chunks per
+    // shard, so each of them gives away 89 chunks, one per round
+    ASSERT_EQ(89U, numRounds);
+
+    size_t minChunks = std::numeric_limits<size_t>::max();
+    size_t maxChunks = 0;
+    for (const auto& entry : chunkMap) {
+        minChunks = std::min(minChunks, entry.second.size());
+        maxChunks = std::max(maxChunks, entry.second.size());
+    }
+    ASSERT_LTE(maxChunks - minChunks, 2U);
+}
+
 TEST(DistributionStatus, AddTagRangeOverlap) {
     DistributionStatus d(kNamespace, ShardToChunksMap{});
 
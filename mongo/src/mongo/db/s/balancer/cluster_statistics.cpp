@@ -72,6 +72,7 @@ BSONObj ClusterStatistics::ShardStatistics::toBSON() const {
     }
 
     builder.append("version", mongoVersion);
+    builder.append("opsPerSec", static_cast<long long>(opsPerSec));
     return builder.obj();
 }
 
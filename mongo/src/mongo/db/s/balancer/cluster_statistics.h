@@ -94,6 +94,10 @@ public:
 
         // Version of mongod, which runs on this shard's primary
         std::string mongoVersion;
+
+        // Rate of operations served by this shard's primary since the previous statistics
+        // refresh. Zero if unknown.
+        uint64_t opsPerSec{0};
     };
 
     virtual ~ClusterStatistics();
@@ -51,16 +51,19 @@ using std::vector;
 namespace {
 
 const char kVersionField[] = "version";
+const char kOpCountersField[] = "opcounters";
+
+// How long the data size of a shard without a quota is reused before it is fetched again. It only
+// breaks ties between equally loaded shards, so it does not need to be fresh.
+const Minutes kTieBreakShardSizeRefreshInterval(10);
 
 /**
- * Executes the serverStatus command against the specified shard and obtains the version of the
- * running MongoD service.
+ * Executes the serverStatus command against the specified shard and returns its response.
  *
- * Returns the MongoD version in strig format or an error. Known error codes are:
+ * Known error codes are:
  *  ShardNotFound if shard by that id is not available on the registry
- *  NoSuchKey if the version could not be retrieved
  */
-StatusWith<string> retrieveShardMongoDVersion(OperationContext* opCtx, ShardId shardId) {
+StatusWith<BSONObj> retrieveShardServerStatus(OperationContext* opCtx, ShardId shardId) {
     auto shardRegistry = Grid::get(opCtx)->shardRegistry();
     auto shardStatus = shardRegistry->getShard(opCtx, shardId);
     if (!shardStatus.isOK()) {
@@ -81,15 +84,22 @@ StatusWith<string> retrieveShardMongoDVersion(OperationContext* opCtx, ShardId s
         return commandResponse.getValue().commandStatus;
     }
 
-    BSONObj serverStatus = std::move(commandResponse.getValue().response);
+    return std::move(commandResponse.getValue().response);
+}
 
-    string version;
-    Status status = bsonExtractStringField(serverStatus, kVersionField, &version);
-    if (!status.isOK()) {
-        return status;
+/**
+ * Returns the total number of operations the shard primary has served since startup, as reported
+ * in the opcounters section of serverStatus.
+ */
+long long sumOpCounters(const BSONObj& serverStatus) {
+    long long total = 0;
+    for (const auto& elem : serverStatus[kOpCountersField].Obj()) {
+        if (elem.isNumber()) {
+            total += elem.safeNumberLong();
+        }
     }
 
-    return version;
+    return total;
 }
 
 }  // namespace
@@ -120,7 +130,7 @@ StatusWith<vector<ShardStatistics>> ClusterStatisticsImpl::getStats(OperationCon
     for (const auto& shard : shards) {
         const auto shardSizeStatus = [&]() -> StatusWith<long long> {
             if (!shard.getMaxSizeMB()) {
-                return 0;
+                return _getTieBreakShardSize(opCtx, shard.getName());
             }
 
             return shardutil::retrieveTotalShardSize(opCtx, shard.getName());
@@ -137,15 +147,29 @@ StatusWith<vector<ShardStatistics>> ClusterStatisticsImpl::getStats(OperationCon
         }
 
         string mongoDVersion;
+        uint64_t opsPerSec = 0;
+
+        auto serverStatusStatus = retrieveShardServerStatus(opCtx, shard.getName());
+        if (serverStatusStatus.isOK()) {
+            const BSONObj& serverStatus = serverStatusStatus.getValue();
 
-        auto mongoDVersionStatus = retrieveShardMongoDVersion(opCtx, shard.getName());
-        if (mongoDVersionStatus.isOK()) {
-            mongoDVersion = std::move(mongoDVersionStatus.getValue());
-        } else {
             // Since the mongod version is only used for reporting, there is no need to fail the
             // entire round if it cannot be retrieved, so just leave it empty
-            log() << "Unable to obtain shard version for " << shard.getName()
-                  << causedBy(mongoDVersionStatus.getStatus());
+            Status versionStatus =
+                bsonExtractStringField(serverStatus, kVersionField, &mongoDVersion);
+            if (!versionStatus.isOK()) {
+                log() << "Unable to obtain shard version for " << shard.getName()
+                      << causedBy(versionStatus);
+            }
+
+            if (serverStatus[kOpCountersField].type() == Object) {
+                opsPerSec = _updateOpsPerSec(shard.getName(), sumOpCounters(serverStatus));
+            }
+        } else {
+            // The server status is only used for reporting and for weighing otherwise equally
+            // loaded shards, so there is no need to fail the entire round if it cannot be retrieved
+            log() << "Unable to obtain server status for " << shard.getName()
+                  << causedBy(serverStatusStatus.getStatus());
         }
 
         std::set<string> shardTags;
@@ -160,9 +184,57 @@ StatusWith<vector<ShardStatistics>> ClusterStatisticsImpl::getStats(OperationCon
                            shard.getDraining(),
                            std::move(shardTags),
                            std::move(mongoDVersion));
+        stats.back().opsPerSec = opsPerSec;
     }
 
     return stats;
 }
 
+long long ClusterStatisticsImpl::_getTieBreakShardSize(OperationContext* opCtx,
+                                                      const ShardId& shardId) {
+    const Date_t now = Date_t::now();
+
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        auto it = _tieBreakShardSizes.find(shardId);
+        if (it != _tieBreakShardSizes.end() &&
+            now - it->second.first < kTieBreakShardSizeRefreshInterval) {
+            return it->second.second;
+        }
+    }
+
+    auto shardSizeStatus = shardutil::retrieveTotalShardSize(opCtx, shardId);
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto& cached = _tieBreakShardSizes[shardId];
+    if (!shardSizeStatus.isOK()) {
+        // Not worth failing the round over, so keep using the last known size, if any
+        log() << "Unable to obtain data size for " << shardId
+              << causedBy(shardSizeStatus.getStatus());
+        return cached.second;
+    }
+
+    cached = {now, shardSizeStatus.getValue()};
+    return cached.second;
+}
+
+uint64_t ClusterStatisticsImpl::_updateOpsPerSec(const ShardId& shardId, long long totalOps) {
+    const Date_t now = Date_t::now();
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    auto& sample = _opCounterSamples[shardId];
+    const auto prevSample = sample;
+    sample = {now, totalOps};
+
+    // The counters reset when the shard primary restarts or fails over, in which case there is no
+    // meaningful rate until the next sample
+    const long long elapsedMillis = durationCount<Milliseconds>(now - prevSample.first);
+    if (prevSample.first == Date_t() || elapsedMillis <= 0 || totalOps < prevSample.second) {
+        return 0;
+    }
+
+    return static_cast<uint64_t>((totalOps - prevSample.second) * 1000 / elapsedMillis);
+}
+
 }  // namespace mongo
@@ -28,14 +28,19 @@
 
 #pragma once
 
+#include <map>
+#include <utility>
+
 #include "mongo/db/s/balancer/cluster_statistics.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
 /**
  * Default implementation for the cluster statistics gathering utility. Uses a blocking method to
- * fetch the statistics and does not perform any caching. If any of the shards fails to report
- * statistics fails the entire refresh.
+ * fetch the statistics and only caches the data size of shards without a quota. If any of the
+ * shards fails to report statistics fails the entire refresh.
  */
 class ClusterStatisticsImpl final : public ClusterStatistics {
 public:
@@ -44,6 +49,30 @@ public:
 
     //vectorĴСǷƬÿShardStatisticsԱӦһƬ
     StatusWith<std::vector<ShardStatistics>> getStats(OperationContext* opCtx) override;
+
+private:
+    /**
+     * Records the latest total operation count of the specified shard and returns the rate of
+     * operations per second since the previous sample, or zero if there is no usable sample yet.
+     */
+    uint64_t _updateOpsPerSec(const ShardId& shardId, long long totalOps);
+
+    /**
+     * Returns the data size in bytes of a shard without a quota, which is only used to break ties
+     * between equally loaded shards. The size is fetched at most every few minutes, and the last
+     * known size, or zero, is returned if it cannot be obtained.
+     */
+    long long _getTieBreakShardSize(OperationContext* opCtx, const ShardId& shardId);
+
+    // Protects the state below
+    stdx::mutex _mutex;
+
+    // Last observed time and total operation count for each shard, used to derive operation rates
+    // between consecutive statistics refreshes
+    std::map<ShardId, std::pair<Date_t, long long>> _opCounterSamples;
+
+    // Time of the last refresh and data size in bytes of each shard without a quota
+    std::map<ShardId, std::pair<Date_t, long long>> _tieBreakShardSizes;
 };
 
 }  // namespace mongo
@@ -52,13 +52,16 @@
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/s/metadata_manager.h"
+#include "mongo/db/s/range_deletion_throttle.h"
 #include "mongo/db/s/sharding_state.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/write_concern.h"
 #include "mongo/executor/task_executor.h"
+#include "mongo/s/shard_key_pattern.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 namespace {
@@ -100,9 +103,12 @@ boost::optional<Date_t> CollectionRangeDeleter::cleanUpNextRange(
     CollectionRangeDeleter* forTestOnly) {
 
     StatusWith<int> wrote = 0;
+    long long bytesDeleted = 0;
+    Milliseconds deleteTime(0);
 
     auto range = boost::optional<ChunkRange>(boost::none);
     auto notification = DeleteNotification();
+    BSONObj resumeKey;
 
     {
         AutoGetCollection autoColl(opCtx, nss, MODE_IX);
@@ -163,6 +169,7 @@ boost::optional<Date_t> CollectionRangeDeleter::cleanUpNextRange(
             const auto& frontRange = orphans.front().range;
             range.emplace(frontRange.getMin().getOwned(), frontRange.getMax().getOwned());
             notification = orphans.front().notification;
+            resumeKey = self->_resumeKey;
         }
 
         invariant(range);
@@ -201,7 +208,10 @@ boost::optional<Date_t> CollectionRangeDeleter::cleanUpNextRange(
 
         try {
             const auto keyPattern = scopedCollectionMetadata->getKeyPattern();
-            wrote = self->_doDeletion(opCtx, collection, keyPattern, *range, maxToDelete);
+            Timer deleteTimer;
+            wrote = self->_doDeletion(
+                opCtx, collection, keyPattern, *range, maxToDelete, &resumeKey, &bytesDeleted);
+            deleteTime = Milliseconds(deleteTimer.millis());
         } catch (const DBException& e) {
             wrote = e.toStatus();
             warning() << e.what();
@@ -222,6 +232,14 @@ boost::optional<Date_t> CollectionRangeDeleter::cleanUpNextRange(
 
             return Date_t{};
         }
+
+        {
+            // The next batch of this range starts where this one stopped
+            stdx::lock_guard<stdx::mutex> scopedLock(css->_metadataManager->_managerLock);
+            if (!notification.ready()) {
+                self->_resumeKey = resumeKey.getOwned();
+            }
+        }
     }  // drop autoColl
 
     invariant(range);
@@ -232,6 +250,7 @@ boost::optional<Date_t> CollectionRangeDeleter::cleanUpNextRange(
     const auto clientOpTime = repl::ReplClientInfo::forClient(opCtx->getClient()).getLastOp();
 
     // Wait for replication outside the lock
+    Timer replicationTimer;
     const auto status = [&] {
         try {
             WriteConcernResult unusedWCResult;
@@ -241,6 +260,9 @@ boost::optional<Date_t> CollectionRangeDeleter::cleanUpNextRange(
         }
     }();
 
+    RangeDeletionThrottle::get(opCtx)->recordBatch(
+        wrote.getValue(), bytesDeleted, deleteTime, Milliseconds(replicationTimer.millis()));
+
     if (!status.isOK()) {
         LOG(0) << "Error when waiting for write concern after removing " << nss << " range "
                << redact(range->toString()) << " : " << redact(status.reason());
@@ -273,7 +295,9 @@ StatusWith<int> CollectionRangeDeleter::_doDeletion(OperationContext* opCtx,
                                                     Collection* collection,
                                                     BSONObj const& keyPattern,
                                                     ChunkRange const& range,
-                                                    int maxToDelete) {
+                                                    int maxToDelete,
+                                                    BSONObj* resumeKey,
+                                                    long long* bytesDeleted) {
     invariant(collection != nullptr);
     invariant(!isEmpty());
 
@@ -296,7 +320,10 @@ StatusWith<int> CollectionRangeDeleter::_doDeletion(OperationContext* opCtx,
         return Helpers::toKeyFormat(indexKeyPattern.extendRangeBound(key, false));
     };
 
-    const auto min = extend(range.getMin());
+    // Resume from the shard key of the last document removed by the previous batch, so as not to
+    // walk again over the index entries of documents already deleted
+    const bool resuming = !resumeKey->isEmpty();
+    const auto min = extend(resuming ? *resumeKey : range.getMin());
     const auto max = extend(range.getMax());
 
     LOG(1) << "begin removal of " << min << " to " << max << " in " << nss.ns();
@@ -315,16 +342,21 @@ StatusWith<int> CollectionRangeDeleter::_doDeletion(OperationContext* opCtx,
         saver.emplace("moveChunk", nss.ns(), "cleaning");
     }
 
-    int numDeleted = 0;
-    do {
-        auto halfOpen = BoundInclusion::kIncludeStartKeyOnly;
-        auto manual = PlanExecutor::YIELD_MANUAL;
-        auto forward = InternalPlanner::FORWARD;
-        auto fetch = InternalPlanner::IXSCAN_FETCH;
+    const ShardKeyPattern shardKeyPattern(keyPattern);
 
-        auto exec = InternalPlanner::indexScan(
-            opCtx, collection, descriptor, min, max, halfOpen, manual, forward, fetch);
+    // Deletes in shard key order with a single index cursor, which is saved around each deletion
+    auto exec = InternalPlanner::indexScan(opCtx,
+                                           collection,
+                                           descriptor,
+                                           min,
+                                           max,
+                                           BoundInclusion::kIncludeStartKeyOnly,
+                                           PlanExecutor::YIELD_MANUAL,
+                                           InternalPlanner::FORWARD,
+                                           InternalPlanner::IXSCAN_FETCH);
 
+    int numDeleted = 0;
+    do {
         RecordId rloc;
         BSONObj obj;
         PlanExecutor::ExecState state = exec->getNext(&obj, &rloc);
@@ -340,6 +372,16 @@ StatusWith<int> CollectionRangeDeleter::_doDeletion(OperationContext* opCtx,
         }
         invariant(PlanExecutor::ADVANCED == state);
 
+        *resumeKey = shardKeyPattern.extractShardKeyFromDoc(obj);
+        *bytesDeleted += obj.objsize();
+
+        // The document is still needed by the RemoveSaver after the cursor has been saved
+        if (saver) {
+            obj = obj.getOwned();
+        }
+
+        exec->saveState();
+
         writeConflictRetry(opCtx, "delete range", nss.ns(), [&] {
             WriteUnitOfWork wuow(opCtx);
             if (saver) {
@@ -348,8 +390,27 @@ StatusWith<int> CollectionRangeDeleter::_doDeletion(OperationContext* opCtx,
             collection->deleteDocument(opCtx, kUninitializedStmtId, rloc, nullptr, true);
             wuow.commit();
         });
+
+        try {
+            exec->restoreState();
+        } catch (const DBException& ex) {
+            warning() << "error restoring cursor state while trying to delete " << redact(min)
+                      << " to " << redact(max) << " in " << nss
+                      << ", stats: " << Explain::getWinningPlanStats(exec.get()) << ": "
+                      << redact(ex.toStatus());
+            ++numDeleted;
+            break;
+        }
     } while (++numDeleted < maxToDelete);
 
+    // A range is only done once a scan from its start finds nothing, which also catches anything
+    // behind the resume key
+    if (resuming && numDeleted == 0) {
+        *resumeKey = BSONObj();
+        return _doDeletion(
+            opCtx, collection, keyPattern, range, maxToDelete, resumeKey, bytesDeleted);
+    }
+
     return numDeleted;
 }
 
@@ -413,6 +474,7 @@ bool CollectionRangeDeleter::isEmpty() const {
 }
 
 void CollectionRangeDeleter::clear(Status status) {
+    _resumeKey = BSONObj();
     for (auto& range : _orphans) {
         range.notification.notify(status);  // wake up anything still waiting
     }
@@ -424,6 +486,7 @@ void CollectionRangeDeleter::clear(Status status) {
 }
 
 void CollectionRangeDeleter::_pop(Status result) {
+    _resumeKey = BSONObj();
     _orphans.front().notification.notify(result);  // wake up waitForClean
     _orphans.pop_front();
 }
@@ -30,6 +30,7 @@
 #include <list>
 
 #include "mongo/base/disallow_copying.h"
+#include "mongo/bson/bsonobj.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/executor/task_executor.h"
 #include "mongo/s/catalog/type_chunk.h"
@@ -171,8 +172,11 @@ public:
 
 private:
     /**
-     * Performs the deletion of up to maxToDelete entries within the range in progress. Must be
-     * called under the collection lock.
+     * Performs the deletion of up to maxToDelete entries within the range in progress, in shard key
+     * order. Must be called under the collection lock.
+     *
+     * Starts from 'resumeKey' if it is not empty, and sets it to the shard key of the last document
+     * deleted. Adds the sizes of the deleted documents to 'bytesDeleted'.
      *
      * Returns the number of documents deleted, 0 if done with the range, or bad status if deleting
      * the range failed.
@@ -181,7 +185,9 @@ private:
                                 Collection* collection,
                                 const BSONObj& keyPattern,
                                 ChunkRange const& range,
-                                int maxToDelete);
+                                int maxToDelete,
+                                BSONObj* resumeKey,
+                                long long* bytesDeleted);
 
     /**
      * Removes the latest-scheduled range from the ranges to be cleaned up, and notifies any
@@ -195,6 +201,10 @@ private:
      */
     std::list<Deletion> _orphans;
     std::list<Deletion> _delayedOrphans;
+
+    // Shard key of the last document deleted from the front range, from which its next batch
+    // starts. Empty before the first batch of a range.
+    BSONObj _resumeKey;
 };
 
 }  // namespace mongo
@@ -41,6 +41,7 @@
 #include "mongo/db/range_arithmetic.h"
 #include "mongo/db/s/collection_range_deleter.h"
 #include "mongo/db/s/collection_sharding_state.h"
+#include "mongo/db/s/range_deletion_throttle.h"
 #include "mongo/db/s/sharding_state.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/assert_util.h"
@@ -136,13 +137,17 @@ void scheduleCleanup(executor::TaskExecutor* executor,
             auto uniqueOpCtx = Client::getCurrent()->makeOperationContext();
             auto opCtx = uniqueOpCtx.get();
 
-            const int maxToDelete = std::max(int(internalQueryExecYieldIterations.load()), 1);
+            auto* const throttle = RangeDeletionThrottle::get(opCtx);
+            const int maxToDelete = throttle->getBatchSize();
 
             MONGO_FAIL_POINT_PAUSE_WHILE_SET(suspendRangeDeletion);
 
             auto next = CollectionRangeDeleter::cleanUpNextRange(opCtx, nss, epoch, maxToDelete);
             if (next) {
-                scheduleCleanup(executor, std::move(nss), std::move(epoch), *next);
+                scheduleCleanup(executor,
+                                std::move(nss),
+                                std::move(epoch),
+                                std::max(*next, throttle->getNextBatchTime(opCtx)));
             }
         });
 
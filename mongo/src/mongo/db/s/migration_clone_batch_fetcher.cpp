@@ -0,0 +1,126 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/s/migration_clone_batch_fetcher.h"
+
+#include "mongo/db/client.h"
+#include "mongo/db/operation_context.h"
+
+namespace mongo {
+
+MigrationCloneBatchFetcher::MigrationCloneBatchFetcher(FetchBatchFn fetchBatchFn,
+                                                       int numFetchers,
+                                                       size_t maxBufferedBatches)
+    : _fetchBatchFn(std::move(fetchBatchFn)),
+      _maxBufferedBatches(maxBufferedBatches),
+      _numActiveFetchers(numFetchers) {
+    for (int i = 0; i < numFetchers; ++i) {
+        _fetchers.emplace_back([this] { _fetchLoop(); });
+    }
+}
+
+MigrationCloneBatchFetcher::~MigrationCloneBatchFetcher() {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _shutdown = true;
+    }
+    _cv.notify_all();
+
+    for (auto& fetcher : _fetchers) {
+        fetcher.join();
+    }
+}
+
+StatusWith<BSONObj> MigrationCloneBatchFetcher::next(OperationContext* opCtx) {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    opCtx->waitForConditionOrInterrupt(_cv, lk, [&] {
+        return !_status.isOK() || !_batches.empty() || _numActiveFetchers == 0;
+    });
+
+    if (!_status.isOK()) {
+        return _status;
+    }
+
+    if (_batches.empty()) {
+        return BSONObj();
+    }
+
+    BSONObj batch = std::move(_batches.front());
+    _batches.pop_front();
+    _cv.notify_all();
+
+    return batch;
+}
+
+void MigrationCloneBatchFetcher::_fetchLoop() {
+    Client::initThread("migrateCloneFetcher");
+
+    try {
+        while (true) {
+            {
+                stdx::unique_lock<stdx::mutex> lk(_mutex);
+                _cv.wait(lk, [&] {
+                    return _shutdown || _exhausted || !_status.isOK() ||
+                        _batches.size() < _maxBufferedBatches;
+                });
+
+                if (_shutdown || _exhausted || !_status.isOK()) {
+                    break;
+                }
+            }
+
+            BSONObj res = _fetchBatchFn();
+
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            if (res["objects"].Obj().isEmpty()) {
+                _exhausted = true;
+            } else {
+                _batches.push_back(res.getOwned());
+            }
+            _cv.notify_all();
+        }
+    } catch (const DBException& ex) {
+        _setError(ex.toStatus());
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    --_numActiveFetchers;
+    _cv.notify_all();
+}
+
+void MigrationCloneBatchFetcher::_setError(Status status) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (_status.isOK()) {
+        _status = std::move(status);
+    }
+    _cv.notify_all();
+}
+
+}  // namespace mongo
@@ -0,0 +1,110 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <deque>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status_with.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+
+namespace mongo {
+
+class OperationContext;
+
+/**
+ * Requests _migrateClone batches from the donor shard on several threads and buffers the
+ * responses for the migrate thread to insert. The donor hands out disjoint sets of documents to
+ * concurrent _migrateClone requests, so batches may be inserted in whichever order they arrive.
+ */
+class MigrationCloneBatchFetcher {
+    MONGO_DISALLOW_COPYING(MigrationCloneBatchFetcher);
+
+public:
+    /**
+     * Runs one _migrateClone request against the donor and returns its response. Called
+     * concurrently from all the fetcher threads. Reports failures by throwing.
+     */
+    using FetchBatchFn = stdx::function<BSONObj()>;
+
+    /**
+     * Starts 'numFetchers' threads, each of which keeps calling 'fetchBatchFn' until the donor
+     * returns an empty batch, while at most 'maxBufferedBatches' responses are waiting in next().
+     */
+    MigrationCloneBatchFetcher(FetchBatchFn fetchBatchFn,
+                               int numFetchers,
+                               size_t maxBufferedBatches);
+
+    /**
+     * Stops the fetcher threads and waits for them to exit. A request which is already in
+     * progress is allowed to complete and its response is discarded.
+     */
+    ~MigrationCloneBatchFetcher();
+
+    /**
+     * Blocks until a _migrateClone response is available and returns it, or returns an empty
+     * object once the donor has no more documents to clone. Returns the error of the first failed
+     * _migrateClone request, if any.
+     */
+    StatusWith<BSONObj> next(OperationContext* opCtx);
+
+private:
+    void _fetchLoop();
+
+    void _setError(Status status);
+
+    const FetchBatchFn _fetchBatchFn;
+    const size_t _maxBufferedBatches;
+
+    // Protects the members below
+    stdx::mutex _mutex;
+    stdx::condition_variable _cv;
+
+    // Fetched _migrateClone responses which have not been returned by next() yet
+    std::deque<BSONObj> _batches;
+
+    // The error of the first failed _migrateClone request
+    Status _status{Status::OK()};
+
+    int _numActiveFetchers;
+
+    // Set once the donor returns an empty batch, after which no more requests are issued
+    bool _exhausted{false};
+
+    bool _shutdown{false};
+
+    std::vector<stdx::thread> _fetchers;
+};
+
+}  // namespace mongo
@@ -0,0 +1,218 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <set>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/s/migration_clone_batch_fetcher.h"
+#include "mongo/s/shard_server_test_fixture.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+namespace {
+
+const int kDocsPerBatch = 3;
+
+/**
+ * Stands in for the donor shard. Each call to fetchBatch() hands out the next batch of
+ * kDocsPerBatch documents, until 'numBatches' batches have been handed out, after which it
+ * returns empty batches, the same as _migrateClone does once the chunk has been cloned.
+ */
+class FakeDonor {
+public:
+    explicit FakeDonor(int numBatches) : _numBatches(numBatches) {}
+
+    BSONObj fetchBatch() {
+        int batchNum;
+        {
+            stdx::unique_lock<stdx::mutex> lk(_mutex);
+            ++_numRequests;
+            ++_numInProgress;
+            _cv.notify_all();
+
+            // Hold the first requests until the expected number of them are running at the same
+            // time, which can only happen if they come from different fetcher threads.
+            _cv.wait(lk, [&] { return _numInProgress >= _waitForConcurrentRequests; });
+            _waitForConcurrentRequests = 0;
+
+            if (_failAtRequest == _numRequests) {
+                --_numInProgress;
+                uasserted(ErrorCodes::OperationFailed, "Fake _migrateClone failure");
+            }
+
+            batchNum = _nextBatch++;
+            --_numInProgress;
+        }
+
+        BSONArrayBuilder objects;
+        if (batchNum < _numBatches) {
+            for (int i = 0; i < kDocsPerBatch; ++i) {
+                objects.append(BSON("_id" << batchNum * kDocsPerBatch + i));
+            }
+        }
+
+        return BSON("objects" << objects.arr());
+    }
+
+    void waitForConcurrentRequests(int numRequests) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _waitForConcurrentRequests = numRequests;
+    }
+
+    void failAtRequest(int requestNum) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _failAtRequest = requestNum;
+    }
+
+    void waitForNumRequests(int numRequests) {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _cv.wait(lk, [&] { return _numRequests >= numRequests; });
+    }
+
+    int numRequests() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _numRequests;
+    }
+
+    MigrationCloneBatchFetcher::FetchBatchFn fetchBatchFn() {
+        return [this] { return fetchBatch(); };
+    }
+
+private:
+    const int _numBatches;
+
+    stdx::mutex _mutex;
+    stdx::condition_variable _cv;
+
+    int _numRequests{0};
+    int _numInProgress{0};
+    int _nextBatch{0};
+    int _waitForConcurrentRequests{0};
+    int _failAtRequest{0};
+};
+
+using MigrationCloneBatchFetcherTest = ShardServerTestFixture;
+
+/**
+ * Calls next() until the fetcher reports that the donor is exhausted and returns the _id of every
+ * document returned.
+ */
+std::multiset<int> fetchAll(OperationContext* opCtx, MigrationCloneBatchFetcher* fetcher) {
+    std::multiset<int> ids;
+    while (true) {
+        auto batch = unittest::assertGet(fetcher->next(opCtx));
+        if (batch.isEmpty()) {
+            break;
+        }
+
+        for (const auto& elem : batch["objects"].Obj()) {
+            ids.insert(elem.Obj()["_id"].numberInt());
+        }
+    }
+    return ids;
+}
+
+TEST_F(MigrationCloneBatchFetcherTest, ReturnsEmptyObjectWhenDonorHasNothingToClone) {
+    FakeDonor donor(0);
+    MigrationCloneBatchFetcher fetcher(donor.fetchBatchFn(), 2, 4);
+
+    ASSERT(fetchAll(operationContext(), &fetcher).empty());
+}
+
+TEST_F(MigrationCloneBatchFetcherTest, SeveralFetchersReturnEveryDocumentExactlyOnce) {
+    const int kNumFetchers = 4;
+    const int kNumBatches = 50;
+
+    FakeDonor donor(kNumBatches);
+    donor.waitForConcurrentRequests(kNumFetchers);
+    MigrationCloneBatchFetcher fetcher(donor.fetchBatchFn(), kNumFetchers, 2);
+
+    const auto ids = fetchAll(operationContext(), &fetcher);
+    ASSERT_EQ(static_cast<size_t>(kNumBatches * kDocsPerBatch), ids.size());
+    for (int id = 0; id < kNumBatches * kDocsPerBatch; ++id) {
+        ASSERT_EQ(1U, ids.count(id));
+    }
+}
+
+TEST_F(MigrationCloneBatchFetcherTest, StopsFetchingWhileBufferIsFull) {
+    FakeDonor donor(10);
+    MigrationCloneBatchFetcher fetcher(donor.fetchBatchFn(), 1, 2);
+
+    donor.waitForNumRequests(2);
+    sleepmillis(100);
+    ASSERT_EQ(2, donor.numRequests());
+
+    // Consuming one batch makes room for exactly one more
+    auto batch = unittest::assertGet(fetcher.next(operationContext()));
+    ASSERT_EQ(kDocsPerBatch, batch["objects"].Obj().nFields());
+
+    donor.waitForNumRequests(3);
+    sleepmillis(100);
+    ASSERT_EQ(3, donor.numRequests());
+}
+
+TEST_F(MigrationCloneBatchFetcherTest, FailedRequestIsReturnedByNext) {
+    FakeDonor donor(10);
+    donor.failAtRequest(3);
+    MigrationCloneBatchFetcher fetcher(donor.fetchBatchFn(), 2, 4);
+
+    while (true) {
+        auto swBatch = fetcher.next(operationContext());
+        if (!swBatch.isOK()) {
+            ASSERT_EQ(ErrorCodes::OperationFailed, swBatch.getStatus());
+            break;
+        }
+
+        ASSERT_FALSE(swBatch.getValue().isEmpty());
+    }
+
+    // The failure sticks, even though the other fetcher may have buffered more batches
+    ASSERT_EQ(ErrorCodes::OperationFailed, fetcher.next(operationContext()).getStatus());
+}
+
+TEST_F(MigrationCloneBatchFetcherTest, DestructorStopsFetchersWaitingOnFullBuffer) {
+    FakeDonor donor(1000);
+
+    {
+        MigrationCloneBatchFetcher fetcher(donor.fetchBatchFn(), 3, 1);
+        donor.waitForNumRequests(1);
+    }
+
+    const int numRequests = donor.numRequests();
+    sleepmillis(100);
+    ASSERT_EQ(numRequests, donor.numRequests());
+}
+
+}  // namespace
+}  // namespace mongo
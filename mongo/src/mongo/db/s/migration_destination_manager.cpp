@@ -43,6 +43,7 @@
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/catalog/document_validation.h"
 #include "mongo/db/catalog/index_create.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/namespace_string.h"
@@ -53,15 +54,19 @@
 #include "mongo/db/s/collection_metadata.h"
 #include "mongo/db/s/collection_range_deleter.h"
 #include "mongo/db/s/collection_sharding_state.h"
+#include "mongo/db/s/migration_clone_batch_fetcher.h"
 #include "mongo/db/s/migration_util.h"
 #include "mongo/db/s/move_timing_helper.h"
 #include "mongo/db/s/sharding_state.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/s/catalog/type_chunk.h"
 #include "mongo/s/client/shard_registry.h"
 #include "mongo/s/grid.h"
 #include "mongo/s/shard_key_pattern.h"
 #include "mongo/stdx/chrono.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/concurrency/notification.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
@@ -74,6 +79,14 @@ using str::stream;
 
 namespace {
 
+// The number of connections on which the recipient concurrently requests _migrateClone batches
+// from the donor shard.
+MONGO_EXPORT_SERVER_PARAMETER(migrateCloneFetcherThreads, int, 2);
+
+// The number of fetched _migrateClone batches which may wait to be inserted before the fetchers
+// stop requesting more.
+MONGO_EXPORT_SERVER_PARAMETER(migrateCloneMaxBufferedBatches, int, 4);
+
 const WriteConcernOptions kMajorityWriteConcern(WriteConcernOptions::kMajority,
                                                 // Note: Even though we're setting UNSET here,
                                                 // kMajority implies JOURNAL if journaling is
@@ -442,6 +455,61 @@ Status MigrationDestinationManager::startCommit(const MigrationSessionId& sessio
     return Status::OK();
 }
 
+void MigrationDestinationManager::insertClonedBatch(OperationContext* opCtx,
+                                                    const NamespaceString& nss,
+                                                    const BSONObj& min,
+                                                    const BSONObj& max,
+                                                    const BSONObj& shardKeyPattern,
+                                                    const BSONObj& docsToClone) {
+    writeConflictRetry(opCtx, "migrateCloneBatch", nss.ns(), [&] {
+        OldClientWriteContext cx(opCtx, nss.ns());
+
+        Collection* const collection = cx.db()->getCollection(opCtx, nss);
+        uassert(ErrorCodes::NamespaceNotFound,
+                str::stream() << "Collection " << nss.ns() << " was dropped during migration",
+                collection);
+
+        std::vector<InsertStatement> toInsert;
+        for (const auto& elem : docsToClone) {
+            const BSONObj docToClone = elem.Obj();
+
+            BSONObj localDoc;
+            if (willOverrideLocalId(
+                    opCtx, nss, min, max, shardKeyPattern, cx.db(), docToClone, &localDoc)) {
+                string errMsg = str::stream() << "cannot migrate chunk, local document "
+                                              << redact(localDoc)
+                                              << " has same _id as cloned "
+                                              << "remote document " << redact(docToClone);
+
+                warning() << errMsg;
+
+                // Exception will abort migration cleanly
+                uasserted(16976, errMsg);
+            }
+
+            if (!localDoc.isEmpty()) {
+                Helpers::upsert(opCtx, nss.ns(), docToClone, true);
+                continue;
+            }
+
+            toInsert.emplace_back(docToClone);
+        }
+
+        if (toInsert.empty()) {
+            return;
+        }
+
+        WriteUnitOfWork wuow(opCtx);
+        uassertStatusOK(collection->insertDocuments(opCtx,
+                                                    toInsert.begin(),
+                                                    toInsert.end(),
+                                                    nullptr /* opDebug */,
+                                                    true /* enforceQuota */,
+                                                    true /* fromMigrate */));
+        wuow.commit();
+    });
+}
+
 //ĿķƬǨchunkݵ̻߳صMigrationDestinationManager::start
 void MigrationDestinationManager::_migrateThread(BSONObj min,
                                                  BSONObj max,
@@ -734,82 +802,71 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* opCtx,
 
         _chunkMarkedPending = true;  // no lock needed, only the migrate thread looks.
 
+        MigrationCloneBatchFetcher fetcher(
+            [fromShardConnString, migrateCloneRequest] {
+                ScopedDbConnection conn(fromShardConnString);
+
+                BSONObj res;
+                if (!conn->runCommand("admin", migrateCloneRequest, res)) {
+                    conn.done();
+                    uasserted(ErrorCodes::OperationFailed,
+                              str::stream() << "_migrateClone failed: "
+                                            << redact(res.toString()));
+                }
+
+                conn.done();
+                return res.getOwned();
+            },
+            std::max(1, migrateCloneFetcherThreads.load()),
+            std::max(1, migrateCloneMaxBufferedBatches.load()));
+
         while (true) {
-            BSONObj res;
-            if (!conn->runCommand("admin",
-                                  migrateCloneRequest,
-                                  res)) {  // gets array of objects to copy, in disk order
-                setStateFail(str::stream() << "_migrateClone failed: " << redact(res.toString()));
+            // Gets an array of objects to copy, in disk order
+            auto swRes = fetcher.next(opCtx);
+            if (!swRes.isOK()) {
+                setStateFail(swRes.getStatus().reason());
                 conn.done();
                 return;
             }
 
-            BSONObj arr = res["objects"].Obj();
-            int thisTime = 0;
-
-            BSONObjIterator i(arr);
-            while (i.more()) {
-                opCtx->checkForInterrupt();
+            const BSONObj& res = swRes.getValue();
+            if (res.isEmpty())
+                break;
 
-                if (getState() == ABORT) {
-                    log() << "Migration aborted while copying documents";
-                    return;
-                }
+            opCtx->checkForInterrupt();
 
-                BSONObj docToClone = i.next().Obj();
-                {
-                    OldClientWriteContext cx(opCtx, _nss.ns());
-
-                    BSONObj localDoc;
-                    if (willOverrideLocalId(opCtx,
-                                            _nss,
-                                            min,
-                                            max,
-                                            shardKeyPattern,
-                                            cx.db(),
-                                            docToClone,
-                                            &localDoc)) {
-                        string errMsg = str::stream() << "cannot migrate chunk, local document "
-                                                      << redact(localDoc)
-                                                      << " has same _id as cloned "
-                                                      << "remote document " << redact(docToClone);
-
-                        warning() << errMsg;
-
-                        // Exception will abort migration cleanly
-                        uasserted(16976, errMsg);
-                    }
+            if (getState() == ABORT) {
+                log() << "Migration aborted while copying documents";
+                return;
+            }
 
-                    Helpers::upsert(opCtx, _nss.ns(), docToClone, true);
-                }
-                thisTime++;
+            BSONObj arr = res["objects"].Obj();
+            insertClonedBatch(opCtx, _nss, min, max, shardKeyPattern, arr);
 
-                {
-                    stdx::lock_guard<stdx::mutex> statsLock(_mutex);
+            {
+                stdx::lock_guard<stdx::mutex> statsLock(_mutex);
+                for (const auto& elem : arr) {
                     _numCloned++;
-                    _clonedBytes += docToClone.objsize();
+                    _clonedBytes += elem.Obj().objsize();
                 }
+            }
 
-                if (writeConcern.shouldWaitForOtherNodes()) {
-                    repl::ReplicationCoordinator::StatusAndDuration replStatus =
-                        repl::getGlobalReplicationCoordinator()->awaitReplication(
-                            opCtx,
-                            repl::ReplClientInfo::forClient(opCtx->getClient()).getLastOp(),
-                            writeConcern);
-                    if (replStatus.status.code() == ErrorCodes::WriteConcernFailed) {
-                        warning() << "secondaryThrottle on, but doc insert timed out; "
-                                     "continuing";
-                    } else {
-                        massertStatusOK(replStatus.status);
-                    }
+            if (writeConcern.shouldWaitForOtherNodes()) {
+                repl::ReplicationCoordinator::StatusAndDuration replStatus =
+                    repl::getGlobalReplicationCoordinator()->awaitReplication(
+                        opCtx,
+                        repl::ReplClientInfo::forClient(opCtx->getClient()).getLastOp(),
+                        writeConcern);
+                if (replStatus.status.code() == ErrorCodes::WriteConcernFailed) {
+                    warning() << "secondaryThrottle on, but doc insert timed out; "
+                                 "continuing";
+                } else {
+                    massertStatusOK(replStatus.status);
                 }
             }
-
-            if (thisTime == 0)
-                break;
         }
 
-        timing.done(3);
+        timing.done(3, _clonedBytes);
         MONGO_FAIL_POINT_PAUSE_WHILE_SET(migrateThreadHangAtStep3);
 
         if (MONGO_FAIL_POINT(failMigrationLeaveOrphans)) {
@@ -829,6 +886,7 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* opCtx,
         // 4. Do bulk of mods   Ǩƹ
         setState(CATCHUP);
 
+        long long transferredModsBytes = 0;
         while (true) {
             BSONObj res;
             if (!conn->runCommand("admin", xferModsRequest, res)) {
@@ -837,6 +895,8 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* opCtx,
                 return;
             }
 
+            transferredModsBytes += res.objsize();
+
 			//û
             if (res["size"].number() == 0) {
                 break;
@@ -872,7 +932,7 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* opCtx,
             }
         }
 
-        timing.done(4);
+        timing.done(4, transferredModsBytes);
         MONGO_FAIL_POINT_PAUSE_WHILE_SET(migrateThreadHangAtStep4);
     }
 
@@ -129,6 +129,22 @@ public:
 
     Status startCommit(const MigrationSessionId& sessionId);
 
+    /**
+     * Inserts the documents of one _migrateClone batch. Documents which do not exist locally are
+     * inserted together through a single insertDocuments call, so that each index is maintained
+     * once for the whole batch rather than once per document. Documents whose _id already exists
+     * within the chunk range are upserted. Throws if a document's _id already exists outside of the
+     * chunk range.
+     *
+     * Exposed for unit testing.
+     */
+    static void insertClonedBatch(OperationContext* opCtx,
+                                  const NamespaceString& nss,
+                                  const BSONObj& min,
+                                  const BSONObj& max,
+                                  const BSONObj& shardKeyPattern,
+                                  const BSONObj& docsToClone);
+
 private:
     /**
      * Thread which drives the migration apply process on the recipient side.
@@ -0,0 +1,145 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/client/dbclientcursor.h"
+#include "mongo/db/dbdirectclient.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/s/migration_destination_manager.h"
+#include "mongo/s/shard_server_test_fixture.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const NamespaceString kNss("TestDB", "TestColl");
+const BSONObj kShardKeyPattern{BSON("X" << 1)};
+const BSONObj kChunkMin{BSON("X" << 0)};
+const BSONObj kChunkMax{BSON("X" << 100)};
+
+class MigrationDestinationManagerTest : public ShardServerTestFixture {
+protected:
+    void setUp() override {
+        ShardServerTestFixture::setUp();
+
+        _client.emplace(operationContext());
+
+        ASSERT(client()->createCollection(kNss.ns()));
+        client()->createIndex(kNss.ns(), kShardKeyPattern);
+        client()->createIndex(kNss.ns(), BSON("Y" << 1));
+    }
+
+    void tearDown() override {
+        _client.reset();
+
+        ShardServerTestFixture::tearDown();
+    }
+
+    DBDirectClient* client() {
+        invariant(_client);
+        return _client.get_ptr();
+    }
+
+    void insertClonedBatch(const BSONArray& docs) {
+        MigrationDestinationManager::insertClonedBatch(
+            operationContext(), kNss, kChunkMin, kChunkMax, kShardKeyPattern, docs);
+    }
+
+    /**
+     * Returns the number of documents matching 'query' when answered through the index on Y, so
+     * that a stale or missing index entry shows up as a wrong count.
+     */
+    int countUsingIndexOnY(const BSONObj& query) {
+        return client()->query(kNss.ns(), Query(query).hint(BSON("Y" << 1)))->itcount();
+    }
+
+private:
+    boost::optional<DBDirectClient> _client;
+};
+
+TEST_F(MigrationDestinationManagerTest, InsertClonedBatchInsertsNewDocumentsIntoEveryIndex) {
+    BSONArrayBuilder docs;
+    for (int i = 0; i < 50; ++i) {
+        docs.append(BSON("_id" << i << "X" << i << "Y" << i % 5));
+    }
+
+    insertClonedBatch(docs.arr());
+
+    ASSERT_EQ(50U, client()->count(kNss.ns()));
+    ASSERT_EQ(10, countUsingIndexOnY(BSON("Y" << 3)));
+    ASSERT_EQ(50, client()->query(kNss.ns(), Query().hint(kShardKeyPattern))->itcount());
+}
+
+TEST_F(MigrationDestinationManagerTest, InsertClonedBatchUpsertsDocumentsAlreadyInTheChunkRange) {
+    client()->insert(kNss.ns(), BSON("_id" << 1 << "X" << 1 << "Y" << 0));
+    client()->insert(kNss.ns(), BSON("_id" << 2 << "X" << 2 << "Y" << 0));
+
+    insertClonedBatch(BSON_ARRAY(BSON("_id" << 1 << "X" << 1 << "Y" << 10)
+                                 << BSON("_id" << 3 << "X" << 3 << "Y" << 30)
+                                 << BSON("_id" << 2 << "X" << 2 << "Y" << 20)));
+
+    ASSERT_EQ(3U, client()->count(kNss.ns()));
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 1 << "X" << 1 << "Y" << 10),
+                      client()->findOne(kNss.ns(), QUERY("_id" << 1)));
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 2 << "X" << 2 << "Y" << 20),
+                      client()->findOne(kNss.ns(), QUERY("_id" << 2)));
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 3 << "X" << 3 << "Y" << 30),
+                      client()->findOne(kNss.ns(), QUERY("_id" << 3)));
+
+    // The secondary index must reflect the upserted versions only
+    ASSERT_EQ(0, countUsingIndexOnY(BSON("Y" << 0)));
+    ASSERT_EQ(1, countUsingIndexOnY(BSON("Y" << 10)));
+    ASSERT_EQ(1, countUsingIndexOnY(BSON("Y" << 20)));
+    ASSERT_EQ(1, countUsingIndexOnY(BSON("Y" << 30)));
+}
+
+TEST_F(MigrationDestinationManagerTest, InsertClonedBatchFailsIfIdExistsOutsideTheChunkRange) {
+    client()->insert(kNss.ns(), BSON("_id" << 1 << "X" << 500 << "Y" << 0));
+
+    ASSERT_THROWS_CODE(insertClonedBatch(BSON_ARRAY(BSON("_id" << 2 << "X" << 2 << "Y" << 2)
+                                                    << BSON("_id" << 1 << "X" << 1 << "Y" << 1))),
+                       AssertionException,
+                       ErrorCodes::Error(16976));
+
+    // Nothing from the failed batch was inserted and the local document was left alone
+    ASSERT_EQ(1U, client()->count(kNss.ns()));
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 1 << "X" << 500 << "Y" << 0),
+                      client()->findOne(kNss.ns(), QUERY("_id" << 1)));
+}
+
+TEST_F(MigrationDestinationManagerTest, InsertClonedBatchFailsIfCollectionWasDropped) {
+    ASSERT(client()->dropCollection(kNss.ns()));
+
+    ASSERT_THROWS_CODE(insertClonedBatch(BSON_ARRAY(BSON("_id" << 1 << "X" << 1 << "Y" << 1))),
+                       AssertionException,
+                       ErrorCodes::NamespaceNotFound);
+}
+
+}  // namespace
+}  // namespace mongo
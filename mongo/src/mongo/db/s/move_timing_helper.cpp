@@ -72,6 +72,11 @@ MoveTimingHelper::~MoveTimingHelper() {
             _b.append("from", _from.toString());
         }
 
+        BSONObj bytesPerSec = _bytesPerSecBuilder.obj();
+        if (!bytesPerSec.isEmpty()) {
+            _b.append("bytesPerSec", bytesPerSec);
+        }
+
         if (_nextStep != _totalNumSteps) {
             _b.append("note", "aborted");
         } else {
@@ -114,4 +119,17 @@ void MoveTimingHelper::done(int step) {
     _t.reset();
 }
 
+void MoveTimingHelper::done(int step, long long numBytes) {
+    const long long micros = _t.micros();
+
+    done(step);
+
+    const std::string s = str::stream() << "step " << step << " of " << _totalNumSteps;
+    _bytesPerSecBuilder.appendNumber(
+        s, micros > 0 ? static_cast<long long>(numBytes * 1000000.0 / micros) : numBytes);
+
+    log() << "moveChunk." << _where << " " << s << " transferred " << numBytes << " bytes in "
+          << micros / 1000 << "ms";
+}
+
 }  // namespace mongo
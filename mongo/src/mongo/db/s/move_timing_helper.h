@@ -55,6 +55,11 @@ public:
 
     void done(int step);
 
+    /**
+     * Same as done(step), but also records the throughput of a step which transferred 'numBytes'.
+     */
+    void done(int step, long long numBytes);
+
 private:
     // Measures how long the receiving of a chunk takes
     Timer _t;
@@ -69,6 +74,9 @@ private:
 
     int _nextStep;
     BSONObjBuilder _b;
+
+    // Bytes per second of the steps which transfer data, keyed by step like the timings in '_b'
+    BSONObjBuilder _bytesPerSecBuilder;
 };
 
 }  // namespace mongo
@@ -0,0 +1,176 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kSharding
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/s/range_deletion_throttle.h"
+
+#include <algorithm>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/service_context.h"
+#include "mongo/db/storage/storage_engine.h"
+#include "mongo/util/log.h"
+
+namespace mongo {
+namespace {
+
+// The largest number of documents deleted by one batch of range deletion.
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterMaxBatchSize, int, 128);
+
+// The rate, in bytes per second, at which orphaned documents are removed. 0 means unlimited.
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterMaxBytesPerSec, long long, 0);
+
+// A batch whose deletions take longer than this to be acknowledged by a majority of the replica
+// set makes the range deleter shrink its batches and pause before the next one.
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterMaxReplicationWaitMS, int, 1000);
+
+// The fraction of the storage engine's cache holding dirty data above which range deletion pauses.
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterMaxCacheDirtyRatio, double, 0.15);
+
+// How long range deletion pauses after a batch which replicated too slowly, or while the storage
+// engine's cache is too dirty.
+MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterBackoffMS, int, 1000);
+
+const auto getRangeDeletionThrottle = ServiceContext::declareDecoration<RangeDeletionThrottle>();
+
+int maxBatchSize() {
+    return std::max(1, rangeDeleterMaxBatchSize.load());
+}
+
+}  // namespace
+
+RangeDeletionThrottle::RangeDeletionThrottle() = default;
+
+RangeDeletionThrottle* RangeDeletionThrottle::get(OperationContext* opCtx) {
+    return get(opCtx->getServiceContext());
+}
+
+RangeDeletionThrottle* RangeDeletionThrottle::get(ServiceContext* serviceContext) {
+    return &getRangeDeletionThrottle(serviceContext);
+}
+
+int RangeDeletionThrottle::getBatchSize() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _getBatchSize(lk);
+}
+
+void RangeDeletionThrottle::recordBatch(int numDocs,
+                                        long long numBytes,
+                                        Milliseconds deleteTime,
+                                        Milliseconds replicationWait) {
+    const auto now = Date_t::now();
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _docsDeleted += numDocs;
+    _bytesDeleted += numBytes;
+    _batches++;
+    _lastReplicationWait = replicationWait;
+
+    const auto elapsedMillis = durationCount<Milliseconds>(deleteTime + replicationWait);
+    const double batchBytesPerSec = numBytes * 1000.0 / std::max<long long>(elapsedMillis, 1);
+    _bytesPerSec = _batches == 1 ? batchBytesPerSec : 0.8 * _bytesPerSec + 0.2 * batchBytesPerSec;
+
+    // Spend the bytes per second budget on the documents just deleted
+    const long long maxBytesPerSec = rangeDeleterMaxBytesPerSec.load();
+    if (maxBytesPerSec > 0) {
+        _nextBatchTime = std::max(_nextBatchTime, now) +
+            Milliseconds(static_cast<long long>(numBytes * 1000.0 / maxBytesPerSec));
+    }
+
+    if (replicationWait > Milliseconds(rangeDeleterMaxReplicationWaitMS.load())) {
+        LOG(1) << "Range deletion batch of " << numDocs << " documents took " << replicationWait
+               << " to replicate; backing off";
+
+        _replicationBackoffs++;
+        _shrinkBatchSize(lk);
+        _nextBatchTime = std::max(_nextBatchTime, now + Milliseconds(rangeDeleterBackoffMS.load()));
+        return;
+    }
+
+    // Grow the batch size back additively only after a batch which used all of it
+    if (numDocs >= _getBatchSize(lk)) {
+        _batchSize = std::min(maxBatchSize(), _batchSize + std::max(1, maxBatchSize() / 8));
+    }
+}
+
+Date_t RangeDeletionThrottle::getNextBatchTime(OperationContext* opCtx) {
+    auto storageEngine = opCtx->getServiceContext()->getGlobalStorageEngine();
+    const double cacheDirtyRatio = storageEngine ? storageEngine->getCacheDirtyRatio() : 0.0;
+
+    const auto now = Date_t::now();
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (cacheDirtyRatio > rangeDeleterMaxCacheDirtyRatio.load()) {
+        LOG(1) << "Storage engine cache is " << cacheDirtyRatio * 100
+               << "% dirty; backing off range deletion";
+
+        _cacheBackoffs++;
+        _shrinkBatchSize(lk);
+        _nextBatchTime = std::max(_nextBatchTime, now + Milliseconds(rangeDeleterBackoffMS.load()));
+    }
+
+    if (_nextBatchTime > now) {
+        _throttledMillis += durationCount<Milliseconds>(_nextBatchTime - now);
+        return _nextBatchTime;
+    }
+
+    return Date_t{};
+}
+
+void RangeDeletionThrottle::report(BSONObjBuilder* builder) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    builder->appendNumber("docsDeleted", _docsDeleted);
+    builder->appendNumber("bytesDeleted", _bytesDeleted);
+    builder->appendNumber("batches", _batches);
+    builder->appendNumber("batchSize", _getBatchSize(lk));
+    builder->appendNumber("bytesPerSec", static_cast<long long>(_bytesPerSec));
+    builder->appendNumber("lastReplicationWaitMillis",
+                          durationCount<Milliseconds>(_lastReplicationWait));
+    builder->appendNumber("replicationBackoffs", _replicationBackoffs);
+    builder->appendNumber("cacheBackoffs", _cacheBackoffs);
+    builder->appendNumber("throttledMillis", _throttledMillis);
+}
+
+int RangeDeletionThrottle::_getBatchSize(WithLock) {
+    // The first batch, and any after rangeDeleterMaxBatchSize was lowered, use the maximum
+    if (_batchSize <= 0 || _batchSize > maxBatchSize()) {
+        _batchSize = maxBatchSize();
+    }
+    return _batchSize;
+}
+
+void RangeDeletionThrottle::_shrinkBatchSize(WithLock lk) {
+    _batchSize = std::max(1, _getBatchSize(lk) / 2);
+}
+
+}  // namespace mongo
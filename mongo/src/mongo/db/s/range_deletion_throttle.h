@@ -0,0 +1,117 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/concurrency/with_lock.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+class BSONObjBuilder;
+class OperationContext;
+class ServiceContext;
+
+/**
+ * Paces the deletion of orphaned ranges across all collections on a shard. Batches of deletions
+ * are spaced so that the bytes removed per second stay within rangeDeleterMaxBytesPerSec, and
+ * both the batch size and the spacing back off while the secondaries take long to acknowledge a
+ * batch or while the storage engine's cache holds too much dirty data. The batch size grows back
+ * while neither happens.
+ */
+class RangeDeletionThrottle {
+    MONGO_DISALLOW_COPYING(RangeDeletionThrottle);
+
+public:
+    RangeDeletionThrottle();
+
+    /**
+     * Retrieves the RangeDeletionThrottle associated with the specified service context.
+     */
+    static RangeDeletionThrottle* get(OperationContext* opCtx);
+    static RangeDeletionThrottle* get(ServiceContext* serviceContext);
+
+    /**
+     * Returns the maximum number of documents the next batch of range deletion should remove.
+     */
+    int getBatchSize();
+
+    /**
+     * Records a batch of range deletion which removed 'numDocs' documents totalling 'numBytes',
+     * taking 'deleteTime' to delete them and 'replicationWait' for a majority of the replica set
+     * to acknowledge the deletions.
+     */
+    void recordBatch(int numDocs,
+                     long long numBytes,
+                     Milliseconds deleteTime,
+                     Milliseconds replicationWait);
+
+    /**
+     * Returns the earliest time at which the next batch of range deletion should begin. Checks the
+     * storage engine's cache, so must not be called under locks.
+     */
+    Date_t getNextBatchTime(OperationContext* opCtx);
+
+    /**
+     * Appends the progress and the recent rate of range deletion to 'builder'.
+     */
+    void report(BSONObjBuilder* builder);
+
+private:
+    /**
+     * Returns the current batch size, clamped to the range allowed by rangeDeleterMaxBatchSize.
+     */
+    int _getBatchSize(WithLock);
+
+    void _shrinkBatchSize(WithLock);
+
+    stdx::mutex _mutex;
+
+    // The current batch size, between 1 and rangeDeleterMaxBatchSize, or 0 until first used
+    int _batchSize{0};
+
+    // The earliest time at which the next batch may begin without exceeding the bytes per second
+    // budget or cutting short a back-off
+    Date_t _nextBatchTime;
+
+    // Exponentially weighted average of the bytes removed per second, over the time spent both
+    // deleting and waiting for replication
+    double _bytesPerSec{0};
+
+    long long _docsDeleted{0};
+    long long _bytesDeleted{0};
+    long long _batches{0};
+    long long _replicationBackoffs{0};
+    long long _cacheBackoffs{0};
+    long long _throttledMillis{0};
+    Milliseconds _lastReplicationWait{0};
+};
+
+}  // namespace mongo
@@ -0,0 +1,98 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/s/range_deletion_throttle.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/query/query_test_service_context.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const int kDefaultMaxBatchSize = 128;
+
+TEST(RangeDeletionThrottleTest, StartsAtTheMaximumBatchSizeWithoutDelay) {
+    QueryTestServiceContext serviceContext;
+    auto opCtx = serviceContext.makeOperationContext();
+
+    RangeDeletionThrottle throttle;
+    ASSERT_EQ(kDefaultMaxBatchSize, throttle.getBatchSize());
+    ASSERT_EQ(Date_t{}, throttle.getNextBatchTime(opCtx.get()));
+}
+
+TEST(RangeDeletionThrottleTest, SlowReplicationShrinksBatchesAndDelaysTheNextOne) {
+    QueryTestServiceContext serviceContext;
+    auto opCtx = serviceContext.makeOperationContext();
+
+    RangeDeletionThrottle throttle;
+    const int batchSize = throttle.getBatchSize();
+    throttle.recordBatch(batchSize, 1024, Milliseconds(10), Seconds(5));
+
+    ASSERT_EQ(batchSize / 2, throttle.getBatchSize());
+    ASSERT_GT(throttle.getNextBatchTime(opCtx.get()), Date_t::now());
+}
+
+TEST(RangeDeletionThrottleTest, FullBatchesGrowTheBatchSizeBackToTheMaximum) {
+    RangeDeletionThrottle throttle;
+    throttle.recordBatch(throttle.getBatchSize(), 1024, Milliseconds(10), Seconds(5));
+    throttle.recordBatch(throttle.getBatchSize(), 1024, Milliseconds(10), Seconds(5));
+    ASSERT_EQ(kDefaultMaxBatchSize / 4, throttle.getBatchSize());
+
+    // A batch which did not fill up its size does not grow it
+    throttle.recordBatch(1, 1024, Milliseconds(10), Milliseconds(10));
+    ASSERT_EQ(kDefaultMaxBatchSize / 4, throttle.getBatchSize());
+
+    for (int i = 0; i < 10; i++) {
+        throttle.recordBatch(throttle.getBatchSize(), 1024, Milliseconds(10), Milliseconds(10));
+    }
+    ASSERT_EQ(kDefaultMaxBatchSize, throttle.getBatchSize());
+}
+
+TEST(RangeDeletionThrottleTest, ReportsProgressAndBackoffs) {
+    RangeDeletionThrottle throttle;
+    throttle.recordBatch(100, 4000, Milliseconds(500), Milliseconds(500));
+    throttle.recordBatch(10, 400, Milliseconds(10), Seconds(5));
+
+    BSONObjBuilder builder;
+    throttle.report(&builder);
+    const BSONObj report = builder.obj();
+
+    ASSERT_EQ(110, report["docsDeleted"].numberLong());
+    ASSERT_EQ(4400, report["bytesDeleted"].numberLong());
+    ASSERT_EQ(2, report["batches"].numberLong());
+    ASSERT_EQ(1, report["replicationBackoffs"].numberLong());
+    ASSERT_EQ(0, report["cacheBackoffs"].numberLong());
+    ASSERT_EQ(5000, report["lastReplicationWaitMillis"].numberLong());
+    ASSERT_GT(report["bytesPerSec"].numberLong(), 0);
+}
+
+}  // namespace
+}  // namespace mongo
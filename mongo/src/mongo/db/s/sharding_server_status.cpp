@@ -30,6 +30,7 @@
 
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/commands/server_status.h"
+#include "mongo/db/s/range_deletion_throttle.h"
 #include "mongo/db/s/sharding_state.h"
 #include "mongo/db/server_options.h"
 #include "mongo/s/balancer_configuration.h"
@@ -71,6 +72,10 @@ public:
             if (!migrationStatus.isEmpty()) {
                 result.append("migrations", migrationStatus);
             }
+
+            BSONObjBuilder rangeDeleterBuilder(result.subobjStart("rangeDeleter"));
+            RangeDeletionThrottle::get(opCtx)->report(&rangeDeleterBuilder);
+            rangeDeleterBuilder.doneFast();
         }
 
         return result.obj();
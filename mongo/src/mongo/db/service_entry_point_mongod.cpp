@@ -33,6 +33,8 @@
 
 #include "mongo/db/service_entry_point_mongod.h"
 
+#include <boost/optional.hpp>
+
 #include "mongo/base/checked_cast.h"
 #include "mongo/db/audit.h"
 #include "mongo/db/auth/authorization_session.h"
@@ -55,6 +57,7 @@
 #include "mongo/db/logical_time_validator.h"
 #include "mongo/db/ops/write_ops.h"
 #include "mongo/db/ops/write_ops_exec.h"
+#include "mongo/db/query/cursor_response.h"
 #include "mongo/db/query/find.h"
 #include "mongo/db/read_concern.h"
 #include "mongo/db/repl/optime.h"
@@ -65,6 +68,7 @@
 #include "mongo/db/s/sharded_connection_info.h"
 #include "mongo/db/s/sharding_state.h"
 #include "mongo/db/server_options.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/session_catalog.h"
 #include "mongo/db/stats/counters.h"
 #include "mongo/db/stats/top.h"
@@ -76,6 +80,7 @@
 #include "mongo/rpc/metadata/repl_set_metadata.h"
 #include "mongo/rpc/metadata/sharding_metadata.h"
 #include "mongo/rpc/metadata/tracking_metadata.h"
+#include "mongo/rpc/op_msg_rpc_impls.h"
 #include "mongo/rpc/reply_builder_interface.h"
 #include "mongo/s/grid.h"
 #include "mongo/s/stale_exception.h"
@@ -93,6 +98,10 @@ MONGO_FP_DECLARE(respondWithNotPrimaryInCommandDispatch);
 namespace {
 using logger::LogComponent;
 
+// Owned documents of at least this many bytes are sent from their own buffers rather than copied
+// into cursor replies. Smaller ones are cheaper to copy than to gather. Zero disables this.
+MONGO_EXPORT_SERVER_PARAMETER(cursorReplyMinReferencedDocumentBytes, int, 4 * 1024);
+
 // The command names for which to check out a session.
 //
 // Note: Eval should check out a session because it defaults to running under a global write lock,
@@ -539,6 +548,7 @@ bool runCommandImpl(OperationContext* opCtx,
 
         if (!linearizableReadStatus.isOK()) {
             inPlaceReplyBob.resetToEmpty();
+            ScopedCursorBatchReferences::discardAll(opCtx);
             auto result = Command::appendCommandStatus(inPlaceReplyBob, linearizableReadStatus);
             inPlaceReplyBob.doneFast();
             BSONObjBuilder metadataBob;
@@ -935,6 +945,17 @@ DbResponse runCommands(OperationContext* opCtx, const Message& message) {
                 CurOp::get(opCtx)->setLogicalOp_inlock(c->getLogicalOp());
             }
 
+            // Replies that go straight to a client connection may send large owned documents of
+            // a cursor batch from their own buffers instead of copying them into the reply.
+            boost::optional<ScopedCursorBatchReferences> batchReferences;
+            if (replyBuilder->getProtocol() == rpc::Protocol::kOpMsg &&
+                opCtx->getClient()->session() && !opCtx->getClient()->isInDirectClient()) {
+                batchReferences.emplace(
+                    opCtx,
+                    checked_cast<rpc::OpMsgReplyBuilder*>(replyBuilder.get())->getOpMsgBuilder(),
+                    cursorReplyMinReferencedDocumentBytes.load());
+            }
+
             execCommandDatabase(opCtx, c, request, replyBuilder.get());
         } catch (const DBException& ex) {
             BSONObjBuilder metadataBob;
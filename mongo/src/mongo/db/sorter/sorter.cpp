@@ -55,12 +55,17 @@
 #include "mongo/config.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/service_context.h"
+#include "mongo/db/sorter/sorter_spill_pool.h"
 #include "mongo/db/storage/encryption_hooks.h"
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/s/is_mongos.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/mutex.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/bufreader.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/destructor_guard.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/unowned_ptr.h"
@@ -289,32 +294,37 @@ public:
         : _opts(opts),
           _remaining(opts.limit ? opts.limit : std::numeric_limits<unsigned long long>::max()),
           _first(true),
-          _greater(comp) {
+          _live(0),
+          _comp(comp) {
         for (size_t i = 0; i < iters.size(); i++) {
             if (iters[i]->more()) {
-                _heap.push_back(std::make_shared<Stream>(i, iters[i]->next(), iters[i]));
+                _streams.push_back(std::make_shared<Stream>(i, iters[i]->next(), iters[i]));
             }
         }
 
-        if (_heap.empty()) {
+        if (_streams.empty()) {
             _remaining = 0;
             return;
         }
 
-        std::make_heap(_heap.begin(), _heap.end(), _greater);
-        std::pop_heap(_heap.begin(), _heap.end(), _greater);
-        _current = _heap.back();
-        _heap.pop_back();
+        // Loser tree over the streams: leaves are at positions [k, 2k), internal node n
+        // holds the loser of the match between its children and _tree[0] holds the overall
+        // winner. Advancing the winner only replays the matches on its leaf-to-root path, so
+        // each output costs log2(k) compares rather than the ~2*log2(k) of a binary heap.
+        _live = _streams.size();
+        _tree.resize(_streams.size());
+        _tree[0] = _streams.size() == 1 ? 0 : build(1);
     }
 
     bool more() {
-        if (_remaining > 0 && (_first || !_heap.empty() || _current->more()))
+        if (_remaining > 0 && (_first || _live > 1 || _streams[_tree[0]]->more()))
             return true;
 
         // We are done so clean up resources.
         // Can't do this in next() due to lifetime guarantees of unowned Data.
-        _heap.clear();
-        _current.reset();
+        _streams.clear();
+        _tree.clear();
+        _live = 0;
         _remaining = 0;
 
         return false;
@@ -327,22 +337,24 @@ public:
 
         if (_first) {
             _first = false;
-            return _current->current();
+            return _streams[_tree[0]]->current();
         }
 
-        if (!_current->advance()) {
-            verify(!_heap.empty());
+        size_t winner = _tree[0];
+        if (!_streams[winner]->advance()) {
+            verify(_live > 1);
+            _live--;
+        }
 
-            std::pop_heap(_heap.begin(), _heap.end(), _greater);
-            _current = _heap.back();
-            _heap.pop_back();
-        } else if (!_heap.empty() && _greater(_current, _heap.front())) {
-            std::pop_heap(_heap.begin(), _heap.end(), _greater);
-            std::swap(_current, _heap.back());
-            std::push_heap(_heap.begin(), _heap.end(), _greater);
+        // Replay the matches on the path from the old winner's leaf to the root. Exhausted
+        // streams lose every match, so they sink out of the way without a separate removal.
+        for (size_t node = (winner + _streams.size()) / 2; node > 0; node /= 2) {
+            if (better(_tree[node], winner))
+                std::swap(_tree[node], winner);
         }
+        _tree[0] = winner;
 
-        return _current->current();
+        return _streams[winner]->current();
     }
 
 
@@ -350,53 +362,85 @@ private:
     class Stream {  // Data + Iterator
     public:
         Stream(size_t fileNum, const Data& first, std::shared_ptr<Input> rest)
-            : fileNum(fileNum), _current(first), _rest(rest) {}
+            : fileNum(fileNum), _current(first), _rest(rest), _exhausted(false) {}
 
         const Data& current() const {
             return _current;
         }
         bool more() {
-            return _rest->more();
+            return !_exhausted && _rest->more();
         }
         bool advance() {
-            if (!_rest->more())
+            if (!_rest->more()) {
+                _exhausted = true;
                 return false;
+            }
 
             _current = _rest->next();
             return true;
         }
+        bool exhausted() const {
+            return _exhausted;
+        }
 
         const size_t fileNum;
 
     private:
         Data _current;
         std::shared_ptr<Input> _rest;
+        bool _exhausted;
     };
 
-    class STLComparator {  // uses greater rather than less-than to maintain a MinHeap
-    public:
-        explicit STLComparator(const Comparator& comp) : _comp(comp) {}
-        bool operator()(unowned_ptr<const Stream> lhs, unowned_ptr<const Stream> rhs) const {
-            // first compare data
-            dassertCompIsSane(_comp, lhs->current(), rhs->current());
-            int ret = _comp(lhs->current(), rhs->current());
-            if (ret)
-                return ret > 0;
-
-            // then compare fileNums to ensure stability
-            return lhs->fileNum > rhs->fileNum;
+    /**
+     * Returns true if stream 'lhs' should be output before stream 'rhs'. Exhausted streams
+     * sort after everything else and ties go to the lower fileNum to keep the merge stable.
+     */
+    bool better(size_t lhs, size_t rhs) const {
+        const Stream& l = *_streams[lhs];
+        const Stream& r = *_streams[rhs];
+
+        if (l.exhausted() || r.exhausted()) {
+            if (l.exhausted() != r.exhausted())
+                return r.exhausted();
+            return l.fileNum < r.fileNum;
         }
 
-    private:
-        const Comparator _comp;
-    };
+        // first compare data
+        dassertCompIsSane(_comp, l.current(), r.current());
+        int ret = _comp(l.current(), r.current());
+        if (ret)
+            return ret < 0;
+
+        // then compare fileNums to ensure stability
+        return l.fileNum < r.fileNum;
+    }
+
+    /**
+     * Plays the matches of the subtree rooted at 'node', storing the losers in _tree and
+     * returning the index of the winning stream.
+     */
+    size_t build(size_t node) {
+        const size_t k = _streams.size();
+        if (node >= k)
+            return node - k;
+
+        size_t left = build(2 * node);
+        size_t right = build(2 * node + 1);
+        if (better(left, right)) {
+            _tree[node] = right;
+            return left;
+        }
+        _tree[node] = left;
+        return right;
+    }
 
     SortOptions _opts;
     unsigned long long _remaining;
     bool _first;
-    std::shared_ptr<Stream> _current;
-    std::vector<std::shared_ptr<Stream>> _heap;  // MinHeap
-    STLComparator _greater;                      // named so calls make sense
+    size_t _live;  // number of streams that are not yet exhausted
+    std::vector<std::shared_ptr<Stream>> _streams;
+    std::vector<size_t> _tree;  // loser tree of indexes into _streams
+    const Comparator _comp;
 };
 
 //IndexAccessMethod::BulkBuilder::BulkBuilder->Sorter<Key, Value>::makeйʹ
@@ -417,6 +461,13 @@ public:
         verify(_opts.limit == 0);
     }
 
+    ~NoLimitSorter() {
+        // Background spills reference this sorter, so they must finish before it goes away.
+        for (auto&& spill : _inFlight) {
+            DESTRUCTOR_GUARD(spill->wait(););
+        }
+    }
+
     void add(const Key& key, const Value& val) {
         _data.push_back(std::make_pair(key, val));
 
@@ -431,11 +482,12 @@ public:
     Iterator* done() {
         if (_iters.empty()) {
 			//˵ݶ500MҲǲڴļ⣬ֱڴ
-            sort();
+            sort(_data);
             return new InMemIterator<Key, Value>(_data);
         }
 
         spill();
+        waitForSpills(0);
 		//ļϲ
         return Iterator::merge(_iters, _opts, _comp);
     }
@@ -462,15 +514,44 @@ private:
     };
 
 	//spill()ãdataѹдļ
-    void sort() {
+    void sort(std::deque<Data>& data) const {
         STLComparator less(_comp);
-        std::stable_sort(_data.begin(), _data.end(), less);
+        std::stable_sort(data.begin(), data.end(), less);
 
         // Does 2x more compares than stable_sort
         // TODO test on windows
         // std::sort(_data.begin(), _data.end(), comp);
     }
 
+    /**
+     * Writes already sorted 'data' to a new spill file, consuming it, and returns an
+     * iterator over the file.
+     */
+    std::shared_ptr<Iterator> writeRun(std::deque<Data>& data) const {
+        SortedFileWriter<Key, Value> writer(_opts, _settings);
+        for (; !data.empty(); data.pop_front()) {
+            writer.addAlreadySorted(data.front().first, data.front().second);
+        }
+        return std::shared_ptr<Iterator>(writer.done());
+    }
+
+    /**
+     * Joins the oldest background spills until at most 'maxInFlight' remain, publishing
+     * their iterators into the slots reserved for them in _iters. Rethrows the first error
+     * raised by a joined spill.
+     */
+    void waitForSpills(size_t maxInFlight) {
+        while (_inFlight.size() > maxInFlight) {
+            std::unique_ptr<BackgroundSpill> spill = std::move(_inFlight.front());
+            _inFlight.pop_front();
+
+            spill->wait();
+            if (spill->error)
+                std::rethrow_exception(spill->error);
+            _iters[spill->slot] = std::move(spill->result);
+        }
+    }
+
 	//addӿڵ
     void spill() {
         if (_data.empty())
@@ -489,20 +570,71 @@ private:
                           << " bytes, but did not opt in to external sorting. Aborting operation."
                           << " Pass allowDiskUse:true to opt in.");
         }
-		//
-        sort();
 
-		//ź_dataдwriterУѹдļ
-        SortedFileWriter<Key, Value> writer(_opts, _settings);
-        for (; !_data.empty(); _data.pop_front()) {
-            writer.addAlreadySorted(_data.front().first, _data.front().second);
+        if (_opts.maxParallelSpills == 0) {
+		    //
+            sort(_data);
+
+		    //ź_dataдwriterУѹдļ
+            _iters.push_back(writeRun(_data));
+
+            _memUsed = 0;
+            return;
         }
 
-        _iters.push_back(std::shared_ptr<Iterator>(writer.done()));
+        // Hand the run to the shared spill pool so the caller can keep adding data while it
+        // is sorted, compressed and written. Runs keep their full size, so at most
+        // maxParallelSpills of them are held in memory besides the one being filled. The run's
+        // slot in _iters is reserved now so that the merge sees runs in the order they were
+        // produced.
+        waitForSpills(_opts.maxParallelSpills - 1);
+
+        auto spill = stdx::make_unique<BackgroundSpill>();
+        spill->data.swap(_data);
+        spill->slot = _iters.size();
+
+        BackgroundSpill* raw = spill.get();
+        auto task = [this, raw] {
+            try {
+                sort(raw->data);
+                raw->result = writeRun(raw->data);
+            } catch (...) {
+                raw->error = std::current_exception();
+            }
+            raw->markDone();
+        };
+        if (!getSorterSpillThreadPool()->schedule(task).isOK()) {
+            // The pool only refuses work once it is shut down, so spill on this thread.
+            task();
+        }
+        _iters.emplace_back();
+        _inFlight.push_back(std::move(spill));
 
         _memUsed = 0;
     }
 
+    struct BackgroundSpill {
+        std::deque<Data> data;
+        size_t slot = 0;  // index in _iters that receives the result
+        std::shared_ptr<Iterator> result;
+        std::exception_ptr error;
+
+        void markDone() {
+            stdx::lock_guard<stdx::mutex> lk(mutex);
+            done = true;
+            doneCV.notify_all();
+        }
+
+        void wait() {
+            stdx::unique_lock<stdx::mutex> lk(mutex);
+            doneCV.wait(lk, [this] { return done; });
+        }
+
+        stdx::mutex mutex;
+        stdx::condition_variable doneCV;
+        bool done = false;
+    };
+
     const Comparator _comp;
     const Settings _settings;
     SortOptions _opts;
@@ -510,6 +642,7 @@ private:
 	//KVӵqueue
     std::deque<Data> _data;                         // the "current" data
     std::vector<std::shared_ptr<Iterator>> _iters;  // data that has already been spilled
+    std::deque<std::unique_ptr<BackgroundSpill>> _inFlight;  // spills still being written
 };
 
 //Sorter<Key, Value>::makeɹʹ
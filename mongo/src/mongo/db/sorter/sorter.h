@@ -100,9 +100,17 @@ struct SortOptions {
     bool extSortAllowed;         /// If false, uassert if more mem needed than allowed.
     std::string tempDir;         /// Directory to directly place files in.
                                  /// Must be explicitly set if extSortAllowed is true.
+    size_t maxParallelSpills;    /// Number of spills that may sort and write in the background
+                                 /// while more data is added. 0 spills on the calling thread.
+                                 /// Each in-flight spill holds one run of up to
+                                 /// maxMemoryUsageBytes on top of the run being filled.
 
     //
-    SortOptions() : limit(0), maxMemoryUsageBytes(64 * 1024 * 1024), extSortAllowed(false) {}
+    SortOptions()
+        : limit(0),
+          maxMemoryUsageBytes(64 * 1024 * 1024),
+          extSortAllowed(false),
+          maxParallelSpills(0) {}
 
     /// Fluent API to support expressions like SortOptions().Limit(1000).ExtSortAllowed(true)
 
@@ -125,6 +133,11 @@ struct SortOptions {
         tempDir = newTempDir;
         return *this;
     }
+
+    SortOptions& MaxParallelSpills(size_t newMaxParallelSpills) {
+        maxParallelSpills = newMaxParallelSpills;
+        return *this;
+    }
 };
 
 /// This is the output from the sorting framework
@@ -0,0 +1,61 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/sorter/sorter_spill_pool.h"
+
+#include <algorithm>
+
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/concurrency/thread_pool.h"
+
+namespace mongo {
+
+namespace {
+
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(internalSorterMaxSpillThreads, int, 4);
+
+}  // namespace
+
+ThreadPool* getSorterSpillThreadPool() {
+    // Intentionally leaked: sorters join their spills before they are destroyed, so the pool is
+    // idle whenever the process exits.
+    static ThreadPool* const pool = [] {
+        ThreadPool::Options options;
+        options.poolName = "SorterSpill";
+        options.minThreads = 0;
+        options.maxThreads = static_cast<size_t>(std::max(1, internalSorterMaxSpillThreads));
+        auto pool = new ThreadPool(options);
+        pool->startup();
+        return pool;
+    }();
+    return pool;
+}
+
+}  // namespace mongo
@@ -319,6 +319,16 @@ public:
             ASSERT_ITERATORS_EQUIVALENT(mergeIterators(iterators, DESC),
                                         make_shared<IntIterator>(30, 0, -1));
         }
+        {  // test ASC with a non power of two number of sources that run out at different times
+            std::shared_ptr<IWIterator> iterators[] = {make_shared<IntIterator>(27, 40),
+                                                       make_shared<IntIterator>(0, 10),
+                                                       make_shared<IntIterator>(40, 41),
+                                                       make_shared<IntIterator>(10, 25),
+                                                       make_shared<IntIterator>(25, 27)};
+
+            ASSERT_ITERATORS_EQUIVALENT(mergeIterators(iterators, ASC),
+                                        make_shared<IntIterator>(0, 41));
+        }
         {  // test Limit
             std::shared_ptr<IWIterator> iterators[] = {
                 make_shared<IntIterator>(1, 20, 2)  // 1, 3, ... 19
@@ -541,6 +551,24 @@ class LotsOfDataWithLimit : public LotsOfDataLittleMemory<Random> {
     }
     enum { MEM_LIMIT = 32 * 1024 };
 };
+
+template <bool Random = true>
+class LotsOfDataParallelSpills : public LotsOfDataLittleMemory<Random> {
+    typedef LotsOfDataLittleMemory<Random> Parent;
+    SortOptions adjustSortOptions(SortOptions opts) {
+        return opts.MaxMemoryUsageBytes(Parent::MEM_LIMIT).ExtSortAllowed().MaxParallelSpills(1);
+    }
+
+    void addData(unowned_ptr<IWSorter> sorter) {
+        Parent::addData(sorter);
+
+        // Background spills must not shrink the runs, so there are as many files as when
+        // spilling on the calling thread.
+        const size_t serialFiles = (Parent::NUM_ITEMS * sizeof(IWPair)) / Parent::MEM_LIMIT;
+        ASSERT_GREATER_THAN_OR_EQUALS(static_cast<size_t>(sorter->numFiles()), serialFiles);
+        ASSERT_LESS_THAN_OR_EQUALS(static_cast<size_t>(sorter->numFiles()), serialFiles + 1);
+    }
+};
 }
 
 class SorterSuite : public mongo::unittest::Suite {
@@ -556,6 +584,8 @@ public:
         add<SorterTests::Dupes>();
         add<SorterTests::LotsOfDataLittleMemory</*random=*/false>>();
         add<SorterTests::LotsOfDataLittleMemory</*random=*/true>>();
+        add<SorterTests::LotsOfDataParallelSpills</*random=*/false>>();
+        add<SorterTests::LotsOfDataParallelSpills</*random=*/true>>();
         add<SorterTests::LotsOfDataWithLimit<1, /*random=*/false>>();     // limit=1 is special case
         add<SorterTests::LotsOfDataWithLimit<1, /*random=*/true>>();      // limit=1 is special case
         add<SorterTests::LotsOfDataWithLimit<100, /*random=*/false>>();   // fits in mem
@@ -245,6 +245,11 @@ public:
             return *_it;
         }
 
+        BSONObj currentKey(size_t numFields) const override {
+            invariant(!_isEOF);
+            return _it->key;
+        }
+
         void setEndPosition(const BSONObj& key, bool inclusive) override {
             if (key.isEmpty()) {
                 // This means scan to end of index.
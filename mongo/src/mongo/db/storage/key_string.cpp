@@ -35,6 +35,7 @@
 #include "mongo/db/storage/key_string.h"
 
 #include <cmath>
+#include <limits>
 #include <type_traits>
 
 #include "mongo/base/data_view.h"
@@ -232,12 +233,53 @@ namespace {
 void memcpy_flipBits(void* dst, const void* src, size_t bytes) {
     const char* input = static_cast<const char*>(src);
     char* output = static_cast<char*>(dst);
+    for (; bytes >= sizeof(uint64_t); bytes -= sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, input, sizeof(word));
+        word = ~word;
+        memcpy(output, &word, sizeof(word));
+        input += sizeof(word);
+        output += sizeof(word);
+    }
     const char* const end = input + bytes;
     while (input != end) {
         *output++ = ~(*input++);
     }
 }
 
+void copyBytes(void* dst, const void* src, size_t bytes, bool invert) {
+    if (invert) {
+        memcpy_flipBits(dst, src, bytes);
+    } else {
+        memcpy(dst, src, bytes);
+    }
+}
+
+/**
+ * Same result as memcmp() clamped to -1, 0 or 1. Most keys are a few dozen bytes long, so rather
+ * than calling into memcmp() this compares eight bytes per load, and only orders the first words
+ * that differ by their big-endian values.
+ */
+int compareKeyStringBytes(const char* lhs, const char* rhs, size_t bytes) {
+    for (; bytes >= sizeof(uint64_t); bytes -= sizeof(uint64_t)) {
+        uint64_t lhsWord;
+        uint64_t rhsWord;
+        memcpy(&lhsWord, lhs, sizeof(lhsWord));
+        memcpy(&rhsWord, rhs, sizeof(rhsWord));
+        if (lhsWord != rhsWord) {
+            return endian::bigToNative(lhsWord) < endian::bigToNative(rhsWord) ? -1 : 1;
+        }
+        lhs += sizeof(lhsWord);
+        rhs += sizeof(rhsWord);
+    }
+    for (; bytes; --bytes, ++lhs, ++rhs) {
+        if (*lhs != *rhs) {
+            return static_cast<uint8_t>(*lhs) < static_cast<uint8_t>(*rhs) ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
 template <typename T>
 T readType(BufReader* reader, bool inverted) {
     MONGO_STATIC_ASSERT(std::is_integral<T>::value);
@@ -443,25 +485,33 @@ void KeyString::_appendBool(bool val, bool invert) {
 }
 
 void KeyString::_appendDate(Date_t val, bool invert) {
-    _append(CType::kDate, invert);
     // see: http://en.wikipedia.org/wiki/Offset_binary
     uint64_t encoded = static_cast<uint64_t>(val.asInt64());
     encoded ^= (1LL << 63);  // flip highest bit (equivalent to bias encoding)
-    _append(endian::nativeToBig(encoded), invert);
+    encoded = endian::nativeToBig(encoded);
+    _appendTypeAndBytes(CType::kDate, &encoded, sizeof(encoded), invert);
 }
 
 void KeyString::_appendTimestamp(Timestamp val, bool invert) {
-    _append(CType::kTimestamp, invert);
-    _append(endian::nativeToBig(val.asLL()), invert);
+    const unsigned long long encoded = endian::nativeToBig(val.asLL());
+    _appendTypeAndBytes(CType::kTimestamp, &encoded, sizeof(encoded), invert);
 }
 
 void KeyString::_appendOID(OID val, bool invert) {
-    _append(CType::kOID, invert);
-    _appendBytes(val.view().view(), OID::kOIDSize, invert);
+    _appendTypeAndBytes(CType::kOID, val.view().view(), OID::kOIDSize, invert);
 }
 
 void KeyString::_appendString(StringData val, bool invert) {
     _typeBits.appendString();
+    // Strings without NUL bytes, nearly all of them, are written with their CType byte and
+    // terminator in one go.
+    if (!memchr(val.rawData(), 0, val.size())) {
+        char* const base = _buffer.skip(1 + val.size() + 1);
+        base[0] = invert ? ~CType::kStringLike : CType::kStringLike;
+        copyBytes(base + 1, val.rawData(), val.size(), invert);
+        base[1 + val.size()] = invert ? ~char(0) : char(0);
+        return;
+    }
     _append(CType::kStringLike, invert);
     _appendStringLike(val, invert);
 }
@@ -1050,13 +1100,12 @@ void KeyString::_appendPreshiftedIntegerPortion(uint64_t value, bool isNegative,
     value = endian::nativeToBig(value);
     const void* firstUsedByte = reinterpret_cast<const char*>((&value) + 1) - bytesNeeded;
 
-    if (isNegative) {
-        _append(uint8_t(CType::kNumericNegative1ByteInt - (bytesNeeded - 1)), invert);
-        _appendBytes(firstUsedByte, bytesNeeded, !invert);
-    } else {
-        _append(uint8_t(CType::kNumericPositive1ByteInt + (bytesNeeded - 1)), invert);
-        _appendBytes(firstUsedByte, bytesNeeded, invert);
-    }
+    const uint8_t ctype = isNegative
+        ? uint8_t(CType::kNumericNegative1ByteInt - (bytesNeeded - 1))
+        : uint8_t(CType::kNumericPositive1ByteInt + (bytesNeeded - 1));
+    char* const base = _buffer.skip(1 + bytesNeeded);
+    base[0] = invert ? ~ctype : ctype;
+    copyBytes(base + 1, firstUsedByte, bytesNeeded, isNegative ? !invert : invert);
 }
 
 template <typename T>
@@ -1065,13 +1114,13 @@ void KeyString::_append(const T& thing, bool invert) {
 }
 
 void KeyString::_appendBytes(const void* source, size_t bytes, bool invert) {
-    char* const base = _buffer.skip(bytes);
+    copyBytes(_buffer.skip(bytes), source, bytes, invert);
+}
 
-    if (invert) {
-        memcpy_flipBits(base, source, bytes);
-    } else {
-        memcpy(base, source, bytes);
-    }
+void KeyString::_appendTypeAndBytes(uint8_t ctype, const void* source, size_t bytes, bool invert) {
+    char* const base = _buffer.skip(1 + bytes);
+    base[0] = invert ? ~ctype : ctype;
+    copyBytes(base + 1, source, bytes, invert);
 }
 
 
@@ -1691,10 +1740,18 @@ Decimal128 adjustDecimalExponent(TypeBits::Reader* typeBits, Decimal128 num) {
 }  // namespace
 
 BSONObj KeyString::toBson(const char* buffer, size_t len, Ordering ord, const TypeBits& typeBits) {
+    return toBsonPrefix(buffer, len, ord, typeBits, std::numeric_limits<size_t>::max());
+}
+
+BSONObj KeyString::toBsonPrefix(const char* buffer,
+                                size_t len,
+                                Ordering ord,
+                                const TypeBits& typeBits,
+                                size_t numFields) {
     BSONObjBuilder builder;
     BufReader reader(buffer, len);
     TypeBits::Reader typeBitsReader(typeBits);
-    for (int i = 0; reader.remaining(); i++) {
+    for (size_t i = 0; i < numFields && reader.remaining(); i++) {
         const bool invert = (ord.get(i) == -1);
         uint8_t ctype = readType<uint8_t>(&reader, invert);
         if (ctype == kLess || ctype == kGreater) {
@@ -1755,7 +1812,7 @@ int KeyString::compare(const KeyString& other) const {
 
     int min = std::min(a, b);
 
-    int cmp = memcmp(getBuffer(), other.getBuffer(), min);
+    int cmp = compareKeyStringBytes(getBuffer(), other.getBuffer(), min);
 
     if (cmp) {
         if (cmp < 0)
@@ -301,6 +301,13 @@ public:
     static BSONObj toBson(StringData data, Ordering ord, const TypeBits& types);
     static BSONObj toBson(const char* buffer, size_t len, Ordering ord, const TypeBits& types);
 
+    /**
+     * Like toBson(), but stops after the first 'numFields' fields of the key, so that the bytes
+     * of later fields are not even looked at.
+     */
+    static BSONObj toBsonPrefix(
+        const char* buffer, size_t len, Ordering ord, const TypeBits& types, size_t numFields);
+
     /**
      * Decodes a RecordId from the end of a buffer.
      */
@@ -402,6 +409,11 @@ private:
     void _append(const T& thing, bool invert);
     void _appendBytes(const void* source, size_t bytes, bool invert);
 
+    /**
+     * Appends a CType byte followed by 'bytes' bytes of 'source', extending the buffer once.
+     */
+    void _appendTypeAndBytes(uint8_t ctype, const void* source, size_t bytes, bool invert);
+
     TypeBits _typeBits;
     StackBufBuilder _buffer;
 };
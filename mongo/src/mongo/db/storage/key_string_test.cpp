@@ -173,6 +173,115 @@ TEST_F(KeyStringTest, ActualBytesDouble) {
     ASSERT_EQUALS(hexFlipped, toHex(ks.getBuffer(), ks.getSize()));
 }
 
+namespace {
+/**
+ * Checks that 'obj' encodes to exactly 'hex' ascending, and to its bit flipped bytes but for the
+ * trailing kEnd descending.
+ */
+void assertActualBytes(KeyString::Version version, const BSONObj& obj, const string& hex) {
+    KeyString ks(version, obj, ALL_ASCENDING);
+    ASSERT_EQUALS(hex, toHex(ks.getBuffer(), ks.getSize()));
+
+    string hexFlipped;
+    for (size_t i = 0; i < hex.size() - 2; i += 2) {
+        char c = fromHex(hex.c_str() + i);
+        c = ~c;
+        hexFlipped += toHex(&c, 1);
+    }
+    hexFlipped += hex.substr(hex.size() - 2);
+
+    ks.resetToKey(obj, ONE_DESCENDING);
+    ASSERT_EQUALS(hexFlipped, toHex(ks.getBuffer(), ks.getSize()));
+}
+}  // namespace
+
+TEST_F(KeyStringTest, ActualBytesOfSingleAppendTypes) {
+    // These types write their CType byte and value in one go, pin their on-disk format.
+    assertActualBytes(version,
+                      BSON("" << Date_t::fromMillisSinceEpoch(0)),
+                      "78"                // kDate
+                      "8000000000000000"  // 0 with the highest bit flipped
+                      "04");              // kEnd
+    assertActualBytes(version,
+                      BSON("" << Timestamp(1, 2)),
+                      "82"                // kTimestamp
+                      "0000000100000002"  // seconds, increment
+                      "04");
+    assertActualBytes(version,
+                      BSON("" << OID("abcdefabcdefabcdefabcdef")),
+                      "64"                        // kOID
+                      "ABCDEFABCDEFABCDEFABCDEF"  // OID bytes
+                      "04");
+    assertActualBytes(version,
+                      BSON("" << 5),
+                      "2B"  // kNumericPositive1ByteInt
+                      "0A"  // 5 << 1
+                      "04");
+    assertActualBytes(version,
+                      BSON("" << -300LL),
+                      "26"    // kNumericNegative2ByteInt
+                      "FDA7"  // ~(300 << 1)
+                      "04");
+    assertActualBytes(version,
+                      BSON(""
+                           << "ab"),
+                      "3C"    // kStringLike
+                      "6162"  // "ab"
+                      "00"    // terminator
+                      "04");
+    assertActualBytes(version,
+                      BSON("" << StringData("a\0b", 3)),
+                      "3C"    // kStringLike
+                      "61"    // "a"
+                      "00FF"  // escaped NUL
+                      "6200"  // "b", terminator
+                      "04");
+}
+
+TEST_F(KeyStringTest, SingleAppendTypesRoundtripAndOrder) {
+    std::vector<BSONObj> values;
+    for (long long millis : {-1LL, 0LL, 1LL, 123123123LL, std::numeric_limits<long long>::max()}) {
+        values.push_back(BSON("" << Date_t::fromMillisSinceEpoch(millis)));
+    }
+    for (unsigned secs : {0U, 1U, 123123U, ~0U}) {
+        values.push_back(BSON("" << Timestamp(secs, 3)));
+    }
+    values.push_back(BSON("" << OID("000000000000000000000000")));
+    values.push_back(BSON("" << OID("abcdefabcdefabcdefabcdef")));
+    values.push_back(BSON("" << OID("ffffffffffffffffffffffff")));
+    // Integers of every encoded width, both signs.
+    for (int shift = 0; shift < 63; shift += 7) {
+        const long long magnitude = 1LL << shift;
+        values.push_back(BSON("" << magnitude));
+        values.push_back(BSON("" << -magnitude));
+        values.push_back(BSON("" << magnitude + 1));
+        if (magnitude <= std::numeric_limits<int>::max()) {
+            values.push_back(BSON("" << static_cast<int>(magnitude)));
+            values.push_back(BSON("" << -static_cast<int>(magnitude)));
+        }
+    }
+    values.push_back(BSON("" << std::numeric_limits<long long>::max()));
+    values.push_back(BSON("" << std::numeric_limits<int>::min()));
+    for (auto&& str : {StringData(""),
+                       StringData("a"),
+                       StringData("abcdefghijklmnopqrstuvwxyz"),
+                       StringData("\0", 1),
+                       StringData("a\0", 2),
+                       StringData("a\0b", 3),
+                       StringData("\0\0\xff", 3)}) {
+        values.push_back(BSON("" << str));
+    }
+
+    for (auto&& value : values) {
+        ROUNDTRIP(version, value);
+    }
+    for (auto&& lhs : values) {
+        for (auto&& rhs : values) {
+            COMPARES_SAME(version, lhs, rhs);
+        }
+    }
+}
+
 TEST_F(KeyStringTest, AllTypesSimple) {
     ROUNDTRIP(version, BSON("" << 5.5));
     ROUNDTRIP(version,
@@ -250,6 +359,34 @@ TEST_F(KeyStringTest, Compound1) {
     ROUNDTRIP(version, BSON("" << BSON("" << 5) << "" << 1));
 }
 
+TEST_F(KeyStringTest, ToBsonPrefix) {
+    Ordering ordering = Ordering::make(BSON("a" << 1 << "b" << -1 << "c" << 1));
+    const BSONObj key = BSON("" << 1.0 << ""
+                                << "str"
+                                << ""
+                                << 3LL);
+    KeyString ks(version, key, ordering, RecordId(7));
+
+    auto prefix = [&](size_t numFields) {
+        return KeyString::toBsonPrefix(
+            ks.getBuffer(), ks.getSize(), ordering, ks.getTypeBits(), numFields);
+    };
+
+    ASSERT_BSONOBJ_EQ(prefix(0), BSONObj());
+    ASSERT_BSONOBJ_EQ(prefix(1), BSON("" << 1.0));
+    ASSERT_EQ(prefix(1).firstElement().type(), NumberDouble);
+    ASSERT_BSONOBJ_EQ(prefix(2),
+                      BSON("" << 1.0 << ""
+                              << "str"));
+    ASSERT_BSONOBJ_EQ(prefix(3), key);
+    const BSONObj whole = prefix(4);
+    ASSERT_BSONOBJ_EQ(whole, key);
+    BSONObjIterator it(whole);
+    it.next();
+    it.next();
+    ASSERT_EQ(it.next().type(), NumberLong);
+}
+
 TEST_F(KeyStringTest, Undef1) {
     ROUNDTRIP(version, BSON("" << BSONUndefined));
 }
@@ -1313,3 +1450,125 @@ TEST_F(KeyStringTest, DecimalFromUniformDoublePerf) {
     }
     perfTest(version, numbers);
 }
+
+TEST_F(KeyStringTest, CompareDiffersAtEachOffset) {
+    // Covers keys differing in the words and in the trailing bytes of the comparison.
+    for (int size = 1; size <= 40; size++) {
+        for (int offset = 0; offset < size; offset++) {
+            std::string lower(size, 'a');
+            std::string higher = lower;
+            higher[offset] = '\xf0';
+
+            KeyString lowerKey(version);
+            lowerKey.resetFromBuffer(lower.data(), lower.size());
+            KeyString higherKey(version);
+            higherKey.resetFromBuffer(higher.data(), higher.size());
+            ASSERT_LT(lowerKey.compare(higherKey), 0);
+            ASSERT_GT(higherKey.compare(lowerKey), 0);
+            ASSERT_EQ(lowerKey.compare(lowerKey), 0);
+
+            KeyString prefixKey(version);
+            prefixKey.resetFromBuffer(lower.data(), offset);
+            ASSERT_LT(prefixKey.compare(lowerKey), 0);
+        }
+    }
+}
+
+namespace {
+/**
+ * Logs the time per encode, decode and compare of the 'keys' of a kind of index key, each
+ * operation repeated on all keys for at least kMinPerfMicros microseconds.
+ */
+void keyPerfTest(KeyString::Version version, StringData kind, const std::vector<BSONObj>& keys) {
+    const Ordering ord = ALL_ASCENDING;
+    std::vector<std::unique_ptr<KeyString>> encoded;
+    for (auto&& key : keys) {
+        encoded.push_back(stdx::make_unique<KeyString>(version, key, ord));
+    }
+
+    auto timePerKey = [&](const stdx::function<void()>& pass) {
+        uint64_t micros = 0;
+        uint64_t iters;
+        for (iters = 16; iters < (1 << 30) && micros < kMinPerfMicros; iters *= 2) {
+            Timer t;
+            for (uint64_t i = 0; i < iters; i++) {
+                pass();
+            }
+            micros = t.micros();
+        }
+        return 1E3 * micros / static_cast<double>(iters * keys.size());
+    };
+
+    KeyString ks(version);
+    const double encodeNanos = timePerKey([&] {
+        for (auto&& key : keys) {
+            ks.resetToKey(key, ord);
+            invariant(ks.getSize());
+        }
+    });
+    const double decodeNanos = timePerKey([&] {
+        for (auto&& key : encoded) {
+            invariant(!toBson(*key, ord).isEmpty());
+        }
+    });
+    const double compareNanos = timePerKey([&] {
+        int sum = 0;
+        for (size_t i = 1; i < encoded.size(); i++) {
+            sum += encoded[i - 1]->compare(*encoded[i]);
+        }
+        invariant(sum <= static_cast<int>(encoded.size()));
+    });
+
+    log() << kind << " " << mongo::KeyString::versionToString(version) << " keys: " << encodeNanos
+          << " ns per encode, " << decodeNanos << " ns per decode, " << compareNanos
+          << " ns per compare" << (kDebugBuild ? " (DEBUG BUILD!)" : "");
+}
+}  // namespace
+
+TEST_F(KeyStringTest, Int64KeyPerf) {
+    std::mt19937 gen(newSeed());
+    std::uniform_int_distribution<long long> uniformInt64(std::numeric_limits<long long>::min(),
+                                                          std::numeric_limits<long long>::max());
+    std::vector<BSONObj> keys;
+    for (uint64_t x = 0; x < kMinPerfSamples; x++)
+        keys.push_back(BSON("" << uniformInt64(gen)));
+
+    keyPerfTest(version, "int64", keys);
+}
+
+TEST_F(KeyStringTest, OIDKeyPerf) {
+    std::vector<BSONObj> keys;
+    for (uint64_t x = 0; x < kMinPerfSamples; x++)
+        keys.push_back(BSON("" << OID::gen()));
+
+    keyPerfTest(version, "ObjectId", keys);
+}
+
+TEST_F(KeyStringTest, ShortStringKeyPerf) {
+    std::mt19937 gen(newSeed());
+    std::uniform_int_distribution<int> length(1, 32);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::vector<BSONObj> keys;
+    for (uint64_t x = 0; x < kMinPerfSamples; x++) {
+        std::string str(length(gen), 'a');
+        for (auto&& c : str)
+            c = letter(gen);
+        keys.push_back(BSON("" << str));
+    }
+
+    keyPerfTest(version, "short string", keys);
+}
+
+TEST_F(KeyStringTest, CompoundKeyPerf) {
+    std::mt19937 gen(newSeed());
+    std::exponential_distribution<double> expReal(1e-3);
+    std::vector<BSONObj> keys;
+    for (uint64_t x = 0; x < kMinPerfSamples; x++) {
+        keys.push_back(BSON("" << static_cast<int>(expReal(gen)) << ""
+                               << ("user" + std::to_string(x % 1000))
+                               << ""
+                               << OID::gen()));
+    }
+
+    keyPerfTest(version, "compound", keys);
+}
@@ -279,6 +279,13 @@ public:
      */
     virtual void replicationBatchIsComplete() const {};
 
+    /**
+     * See `StorageEngine::getCacheDirtyRatio()`
+     */
+    virtual double getCacheDirtyRatio() const {
+        return 0.0;
+    }
+
     /**
      * The destructor will never be called from mongod, but may be called from tests.
      * Engines may assume that this will only be called in the case of clean shutdown, even if
@@ -496,4 +496,8 @@ bool KVStorageEngine::supportsRecoverToStableTimestamp() const {
 void KVStorageEngine::replicationBatchIsComplete() const {
     return _engine->replicationBatchIsComplete();
 }
+
+double KVStorageEngine::getCacheDirtyRatio() const {
+    return _engine->getCacheDirtyRatio();
+}
 }  // namespace mongo
@@ -284,6 +284,8 @@ public:
 
     virtual void replicationBatchIsComplete() const override;
 
+    virtual double getCacheDirtyRatio() const override;
+
     SnapshotManager* getSnapshotManager() const final;
 
     void setJournalListener(JournalListener* jl) final;
@@ -148,6 +148,11 @@ public:
             return curr(parts);
         }
 
+        BSONObj currentKey(size_t numFields) const override {
+            invariant(!isEOF());
+            return getKey();
+        }
+
         void setEndPosition(const BSONObj& key, bool inclusive) override {
             if (key.isEmpty()) {
                 // This means scan to end of index.
@@ -379,6 +384,9 @@ public:
         void setEndPosition(const BSONObj& key, bool inclusive) override {
             MONGO_UNREACHABLE;
         }
+        BSONObj currentKey(size_t numFields) const override {
+            MONGO_UNREACHABLE;
+        }
         boost::optional<IndexKeyEntry> seek(const BSONObj& key,
                                             bool inclusive,
                                             RequestedInfo parts) override {
@@ -28,6 +28,7 @@
 
 #include <boost/optional/optional.hpp>
 #include <boost/optional/optional_io.hpp>
+#include <limits>
 #include <memory>
 
 #include "mongo/db/jsobj.h"
@@ -41,6 +42,7 @@ namespace mongo {
 
 class BSONObjBuilder;
 class BucketDeletionNotification;
+class KeyString;
 class SortedDataBuilderInterface;
 struct ValidateResults;
 
@@ -106,6 +108,14 @@ public:
     virtual SortedDataBuilderInterface* getBulkBuilder(OperationContext* opCtx,
                                                        bool dupsAllowed) = 0;
 
+    /**
+     * Returns true if the builders returned by getBulkBuilder() do not use their OperationContext
+     * in addKey(), which may then be called from a thread other than the one owning it.
+     */
+    virtual bool canAddBulkKeysFromAnyThread() const {
+        return false;
+    }
+
     /**
      * Insert an entry into the index with the specified key and RecordId.
      *
@@ -285,6 +295,26 @@ public:
          */
         virtual boost::optional<IndexKeyEntry> next(RequestedInfo parts = kKeyAndLoc) = 0;
 
+        /**
+         * Returns the key of the entry last returned by next() or a seek method, which may have
+         * been asked for kWantLoc only. This lets callers that skip some of the entries without
+         * looking at their keys, such as a deduplicating index scan, only have the keys they keep
+         * decoded. Only the first 'numFields' fields have to be decoded, so later fields may be
+         * missing from the key. The cursor must not have been moved, saved or reached EOF since.
+         */
+        virtual BSONObj currentKey(size_t numFields = std::numeric_limits<size_t>::max()) const = 0;
+
+        /**
+         * Returns the KeyString the entry last returned by next() or a seek method is stored as,
+         * possibly followed by its RecordId, without decoding it. Callers asking for kWantLoc
+         * only can compare it against KeyStrings of the index's version and ordering and decode
+         * just the keys they need with currentKey(). Returns nullptr if the index does not store
+         * its keys as KeyStrings. Valid under the same conditions as currentKey().
+         */
+        virtual const KeyString* currentKeyString() const {
+            return nullptr;
+        }
+
         //
         // Seeking
         //
@@ -166,5 +166,78 @@ TEST(SortedDataInterface, ExhaustCursorReversed) {
     }
 }
 
+// Call advance() on a forward cursor asking for the RecordIds only, and decode the keys of every
+// other entry afterwards.
+TEST(SortedDataInterface, CurrentKeyOfLocOnlyEntries) {
+    const auto harnessHelper(newSortedDataInterfaceHarnessHelper());
+    const std::unique_ptr<SortedDataInterface> sorted(harnessHelper->newSortedDataInterface(false));
+
+    int nToInsert = 10;
+    for (int i = 0; i < nToInsert; i++) {
+        const ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        {
+            WriteUnitOfWork uow(opCtx.get());
+            BSONObj key = BSON("" << i);
+            RecordId loc(42, i * 2);
+            ASSERT_OK(sorted->insert(opCtx.get(), key, loc, true));
+            uow.commit();
+        }
+    }
+
+    {
+        const ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        const std::unique_ptr<SortedDataInterface::Cursor> cursor(sorted->newCursor(opCtx.get()));
+        const auto kWantLoc = SortedDataInterface::Cursor::kWantLoc;
+        for (int i = 0; i < nToInsert; i++) {
+            auto entry =
+                i == 0 ? cursor->seek(kMinBSONKey, true, kWantLoc) : cursor->next(kWantLoc);
+            ASSERT(entry);
+            ASSERT_EQ(entry->loc, RecordId(42, i * 2));
+            if (i % 2 == 0) {
+                ASSERT_BSONOBJ_EQ(cursor->currentKey(), BSON("" << i));
+            }
+        }
+        ASSERT(!cursor->next(kWantLoc));
+    }
+}
+
+// Decode a prefix of compound keys. Indexes that keep their keys decoded may return more fields
+// than asked for, but always at least the leading ones.
+TEST(SortedDataInterface, CurrentKeyPrefix) {
+    const auto harnessHelper(newSortedDataInterfaceHarnessHelper());
+    const std::unique_ptr<SortedDataInterface> sorted(harnessHelper->newSortedDataInterface(false));
+
+    int nToInsert = 10;
+    for (int i = 0; i < nToInsert; i++) {
+        const ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        {
+            WriteUnitOfWork uow(opCtx.get());
+            BSONObj key = BSON("" << i << "" << -i << "" << "str");
+            RecordId loc(42, i * 2);
+            ASSERT_OK(sorted->insert(opCtx.get(), key, loc, true));
+            uow.commit();
+        }
+    }
+
+    {
+        const ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        const std::unique_ptr<SortedDataInterface::Cursor> cursor(sorted->newCursor(opCtx.get()));
+        const auto kWantLoc = SortedDataInterface::Cursor::kWantLoc;
+        for (int i = 0; i < nToInsert; i++) {
+            auto entry =
+                i == 0 ? cursor->seek(kMinBSONKey, true, kWantLoc) : cursor->next(kWantLoc);
+            ASSERT(entry);
+            ASSERT_BSONOBJ_EQ(cursor->currentKey(), BSON("" << i << "" << -i << "" << "str"));
+
+            BSONObjIterator prefix(cursor->currentKey(2));
+            ASSERT(prefix.more());
+            ASSERT_EQ(prefix.next().numberInt(), i);
+            ASSERT(prefix.more());
+            ASSERT_EQ(prefix.next().numberInt(), -i);
+        }
+        ASSERT(!cursor->next(kWantLoc));
+    }
+}
+
 }  // namespace
 }  // namespace mongo
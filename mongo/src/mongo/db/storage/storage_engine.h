@@ -363,6 +363,15 @@ public:
      */
     virtual void replicationBatchIsComplete() const {};
 
+    /**
+     * Returns the fraction, between 0 and 1, of the storage engine's cache which holds data not yet
+     * written to disk. Background work such as range deletion backs off while this is high.
+     * Engines without such a cache return 0.
+     */
+    virtual double getCacheDirtyRatio() const {
+        return 0.0;
+    }
+
     // (CollectionName, IndexName)
     //KVStorageEngine::reconcileCatalogAndIdentsʹ
     typedef std::pair<std::string, std::string> CollectionIndexNamePair;
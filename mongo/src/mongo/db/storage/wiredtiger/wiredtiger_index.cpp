@@ -788,6 +788,17 @@ public:
         return curr(parts);
     }
 
+    BSONObj currentKey(size_t numFields) const override {
+        invariant(!_eof);
+        return KeyString::toBsonPrefix(
+            _key.getBuffer(), _key.getSize(), _idx.ordering(), _typeBits, numFields);
+    }
+
+    const KeyString* currentKeyString() const override {
+        invariant(!_eof);
+        return &_key;
+    }
+
 	//CountScan::doWork   IndexScan::initIndexScanִ
     void setEndPosition(const BSONObj& key, bool inclusive) override {
         TRACE_CURSOR << "setEndPosition inclusive: " << inclusive << ' ' << key;
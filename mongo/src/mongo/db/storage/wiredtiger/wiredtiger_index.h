@@ -117,6 +117,11 @@ public:
 
     virtual Status compact(OperationContext* opCtx);
 
+    // Bulk builders add keys through a bulk cursor opened on a session of their own.
+    bool canAddBulkKeysFromAnyThread() const override {
+        return true;
+    }
+
     const std::string& uri() const {
         return _uri;
     }
@@ -1513,4 +1513,18 @@ void WiredTigerKVEngine::replicationBatchIsComplete() const {
     _oplogManager->triggerJournalFlush(); //WiredTigerOplogManager::triggerJournalFlush
 }
 
+double WiredTigerKVEngine::getCacheDirtyRatio() const {
+    WiredTigerSession session(_conn);
+
+    auto dirtyBytes = WiredTigerUtil::getStatisticsValueAs<long long>(
+        session.getSession(), "statistics:", "statistics=(fast)", WT_STAT_CONN_CACHE_BYTES_DIRTY);
+    auto cacheBytes = WiredTigerUtil::getStatisticsValueAs<long long>(
+        session.getSession(), "statistics:", "statistics=(fast)", WT_STAT_CONN_CACHE_BYTES_MAX);
+    if (!dirtyBytes.isOK() || !cacheBytes.isOK() || cacheBytes.getValue() <= 0) {
+        return 0.0;
+    }
+
+    return static_cast<double>(dirtyBytes.getValue()) / cacheBytes.getValue();
+}
+
 }  // namespace mongo
@@ -251,6 +251,12 @@ public:
      */
     void replicationBatchIsComplete() const override;
 
+    /**
+     * Returns the tracked dirty bytes in the WiredTiger cache as a fraction of the configured cache
+     * size.
+     */
+    double getCacheDirtyRatio() const override;
+
     /**
      * Sets the implementation for `initRsOplogBackgroundThread` (allowing tests to skip the
      * background job, for example). Intended to be called from a MONGO_INITIALIZER and therefroe in
@@ -34,15 +34,24 @@
 #include <cstring>
 
 #include "mongo/db/storage/wiredtiger/wiredtiger_oplog_manager.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/concurrency/idle_thread_block.h"
 #include "mongo/util/log.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 namespace {
 // This is the minimum valid timestamp; it can be used for reads that need to see all untimestamped
 // data but no timestamped data.  We cannot use 0 here because 0 means see all timestamped data.
 const uint64_t kMinimumTimestamp = 1;
+
+// How long the oplog journal thread lets further commits accumulate after being triggered, so
+// that one journal flush publishes all of them. 0 flushes as soon as the thread is triggered.
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerOplogJournalFlushDelayMicros, int, 0);
 }  // namespace
 
 MONGO_FP_DECLARE(WTPausePrimaryOplogDurabilityLoop);
@@ -123,8 +132,17 @@ void WiredTigerOplogManager::waitForAllEarlierOplogWritesToBeVisible(
     // Close transaction before we wait.
     opCtx->recoveryUnit()->abandonSnapshot();
 
+    Timer waitTimer;
+    ON_BLOCK_EXIT([&] {
+        _visibilityWaits.fetchAndAdd(1);
+        _visibilityWaitMicros.fetchAndAdd(waitTimer.micros());
+    });
+
+    stdx::condition_variable becameVisible;
     stdx::unique_lock<stdx::mutex> lk(_oplogVisibilityStateMutex);
-    opCtx->waitForConditionOrInterrupt(_opsBecameVisibleCV, lk, [&] {
+    const auto waiter = _visibilityWaiters.emplace(waitingFor, &becameVisible);
+    ON_BLOCK_EXIT([&] { _visibilityWaiters.erase(waiter); });
+    opCtx->waitForConditionOrInterrupt(becameVisible, lk, [&] {
         auto newLatestVisibleTimestamp = getOplogReadTimestamp();
         if (newLatestVisibleTimestamp < currentLatestVisibleTimestamp) {
             LOG(1) << "oplog latest visible timestamp went backwards";
@@ -151,6 +169,9 @@ void WiredTigerOplogManager::waitForAllEarlierOplogWritesToBeVisible(
 //WiredTigerKVEngine::replicationBatchIsCompleteеִ
 void WiredTigerOplogManager::triggerJournalFlush() {
     stdx::lock_guard<stdx::mutex> lk(_oplogVisibilityStateMutex);
+    if (!_pendingFlushTriggers++) {
+        _firstPendingTriggerMicros = curTimeMicros64();
+    }
     if (!_opsWaitingForJournal) {
         _opsWaitingForJournal = true;
         _opsWaitingForJournalCV.notify_one();
@@ -179,11 +200,22 @@ void WiredTigerOplogManager::_oplogJournalThreadLoop(WiredTigerSessionCache* ses
             lk.lock();
         }
 
+        const int flushDelayMicros = wiredTigerOplogJournalFlushDelayMicros.load();
+        if (!_shuttingDown && flushDelayMicros > 0) {
+            // Commits triggering a flush in the meantime are published by this one.
+            lk.unlock();
+            sleepmicros(flushDelayMicros);
+            lk.lock();
+        }
+
         if (_shuttingDown) {
             log() << "oplog journal thread loop shutting down";
             return;
         }
         _opsWaitingForJournal = false;
+        const long long batchSize = _pendingFlushTriggers;
+        const unsigned long long firstTriggerMicros = _firstPendingTriggerMicros;
+        _pendingFlushTriggers = 0;
         lk.unlock();
 
         const uint64_t newTimestamp = _fetchAllCommittedValue(sessionCache->conn());
@@ -202,6 +234,15 @@ void WiredTigerOplogManager::_oplogJournalThreadLoop(WiredTigerSessionCache* ses
         _setOplogReadTimestamp(lk, newTimestamp);
         lk.unlock();
 
+        _journalFlushes.fetchAndAdd(1);
+        _journalFlushTriggers.fetchAndAdd(batchSize);
+        _lastJournalFlushBatchSize.store(batchSize);
+        if (batchSize) {
+            const long long lagMicros = curTimeMicros64() - firstTriggerMicros;
+            _visibilityLagMicros.fetchAndAdd(lagMicros);
+            _lastVisibilityLagMicros.store(lagMicros);
+        }
+
         // Wake up any await_data cursors and tell them more data might be visible now.
         oplogRecordStore->notifyCappedWaitersIfNeeded();
 
@@ -223,12 +264,41 @@ void WiredTigerOplogManager::setOplogReadTimestamp(Timestamp ts) {
     _setOplogReadTimestamp(lk, ts.asULL());
 }
 
-void WiredTigerOplogManager::_setOplogReadTimestamp(WithLock, uint64_t newTimestamp) {
-    _oplogReadTimestamp.store(newTimestamp);
-    _opsBecameVisibleCV.notify_all();
+void WiredTigerOplogManager::_setOplogReadTimestamp(WithLock lk, uint64_t newTimestamp) {
+    const uint64_t oldTimestamp = _oplogReadTimestamp.swap(newTimestamp);
+    _notifyVisibilityWaiters(lk, oldTimestamp, newTimestamp);
     LOG(2) << "setting new oplogReadTimestamp: " << newTimestamp;
 }
 
+void WiredTigerOplogManager::_notifyVisibilityWaiters(WithLock,
+                                                      uint64_t oldTimestamp,
+                                                      uint64_t newTimestamp) {
+    // A timestamp going backwards means a rollback, which ends every wait.
+    auto end = _visibilityWaiters.end();
+    if (newTimestamp >= oldTimestamp) {
+        const RecordId latestVisible = std::max(RecordId(newTimestamp), _oplogMaxAtStartup);
+        end = _visibilityWaiters.upper_bound(latestVisible);
+    }
+    for (auto it = _visibilityWaiters.begin(); it != end; ++it) {
+        it->second->notify_one();
+    }
+}
+
+void WiredTigerOplogManager::appendStats(BSONObjBuilder* builder) const {
+    builder->append("journalFlushes", _journalFlushes.load());
+    builder->append("journalFlushTriggers", _journalFlushTriggers.load());
+    builder->append("lastJournalFlushBatchSize", _lastJournalFlushBatchSize.load());
+    builder->append("visibilityLagMicros", _visibilityLagMicros.load());
+    builder->append("lastVisibilityLagMicros", _lastVisibilityLagMicros.load());
+    builder->append("visibilityWaits", _visibilityWaits.load());
+    builder->append("visibilityWaitMicros", _visibilityWaitMicros.load());
+}
+
+size_t WiredTigerOplogManager::getNumVisibilityWaiters_forTest() const {
+    stdx::lock_guard<stdx::mutex> lk(_oplogVisibilityStateMutex);
+    return _visibilityWaiters.size();
+}
+
 uint64_t WiredTigerOplogManager::_fetchAllCommittedValue(WT_CONNECTION* conn) {
     // Fetch the latest all_committed value from the storage engine.  This value will be a
     // timestamp that has no holes (uncommitted transactions with lower timestamps) behind it.
@@ -29,6 +29,8 @@
 
 #pragma once
 
+#include <map>
+
 #include "mongo/base/disallow_copying.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
@@ -81,6 +83,14 @@ public:
     void waitForAllEarlierOplogWritesToBeVisible(const WiredTigerRecordStore* oplogRecordStore,
                                                  OperationContext* opCtx) const;
 
+    // Reports the journal flushes made to publish oplog visibility, how many triggers each
+    // absorbed, how long publishing lagged behind the first trigger and how long operations waited
+    // for their writes to become visible.
+    void appendStats(BSONObjBuilder* builder) const;
+
+    // Returns how many operations are blocked in waitForAllEarlierOplogWritesToBeVisible().
+    size_t getNumVisibilityWaiters_forTest() const;
+
 private:
     void _oplogJournalThreadLoop(WiredTigerSessionCache* sessionCache,
                                  WiredTigerRecordStore* oplogRecordStore,
@@ -88,14 +98,16 @@ private:
 
     void _setOplogReadTimestamp(WithLock, uint64_t newTimestamp);
 
+    // Wakes the operations waiting for RecordIds that are now visible, or all of them if the
+    // visible timestamp went backwards.
+    void _notifyVisibilityWaiters(WithLock, uint64_t oldTimestamp, uint64_t newTimestamp);
+
     uint64_t _fetchAllCommittedValue(WT_CONNECTION* conn);
 
     stdx::thread _oplogJournalThread;
     mutable stdx::mutex _oplogVisibilityStateMutex;
     mutable stdx::condition_variable
         _opsWaitingForJournalCV;  // Signaled to trigger a journal flush.
-    mutable stdx::condition_variable
-        _opsBecameVisibleCV;  // Signaled when a journal flush is complete.
 
     bool _isRunning = false;     // Guarded by the oplogVisibilityStateMutex.
     bool _shuttingDown = false;  // Guarded by oplogVisibilityStateMutex.
@@ -105,6 +117,24 @@ private:
     RecordId _oplogMaxAtStartup = RecordId(0);  // Guarded by oplogVisibilityStateMutex.
     bool _opsWaitingForJournal = false;         // Guarded by oplogVisibilityStateMutex.
 
+    // Operations in waitForAllEarlierOplogWritesToBeVisible(), keyed by the RecordId each waits to
+    // become visible, so that publishing a timestamp only wakes those it satisfies. Guarded by
+    // oplogVisibilityStateMutex.
+    mutable std::multimap<RecordId, stdx::condition_variable*> _visibilityWaiters;
+
+    // Calls to triggerJournalFlush() not yet taken by the journal thread, and the time of the
+    // first of them. Guarded by oplogVisibilityStateMutex.
+    long long _pendingFlushTriggers = 0;
+    unsigned long long _firstPendingTriggerMicros = 0;
+
+    AtomicInt64 _journalFlushes;
+    AtomicInt64 _journalFlushTriggers;
+    AtomicInt64 _lastJournalFlushBatchSize;
+    AtomicInt64 _visibilityLagMicros;
+    AtomicInt64 _lastVisibilityLagMicros;
+    mutable AtomicInt64 _visibilityWaits;
+    mutable AtomicInt64 _visibilityWaitMicros;
+
     //οhttp://www.mongoing.com/archives/25302  ʱ߼ʱ
     AtomicUInt64 _oplogReadTimestamp;
 };
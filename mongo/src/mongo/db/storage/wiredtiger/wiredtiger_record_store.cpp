@@ -77,6 +77,13 @@ static const int kMaximumRecordStoreVersion = 1;
 MONGO_STATIC_ASSERT(kCurrentRecordStoreVersion >= kMinimumRecordStoreVersion);
 MONGO_STATIC_ASSERT(kCurrentRecordStoreVersion <= kMaximumRecordStoreVersion);
 
+// getManyCursors() splits collections into at most kMaxScanRanges ranges of roughly
+// kMinRecordsPerScanRange records or more each. The range boundaries are picked from
+// kSamplesPerScanRange random records per range, which evens out the range sizes.
+const long long kMinRecordsPerScanRange = 1000;
+const long long kMaxScanRanges = 64;
+const long long kSamplesPerScanRange = 8;
+
 void checkOplogFormatVersion(OperationContext* opCtx, const std::string& uri) {
     StatusWith<BSONObj> appMetadata = WiredTigerUtil::getApplicationMetadata(opCtx, uri);
     fassertStatusOK(39999, appMetadata);
@@ -533,6 +540,67 @@ private:
     const std::string _config;
 };
 
+/**
+ * Iterates forwards over the records with ids in ['start', 'end'). A null 'start' or 'end' leaves
+ * that side of the range unbounded.
+ */
+class WiredTigerRecordStore::RangeCursor final : public RecordCursor {
+public:
+    RangeCursor(std::unique_ptr<WiredTigerRecordStoreCursorBase> cursor,
+                RecordId start,
+                RecordId end)
+        : _cursor(std::move(cursor)), _start(start), _end(end) {}
+
+    boost::optional<Record> next() final {
+        if (_eof)
+            return {};
+
+        if (!_positioned) {
+            if (!_start.isNull()) {
+                _cursor->positionAtOrAfter(_start);
+            }
+            _positioned = true;
+        }
+
+        auto record = _cursor->next();
+        if (!record || (!_end.isNull() && record->id >= _end)) {
+            _eof = true;
+            return {};
+        }
+        _returnedAny = true;
+        return record;
+    }
+
+    void save() final {
+        _cursor->save();
+    }
+
+    bool restore() final {
+        // Until a record has been returned the underlying cursor restores to the start of the
+        // record store, so it needs positioning again.
+        if (!_returnedAny) {
+            _positioned = false;
+        }
+        return _cursor->restore();
+    }
+
+    void detachFromOperationContext() final {
+        _cursor->detachFromOperationContext();
+    }
+
+    void reattachToOperationContext(OperationContext* opCtx) final {
+        _cursor->reattachToOperationContext(opCtx);
+    }
+
+private:
+    const std::unique_ptr<WiredTigerRecordStoreCursorBase> _cursor;
+    const RecordId _start;
+    const RecordId _end;
+    bool _positioned = false;
+    bool _returnedAny = false;
+    bool _eof = false;
+};
+
 //WiredTigerRecordStore::generateCreateStringȡwiredtigeruri
 //WiredTigerIndex::generateCreateStringȡwiredtigeruri
 //WiredTigerKVEngine::createGroupedRecordStore  
@@ -1430,8 +1498,52 @@ std::unique_ptr<RecordCursor> WiredTigerRecordStore::getRandomCursor(
 
 std::vector<std::unique_ptr<RecordCursor>> WiredTigerRecordStore::getManyCursors(
     OperationContext* opCtx) const {
-    std::vector<std::unique_ptr<RecordCursor>> cursors(1);
-    cursors[0] = getCursor(opCtx, /*forward=*/true);
+    std::vector<std::unique_ptr<RecordCursor>> cursors;
+
+    // Capped collections, including the oplog, must be read in insertion order by a single cursor.
+    const long long numRanges =
+        std::min(kMaxScanRanges, numRecords(opCtx) / kMinRecordsPerScanRange);
+    if (_isCapped || numRanges < 2) {
+        cursors.push_back(getCursor(opCtx, /*forward=*/true));
+        return cursors;
+    }
+
+    std::vector<RecordId> samples;
+    auto random = getRandomCursor(opCtx);
+    for (long long i = 0; i < numRanges * kSamplesPerScanRange; ++i) {
+        auto record = random->next();
+        if (!record)
+            break;
+        samples.push_back(record->id);
+    }
+    random.reset();
+
+    std::sort(samples.begin(), samples.end());
+    samples.erase(std::unique(samples.begin(), samples.end()), samples.end());
+
+    // The record count is only an estimate, so the collection may have too few records left to
+    // split into ranges.
+    if (samples.size() < 2) {
+        cursors.push_back(getCursor(opCtx, /*forward=*/true));
+        return cursors;
+    }
+
+    RecordId start;
+    auto makeRangeCursor = [&](RecordId end) {
+        std::unique_ptr<WiredTigerRecordStoreCursorBase> cursor(
+            checked_cast<WiredTigerRecordStoreCursorBase*>(
+                getCursor(opCtx, /*forward=*/true).release()));
+        cursors.push_back(stdx::make_unique<RangeCursor>(std::move(cursor), start, end));
+        start = end;
+    };
+
+    for (long long i = 1; i < numRanges; ++i) {
+        const RecordId& boundary = samples[i * samples.size() / numRanges];
+        if (boundary > start) {
+            makeRangeCursor(boundary);
+        }
+    }
+    makeRangeCursor(RecordId());
     return cursors;
 }
 
@@ -1853,6 +1965,34 @@ boost::optional<Record> WiredTigerRecordStoreCursorBase::seekExact(const RecordI
 }
 
 
+void WiredTigerRecordStoreCursorBase::positionAtOrAfter(const RecordId& start) {
+    invariant(_forward && _lastReturnedId.isNull());
+    _skipNextAdvance = false;
+
+    WT_CURSOR* c = _cursor->get();
+    setKey(c, start);
+
+    int cmp;
+    // Nothing after the next line can throw WCEs.
+    int ret = WT_READ_CHECK(c->search_near(c, &cmp));
+    if (ret == WT_NOTFOUND) {
+        _eof = true;
+        return;
+    }
+    invariantWTOK(ret);
+
+    // If we landed before 'start', the next call to next() advances onto the first record after
+    // it. Otherwise we are already on that record and next() returns it without advancing.
+    if (cmp >= 0) {
+        RecordId id;
+        if (hasWrongPrefix(c, &id)) {
+            _eof = true;
+            return;
+        }
+        _skipNextAdvance = true;
+    }
+}
+
 void WiredTigerRecordStoreCursorBase::save() {
     try {
         if (_cursor)
@@ -300,6 +300,7 @@ protected:
 
 private:
     class RandomCursor;
+    class RangeCursor;
 
     class NumRecordsChange;
     class DataSizeChange;
@@ -425,6 +426,13 @@ public:
 
     boost::optional<Record> seekExact(const RecordId& id);
 
+    /**
+     * Positions a forward cursor that has not returned anything yet so that the following call to
+     * next() returns the first record with an id at or after 'start'. Used to iterate a range of
+     * the record store.
+     */
+    void positionAtOrAfter(const RecordId& start);
+
     void save();
 
     void saveUnpositioned();
@@ -29,6 +29,7 @@
 #include "mongo/platform/basic.h"
 
 #include <memory>
+#include <set>
 #include <sstream>
 #include <string>
 #include <time.h>
@@ -40,18 +41,24 @@
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/json.h"
 #include "mongo/db/operation_context_noop.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/kv/kv_prefix.h"
 #include "mongo/db/storage/record_store_test_harness.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_oplog_manager.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store_oplog_stones.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_size_storer.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/fail_point.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 namespace {
@@ -351,6 +358,170 @@ TEST(WiredTigerRecordStoreTest, OplogDurableVisibilityOutOfOrder) {
     ASSERT(!wtrs->isOpHidden_forTest(id2));
 }
 
+WiredTigerOplogManager* getOplogManager(OperationContext* opCtx) {
+    return WiredTigerRecoveryUnit::get(opCtx)->getSessionCache()->getKVEngine()->getOplogManager();
+}
+
+/**
+ * Calls waitForAllEarlierOplogWritesToBeVisible() on a separate thread, and so waits for the
+ * newest oplog entry at the time it is constructed to become visible. The constructor returns
+ * once the wait has been registered with the oplog manager.
+ */
+class OplogVisibilityWaiter {
+public:
+    OplogVisibilityWaiter(RecordStoreHarnessHelper* harnessHelper, RecordStore* rs)
+        : _client(harnessHelper->serviceContext()->makeClient("visibilityWaiter")),
+          _opCtx(harnessHelper->newOperationContext(_client.get())) {
+        auto oplogManager = getOplogManager(_opCtx.get());
+        const auto numWaiters = oplogManager->getNumVisibilityWaiters_forTest();
+
+        _thread = stdx::thread([this, rs] {
+            rs->waitForAllEarlierOplogWritesToBeVisible(_opCtx.get());
+            _done.store(true);
+        });
+
+        while (!_done.load() && oplogManager->getNumVisibilityWaiters_forTest() == numWaiters) {
+            sleepmillis(1);
+        }
+    }
+
+    ~OplogVisibilityWaiter() {
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+    }
+
+    bool isDone() const {
+        return _done.load();
+    }
+
+    void join() {
+        _thread.join();
+    }
+
+private:
+    ServiceContext::UniqueClient _client;
+    ServiceContext::UniqueOperationContext _opCtx;
+    AtomicBool _done{false};
+    stdx::thread _thread;
+};
+
+RecordId _insertOplogEntry(RecordStoreHarnessHelper* harnessHelper,
+                           const unique_ptr<RecordStore>& rs,
+                           int inc) {
+    ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+    WriteUnitOfWork uow(opCtx.get());
+    RecordId id = _oplogOrderInsertOplog(opCtx.get(), rs, inc);
+    uow.commit();
+    return id;
+}
+
+// Test that publishing an oplog read timestamp only releases the operations waiting for entries at
+// or before it.
+TEST(WiredTigerRecordStoreTest, OplogVisibilityReleasesOnlyWaitersForVisibleEntries) {
+    ON_BLOCK_EXIT([] { WTPausePrimaryOplogDurabilityLoop.setMode(FailPoint::off); });
+    WTPausePrimaryOplogDurabilityLoop.setMode(FailPoint::alwaysOn);
+
+    unique_ptr<RecordStoreHarnessHelper> harnessHelper(newRecordStoreHarnessHelper());
+    unique_ptr<RecordStore> rs(harnessHelper->newCappedRecordStore("local.oplog.rs", 100000, -1));
+    auto wtrs = checked_cast<WiredTigerRecordStore*>(rs.get());
+    auto oplogManager = getOplogManager(harnessHelper->newOperationContext().get());
+
+    RecordId id1 = _insertOplogEntry(harnessHelper.get(), rs, 1);
+    OplogVisibilityWaiter waiterForId1(harnessHelper.get(), rs.get());
+
+    RecordId id2 = _insertOplogEntry(harnessHelper.get(), rs, 2);
+    OplogVisibilityWaiter waiterForId2(harnessHelper.get(), rs.get());
+
+    ASSERT_EQ(2U, oplogManager->getNumVisibilityWaiters_forTest());
+    ASSERT(wtrs->isOpHidden_forTest(id1));
+    ASSERT(wtrs->isOpHidden_forTest(id2));
+
+    oplogManager->setOplogReadTimestamp(Timestamp(id1.repr()));
+    waiterForId1.join();
+
+    sleepmillis(100);
+    ASSERT_FALSE(waiterForId2.isDone());
+    ASSERT_EQ(1U, oplogManager->getNumVisibilityWaiters_forTest());
+
+    oplogManager->setOplogReadTimestamp(Timestamp(id2.repr()));
+    waiterForId2.join();
+    ASSERT_EQ(0U, oplogManager->getNumVisibilityWaiters_forTest());
+}
+
+// Test that the oplog read timestamp going backwards, as it does on rollback, releases every
+// operation waiting for oplog visibility even though the entries they wait for are still hidden.
+TEST(WiredTigerRecordStoreTest, OplogVisibilityGoingBackwardsReleasesAllWaiters) {
+    ON_BLOCK_EXIT([] { WTPausePrimaryOplogDurabilityLoop.setMode(FailPoint::off); });
+    WTPausePrimaryOplogDurabilityLoop.setMode(FailPoint::alwaysOn);
+
+    unique_ptr<RecordStoreHarnessHelper> harnessHelper(newRecordStoreHarnessHelper());
+    unique_ptr<RecordStore> rs(harnessHelper->newCappedRecordStore("local.oplog.rs", 100000, -1));
+    auto wtrs = checked_cast<WiredTigerRecordStore*>(rs.get());
+    auto oplogManager = getOplogManager(harnessHelper->newOperationContext().get());
+
+    RecordId id1 = _insertOplogEntry(harnessHelper.get(), rs, 1);
+    oplogManager->setOplogReadTimestamp(Timestamp(id1.repr()));
+
+    RecordId id2 = _insertOplogEntry(harnessHelper.get(), rs, 2);
+    OplogVisibilityWaiter firstWaiter(harnessHelper.get(), rs.get());
+    OplogVisibilityWaiter secondWaiter(harnessHelper.get(), rs.get());
+    ASSERT_EQ(2U, oplogManager->getNumVisibilityWaiters_forTest());
+
+    oplogManager->setOplogReadTimestamp(Timestamp(4, 1));
+    firstWaiter.join();
+    secondWaiter.join();
+
+    ASSERT_EQ(0U, oplogManager->getNumVisibilityWaiters_forTest());
+    ASSERT(wtrs->isOpHidden_forTest(id2));
+}
+
+// Test that commits made while the oplog journal thread holds off its flush for
+// wiredTigerOplogJournalFlushDelayMicros are all published by a single flush, and that the
+// oplogVisibility statistics account for it.
+TEST(WiredTigerRecordStoreTest, OplogJournalFlushDelayBatchesCommits) {
+    const long long kFlushDelayMicros = 200 * 1000;
+
+    auto flushDelayParam =
+        ServerParameterSet::getGlobal()->getMap().find("wiredTigerOplogJournalFlushDelayMicros");
+    ASSERT(flushDelayParam != ServerParameterSet::getGlobal()->getMap().end());
+    ON_BLOCK_EXIT([&] { ASSERT_OK(flushDelayParam->second->setFromString("0")); });
+    ASSERT_OK(flushDelayParam->second->setFromString(std::to_string(kFlushDelayMicros)));
+
+    unique_ptr<RecordStoreHarnessHelper> harnessHelper(newRecordStoreHarnessHelper());
+    unique_ptr<RecordStore> rs(harnessHelper->newCappedRecordStore("local.oplog.rs", 100000, -1));
+    auto wtrs = checked_cast<WiredTigerRecordStore*>(rs.get());
+    ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+    auto oplogManager = getOplogManager(opCtx.get());
+
+    auto getStats = [&] {
+        BSONObjBuilder builder;
+        oplogManager->appendStats(&builder);
+        return builder.obj();
+    };
+    const BSONObj before = getStats();
+
+    _insertOplogEntry(harnessHelper.get(), rs, 1);
+    _insertOplogEntry(harnessHelper.get(), rs, 2);
+    RecordId id3 = _insertOplogEntry(harnessHelper.get(), rs, 3);
+
+    rs->waitForAllEarlierOplogWritesToBeVisible(opCtx.get());
+    ASSERT_FALSE(wtrs->isOpHidden_forTest(id3));
+
+    const BSONObj after = getStats();
+    auto delta = [&](StringData field) {
+        return after[field].numberLong() - before[field].numberLong();
+    };
+
+    ASSERT_EQ(1, delta("journalFlushes"));
+    ASSERT_EQ(3, delta("journalFlushTriggers"));
+    ASSERT_EQ(3, after["lastJournalFlushBatchSize"].numberLong());
+    ASSERT_GTE(after["lastVisibilityLagMicros"].numberLong(), kFlushDelayMicros);
+    ASSERT_GTE(delta("visibilityLagMicros"), kFlushDelayMicros);
+    ASSERT_EQ(1, delta("visibilityWaits"));
+    ASSERT_GTE(delta("visibilityWaitMicros"), 0);
+}
+
 TEST(WiredTigerRecordStoreTest, AppendCustomStatsMetadata) {
     std::unique_ptr<RecordStoreHarnessHelper> harnessHelper = newRecordStoreHarnessHelper();
     unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore("a.b"));
@@ -403,6 +574,41 @@ TEST(WiredTigerRecordStoreTest, CappedCursorYieldFirst) {
     ASSERT(!cursor->next());
 }
 
+// getManyCursors() splits a large collection into disjoint ranges which together return every
+// record exactly once, even when they yield before their first call to next().
+TEST(WiredTigerRecordStoreTest, ManyCursorsPartitionRecordStore) {
+    unique_ptr<RecordStoreHarnessHelper> harnessHelper(newRecordStoreHarnessHelper());
+    unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
+
+    const int numRecords = 5000;
+    std::set<RecordId> inserted;
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        WriteUnitOfWork uow(opCtx.get());
+        for (int i = 0; i < numRecords; i++) {
+            StatusWith<RecordId> res = rs->insertRecord(opCtx.get(), "a", 2, Timestamp(), false);
+            ASSERT_OK(res.getStatus());
+            inserted.insert(res.getValue());
+        }
+        uow.commit();
+    }
+
+    ServiceContext::UniqueOperationContext cursorCtx(harnessHelper->newOperationContext());
+    auto cursors = rs->getManyCursors(cursorCtx.get());
+    ASSERT_GT(cursors.size(), 1U);
+
+    std::set<RecordId> seen;
+    for (auto&& cursor : cursors) {
+        cursor->save();
+        cursorCtx->recoveryUnit()->abandonSnapshot();
+        ASSERT_TRUE(cursor->restore());
+        while (auto record = cursor->next()) {
+            ASSERT_TRUE(seen.insert(record->id).second);
+        }
+    }
+    ASSERT_TRUE(seen == inserted);
+}
+
 BSONObj makeBSONObjWithSize(const Timestamp& opTime, int size, char fill = 'x') {
     BSONObj objTemplate = BSON("ts" << opTime << "str"
                                     << "");
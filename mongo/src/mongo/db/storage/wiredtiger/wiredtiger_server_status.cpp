@@ -80,6 +80,11 @@ BSONObj WiredTigerServerStatusSection::generateSection(OperationContext* opCtx,
 
     WiredTigerKVEngine::appendGlobalStats(bob);
 
+    {
+        BSONObjBuilder oplogBuilder(bob.subobjStart("oplogVisibility"));
+        _engine->getOplogManager()->appendStats(&oplogBuilder);
+    }
+
     return bob.obj();
 }
 
@@ -41,6 +41,7 @@
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/service_context_d.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/dbtests/dbtests.h"
 
 namespace IndexUpdateTests {
@@ -803,6 +804,271 @@ public:
     }
 };
 
+/**
+ * Fixture for foreground builds of several indexes, which generate keys and bulk load the indexes
+ * on 'kParallelism' threads. There are more indexes than threads in most tests, so that some
+ * threads handle several indexes.
+ */
+class ParallelIndexBuildBase : public IndexBuildBase {
+public:
+    static const int kParallelism = 3;
+
+    // Enough documents for the scan to hand several batches to the key generating threads.
+    static const int kNumDocs = 2000;
+
+    ParallelIndexBuildBase()
+        : _parallelism(ServerParameterSet::getGlobal()
+                           ->getMap()
+                           .find("internalIndexBuildParallelism")
+                           ->second) {
+        BSONObjBuilder bob;
+        _parallelism->append(&_opCtx, bob, "value");
+        _originalParallelism = bob.obj()["value"].numberInt();
+        ASSERT_OK(_parallelism->setFromString(std::to_string(kParallelism)));
+    }
+
+    ~ParallelIndexBuildBase() {
+        _parallelism->setFromString(std::to_string(_originalParallelism)).transitional_ignore();
+    }
+
+protected:
+    /**
+     * Inserts 'kNumDocs' documents {_id: i, a: i, b: i % 10, c: "<i>", d: [i, i + 1]}, then
+     * 'extraDocs'.
+     */
+    void insertDocuments(const std::vector<BSONObj>& extraDocs = {}) {
+        WriteUnitOfWork wunit(&_opCtx);
+        OpDebug* const nullOpDebug = nullptr;
+        for (int i = 0; i < kNumDocs; ++i) {
+            ASSERT_OK(collection()->insertDocument(
+                &_opCtx,
+                InsertStatement(BSON("_id" << i << "a" << i << "b" << i % 10 << "c"
+                                           << std::to_string(i)
+                                           << "d"
+                                           << BSON_ARRAY(i << i + 1))),
+                nullOpDebug,
+                true));
+        }
+        for (auto&& doc : extraDocs) {
+            ASSERT_OK(
+                collection()->insertDocument(&_opCtx, InsertStatement(doc), nullOpDebug, true));
+        }
+        wunit.commit();
+    }
+
+    static BSONObj indexSpec(const std::string& name,
+                             const BSONObj& key,
+                             const BSONObj& options = BSONObj()) {
+        BSONObjBuilder bob;
+        bob.append("name", name);
+        bob.append("ns", _ns);
+        bob.append("key", key);
+        bob.append("v", static_cast<int>(kIndexVersion));
+        bob.appendElements(options);
+        return bob.obj();
+    }
+
+    /**
+     * Builds the indexes of 'specs' in the foreground and commits them if the build succeeds.
+     */
+    Status buildIndexes(const std::vector<BSONObj>& specs, std::set<RecordId>* dupsOut = nullptr) {
+        MultiIndexBlock indexer(&_opCtx, collection());
+        indexer.allowInterruption();
+
+        Status status = indexer.init(specs).getStatus();
+        if (status.isOK()) {
+            status = indexer.insertAllDocumentsInCollection(dupsOut);
+        }
+        if (!status.isOK()) {
+            return status;
+        }
+
+        WriteUnitOfWork wunit(&_opCtx);
+        indexer.commit();
+        wunit.commit();
+        return Status::OK();
+    }
+
+    bool indexExists(const std::string& name) {
+        return collection()->getIndexCatalog()->findIndexByName(&_opCtx, name);
+    }
+
+    /**
+     * Runs a full validation of the collection, asserts that it is valid and returns the number
+     * of keys of each index, keyed by index name.
+     */
+    std::map<std::string, long long> validate() {
+        BSONObj result;
+        ASSERT_TRUE(_client.runCommand("unittests",
+                                       BSON("validate"
+                                            << "indexupdate"
+                                            << "full"
+                                            << true),
+                                       result))
+            << result;
+        ASSERT_TRUE(result["valid"].trueValue()) << result;
+
+        std::map<std::string, long long> keysPerIndex;
+        for (auto&& elem : result["keysPerIndex"].Obj()) {
+            const StringData indexNs = elem.fieldNameStringData();
+            keysPerIndex[indexNs.substr(indexNs.find('$') + 1).toString()] = elem.numberLong();
+        }
+        return keysPerIndex;
+    }
+
+private:
+    ServerParameter* const _parallelism;
+    int _originalParallelism;
+};
+
+const int ParallelIndexBuildBase::kParallelism;
+const int ParallelIndexBuildBase::kNumDocs;
+
+/** Several indexes, some of them multikey, are built completely and consistently. */
+class ParallelBuildOfSeveralIndexes : public ParallelIndexBuildBase {
+public:
+    void run() {
+        insertDocuments();
+        ASSERT_OK(buildIndexes({indexSpec("a_1", BSON("a" << 1)),
+                                indexSpec("b_1", BSON("b" << 1)),
+                                indexSpec("c_1", BSON("c" << 1)),
+                                indexSpec("d_1", BSON("d" << 1)),
+                                indexSpec("b_1_a_-1", BSON("b" << 1 << "a" << -1))}));
+
+        auto keysPerIndex = validate();
+        ASSERT_EQUALS(kNumDocs, keysPerIndex["_id_"]);
+        ASSERT_EQUALS(kNumDocs, keysPerIndex["a_1"]);
+        ASSERT_EQUALS(kNumDocs, keysPerIndex["b_1"]);
+        ASSERT_EQUALS(kNumDocs, keysPerIndex["c_1"]);
+        ASSERT_EQUALS(2 * kNumDocs, keysPerIndex["d_1"]);
+        ASSERT_EQUALS(kNumDocs, keysPerIndex["b_1_a_-1"]);
+    }
+};
+
+/** Partial indexes only get the keys of the documents matching their filter. */
+class ParallelBuildOfPartialIndexes : public ParallelIndexBuildBase {
+public:
+    void run() {
+        insertDocuments();
+        ASSERT_OK(buildIndexes(
+            {indexSpec("a_1", BSON("a" << 1)),
+             indexSpec("b_1_partial",
+                       BSON("b" << 1),
+                       BSON("partialFilterExpression" << BSON("b" << BSON("$gte" << 6)))),
+             indexSpec("c_1_partial",
+                       BSON("c" << 1),
+                       BSON("partialFilterExpression" << BSON("a" << BSON("$lt" << 100)))),
+             indexSpec("d_1_partial",
+                       BSON("d" << 1),
+                       BSON("partialFilterExpression"
+                            << BSON("a" << BSON("$gte" << kNumDocs - 10))))}));
+
+        auto keysPerIndex = validate();
+        ASSERT_EQUALS(kNumDocs, keysPerIndex["a_1"]);
+        ASSERT_EQUALS(kNumDocs * 4 / 10, keysPerIndex["b_1_partial"]);
+        ASSERT_EQUALS(100, keysPerIndex["c_1_partial"]);
+        ASSERT_EQUALS(20, keysPerIndex["d_1_partial"]);
+    }
+};
+
+/** A duplicate key in a unique index fails the whole build. */
+class ParallelBuildEnforcesUnique : public ParallelIndexBuildBase {
+public:
+    void run() {
+        insertDocuments({BSON("_id" << kNumDocs << "a" << 7)});
+        const Status status =
+            buildIndexes({indexSpec("b_1", BSON("b" << 1)),
+                          indexSpec("a_1", BSON("a" << 1), BSON("unique" << true)),
+                          indexSpec("c_1", BSON("c" << 1)),
+                          indexSpec("d_1", BSON("d" << 1))});
+        ASSERT_EQUALS(ErrorCodes::DuplicateKey, status);
+
+        ASSERT_FALSE(indexExists("a_1"));
+        ASSERT_FALSE(indexExists("b_1"));
+        validate();
+    }
+};
+
+/** With dupsOut, the build records the duplicates of a unique index rather than failing. */
+class ParallelBuildFillsDups : public ParallelIndexBuildBase {
+public:
+    void run() {
+        insertDocuments({BSON("_id" << kNumDocs << "a" << 7)});
+
+        std::set<RecordId> dups;
+        ASSERT_OK(buildIndexes({indexSpec("b_1", BSON("b" << 1)),
+                                indexSpec("a_1", BSON("a" << 1), BSON("unique" << true)),
+                                indexSpec("c_1", BSON("c" << 1)),
+                                indexSpec("d_1", BSON("d" << 1))},
+                               &dups));
+
+        // Either of the two documents with a: 7 is reported, but not both.
+        ASSERT_EQUALS(1U, dups.size());
+        const BSONObj dup = collection()->docFor(&_opCtx, *dups.begin()).value();
+        ASSERT_EQUALS(7, dup["a"].numberInt());
+        ASSERT_TRUE(indexExists("a_1"));
+        ASSERT_TRUE(indexExists("d_1"));
+    }
+};
+
+/**
+ * A key generation error in a batch handed to the worker threads after the first few fails the
+ * build, whether the scanning thread sees it while queueing or once the scan is done.
+ */
+class ParallelBuildKeyGenerationErrorInLaterBatch : public ParallelIndexBuildBase {
+public:
+    void run() {
+        // Indexing two arrays in one compound index is not allowed.
+        insertDocuments({BSON("_id" << kNumDocs << "a" << BSON_ARRAY(1 << 2) << "d"
+                                    << BSON_ARRAY(3 << 4))});
+        const Status status = buildIndexes({indexSpec("b_1", BSON("b" << 1)),
+                                            indexSpec("c_1", BSON("c" << 1)),
+                                            indexSpec("a_1_d_1", BSON("a" << 1 << "d" << 1)),
+                                            indexSpec("d_1", BSON("d" << 1))});
+        ASSERT_EQUALS(ErrorCodes::CannotIndexParallelArrays, status);
+
+        ASSERT_FALSE(indexExists("a_1_d_1"));
+        ASSERT_FALSE(indexExists("b_1"));
+        validate();
+    }
+};
+
+/** Killing the operation while the worker threads bulk load the indexes fails the build. */
+class ParallelBuildInterruptedDuringBulkLoad : public ParallelIndexBuildBase {
+public:
+    void run() {
+        insertDocuments();
+        {
+            MultiIndexBlock indexer(&_opCtx, collection());
+            indexer.allowInterruption();
+            ASSERT_OK(indexer.init({indexSpec("a_1", BSON("a" << 1)),
+                                    indexSpec("b_1", BSON("b" << 1)),
+                                    indexSpec("c_1", BSON("c" << 1)),
+                                    indexSpec("d_1", BSON("d" << 1))})
+                          .getStatus());
+
+            // Feed the documents directly, so that the kill is first noticed by the bulk load.
+            auto cursor = collection()->getCursor(&_opCtx);
+            while (auto record = cursor->next()) {
+                WriteUnitOfWork wunit(&_opCtx);
+                ASSERT_OK(indexer.insert(record->data.releaseToBson(), record->id));
+                wunit.commit();
+            }
+            cursor.reset();
+
+            getGlobalServiceContext()->setKillAllOperations();
+            const Status status = indexer.doneInserting();
+            ASSERT_TRUE(ErrorCodes::isInterruption(status.code())) << status;
+            getGlobalServiceContext()->unsetKillAllOperations();
+        }
+
+        ASSERT_FALSE(indexExists("a_1"));
+        ASSERT_FALSE(indexExists("d_1"));
+        auto keysPerIndex = validate();
+        ASSERT_EQUALS(1U, keysPerIndex.size());
+    }
+};
+
 class IndexUpdateTests : public Suite {
 public:
     IndexUpdateTests() : Suite("indexupdate") {}
@@ -818,6 +1084,12 @@ public:
         add<InsertBuildIndexInterruptDisallowed>();
         add<InsertBuildIdIndexInterrupt>();
         add<InsertBuildIdIndexInterruptDisallowed>();
+        add<ParallelBuildOfSeveralIndexes>();
+        add<ParallelBuildOfPartialIndexes>();
+        add<ParallelBuildEnforcesUnique>();
+        add<ParallelBuildFillsDups>();
+        add<ParallelBuildKeyGenerationErrorInLaterBatch>();
+        add<ParallelBuildInterruptedDuringBulkLoad>();
         add<SameSpecDifferentOption>();
         add<SameSpecSameOptions>();
         add<DifferentSpecSameName>();
@@ -44,10 +44,12 @@
 #include "mongo/db/matcher/expression_parser.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/query/plan_executor.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/storage/record_store.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/fail_point_service.h"
+#include "mongo/util/scopeguard.h"
 
 namespace QueryStageCollectionScan {
 
@@ -400,6 +402,116 @@ public:
     }
 };
 
+//
+// Batched execution returns the same documents, in the same order, as single-document execution.
+//
+
+class QueryStageCollscanBatchedMatchesSingle : public QueryStageCollectionScanBase {
+public:
+    void run() {
+        AutoGetCollectionForReadCommand ctx(&_opCtx, nss);
+        Collection* coll = ctx.getCollection();
+
+        vector<RecordId> expected;
+        getRecordIds(coll, CollectionScanParams::FORWARD, &expected);
+        ASSERT_EQUALS(static_cast<size_t>(numObj()), expected.size());
+
+        WorkingSet ws;
+        CollectionScanParams params;
+        params.collection = coll;
+        params.direction = CollectionScanParams::FORWARD;
+        params.tailable = false;
+        unique_ptr<CollectionScan> scan(new CollectionScan(&_opCtx, params, &ws, NULL));
+        ASSERT_TRUE(scan->supportsBatchedWork());
+
+        vector<RecordId> actual;
+        while (!scan->isEOF()) {
+            vector<WorkingSetID> results;
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            PlanStage::StageState state = scan->workBatch(7, &results, &id);
+            ASSERT_LTE(results.size(), 7U);
+            ASSERT_EQUALS(PlanStage::ADVANCED == state, !results.empty());
+            for (auto&& result : results) {
+                WorkingSetMember* member = ws.get(result);
+                ASSERT_TRUE(member->hasRecordId());
+                ASSERT_TRUE(member->hasOwnedObj());
+                actual.push_back(member->recordId);
+                ws.free(result);
+            }
+        }
+        ASSERT(expected == actual);
+        ASSERT_EQUALS(static_cast<size_t>(numObj()), scan->getCommonStats()->advanced);
+    }
+};
+
+//
+// The PlanExecutor drives batched execution when the knob is set.
+//
+
+class QueryStageCollscanBatchedExecutorWithMatch : public QueryStageCollectionScanBase {
+public:
+    void run() {
+        const int oldBatchSize = internalQueryExecBatchedWorkSize.load();
+        ON_BLOCK_EXIT([&] { internalQueryExecBatchedWorkSize.store(oldBatchSize); });
+        internalQueryExecBatchedWorkSize.store(8);
+
+        BSONObj obj = BSON("foo" << BSON("$lt" << 25));
+        ASSERT_EQUALS(25, countResults(CollectionScanParams::FORWARD, obj));
+        ASSERT_EQUALS(25, countResults(CollectionScanParams::BACKWARD, obj));
+        ASSERT_EQUALS(numObj(), countResults(CollectionScanParams::FORWARD, BSONObj()));
+    }
+};
+
+//
+// A scan with projected fields returns owned objects holding only those fields, and does not parse
+// records past the last of them.
+//
+
+class QueryStageCollscanProjectedFields : public QueryStageCollectionScanBase {
+public:
+    void run() {
+        AutoGetCollectionForReadCommand ctx(&_opCtx, nss);
+
+        const CollatorInterface* collator = nullptr;
+        const boost::intrusive_ptr<ExpressionContext> expCtx(
+            new ExpressionContext(&_opCtx, collator));
+        StatusWithMatchExpression statusWithMatcher =
+            MatchExpressionParser::parse(BSON("foo" << BSON("$lt" << 10)), expCtx);
+        ASSERT_OK(statusWithMatcher.getStatus());
+        unique_ptr<MatchExpression> filterExpr = std::move(statusWithMatcher.getValue());
+
+        WorkingSet ws;
+        CollectionScanParams params;
+        params.collection = ctx.getCollection();
+        params.direction = CollectionScanParams::FORWARD;
+        params.projectedFields = {"_id"};
+        unique_ptr<CollectionScan> scan(
+            new CollectionScan(&_opCtx, params, &ws, filterExpr.get()));
+
+        int count = 0;
+        while (!scan->isEOF()) {
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            if (PlanStage::ADVANCED != scan->work(&id)) {
+                continue;
+            }
+            WorkingSetMember* member = ws.get(id);
+            ASSERT_EQUALS(WorkingSetMember::OWNED_OBJ, member->getState());
+            ASSERT_FALSE(member->hasRecordId());
+            const BSONObj& obj = member->obj.value();
+            ASSERT_EQUALS(1, obj.nFields());
+            ASSERT_TRUE(obj.hasField("_id"));
+            ws.free(id);
+            ++count;
+        }
+        ASSERT_EQUALS(10, count);
+
+        // Only the matching records are projected, and each skips its 'foo' field.
+        const auto* stats = static_cast<const CollectionScanStats*>(scan->getSpecificStats());
+        const long long fooFieldSize = BSON("foo" << 0).objsize() - BSONObj::kMinBSONLength;
+        ASSERT_EQUALS(10 * fooFieldSize, stats->bytesSkipped);
+    }
+};
+
 class All : public Suite {
 public:
     All() : Suite("QueryStageCollectionScan") {}
@@ -414,6 +526,9 @@ public:
         add<QueryStageCollscanObjectsInOrderBackward>();
         add<QueryStageCollscanInvalidateUpcomingObject>();
         add<QueryStageCollscanInvalidateUpcomingObjectBackward>();
+        add<QueryStageCollscanBatchedMatchesSingle>();
+        add<QueryStageCollscanBatchedExecutorWithMatch>();
+        add<QueryStageCollscanProjectedFields>();
     }
 };
 
@@ -0,0 +1,312 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file tests db/exec/parallel_collection_scan.cpp.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <set>
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/client.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/dbdirectclient.h"
+#include "mongo/db/exec/parallel_collection_scan.h"
+#include "mongo/db/exec/working_set.h"
+#include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/pipeline/expression_context.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/collation/collator_interface_mock.h"
+#include "mongo/db/query/get_executor.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/dbtests/dbtests.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/util/time_support.h"
+
+namespace QueryStageParallelCollectionScan {
+
+using std::unique_ptr;
+using stdx::make_unique;
+
+static const NamespaceString nss{"unittests.QueryStageParallelCollectionScan"};
+
+const size_t kWorkers = 4;
+
+class QueryStageParallelCollectionScanBase {
+public:
+    explicit QueryStageParallelCollectionScanBase(int numObj = 2000)
+        : _client(&_opCtx), _numObj(numObj) {
+        OldClientWriteContext ctx(&_opCtx, nss.ns());
+        for (int i = 0; i < _numObj; ++i) {
+            _client.insert(nss.ns(),
+                           BSON("_id" << i << "foo" << i << "str" << (i % 2 ? "ABC" : "xyz")));
+        }
+    }
+
+    virtual ~QueryStageParallelCollectionScanBase() {
+        OldClientWriteContext ctx(&_opCtx, nss.ns());
+        _client.dropCollection(nss.ns());
+    }
+
+    int numObj() const {
+        return _numObj;
+    }
+
+    /**
+     * Parses 'filterObj' using 'collator'. Both must outlive the stage, unlike whatever the
+     * workers use.
+     */
+    unique_ptr<MatchExpression> parseFilter(const BSONObj& filterObj,
+                                            const CollatorInterface* collator) {
+        const boost::intrusive_ptr<ExpressionContext> expCtx(
+            new ExpressionContext(&_opCtx, collator));
+        return uassertStatusOK(MatchExpressionParser::parse(filterObj, expCtx));
+    }
+
+    /**
+     * Works 'scan' to EOF and returns the "foo" values of the documents it returned.
+     */
+    std::multiset<int> runToEOF(ParallelCollectionScan* scan, WorkingSet* ws) {
+        std::multiset<int> values;
+        while (true) {
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            PlanStage::StageState state = scan->work(&id);
+            if (PlanStage::IS_EOF == state) {
+                return values;
+            }
+            ASSERT_NOT_EQUALS(PlanStage::FAILURE, state);
+            if (PlanStage::ADVANCED == state) {
+                WorkingSetMember* member = ws->get(id);
+                ASSERT_TRUE(member->hasOwnedObj());
+                values.insert(member->obj.value()["foo"].numberInt());
+                ws->free(id);
+            }
+        }
+    }
+
+protected:
+    const ServiceContext::UniqueOperationContext _txnPtr = cc().makeOperationContext();
+    OperationContext& _opCtx = *_txnPtr;
+    DBDirectClient _client;
+
+private:
+    const int _numObj;
+};
+
+// Every document is returned exactly once.
+class QueryStageParallelCollscanReturnsAllDocuments : public QueryStageParallelCollectionScanBase {
+public:
+    void run() {
+        AutoGetCollectionForReadCommand ctx(&_opCtx, nss);
+        WorkingSet ws;
+        auto scan = make_unique<ParallelCollectionScan>(
+            &_opCtx, ctx.getCollection(), kWorkers, &ws, nullptr, nullptr);
+
+        std::multiset<int> values = runToEOF(scan.get(), &ws);
+        ASSERT_EQUALS(static_cast<size_t>(numObj()), values.size());
+        int expected = 0;
+        for (int value : values) {
+            ASSERT_EQUALS(expected++, value);
+        }
+
+        const auto* stats =
+            static_cast<const ParallelCollectionScanStats*>(scan->getSpecificStats());
+        ASSERT_EQUALS(static_cast<size_t>(numObj()), stats->docsTested);
+    }
+};
+
+// Only matching documents are returned, with the comparisons made by the query's collator.
+class QueryStageParallelCollscanFilterWithCollator : public QueryStageParallelCollectionScanBase {
+public:
+    void run() {
+        AutoGetCollectionForReadCommand ctx(&_opCtx, nss);
+        CollatorInterfaceMock collator(CollatorInterfaceMock::MockType::kToLowerString);
+        auto filter = parseFilter(BSON("str"
+                                       << "abc"
+                                       << "foo"
+                                       << BSON("$lt" << 1000)),
+                                  &collator);
+        WorkingSet ws;
+        auto scan = make_unique<ParallelCollectionScan>(
+            &_opCtx, ctx.getCollection(), kWorkers, &ws, filter.get(), &collator);
+
+        std::multiset<int> values = runToEOF(scan.get(), &ws);
+        ASSERT_EQUALS(500U, values.size());
+        for (int value : values) {
+            ASSERT_EQUALS(1, value % 2);
+            ASSERT_LESS_THAN(value, 1000);
+        }
+    }
+};
+
+// Disposing of the stage after a few results, then freeing its query, leaves the workers still
+// running on what they own.
+class QueryStageParallelCollscanEarlyDispose : public QueryStageParallelCollectionScanBase {
+public:
+    // More documents than the workers buffer, so they are still reading when the test acts.
+    QueryStageParallelCollscanEarlyDispose() : QueryStageParallelCollectionScanBase(20000) {}
+
+    void run() {
+        AutoGetCollectionForReadCommand ctx(&_opCtx, nss);
+        auto collator =
+            make_unique<CollatorInterfaceMock>(CollatorInterfaceMock::MockType::kToLowerString);
+        auto filter = parseFilter(BSON("str"
+                                       << "abc"),
+                                  collator.get());
+        WorkingSet ws;
+        auto scan = make_unique<ParallelCollectionScan>(
+            &_opCtx, ctx.getCollection(), kWorkers, &ws, filter.get(), collator.get());
+
+        int returned = 0;
+        while (returned < 10) {
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            PlanStage::StageState state = scan->work(&id);
+            ASSERT_NOT_EQUALS(PlanStage::FAILURE, state);
+            ASSERT_NOT_EQUALS(PlanStage::IS_EOF, state);
+            if (PlanStage::ADVANCED == state) {
+                ++returned;
+            }
+        }
+
+        scan->dispose(&_opCtx);
+        scan.reset();
+        filter.reset();
+        collator.reset();
+
+        // Give the workers time to finish the batches they were matching.
+        sleepmillis(200);
+
+        // The collection can still be scanned as a whole afterwards.
+        scan = make_unique<ParallelCollectionScan>(
+            &_opCtx, ctx.getCollection(), kWorkers, &ws, nullptr, nullptr);
+        ASSERT_EQUALS(static_cast<size_t>(numObj()), runToEOF(scan.get(), &ws).size());
+    }
+};
+
+// Dropping the collection while the workers are still reading it fails the scan rather than
+// returning part of the collection as a complete result.
+class QueryStageParallelCollscanKilledByDrop : public QueryStageParallelCollectionScanBase {
+public:
+    QueryStageParallelCollscanKilledByDrop() : QueryStageParallelCollectionScanBase(20000) {}
+
+    void run() {
+        WorkingSet ws;
+        unique_ptr<ParallelCollectionScan> scan;
+        {
+            AutoGetCollectionForReadCommand ctx(&_opCtx, nss);
+            scan = make_unique<ParallelCollectionScan>(
+                &_opCtx, ctx.getCollection(), kWorkers, &ws, nullptr, nullptr);
+
+            // Start the workers, which stop reading once their result buffer is full.
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            while (PlanStage::ADVANCED != scan->work(&id)) {
+            }
+            scan->saveState();
+        }
+
+        _client.dropCollection(nss.ns());
+
+        // Nothing the stage does from here on needs the dropped collection.
+        scan->restoreState();
+        PlanStage::StageState state = PlanStage::NEED_TIME;
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        int returned = 1;
+        while (PlanStage::FAILURE != state && PlanStage::IS_EOF != state) {
+            state = scan->work(&id);
+            if (PlanStage::ADVANCED == state) {
+                ++returned;
+            }
+        }
+        ASSERT_EQUALS(PlanStage::FAILURE, state);
+        ASSERT_EQUALS(ErrorCodes::QueryPlanKilled,
+                      WorkingSetCommon::getMemberStatus(*ws.get(id)).code());
+        ASSERT_LESS_THAN(returned, numObj());
+    }
+};
+
+// A find that could not release its locks to the workers by yielding is planned as a plain
+// collection scan.
+class QueryStageParallelCollscanNotUsedUnderExclusiveLock
+    : public QueryStageParallelCollectionScanBase {
+public:
+    QueryStageParallelCollscanNotUsedUnderExclusiveLock()
+        : _maxWorkers(internalQueryParallelCollectionScanMaxWorkers.load()),
+          _minDocsPerWorker(internalQueryParallelCollectionScanMinDocsPerWorker.load()) {
+        internalQueryParallelCollectionScanMaxWorkers.store(kWorkers);
+        internalQueryParallelCollectionScanMinDocsPerWorker.store(1);
+    }
+
+    ~QueryStageParallelCollscanNotUsedUnderExclusiveLock() {
+        internalQueryParallelCollectionScanMaxWorkers.store(_maxWorkers);
+        internalQueryParallelCollectionScanMinDocsPerWorker.store(_minDocsPerWorker);
+    }
+
+    void run() {
+        {
+            AutoGetCollectionForReadCommand ctx(&_opCtx, nss);
+            ASSERT_EQUALS(STAGE_PARALLEL_COLLSCAN, findRootStageType(ctx.getCollection()));
+        }
+        {
+            // Takes the database lock in MODE_X.
+            OldClientWriteContext ctx(&_opCtx, nss.ns());
+            ASSERT_EQUALS(STAGE_COLLSCAN, findRootStageType(ctx.getCollection()));
+        }
+    }
+
+private:
+    StageType findRootStageType(Collection* collection) {
+        auto cq = uassertStatusOK(
+            CanonicalQuery::canonicalize(&_opCtx, make_unique<QueryRequest>(nss)));
+        auto exec = uassertStatusOK(getExecutorFind(
+            &_opCtx, collection, nss, std::move(cq), PlanExecutor::YIELD_AUTO));
+        return exec->getRootStage()->stageType();
+    }
+
+    const int _maxWorkers;
+    const int _minDocsPerWorker;
+};
+
+class All : public Suite {
+public:
+    All() : Suite("QueryStageParallelCollectionScan") {}
+
+    void setupTests() {
+        add<QueryStageParallelCollscanReturnsAllDocuments>();
+        add<QueryStageParallelCollscanFilterWithCollator>();
+        add<QueryStageParallelCollscanEarlyDispose>();
+        add<QueryStageParallelCollscanKilledByDrop>();
+        add<QueryStageParallelCollscanNotUsedUnderExclusiveLock>();
+    }
+};
+
+SuiteInstance<All> all;
+}  // namespace QueryStageParallelCollectionScan
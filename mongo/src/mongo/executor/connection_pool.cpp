@@ -32,6 +32,8 @@
 
 #include "mongo/executor/connection_pool.h"
 
+#include <cmath>
+
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/executor/connection_pool_stats.h"
 #include "mongo/executor/remote_command_request.h"
@@ -51,6 +53,20 @@
 
 namespace mongo {
 namespace executor {
+namespace {
+
+// Interval over which requests are counted to estimate a host's request rate
+const Milliseconds kRequestRateInterval = Seconds(1);
+
+// Weight of the most recent interval in the request rate and of the most recent checkout in the
+// checkout time moving averages
+const double kSmoothingFactor = 0.3;
+
+// How many more connections than the estimated steady state need to keep open when sizing
+// adaptively, so that moderate bursts do not have to wait for new connections
+const double kAdaptiveSizingHeadroom = 1.5;
+
+}  // namespace
 
 /**
  * A pool for a specific HostAndPort
@@ -152,14 +168,31 @@ public:
      */
     size_t openConnections(const stdx::unique_lock<stdx::mutex>& lk);
 
+    /**
+     * Returns the number of connections this pool keeps open even when idle. This is
+     * minConnections, unless adaptive sizing raises it to match the observed load.
+     */
+    size_t minConnections(const stdx::unique_lock<stdx::mutex>& lk);
+
+    /**
+     * Returns the distributions of the time requests waited for a connection and of the time
+     * connections stayed checked out.
+     */
+    const ConnectionPoolLatencyHistogram& waitTimes(const stdx::unique_lock<stdx::mutex>& lk);
+    const ConnectionPoolLatencyHistogram& checkoutTimes(const stdx::unique_lock<stdx::mutex>& lk);
+
 private:
     using OwnedConnection = std::unique_ptr<ConnectionInterface>;
     using OwnershipPool = stdx::unordered_map<ConnectionInterface*, OwnedConnection>;
     using LRUOwnershipPool = LRUCache<OwnershipPool::key_type, OwnershipPool::mapped_type>;
-    using Request = std::pair<Date_t, GetConnectionCallback>;
+    struct Request {
+        Date_t expiration;
+        Date_t enqueued;
+        GetConnectionCallback cb;
+    };
     struct RequestComparator {
         bool operator()(const Request& a, const Request& b) {
-            return a.first > b.first;
+            return a.expiration > b.expiration;
         }
     };
 
@@ -179,6 +212,12 @@ private:
 
     void updateStateInLock();
 
+    /**
+     * Folds the requests counted since the last sample into the request rate estimate once at
+     * least kRequestRateInterval has passed.
+     */
+    void updateRequestRate(Date_t now);
+
 private:
     ConnectionPool* const _parent;
 
@@ -229,6 +268,19 @@ droppedProcessingPool
 
     size_t _created;
 
+    // Time at which each checked out connection was handed to its user. Connections checked out
+    // by the pool itself in order to be refreshed are not tracked.
+    stdx::unordered_map<ConnectionInterface*, Date_t> _checkoutStarts;
+
+    ConnectionPoolLatencyHistogram _waitTimeHistogram;
+    ConnectionPoolLatencyHistogram _checkoutTimeHistogram;
+
+    // Load estimates, which drive the number of connections to keep open under adaptive sizing
+    Date_t _requestRateSampleStart;
+    size_t _requestsInSample;
+    double _requestsPerSec;
+    double _avgCheckoutMillis;
+
     /**
      * The current state of the pool
      *
@@ -324,6 +376,8 @@ void ConnectionPool::appendConnectionStats(ConnectionPoolStats* stats) const {
                                      pool->availableConnections(lk),
                                      pool->createdConnections(lk),
                                      pool->refreshingConnections(lk)};
+        hostStats.waitTime = pool->waitTimes(lk);
+        hostStats.checkoutTime = pool->checkoutTimes(lk);
         stats->updateStatsForHost(_name, host, hostStats);
     }
 }
@@ -360,6 +414,9 @@ ConnectionPool::SpecificPool::SpecificPool(ConnectionPool* parent, const HostAnd
       _inFulfillRequests(false),
       _inSpawnConnections(false),
       _created(0),
+      _requestsInSample(0),
+      _requestsPerSec(0),
+      _avgCheckoutMillis(0),
       _state(State::kRunning) {}
 
 ConnectionPool::SpecificPool::~SpecificPool() {
@@ -387,6 +444,33 @@ size_t ConnectionPool::SpecificPool::createdConnections(const stdx::unique_lock<
 size_t ConnectionPool::SpecificPool::openConnections(const stdx::unique_lock<stdx::mutex>& lk) {
     return _checkedOutPool.size() + _readyPool.size() + _processingPool.size();
 }
+
+size_t ConnectionPool::SpecificPool::minConnections(const stdx::unique_lock<stdx::mutex>& lk) {
+    const auto& options = _parent->_options;
+    if (!options.adaptiveSizing) {
+        return options.minConnections;
+    }
+
+    // By Little's law, the number of connections busy on average is the request rate times the
+    // time each request holds its connection
+    const double needed =
+        std::ceil(_requestsPerSec * _avgCheckoutMillis / 1000 * kAdaptiveSizingHeadroom);
+    const size_t adaptiveMin = (needed >= static_cast<double>(options.maxConnections))
+        ? options.maxConnections
+        : static_cast<size_t>(needed);
+
+    return std::max(options.minConnections, adaptiveMin);
+}
+
+const ConnectionPoolLatencyHistogram& ConnectionPool::SpecificPool::waitTimes(
+    const stdx::unique_lock<stdx::mutex>& lk) {
+    return _waitTimeHistogram;
+}
+
+const ConnectionPoolLatencyHistogram& ConnectionPool::SpecificPool::checkoutTimes(
+    const stdx::unique_lock<stdx::mutex>& lk) {
+    return _checkoutTimeHistogram;
+}
 //mongosͺmongod:mongosͺmongodӴNetworkInterfaceASIO::_connectmongosתݵmongodNetworkInterfaceASIO::_beginCommunication
 //mongosͿͻ˽:ServiceEntryPointMongos::handleRequest
 
@@ -399,9 +483,13 @@ void ConnectionPool::SpecificPool::getConnection(const HostAndPort& hostAndPort,
         timeout = _parent->_options.refreshTimeout;
     }
 
-    const auto expiration = _parent->_factory->now() + timeout;
+    const auto now = _parent->_factory->now();
+    const auto expiration = now + timeout;
 
-    _requests.push(make_pair(expiration, std::move(cb)));
+    _requests.push(Request{expiration, now, std::move(cb)});
+
+    _requestsInSample++;
+    updateRequestRate(now);
 
     updateStateInLock();
 
@@ -415,6 +503,22 @@ void ConnectionPool::SpecificPool::returnConnection(ConnectionInterface* connPtr
 
     auto conn = takeFromPool(_checkedOutPool, connPtr);
 
+    auto now = _parent->_factory->now();
+
+    auto checkoutIter = _checkoutStarts.find(connPtr);
+    if (checkoutIter != _checkoutStarts.end()) {
+        const auto checkoutTime = now - checkoutIter->second;
+        _checkoutStarts.erase(checkoutIter);
+
+        _checkoutTimeHistogram.record(checkoutTime);
+        const double checkoutMillis = durationCount<Milliseconds>(checkoutTime);
+        _avgCheckoutMillis = (_checkoutTimeHistogram.count() == 1)
+            ? checkoutMillis
+            : kSmoothingFactor * checkoutMillis + (1 - kSmoothingFactor) * _avgCheckoutMillis;
+    }
+
+    updateRequestRate(now);
+
     updateStateInLock();
 
     // Users are required to call indicateSuccess() or indicateFailure() before allowing
@@ -433,12 +537,11 @@ void ConnectionPool::SpecificPool::returnConnection(ConnectionInterface* connPtr
         return;
     }
 
-    auto now = _parent->_factory->now();
     if (needsRefreshTP <= now) {
         // If we need to refresh this connection
 
         if (_readyPool.size() + _processingPool.size() + _checkedOutPool.size() >=
-            _parent->_options.minConnections) {
+            minConnections(lk)) {
             // If we already have minConnections, just let the connection lapse
             log() << "Ending idle connection to host " << _hostAndPort
                   << " because the pool meets constraints; " << openConnections(lk)
@@ -576,7 +679,7 @@ void ConnectionPool::SpecificPool::processFailure(const Status& status,
     lk.unlock();
 
     while (requestsToFail.size()) {
-        requestsToFail.top().second(status);
+        requestsToFail.top().cb(status);
         requestsToFail.pop();
     }
 }
@@ -622,7 +725,9 @@ void ConnectionPool::SpecificPool::fulfillRequests(stdx::unique_lock<stdx::mutex
 
         // Grab the request and callback
         //cbֵNetworkInterfaceASIO::startCommandеnextStep
-        auto cb = std::move(_requests.top().second);
+        auto cb = std::move(_requests.top().cb);
+        const auto now = _parent->_factory->now();
+        _waitTimeHistogram.record(now - _requests.top().enqueued);
         _requests.pop();
 
         auto connPtr = conn.get();
@@ -630,6 +735,7 @@ void ConnectionPool::SpecificPool::fulfillRequests(stdx::unique_lock<stdx::mutex
         // check out the connection
         //Ѵ_readyPoolȡת_checkedOutPool
         _checkedOutPool[connPtr] = std::move(conn);
+        _checkoutStarts[connPtr] = now;
 
         updateStateInLock();
 
@@ -661,7 +767,7 @@ void ConnectionPool::SpecificPool::spawnConnections(stdx::unique_lock<stdx::mute
     // We want minConnections <= outstanding requests <= maxConnections
     auto target = [&] {
         return std::max(
-            _parent->_options.minConnections,
+            minConnections(lk),
             std::min(_requests.size() + _checkedOutPool.size(), _parent->_options.maxConnections));
     };
 
@@ -759,6 +865,30 @@ void ConnectionPool::SpecificPool::shutdown() {
     _parent->_pools.erase(_hostAndPort);
 }
 
+void ConnectionPool::SpecificPool::updateRequestRate(Date_t now) {
+    if (_requestRateSampleStart == Date_t()) {
+        _requestRateSampleStart = now;
+        return;
+    }
+
+    const auto elapsed = now - _requestRateSampleStart;
+    if (elapsed < kRequestRateInterval) {
+        return;
+    }
+
+    // Weigh the new sample by the number of intervals it spans, so that an idle period of many
+    // intervals decays the estimate as much as that many empty samples would
+    const double elapsedMillis = durationCount<Milliseconds>(elapsed);
+    const double sampleRate = _requestsInSample * 1000 / elapsedMillis;
+    const double weight = 1 -
+        std::pow(1 - kSmoothingFactor,
+                 elapsedMillis / durationCount<Milliseconds>(kRequestRateInterval));
+
+    _requestsPerSec += weight * (sampleRate - _requestsPerSec);
+    _requestsInSample = 0;
+    _requestRateSampleStart = now;
+}
+
 template <typename OwnershipPoolType>
 typename OwnershipPoolType::mapped_type ConnectionPool::SpecificPool::takeFromPool(
     OwnershipPoolType& pool, typename OwnershipPoolType::key_type connPtr) {
@@ -786,16 +916,16 @@ void ConnectionPool::SpecificPool::updateStateInLock() {
 
         // If we were already running and the timer is the same as it was
         // before, nothing to do
-        if (_state == State::kRunning && _requestTimerExpiration == _requests.top().first)
+        if (_state == State::kRunning && _requestTimerExpiration == _requests.top().expiration)
             return;
 
         _state = State::kRunning;
 
         _requestTimer->cancelTimeout();
 
-        _requestTimerExpiration = _requests.top().first;
+        _requestTimerExpiration = _requests.top().expiration;
 
-        auto timeout = _requests.top().first - _parent->_factory->now();
+        auto timeout = _requests.top().expiration - _parent->_factory->now();
 
         // We set a timer for the most recent request, then invoke each timed
         // out request we couldn't service
@@ -806,8 +936,8 @@ void ConnectionPool::SpecificPool::updateStateInLock() {
                 while (_requests.size()) {
                     auto& x = _requests.top();
 
-                    if (x.first <= now) {
-                        auto cb = std::move(x.second);
+                    if (x.expiration <= now) {
+                        auto cb = std::move(x.cb);
                         _requests.pop();
 
                         lk.unlock();
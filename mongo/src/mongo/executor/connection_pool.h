@@ -133,6 +133,15 @@ public:
          * out connections or new requests
          */
         Milliseconds hostTimeout = kDefaultHostTimeout;
+
+        /**
+         * Whether to raise the number of connections kept open for a host above
+         * minConnections to what the observed request rate and checkout time of that
+         * host require, so that bursts of requests find established connections
+         * rather than all opening new ones at once. The adaptive minimum never exceeds
+         * maxConnections and decays again as the request rate drops.
+         */
+        bool adaptiveSizing = false;
     };
 
     explicit ConnectionPool(std::unique_ptr<DependentTypeFactoryInterface> impl,
@@ -32,9 +32,68 @@
 
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/util/map_util.h"
+#include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
 namespace executor {
+namespace {
+
+void appendLatencies(const ConnectionStatsPer& stats, BSONObjBuilder* builder) {
+    if (stats.waitTime.count()) {
+        BSONObjBuilder waitTimeBuilder(builder->subobjStart("waitTimeMillis"));
+        stats.waitTime.appendToBSON(&waitTimeBuilder);
+    }
+    if (stats.checkoutTime.count()) {
+        BSONObjBuilder checkoutTimeBuilder(builder->subobjStart("checkoutTimeMillis"));
+        stats.checkoutTime.appendToBSON(&checkoutTimeBuilder);
+    }
+}
+
+}  // namespace
+
+const std::array<int64_t, ConnectionPoolLatencyHistogram::kNumBounds>
+    ConnectionPoolLatencyHistogram::kUpperBoundsMillis = {
+        1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000};
+
+void ConnectionPoolLatencyHistogram::record(Milliseconds latency) {
+    const auto millis = std::max<int64_t>(0, durationCount<Milliseconds>(latency));
+
+    size_t bucket = 0;
+    while (bucket < kNumBounds && millis >= kUpperBoundsMillis[bucket]) {
+        bucket++;
+    }
+
+    _buckets[bucket]++;
+    _count++;
+    _totalMillis += millis;
+}
+
+ConnectionPoolLatencyHistogram& ConnectionPoolLatencyHistogram::operator+=(
+    const ConnectionPoolLatencyHistogram& other) {
+    for (size_t i = 0; i < _buckets.size(); i++) {
+        _buckets[i] += other._buckets[i];
+    }
+    _count += other._count;
+    _totalMillis += other._totalMillis;
+
+    return *this;
+}
+
+void ConnectionPoolLatencyHistogram::appendToBSON(BSONObjBuilder* builder) const {
+    builder->appendNumber("count", static_cast<long long>(_count));
+    builder->appendNumber("totalMillis", static_cast<long long>(_totalMillis));
+
+    BSONObjBuilder histogramBuilder(builder->subobjStart("histogram"));
+    for (size_t i = 0; i < _buckets.size(); i++) {
+        if (!_buckets[i])
+            continue;
+
+        const std::string bucketName = (i < kNumBounds)
+            ? str::stream() << "<" << kUpperBoundsMillis[i]
+            : str::stream() << ">=" << kUpperBoundsMillis[kNumBounds - 1];
+        histogramBuilder.appendNumber(bucketName, static_cast<long long>(_buckets[i]));
+    }
+}
 
 ConnectionStatsPer::ConnectionStatsPer(size_t nInUse,
                                        size_t nAvailable,
@@ -49,6 +108,8 @@ ConnectionStatsPer& ConnectionStatsPer::operator+=(const ConnectionStatsPer& oth
     available += other.available;
     created += other.created;
     refreshing += other.refreshing;
+    waitTime += other.waitTime;
+    checkoutTime += other.checkoutTime;
 
     return *this;
 }
@@ -83,6 +144,7 @@ void ConnectionPoolStats::appendToBSON(mongo::BSONObjBuilder& result) {
             poolInfo.appendNumber("poolAvailable", poolStats.available);
             poolInfo.appendNumber("poolCreated", poolStats.created);
             poolInfo.appendNumber("poolRefreshing", poolStats.refreshing);
+            appendLatencies(poolStats, &poolInfo);
             for (auto&& host : statsByPoolHost[pool.first]) {
                 BSONObjBuilder hostInfo(poolInfo.subobjStart(host.first.toString()));
                 auto hostStats = host.second;
@@ -90,6 +152,7 @@ void ConnectionPoolStats::appendToBSON(mongo::BSONObjBuilder& result) {
                 hostInfo.appendNumber("available", hostStats.available);
                 hostInfo.appendNumber("created", hostStats.created);
                 hostInfo.appendNumber("refreshing", hostStats.refreshing);
+                appendLatencies(hostStats, &hostInfo);
             }
         }
     }
@@ -102,6 +165,7 @@ void ConnectionPoolStats::appendToBSON(mongo::BSONObjBuilder& result) {
             hostInfo.appendNumber("available", hostStats.available);
             hostInfo.appendNumber("created", hostStats.created);
             hostInfo.appendNumber("refreshing", hostStats.refreshing);
+            appendLatencies(hostStats, &hostInfo);
         }
     }
 }
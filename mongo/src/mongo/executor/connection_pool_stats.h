@@ -28,12 +28,48 @@
 
 #pragma once
 
+#include <array>
+
 #include "mongo/stdx/unordered_map.h"
 #include "mongo/util/net/hostandport.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
+
+class BSONObjBuilder;
+
 namespace executor {
 
+/**
+ * Counts latencies observed by a connection pool, such as the time requests wait for a connection
+ * or the time connections stay checked out, in buckets of increasing width.
+ */
+class ConnectionPoolLatencyHistogram {
+public:
+    static const size_t kNumBounds = 12;
+
+    // Exclusive upper bounds of all buckets but the last, which holds the remaining latencies.
+    static const std::array<int64_t, kNumBounds> kUpperBoundsMillis;
+
+    void record(Milliseconds latency);
+
+    ConnectionPoolLatencyHistogram& operator+=(const ConnectionPoolLatencyHistogram& other);
+
+    uint64_t count() const {
+        return _count;
+    }
+
+    /**
+     * Appends the number of entries, their total latency and the non-empty buckets.
+     */
+    void appendToBSON(BSONObjBuilder* builder) const;
+
+private:
+    std::array<uint64_t, kNumBounds + 1> _buckets{};
+    uint64_t _count = 0;
+    uint64_t _totalMillis = 0;
+};
+
 /**
  * Holds connection information for a specific pool or remote host. These objects are maintained by
  * a parent ConnectionPoolStats object and should not need to be created directly.
@@ -49,6 +85,12 @@ struct ConnectionStatsPer {
     size_t available = 0u;
     size_t created = 0u;
     size_t refreshing = 0u;
+
+    // Time requests waited for a connection to become available
+    ConnectionPoolLatencyHistogram waitTime;
+
+    // Time connections were checked out before being returned to the pool
+    ConnectionPoolLatencyHistogram checkoutTime;
 };
 
 /**
@@ -33,7 +33,9 @@
 
 #include "mongo/executor/connection_pool_test_fixture.h"
 
+#include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/executor/connection_pool.h"
+#include "mongo/executor/connection_pool_stats.h"
 #include "mongo/stdx/future.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/unittest/unittest.h"
@@ -1308,6 +1310,144 @@ TEST_F(ConnectionPoolTest, RefreshTimeoutsDontTimeoutRequests) {
     ASSERT(!conn2);
 }
 
+/**
+ * Issues 'numRequests' concurrent requests against 'pool', completing connection setups as the
+ * pool starts them, and returns the handles. Verifies that no more than 'maxConnecting' setups
+ * are ever in progress and advances the clock by 'setupTime' per completed setup.
+ */
+std::vector<ConnectionPool::ConnectionHandle> checkOutConcurrently(ConnectionPool* pool,
+                                                                  const HostAndPort& host,
+                                                                  size_t numRequests,
+                                                                  size_t maxConnecting,
+                                                                  Date_t* now,
+                                                                  Milliseconds setupTime) {
+    std::vector<ConnectionPool::ConnectionHandle> connections;
+
+    for (size_t i = 0; i < numRequests; i++) {
+        pool->get(host, Seconds(5), [&](StatusWith<ConnectionPool::ConnectionHandle> swConn) {
+            ASSERT(swConn.isOK());
+            connections.push_back(std::move(swConn.getValue()));
+        });
+        ASSERT_LTE(ConnectionImpl::setupQueueDepth(), maxConnecting);
+    }
+
+    while (ConnectionImpl::setupQueueDepth()) {
+        ASSERT_LTE(ConnectionImpl::setupQueueDepth(), maxConnecting);
+        *now += setupTime;
+        PoolImpl::setNow(*now);
+        ConnectionImpl::pushSetup(Status::OK());
+    }
+
+    ASSERT_EQ(numRequests, connections.size());
+    return connections;
+}
+
+void returnAll(std::vector<ConnectionPool::ConnectionHandle>* connections) {
+    for (auto& conn : *connections) {
+        conn->indicateSuccess();
+    }
+    connections->clear();
+}
+
+/**
+ * Simulates a host serving 10 concurrent requests of 100ms each for 10 seconds and returns the
+ * number of connections the pool keeps open to it afterwards.
+ */
+size_t simulateSteadyLoad(ConnectionPool* pool,
+                          const HostAndPort& host,
+                          size_t maxConnecting,
+                          Date_t* now) {
+    for (int tick = 0; tick < 100; tick++) {
+        auto connections =
+            checkOutConcurrently(pool, host, 10, maxConnecting, now, Milliseconds(0));
+
+        *now += Milliseconds(100);
+        PoolImpl::setNow(*now);
+        returnAll(&connections);
+    }
+
+    return pool->getNumConnectionsPerHost(host);
+}
+
+/**
+ * Verify that without adaptive sizing the pool only keeps the connections that were needed
+ * concurrently.
+ */
+TEST_F(ConnectionPoolTest, SteadyLoadWithoutAdaptiveSizing) {
+    ConnectionPool::Options options;
+    options.maxConnecting = 2;
+    options.refreshRequirement = Seconds(20);
+    options.refreshTimeout = Seconds(5);
+    options.hostTimeout = Minutes(5);
+    ConnectionPool pool(stdx::make_unique<PoolImpl>(), "test pool", options);
+
+    const HostAndPort host("localhost", 30000);
+    auto now = Date_t::now();
+    PoolImpl::setNow(now);
+
+    ASSERT_EQ(10U, simulateSteadyLoad(&pool, host, options.maxConnecting, &now));
+}
+
+/**
+ * Verify that adaptive sizing keeps connections for the observed load open, releases them once
+ * the load goes away, and that a 10x traffic spike opens connections no faster than
+ * maxConnecting allows while the waits show up in the pool statistics.
+ */
+TEST_F(ConnectionPoolTest, AdaptiveSizingUnderTrafficSpike) {
+    ConnectionPool::Options options;
+    options.maxConnecting = 2;
+    options.refreshRequirement = Seconds(20);
+    options.refreshTimeout = Seconds(5);
+    options.hostTimeout = Minutes(5);
+    options.adaptiveSizing = true;
+    ConnectionPool pool(stdx::make_unique<PoolImpl>(), "test pool", options);
+
+    const HostAndPort host("localhost", 30000);
+    auto now = Date_t::now();
+    PoolImpl::setNow(now);
+
+    // About 100 requests per second holding their connection for 100ms need 10 connections on
+    // average, and the pool keeps some headroom on top of that
+    const size_t steadyStateConns = simulateSteadyLoad(&pool, host, options.maxConnecting, &now);
+    ASSERT_GTE(steadyStateConns, 14U);
+    ASSERT_LTE(steadyStateConns, 20U);
+
+    // Once the traffic stops the idle connections lapse at their next refresh, down to
+    // minConnections
+    now += Seconds(30);
+    PoolImpl::setNow(now);
+    while (ConnectionImpl::refreshQueueDepth()) {
+        ConnectionImpl::pushRefresh(Status::OK());
+    }
+    ASSERT_EQ(options.minConnections, pool.getNumConnectionsPerHost(host));
+
+    // A spike of 10x the steady state concurrency, with every connect taking 10ms
+    auto connections =
+        checkOutConcurrently(&pool, host, 100, options.maxConnecting, &now, Milliseconds(10));
+    ASSERT_EQ(100U, pool.getNumConnectionsPerHost(host));
+
+    now += Milliseconds(100);
+    PoolImpl::setNow(now);
+    returnAll(&connections);
+
+    ConnectionPoolStats stats;
+    pool.appendConnectionStats(&stats);
+
+    const auto& hostStats = stats.statsByHost[host];
+    ASSERT_EQ(1000U + 100U, hostStats.waitTime.count());
+    ASSERT_EQ(1000U + 100U, hostStats.checkoutTime.count());
+
+    BSONObjBuilder builder;
+    stats.appendToBSON(builder);
+    const auto obj = builder.obj();
+    const auto waitTimeObj = obj["hosts"][host.toString()]["waitTimeMillis"];
+    ASSERT_EQ(1100, waitTimeObj["count"].numberLong());
+
+    // The last spike requests had to wait for almost all connects to complete before them
+    ASSERT(waitTimeObj["histogram"][">=5000"].eoo());
+    ASSERT(!waitTimeObj["histogram"]["<1000"].eoo());
+}
+
 }  // namespace connection_pool_test_details
 }  // namespace executor
 }  // namespace mongo
@@ -81,6 +81,10 @@ public:
         return _builder.finish();
     }
 
+    OpMsgBuilder* getOpMsgBuilder() {
+        return &_builder;
+    }
+
 private:
     OpMsgBuilder _builder;
 };
@@ -125,6 +125,24 @@ void AsyncRequestsSender::stopRetrying() {
     _stopRetrying = true;
 }
 
+void AsyncRequestsSender::addRequests(const std::vector<AsyncRequestsSender::Request>& requests) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    for (const auto& request : requests) {
+        _remotes.emplace_back(request.shardId, request.cmdObj);
+
+        if (_stopRetrying) {
+            _remotes.back().swResponse = !_interruptStatus.isOK()
+                ? _interruptStatus
+                : Status(ErrorCodes::CallbackCanceled,
+                         "request was not sent because the AsyncRequestsSender stopped retrying");
+        }
+    }
+
+    if (!_stopRetrying) {
+        _scheduleRequests(lk);
+    }
+}
+
 //_remotesǷ_remotesԱdoneɣAsyncRequestsSender::_ready()Ķ
 bool AsyncRequestsSender::done() {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
@@ -158,7 +176,8 @@ boost::optional<AsyncRequestsSender::Response> AsyncRequestsSender::_ready() {
 
     // Check if any remote is ready.
     invariant(!_remotes.empty());
-    for (auto& remote : _remotes) {
+    for (size_t i = 0; i < _remotes.size(); ++i) {
+        auto& remote = _remotes[i];
 		//AsyncRequestsSender::_handleResponseлȡӦϢ洢swResponse
 		//ȡswResponseϢӦResponse
         if (remote.swResponse && !remote.done) {
@@ -166,9 +185,11 @@ boost::optional<AsyncRequestsSender::Response> AsyncRequestsSender::_ready() {
             remote.done = true;
             if (remote.swResponse->isOK()) {
                 invariant(remote.shardHostAndPort);
-                return Response(std::move(remote.shardId),
-                                std::move(remote.swResponse->getValue()),
-                                std::move(*remote.shardHostAndPort));
+                Response response(std::move(remote.shardId),
+                                  std::move(remote.swResponse->getValue()),
+                                  std::move(*remote.shardHostAndPort));
+                response.requestIndex = i;
+                return response;
             } else {
                 // If _interruptStatus is set, promote CallbackCanceled errors to it.
                 if (!_interruptStatus.isOK() &&
@@ -176,9 +197,11 @@ boost::optional<AsyncRequestsSender::Response> AsyncRequestsSender::_ready() {
                     remote.swResponse = _interruptStatus;
                 }
 				//Ӧ쳣¼쳣Response
-                return Response(std::move(remote.shardId),
-                                std::move(remote.swResponse->getStatus()),
-                                std::move(remote.shardHostAndPort));
+                Response response(std::move(remote.shardId),
+                                  std::move(remote.swResponse->getStatus()),
+                                  std::move(remote.shardHostAndPort));
+                response.requestIndex = i;
+                return response;
             }
         }
     }
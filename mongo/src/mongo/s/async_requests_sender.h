@@ -117,6 +117,10 @@ public:
         // The exact host on which the remote command was run. Is unset if the shard could not be
         // found or no shard hosts matching the readPreference could be found.
         boost::optional<HostAndPort> shardHostAndPort;
+
+        // The position of the request among all requests given to the ARS, in the order in which
+        // they were given to the constructor and to addRequests().
+        size_t requestIndex = 0;
     };
 
     /**
@@ -161,6 +165,15 @@ public:
      */
     void stopRetrying();
 
+    /**
+     * Schedules further requests. Their responses are returned via next() along with those of the
+     * requests given to the constructor, and done() is false until all of them have been returned.
+     *
+     * Requests added after the ARS has stopped retrying are not sent, and are returned as
+     * CallbackCanceled errors, or as the interruption error if the operation was interrupted.
+     */
+    void addRequests(const std::vector<AsyncRequestsSender::Request>& requests);
+
 private:
     /**
      * We instantiate one of these per remote host.
@@ -41,6 +41,7 @@
 #include "mongo/db/query/index_bounds_builder.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/query/query_planner_common.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
@@ -58,14 +59,212 @@ void checkAllElementsAreOfType(BSONType type, const BSONObj& o) {
     }
 }
 
+// Target number of chunks in each block of a ChunkMap
+const size_t kChunkMapBlockSize = 128;
+
+// Changing more than this fraction of the chunks of a ChunkMap rebuilds it in one pass instead of
+// applying the changes block by block
+const size_t kChunkMapRebuildFraction = 16;
+
+// Shard key bounds are always compared in ascending order
+const Ordering kAllAscending = Ordering::make(BSONObj());
+
 }  // namespace
 
+ChunkMap::const_iterator& ChunkMap::const_iterator::operator++() {
+    if (++_index == _map->_blocks[_block]->chunks.size()) {
+        ++_block;
+        _index = 0;
+    }
+    return *this;
+}
+
+ChunkMap::const_iterator& ChunkMap::const_iterator::operator--() {
+    if (_index == 0) {
+        --_block;
+        _index = _map->_blocks[_block]->chunks.size() - 1;
+    } else {
+        --_index;
+    }
+    return *this;
+}
+
+const std::shared_ptr<Chunk>& ChunkMap::const_iterator::operator*() const {
+    return _map->_blocks[_block]->chunks[_index];
+}
+
+std::string ChunkMap::encodeKey(const BSONObj& key) {
+    const KeyString ks(KeyString::Version::V1, key, kAllAscending);
+    return std::string(ks.getBuffer(), ks.getSize());
+}
+
+ChunkMap::const_iterator ChunkMap::upperBound(const BSONObj& key) const {
+    const auto encodedKey = encodeKey(key);
+
+    const auto blockIt = std::upper_bound(_blockMaxKeys.begin(), _blockMaxKeys.end(), encodedKey);
+    if (blockIt == _blockMaxKeys.end()) {
+        return end();
+    }
+
+    const size_t block = blockIt - _blockMaxKeys.begin();
+    const auto& maxKeys = _blocks[block]->maxKeys;
+    const size_t index =
+        std::upper_bound(maxKeys.begin(), maxKeys.end(), encodedKey) - maxKeys.begin();
+    return {this, block, index};
+}
+
+ChunkMap ChunkMap::makeUpdated(const std::vector<std::shared_ptr<Chunk>>& changedChunks,
+                               std::vector<std::shared_ptr<Chunk>>* removedChunks) const {
+    if (changedChunks.size() > _size / kChunkMapRebuildFraction) {
+        // Too many changes to apply them block by block, so merge them into an ordered map and
+        // flatten it again
+        std::map<std::string, std::shared_ptr<Chunk>> chunks;
+        for (const auto& block : _blocks) {
+            for (size_t i = 0; i < block->chunks.size(); i++) {
+                chunks.emplace_hint(chunks.end(), block->maxKeys[i], block->chunks[i]);
+            }
+        }
+
+        for (const auto& chunk : changedChunks) {
+            auto maxKey = encodeKey(chunk->getMax());
+            const auto low = chunks.upper_bound(encodeKey(chunk->getMin()));
+            const auto high = chunks.upper_bound(maxKey);
+            for (auto it = low; it != high; ++it) {
+                removedChunks->push_back(std::move(it->second));
+            }
+            chunks.erase(low, high);
+            chunks.emplace(std::move(maxKey), chunk);
+        }
+
+        std::vector<std::string> maxKeys;
+        std::vector<std::shared_ptr<Chunk>> sortedChunks;
+        maxKeys.reserve(chunks.size());
+        sortedChunks.reserve(chunks.size());
+        for (auto& entry : chunks) {
+            maxKeys.push_back(entry.first);
+            sortedChunks.push_back(std::move(entry.second));
+        }
+
+        ChunkMap rebuilt;
+        std::vector<bool> ownedBlocks;
+        rebuilt._size = sortedChunks.size();
+        rebuilt._replaceBlocks(0, 0, std::move(maxKeys), std::move(sortedChunks), &ownedBlocks);
+        return rebuilt;
+    }
+
+    ChunkMap updated(*this);
+    std::vector<bool> ownedBlocks(updated._blocks.size(), false);
+    for (const auto& chunk : changedChunks) {
+        updated._apply(chunk, &ownedBlocks, removedChunks);
+    }
+    return updated;
+}
+
+void ChunkMap::_apply(std::shared_ptr<Chunk> chunk,
+                      std::vector<bool>* ownedBlocks,
+                      std::vector<std::shared_ptr<Chunk>>* removedChunks) {
+    invariant(!_blocks.empty());
+
+    auto minKey = encodeKey(chunk->getMin());
+    auto maxKey = encodeKey(chunk->getMax());
+
+    // The blocks holding the chunks which the new chunk replaces. A chunk past the max of the
+    // last block is appended to the last block.
+    const size_t lastBlock = std::min<size_t>(
+        std::upper_bound(_blockMaxKeys.begin(), _blockMaxKeys.end(), maxKey) -
+            _blockMaxKeys.begin(),
+        _blocks.size() - 1);
+    const size_t firstBlock = std::min<size_t>(
+        std::upper_bound(_blockMaxKeys.begin(), _blockMaxKeys.end(), minKey) -
+            _blockMaxKeys.begin(),
+        lastBlock);
+
+    const auto replace = [&](std::vector<std::string>* maxKeys,
+                             std::vector<std::shared_ptr<Chunk>>* chunks) {
+        const auto low = std::upper_bound(maxKeys->begin(), maxKeys->end(), minKey);
+        const auto high = std::upper_bound(low, maxKeys->end(), maxKey);
+        const auto lowChunk = chunks->begin() + (low - maxKeys->begin());
+        const auto highChunk = chunks->begin() + (high - maxKeys->begin());
+
+        removedChunks->insert(removedChunks->end(), lowChunk, highChunk);
+        _size -= highChunk - lowChunk;
+        _size++;
+
+        const auto insertChunk = chunks->erase(lowChunk, highChunk);
+        chunks->insert(insertChunk, chunk);
+        const auto insertKey = maxKeys->erase(low, high);
+        maxKeys->insert(insertKey, std::move(maxKey));
+    };
+
+    // Blocks created by this update are not shared yet and are modified in place, as long as they
+    // do not have to be split
+    if (firstBlock == lastBlock && (*ownedBlocks)[firstBlock] &&
+        _blocks[firstBlock]->chunks.size() + 1 < 2 * kChunkMapBlockSize) {
+        Block* block = _blocks[firstBlock].get();
+        replace(&block->maxKeys, &block->chunks);
+        _blockMaxKeys[firstBlock] = block->maxKeys.back();
+        return;
+    }
+
+    std::vector<std::string> maxKeys;
+    std::vector<std::shared_ptr<Chunk>> chunks;
+    for (size_t i = firstBlock; i <= lastBlock; i++) {
+        const auto& block = *_blocks[i];
+        maxKeys.insert(maxKeys.end(), block.maxKeys.begin(), block.maxKeys.end());
+        chunks.insert(chunks.end(), block.chunks.begin(), block.chunks.end());
+    }
+
+    replace(&maxKeys, &chunks);
+    _replaceBlocks(firstBlock, lastBlock + 1, std::move(maxKeys), std::move(chunks), ownedBlocks);
+}
+
+void ChunkMap::_replaceBlocks(size_t firstBlock,
+                              size_t lastBlock,
+                              std::vector<std::string> maxKeys,
+                              std::vector<std::shared_ptr<Chunk>> chunks,
+                              std::vector<bool>* ownedBlocks) {
+    invariant(maxKeys.size() == chunks.size());
+
+    // Split evenly into blocks of between kChunkMapBlockSize and twice that many chunks, unless
+    // there are fewer chunks than that in total
+    const size_t numChunks = chunks.size();
+    const size_t numBlocks =
+        numChunks < 2 * kChunkMapBlockSize ? (numChunks ? 1 : 0) : numChunks / kChunkMapBlockSize;
+
+    std::vector<std::string> newBlockMaxKeys;
+    std::vector<std::shared_ptr<Block>> newBlocks;
+    for (size_t i = 0; i < numBlocks; i++) {
+        const size_t begin = i * numChunks / numBlocks;
+        const size_t end = (i + 1) * numChunks / numBlocks;
+
+        auto block = std::make_shared<Block>();
+        block->maxKeys.reserve(2 * kChunkMapBlockSize);
+        block->chunks.reserve(2 * kChunkMapBlockSize);
+        std::move(maxKeys.begin() + begin, maxKeys.begin() + end, std::back_inserter(block->maxKeys));
+        std::move(chunks.begin() + begin, chunks.begin() + end, std::back_inserter(block->chunks));
+
+        newBlockMaxKeys.push_back(block->maxKeys.back());
+        newBlocks.push_back(std::move(block));
+    }
+
+    _blockMaxKeys.erase(_blockMaxKeys.begin() + firstBlock, _blockMaxKeys.begin() + lastBlock);
+    _blockMaxKeys.insert(
+        _blockMaxKeys.begin() + firstBlock, newBlockMaxKeys.begin(), newBlockMaxKeys.end());
+
+    _blocks.erase(_blocks.begin() + firstBlock, _blocks.begin() + lastBlock);
+    _blocks.insert(_blocks.begin() + firstBlock, newBlocks.begin(), newBlocks.end());
+
+    ownedBlocks->erase(ownedBlocks->begin() + firstBlock, ownedBlocks->begin() + lastBlock);
+    ownedBlocks->insert(ownedBlocks->begin() + firstBlock, numBlocks, true);
+}
+
 ChunkManager::ChunkManager(NamespaceString nss,
                            boost::optional<UUID> uuid,
                            KeyPattern shardKeyPattern,
                            std::unique_ptr<CollatorInterface> defaultCollator,
                            bool unique,
                            ChunkMap chunkMap,
+                           ChunkMapViews chunkMapViews,
                            ChunkVersion collectionVersion)
     : _sequenceNumber(nextCMSequenceNumber.addAndFetch(1)),
       _nss(std::move(nss)),
@@ -75,7 +274,7 @@ ChunkManager::ChunkManager(NamespaceString nss,
       _unique(unique),
       ////·ɱ  ChunkManager::toStringԴӡmongos·ɱ
       _chunkMap(std::move(chunkMap)),
-      _chunkMapViews(_constructChunkMapViews(collectionVersion.epoch(), _chunkMap)),
+      _chunkMapViews(std::move(chunkMapViews)),
       _collectionVersion(collectionVersion) {}
 
 //ͨshardkeyҵӦchunkϢ
@@ -93,12 +292,12 @@ std::shared_ptr<Chunk> ChunkManager::findIntersectingChunk(const BSONObj& shardK
         }
     }
 
-    const auto it = _chunkMap.upper_bound(shardKey);
+    const auto it = _chunkMap.upperBound(shardKey);
     uassert(ErrorCodes::ShardKeyNotFound,
             str::stream() << "Cannot target single shard using key " << shardKey,
-            it != _chunkMap.end() && it->second->containsKey(shardKey));
+            it != _chunkMap.end() && (*it)->containsKey(shardKey));
 
-    return it->second;
+    return *it;
 }
 
 std::shared_ptr<Chunk> ChunkManager::findIntersectingChunkWithSimpleCollation(
@@ -180,21 +379,22 @@ void ChunkManager::getShardIdsForQuery(OperationContext* opCtx,
     // For now, we satisfy that assumption by adding a shard with no matches rather than returning
     // an empty set of shards.
     if (shardIds->empty()) {
-        shardIds->insert(_chunkMapViews.chunkRangeMap.begin()->second.shardId);
+        shardIds->insert((*_chunkMap.begin())->getShardId());
     }
 }
 
 void ChunkManager::getShardIdsForRange(const BSONObj& min,
                                        const BSONObj& max,
                                        std::set<ShardId>* shardIds) const {
-    auto it = _chunkMapViews.chunkRangeMap.upper_bound(min);
-    auto end = _chunkMapViews.chunkRangeMap.upper_bound(max);
+    const auto& chunkRangeMap = _chunkMapViews.chunkRangeMap;
+    auto it = chunkRangeMap.upper_bound(ChunkMap::encodeKey(min));
+    auto end = chunkRangeMap.upper_bound(ChunkMap::encodeKey(max));
 
     // The chunk range map must always cover the entire key space
-    invariant(it != _chunkMapViews.chunkRangeMap.end());
+    invariant(it != chunkRangeMap.end());
 
     // We need to include the last chunk
-    if (end != _chunkMapViews.chunkRangeMap.cend()) {
+    if (end != chunkRangeMap.end()) {
         ++end;
     }
 
@@ -362,98 +562,197 @@ std::string ChunkManager::toString() const {
     StringBuilder sb;
     sb << "ChunkManager: " << _nss.ns() << " key:" << _shardKeyPattern.toString() << '\n';
 
-    for (const auto& entry : _chunkMap) {
-        sb << "\t" << entry.second->toString() << '\n';
+    for (const auto& chunk : _chunkMap) {
+        sb << "\t" << chunk->toString() << '\n';
     }
 
     return sb.str();
 }
 
-ChunkManager::ChunkMapViews ChunkManager::_constructChunkMapViews(const OID& epoch,
-                                                                  const ChunkMap& chunkMap) {
+ChunkManager::ChunkMapViews ChunkManager::_updateChunkMapViews(
+    const OID& epoch,
+    const ChunkMapViews& previousViews,
+    const ChunkMap& chunkMap,
+    const std::vector<std::shared_ptr<Chunk>>& added,
+    const std::vector<std::shared_ptr<Chunk>>& removed) {
+    ChunkMapViews views(previousViews);
 
-	//¼ĳshard  max汾ı仯
-	ChunkRangeMap chunkRangeMap =
-        SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<ShardAndChunkRange>();
+    _updateChunkRangeMap(chunkMap, added, &views.chunkRangeMap);
 
-    ShardVersionMap shardVersions;
+    for (const auto& chunk : added) {
+        ++views.shardChunkCounts[chunk->getShardId()];
 
-    ChunkMap::const_iterator current = chunkMap.cbegin();
+        auto& maxShardVersion =
+            views.shardVersions.emplace(chunk->getShardId(), ChunkVersion(0, 0, epoch))
+                .first->second;
+        if (chunk->getLastmod() > maxShardVersion)
+            maxShardVersion = chunk->getLastmod();
+    }
 
-    while (current != chunkMap.cend()) {
-        const auto& firstChunkInRange = current->second;
+    // A shard which lost the chunk carrying its version without getting a newer one in the same
+    // update needs its version recomputed from the chunks it still has
+    bool needsRecompute = false;
+    for (const auto& chunk : removed) {
+        auto countIt = views.shardChunkCounts.find(chunk->getShardId());
+        invariant(countIt != views.shardChunkCounts.end() && countIt->second > 0);
+
+        if (--countIt->second == 0) {
+            views.shardChunkCounts.erase(countIt);
+            views.shardVersions.erase(chunk->getShardId());
+        } else if (views.shardVersions[chunk->getShardId()] == chunk->getLastmod()) {
+            needsRecompute = true;
+        }
+    }
 
-        // Tracks the max shard version for the shard on which the current range will reside
-        auto shardVersionIt = shardVersions.find(firstChunkInRange->getShardId());
-        if (shardVersionIt == shardVersions.end()) {
-            shardVersionIt =
-				//ԿShardVersionMapм¼KVΪ: <shardid, ChunkVersion>
-                shardVersions.emplace(firstChunkInRange->getShardId(), ChunkVersion(0, 0, epoch))
-                    .first;
+    if (needsRecompute) {
+        for (auto& entry : views.shardVersions) {
+            entry.second = ChunkVersion(0, 0, epoch);
+        }
+        for (const auto& chunk : chunkMap) {
+            auto& maxShardVersion = views.shardVersions[chunk->getShardId()];
+            if (chunk->getLastmod() > maxShardVersion)
+                maxShardVersion = chunk->getLastmod();
         }
+    }
 
-		//ҲChunkVersion
-        auto& maxShardVersion = shardVersionIt->second;
+    // If a shard has chunks it must have a shard version, otherwise we have an invalid chunk
+    // somewhere, which should have been caught at chunk load time
+    for (const auto& entry : views.shardVersions) {
+        invariant(entry.second.isSet());
+    }
+    invariant(views.shardVersions.size() == views.shardChunkCounts.size());
 
-		//shardidӦchunkversionΪshardchunkа汾ǸlastmodeҲconfig.chunks
-        current = std::find_if(
-            current,
-            chunkMap.cend(),
-            [&firstChunkInRange, &maxShardVersion](const ChunkMap::value_type& chunkMapEntry) {
-                const auto& currentChunk = chunkMapEntry.second;
+    return views;
+}
 
-                if (currentChunk->getShardId() != firstChunkInRange->getShardId())
-                    return true;
+void ChunkManager::_updateChunkRangeMap(const ChunkMap& chunkMap,
+                                        const std::vector<std::shared_ptr<Chunk>>& added,
+                                        ChunkRangeMap* chunkRangeMap) {
+    const auto& comparator = SimpleBSONObjComparator::kInstance;
+
+    // Adds one range for each run of neighbouring chunks in [it, end) on the same shard
+    auto insertRanges = [&](ChunkMap::const_iterator it, ChunkMap::const_iterator end) {
+        while (it != end) {
+            const auto& shardId = (*it)->getShardId();
+            const BSONObj min = (*it)->getMin();
+            BSONObj max = (*it)->getMax();
+            for (++it; it != end && (*it)->getShardId() == shardId; ++it) {
+                max = (*it)->getMax();
+            }
 
-                if (currentChunk->getLastmod() > maxShardVersion)
-                    maxShardVersion = currentChunk->getLastmod();
+            const auto encodedMax = ChunkMap::encodeKey(max);
+            chunkRangeMap->emplace(encodedMax, ShardAndChunkRange{ChunkRange(min, max), shardId});
+        }
+    };
 
-                return false;
-            });
+    // Folds the range preceding 'it' into it if both are on the same shard
+    auto mergeWithPrevious = [&](ChunkRangeMap::iterator it) {
+        if (it == chunkRangeMap->end() || it == chunkRangeMap->begin()) {
+            return;
+        }
 
-        const auto rangeLast = std::prev(current);
+        const auto prev = std::prev(it);
+        if (prev->second.shardId != it->second.shardId) {
+            return;
+        }
 
-        const BSONObj rangeMin = firstChunkInRange->getMin();
-        const BSONObj rangeMax = rangeLast->second->getMax();
+        it->second.range = ChunkRange(prev->second.min(), it->second.max());
+        chunkRangeMap->erase(prev);
+    };
 
-        const auto oldSize = chunkRangeMap.size();
-        const auto insertIterator = chunkRangeMap.insert(
-            chunkRangeMap.end(),
-            //ChunkRangeMapжӦKVΪ<max汾, ShardAndChunkRange>
-            std::make_pair(
-                rangeMax,
-                ShardAndChunkRange{{rangeMin, rangeMax}, firstChunkInRange->getShardId()}));
-        uassert(ErrorCodes::ConflictingOperationInProgress,
-                str::stream() << "Metadata contains two chunks with the same max value "
-                              << rangeMax,
-                oldSize + 1 == chunkRangeMap.size());
+    if (chunkMap.empty()) {
+        chunkRangeMap->clear();
+        return;
+    }
+
+    if (chunkRangeMap->empty() || added.size() * 2 >= chunkMap.size()) {
+        chunkRangeMap->clear();
+        insertRanges(chunkMap.begin(), chunkMap.end());
+        return;
+    }
+
+    for (const auto& chunk : added) {
+        // Find the ranges to rebuild, which must start and end on chunk boundaries of both the
+        // old ranges and the new chunk map. A chunk which spans a boundary of the old ranges
+        // widens the set of ranges until it does not.
+        BSONObj lo = chunk->getMin();
+        BSONObj hi = chunk->getMax();
+        ChunkRangeMap::iterator first;
+        ChunkRangeMap::iterator last;
+        ChunkMap::const_iterator firstChunk;
+        ChunkMap::const_iterator endChunk;
+        while (true) {
+            first = chunkRangeMap->upper_bound(ChunkMap::encodeKey(lo));
+            last = chunkRangeMap->lower_bound(ChunkMap::encodeKey(hi));
+            invariant(first != chunkRangeMap->end() && last != chunkRangeMap->end());
+            ++last;
+
+            const BSONObj rangesMin = first->second.min();
+            const BSONObj rangesMax = std::prev(last)->second.max();
+
+            firstChunk = chunkMap.upperBound(rangesMin);
+            endChunk = last == chunkRangeMap->end() ? chunkMap.end() : chunkMap.upperBound(rangesMax);
+            invariant(firstChunk != chunkMap.end());
+
+            lo = (*firstChunk)->getMin();
+            hi = endChunk == chunkMap.end() ? rangesMax : (*endChunk)->getMin();
+            if (comparator.evaluate(lo == rangesMin) && comparator.evaluate(hi == rangesMax)) {
+                break;
+            }
 
+            // The chunk containing 'rangesMax' starts before it, so it has to be rebuilt too
+            if (endChunk != chunkMap.end() && comparator.evaluate(hi != rangesMax)) {
+                hi = (*endChunk)->getMax();
+            }
+        }
+
+        chunkRangeMap->erase(first, last);
+        insertRanges(firstChunk, endChunk);
+
+        // The rebuilt ranges may continue the ranges on either side of them
+        mergeWithPrevious(chunkRangeMap->upper_bound(ChunkMap::encodeKey(lo)));
+        mergeWithPrevious(chunkRangeMap->upper_bound(ChunkMap::encodeKey(hi)));
+    }
+}
 
-        if (insertIterator != chunkRangeMap.begin()) {
-            // Make sure there are no gaps in the ranges
+void ChunkManager::_checkChangedChunksAdjacency(
+    const ChunkMap& chunkMap, const std::vector<std::shared_ptr<Chunk>>& changed) {
+    for (const auto& chunk : changed) {
+        auto it = chunkMap.upperBound(chunk->getMin());
+
+        // Skip chunks which were replaced by a later change
+        if (it == chunkMap.end() || *it != chunk) {
+            continue;
+        }
+
+        // Make sure there are no gaps in the ranges
+        if (it != chunkMap.begin()) {
+            const auto& prevChunk = *std::prev(it);
             uassert(ErrorCodes::ConflictingOperationInProgress,
                     str::stream() << "Gap or an overlap between ranges "
-                                  << insertIterator->second.range.toString()
+                                  << chunk->toString()
                                   << " and "
-                                  << std::prev(insertIterator)->second.range.toString(),
-                    SimpleBSONObjComparator::kInstance.evaluate(std::prev(insertIterator)->first ==
-                                                                rangeMin));
+                                  << prevChunk->toString(),
+                    SimpleBSONObjComparator::kInstance.evaluate(prevChunk->getMax() ==
+                                                                chunk->getMin()));
         }
 
-        // If a shard has chunks it must have a shard version, otherwise we have an invalid chunk
-        // somewhere, which should have been caught at chunk load time
-        invariant(maxShardVersion.isSet());
+        const auto next = std::next(it);
+        if (next != chunkMap.end()) {
+            uassert(ErrorCodes::ConflictingOperationInProgress,
+                    str::stream() << "Gap or an overlap between ranges "
+                                  << chunk->toString()
+                                  << " and "
+                                  << (*next)->toString(),
+                    SimpleBSONObjComparator::kInstance.evaluate(chunk->getMax() ==
+                                                                (*next)->getMin()));
+        }
     }
 
     if (!chunkMap.empty()) {
-        invariant(!chunkRangeMap.empty());
-        invariant(!shardVersions.empty());
-
-        checkAllElementsAreOfType(MinKey, chunkRangeMap.begin()->second.min());
-        checkAllElementsAreOfType(MaxKey, chunkRangeMap.rbegin()->first);
+        checkAllElementsAreOfType(MinKey, (*chunkMap.begin())->getMin());
+        checkAllElementsAreOfType(MaxKey, (*std::prev(chunkMap.end()))->getMax());
     }
-
-    return {std::move(chunkRangeMap), std::move(shardVersions)};
 }
 
 //ȡһChunkManager
@@ -473,7 +772,8 @@ std::shared_ptr<ChunkManager> ChunkManager::makeNew(
                std::move(shardKeyPattern),
                std::move(defaultCollator),
                std::move(unique),
-               SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<std::shared_ptr<Chunk>>(),
+               ChunkMap(),
+               ChunkMapViews(),
                {0, 0, epoch})
         .makeUpdated(chunks);
 }
@@ -484,8 +784,8 @@ std::shared_ptr<ChunkManager> ChunkManager::makeUpdated(
     const std::vector<ChunkType>& changedChunks) {
     //ȡ_collectionVersionҲshardchunkϢ
     const auto startingCollectionVersion = getVersion();
-	//ػchunkϢб
-    auto chunkMap = _chunkMap;
+    std::vector<std::shared_ptr<Chunk>> newChunks;
+    newChunks.reserve(changedChunks.size());
 
     ChunkVersion collectionVersion = startingCollectionVersion;
     for (const auto& chunk : changedChunks) {
@@ -502,20 +802,7 @@ std::shared_ptr<ChunkManager> ChunkManager::makeUpdated(
         invariant(chunkVersion >= collectionVersion);
         collectionVersion = chunkVersion;
 
-        // Returns the first chunk with a max key that is > min - implies that the chunk overlaps
-        // min
-        const auto low = chunkMap.upper_bound(chunk.getMin());
-
-        // Returns the first chunk with a max key that is > max - implies that the next chunk cannot
-        // not overlap max
-        const auto high = chunkMap.upper_bound(chunk.getMax());
-
-        // Erase all chunks from the map, which overlap the chunk we got from the persistent store
-        chunkMap.erase(low, high);
-
-        // Insert only the chunk itself
-        //map keyΪchunk.getMax()valueΪchunk
-        chunkMap.insert(std::make_pair(chunk.getMax(), std::make_shared<Chunk>(chunk)));
+        newChunks.push_back(std::make_shared<Chunk>(chunk));
     }
 
     // If at least one diff was applied, the metadata is correct, but it might not have changed so
@@ -530,6 +817,15 @@ std::shared_ptr<ChunkManager> ChunkManager::makeUpdated(
         return shared_from_this();
     }
 
+    // Each changed chunk replaces the chunks which overlap it. Only the parts of the chunk map
+    // and of its views which these changes touch are rebuilt.
+    std::vector<std::shared_ptr<Chunk>> removedChunks;
+    auto chunkMap = _chunkMap.makeUpdated(newChunks, &removedChunks);
+    _checkChangedChunksAdjacency(chunkMap, newChunks);
+
+    auto chunkMapViews = _updateChunkMapViews(
+        collectionVersion.epoch(), _chunkMapViews, chunkMap, newChunks, removedChunks);
+
     return std::shared_ptr<ChunkManager>(
         new ChunkManager(_nss,
                          _uuid,
@@ -537,6 +833,7 @@ std::shared_ptr<ChunkManager> ChunkManager::makeUpdated(
                          CollatorInterface::cloneCollator(getDefaultCollator()),
                          isUnique(),
                          std::move(chunkMap),
+                         std::move(chunkMapViews),
                          collectionVersion));
 }
 }  // namespace mongo
@@ -28,9 +28,12 @@
 
 #pragma once
 
+#include <iterator>
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/db/namespace_string.h"
@@ -47,9 +50,129 @@ class CanonicalQuery;
 struct QuerySolutionNode;
 class OperationContext;
 
-// Ordered map from the max for each chunk to an entry describing the chunk
 //map keyΪchunk.getMax()valueΪchunkοChunkManager::makeUpdated
-using ChunkMap = BSONObjIndexedMap<std::shared_ptr<Chunk>>;
+/**
+ * Ordered table of the chunks of a collection, indexed by the max of each chunk. The union of all
+ * chunks' ranges must cover the complete space from [MinKey, MaxKey).
+ *
+ * The bounds are stored as precomputed KeyStrings, so lookups are binary searches comparing plain
+ * bytes rather than BSON. Chunks are kept in sorted blocks of bounded size, which are shared
+ * between the tables of successive refreshes: applying a small set of changed chunks copies only
+ * the blocks those chunks fall into plus the short array of block boundaries, instead of the
+ * whole table.
+ *
+ * Instances are immutable once built.
+ */
+class ChunkMap {
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = std::shared_ptr<Chunk>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = const value_type&;
+
+        const_iterator() = default;
+
+        const_iterator& operator++();
+        const_iterator& operator--();
+
+        const_iterator operator++(int) {
+            auto old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const const_iterator& other) const {
+            return _block == other._block && _index == other._index;
+        }
+        bool operator!=(const const_iterator& other) const {
+            return !(*this == other);
+        }
+
+        const std::shared_ptr<Chunk>& operator*() const;
+        const std::shared_ptr<Chunk>* operator->() const {
+            return &**this;
+        }
+
+    private:
+        friend class ChunkMap;
+
+        const_iterator(const ChunkMap* map, size_t block, size_t index)
+            : _map(map), _block(block), _index(index) {}
+
+        const ChunkMap* _map{nullptr};
+        size_t _block{0};
+        size_t _index{0};
+    };
+
+    const_iterator begin() const {
+        return {this, 0, 0};
+    }
+
+    const_iterator end() const {
+        return {this, _blocks.size(), 0};
+    }
+
+    size_t size() const {
+        return _size;
+    }
+
+    bool empty() const {
+        return _size == 0;
+    }
+
+    /**
+     * Returns the first chunk whose max is greater than 'key', i.e. the only chunk which can
+     * contain 'key', or end() if there is none.
+     */
+    const_iterator upperBound(const BSONObj& key) const;
+
+    /**
+     * Returns a new table in which each of 'changedChunks', in order, replaces all chunks whose
+     * max falls in the range (min, max] of the changed chunk. The replaced chunks are appended to
+     * 'removedChunks'. Does not check that the result is free of gaps or overlaps.
+     */
+    ChunkMap makeUpdated(const std::vector<std::shared_ptr<Chunk>>& changedChunks,
+                         std::vector<std::shared_ptr<Chunk>>* removedChunks) const;
+
+    /**
+     * Returns the bytes which the table compares for a chunk bound or a shard key.
+     */
+    static std::string encodeKey(const BSONObj& key);
+
+private:
+    struct Block {
+        // Encoded max of each chunk, in ascending order, parallel to 'chunks'
+        std::vector<std::string> maxKeys;
+        std::vector<std::shared_ptr<Chunk>> chunks;
+    };
+
+    /**
+     * Applies a single changed chunk in place. Blocks for which 'ownedBlocks' is false may be
+     * shared with other tables and are copied before they are modified.
+     */
+    void _apply(std::shared_ptr<Chunk> chunk,
+                std::vector<bool>* ownedBlocks,
+                std::vector<std::shared_ptr<Chunk>>* removedChunks);
+
+    /**
+     * Replaces the blocks in [firstBlock, lastBlock) with new blocks holding the given chunks,
+     * sorted by their encoded maxes, and marks the new blocks as owned.
+     */
+    void _replaceBlocks(size_t firstBlock,
+                        size_t lastBlock,
+                        std::vector<std::string> maxKeys,
+                        std::vector<std::shared_ptr<Chunk>> chunks,
+                        std::vector<bool>* ownedBlocks);
+
+    // Encoded max of the last chunk in each block, parallel to '_blocks'
+    std::vector<std::string> _blockMaxKeys;
+    std::vector<std::shared_ptr<Block>> _blocks;
+
+    size_t _size{0};
+};
 
 // Map from a shard is to the max chunk version on that shard
 using ShardVersionMap = std::map<ShardId, ChunkVersion>;
@@ -94,8 +217,8 @@ public:
         bool operator!=(const ConstChunkIterator& other) const {
             return !(*this == other);
         }
-        const ChunkMap::mapped_type& operator*() const {
-            return _iter->second;
+        const std::shared_ptr<Chunk>& operator*() const {
+            return *_iter;
         }
 
     private:
@@ -177,7 +300,7 @@ public:
     ChunkVersion getVersion(const ShardId& shardId) const;
 
     ConstRangeOfChunks chunks() const {
-        return {ConstChunkIterator{_chunkMap.cbegin()}, ConstChunkIterator{_chunkMap.cend()}};
+        return {ConstChunkIterator{_chunkMap.begin()}, ConstChunkIterator{_chunkMap.end()}};
     }
 
     int numChunks() const {
@@ -258,8 +381,8 @@ public:
 
 private:
     /**
-     * Represents a range of chunk keys [getMin(), getMax()) and the id of the shard on which they
-     * reside according to the metadata.
+     * Represents a range of contiguous chunks belonging to one shard. Used for targeting wide key
+     * ranges without visiting every chunk in them.
      */
     struct ShardAndChunkRange {
         const BSONObj& min() const {
@@ -274,31 +397,57 @@ private:
         ShardId shardId;
     };
 
-    //οChunkManager::_constructChunkMapViews
-    using ChunkRangeMap = BSONObjIndexedMap<ShardAndChunkRange>;
+    // Indexed by the encoded max of each range, see ChunkMap::encodeKey
+    using ChunkRangeMap = std::map<std::string, ShardAndChunkRange>;
 
     /**
      * Contains different transformations of the chunk map for efficient querying
      */
-    //ChunkManager::_constructChunkMapViews
+    //ChunkManager::_updateChunkMapViews
     struct ChunkMapViews {
         // Transformation of the chunk map containing what range of keys reside on which shard. The
-        // index is the max key of the respective range and the union of all ranges in a such
-        // constructed map must cover the complete space from [MinKey, MaxKey).
-         
-        const ChunkRangeMap chunkRangeMap;
+        // union of all ranges covers the complete space from [MinKey, MaxKey), and neighbouring
+        // ranges are on different shards.
+        ChunkRangeMap chunkRangeMap;
 
         // Map from shard id to the maximum chunk version for that shard. If a shard contains no
         // chunks, it won't be present in this map.
         //ÿshardİ汾ϢȡֵΪshardchunk汾Ϣ
         //ChunkManager::getVersionлȡ
-        const ShardVersionMap shardVersions;
+        ShardVersionMap shardVersions;
+
+        // Number of chunks on each shard in 'shardVersions', which tells when a shard loses its
+        // last chunk without another pass over the chunk map.
+        std::map<ShardId, size_t> shardChunkCounts;
     };
 
     /**
-     * Does a single pass over the chunkMap and constructs the ChunkMapViews object.
+     * Derives the views of 'chunkMap' from the views of the chunk map it was updated from, given
+     * the chunks which were added to and removed from it. Only falls back to a pass over the whole
+     * chunk map if a shard lost the chunk which carried its version.
+     */
+    static ChunkMapViews _updateChunkMapViews(const OID& epoch,
+                                              const ChunkMapViews& previousViews,
+                                              const ChunkMap& chunkMap,
+                                              const std::vector<std::shared_ptr<Chunk>>& added,
+                                              const std::vector<std::shared_ptr<Chunk>>& removed);
+
+    /**
+     * Brings 'chunkRangeMap' up to date with 'chunkMap' after 'added' were applied to it. Only the
+     * ranges overlapping the added chunks are rebuilt, unless the map is empty or most of the
+     * chunks changed.
+     */
+    static void _updateChunkRangeMap(const ChunkMap& chunkMap,
+                                     const std::vector<std::shared_ptr<Chunk>>& added,
+                                     ChunkRangeMap* chunkRangeMap);
+
+    /**
+     * Checks that each of 'changedChunks' which is still in 'chunkMap' is adjacent to its
+     * neighbours, which is sufficient for the whole map to be free of gaps and overlaps if the
+     * map it was updated from was.
      */
-    static ChunkMapViews _constructChunkMapViews(const OID& epoch, const ChunkMap& chunkMap);
+    static void _checkChangedChunksAdjacency(const ChunkMap& chunkMap,
+                                             const std::vector<std::shared_ptr<Chunk>>& changed);
 
     ChunkManager(NamespaceString nss,
                  boost::optional<UUID>,
@@ -306,6 +455,7 @@ private:
                  std::unique_ptr<CollatorInterface> defaultCollator,
                  bool unique,
                  ChunkMap chunkMap,
+                 ChunkMapViews chunkMapViews,
                  ChunkVersion collectionVersion);
 
     // The shard versioning mechanism hinges on keeping track of the number of times we reload
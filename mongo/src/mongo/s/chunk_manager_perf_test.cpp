@@ -0,0 +1,160 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kDefault
+
+#include "mongo/platform/basic.h"
+
+#include <vector>
+
+#include "mongo/bson/simple_bsonobj_comparator.h"
+#include "mongo/platform/random.h"
+#include "mongo/s/chunk_manager.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/log.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+namespace {
+
+// These tests measure lookup latency and refresh cost of the routing table for collections with
+// many chunks. It is neither practical nor useful to run the larger ones on debug builds, so only
+// the smallest runs there, to keep the code exercised.
+
+const NamespaceString kNss("TestDB", "TestColl");
+const int kNumShards = 8;
+const int kNumLookups = 200 * 1000;
+const int kNumRefreshes = 100;
+
+BSONObj shardKeyAt(int i) {
+    return BSON("a" << i * 10);
+}
+
+/**
+ * Returns 'numChunks' chunks covering [MinKey, MaxKey), placed on the shards round-robin, which is
+ * the worst case for the number of contiguous ranges on each shard.
+ */
+std::vector<ChunkType> makeChunks(const OID& epoch, int numChunks) {
+    std::vector<ChunkType> chunks;
+    chunks.reserve(numChunks);
+
+    ChunkVersion version(1, 0, epoch);
+    for (int i = 0; i < numChunks; i++) {
+        const BSONObj min = i == 0 ? BSON("a" << MINKEY) : shardKeyAt(i);
+        const BSONObj max = i == numChunks - 1 ? BSON("a" << MAXKEY) : shardKeyAt(i + 1);
+
+        chunks.emplace_back(
+            kNss, ChunkRange{min, max}, version, ShardId{str::stream() << (i % kNumShards)});
+        version.incMinor();
+    }
+    return chunks;
+}
+
+void runPerfTest(int numChunks) {
+    if (kDebugBuild && numChunks > 10 * 1000) {
+        log() << "Skipping " << numChunks << " chunks perf test on a debug build";
+        return;
+    }
+
+    const OID epoch = OID::gen();
+    const auto chunks = makeChunks(epoch, numChunks);
+
+    Timer buildTimer;
+    auto cm = ChunkManager::makeNew(
+        kNss, boost::none, KeyPattern(BSON("a" << 1)), nullptr, false, epoch, chunks);
+    const auto buildMicros = buildTimer.micros();
+    ASSERT_EQ(numChunks, cm->numChunks());
+
+    // The BSON-keyed ordered map which the routing table used to be searched with, as a baseline
+    auto bsonMap = SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<ChunkType>();
+    for (const auto& chunk : chunks) {
+        bsonMap.emplace(chunk.getMax(), chunk);
+    }
+
+    PseudoRandom random(1);
+    std::vector<BSONObj> keys;
+    keys.reserve(kNumLookups);
+    for (int i = 0; i < kNumLookups; i++) {
+        keys.push_back(BSON("a" << random.nextInt32(numChunks * 10)));
+    }
+
+    Timer lookupTimer;
+    for (const auto& key : keys) {
+        cm->findIntersectingChunkWithSimpleCollation(key);
+    }
+    const auto lookupMicros = lookupTimer.micros();
+
+    Timer bsonLookupTimer;
+    for (const auto& key : keys) {
+        auto it = bsonMap.upper_bound(key);
+        ASSERT(it != bsonMap.end());
+    }
+    const auto bsonLookupMicros = bsonLookupTimer.micros();
+
+    // Each refresh splits a random chunk in two, which is the typical small diff
+    ChunkVersion version = cm->getVersion();
+    Timer refreshTimer;
+    for (int i = 0; i < kNumRefreshes; i++) {
+        const int chunkToSplit = 1 + random.nextInt32(numChunks - 2);
+        const auto& shardId = chunks[chunkToSplit].getShard();
+        const BSONObj splitPoint = BSON("a" << chunkToSplit * 10 + 1 + i % 9);
+
+        std::vector<ChunkType> changedChunks;
+        version.incMinor();
+        changedChunks.emplace_back(
+            kNss, ChunkRange{shardKeyAt(chunkToSplit), splitPoint}, version, shardId);
+        version.incMinor();
+        changedChunks.emplace_back(kNss,
+                                   ChunkRange{splitPoint, shardKeyAt(chunkToSplit + 1)},
+                                   version,
+                                   shardId);
+
+        cm = cm->makeUpdated(changedChunks);
+    }
+    const auto refreshMicros = refreshTimer.micros();
+
+    log() << numChunks << " chunks: build " << buildMicros / 1000 << " ms, lookup "
+          << 1E3 * lookupMicros / kNumLookups << " ns (BSON map "
+          << 1E3 * bsonLookupMicros / kNumLookups << " ns), refresh "
+          << refreshMicros / kNumRefreshes << " us" << (kDebugBuild ? " (DEBUG BUILD!)" : "");
+}
+
+TEST(ChunkManagerPerf, LookupAndRefresh10K) {
+    runPerfTest(10 * 1000);
+}
+
+TEST(ChunkManagerPerf, LookupAndRefresh100K) {
+    runPerfTest(100 * 1000);
+}
+
+TEST(ChunkManagerPerf, LookupAndRefresh1M) {
+    runPerfTest(1000 * 1000);
+}
+
+}  // namespace
+}  // namespace mongo
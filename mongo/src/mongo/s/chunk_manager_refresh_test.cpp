@@ -0,0 +1,415 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "mongo/bson/simple_bsonobj_comparator.h"
+#include "mongo/platform/random.h"
+#include "mongo/s/chunk_manager.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+// These tests apply small refreshes to routing tables large enough to span many blocks of the
+// chunk map, so that the changes go through the incremental path rather than a full rebuild, and
+// check the result against a plain ordered map of the expected chunks.
+
+const NamespaceString kNss("TestDB", "TestColl");
+const int kNumShards = 4;
+const int kMinBound = std::numeric_limits<int>::min();
+const int kMaxBound = std::numeric_limits<int>::max();
+
+BSONObj keyAt(int value) {
+    if (value == kMinBound) {
+        return BSON("a" << MINKEY);
+    }
+    if (value == kMaxBound) {
+        return BSON("a" << MAXKEY);
+    }
+    return BSON("a" << value);
+}
+
+ShardId shardAt(int i) {
+    return ShardId(str::stream() << "shard" << i);
+}
+
+/**
+ * The expected routing table, as an ordered map from each chunk's min to the chunk. Each change
+ * assigns the next collection version to the chunks it produces and returns them as the diff
+ * which a refresh would fetch from the config server.
+ */
+class RoutingTableModel {
+public:
+    struct ModelChunk {
+        int max;
+        ShardId shardId;
+        ChunkVersion version;
+    };
+
+    /**
+     * Creates 'numChunks' chunks of 'width' keys each, the first and last of them extended to
+     * MinKey and MaxKey, placed on the shards round-robin.
+     */
+    RoutingTableModel(int numChunks, int width) : _version(1, 0, OID::gen()) {
+        for (int i = 0; i < numChunks; i++) {
+            const int min = i == 0 ? kMinBound : i * width;
+            const int max = i == numChunks - 1 ? kMaxBound : (i + 1) * width;
+            _chunks[min] = {max, shardAt(i % kNumShards), _version};
+            _version.incMinor();
+        }
+    }
+
+    std::shared_ptr<ChunkManager> makeChunkManager() const {
+        std::vector<std::pair<ChunkVersion, ChunkType>> byVersion;
+        for (const auto& entry : _chunks) {
+            byVersion.emplace_back(entry.second.version, toChunkType(entry));
+        }
+        std::sort(byVersion.begin(), byVersion.end(), [](const auto& lhs, const auto& rhs) {
+            return rhs.first > lhs.first;
+        });
+
+        std::vector<ChunkType> chunks;
+        for (const auto& entry : byVersion) {
+            chunks.push_back(entry.second);
+        }
+
+        return ChunkManager::makeNew(
+            kNss, boost::none, KeyPattern(BSON("a" << 1)), nullptr, false, epoch(), chunks);
+    }
+
+    const OID& epoch() const {
+        return _version.epoch();
+    }
+
+    const std::map<int, ModelChunk>& chunks() const {
+        return _chunks;
+    }
+
+    /**
+     * Returns the min of the chunk which contains 'key'.
+     */
+    int chunkContaining(int key) const {
+        return std::prev(_chunks.upper_bound(key))->first;
+    }
+
+    /**
+     * Splits the chunk starting at 'min' at each of 'splitPoints', which must be ascending and
+     * inside the chunk.
+     */
+    void split(int min, const std::vector<int>& splitPoints, std::vector<ChunkType>* diff) {
+        const auto chunk = _chunks.at(min);
+
+        int pieceMin = min;
+        for (int splitPoint : splitPoints) {
+            _set(pieceMin, splitPoint, chunk.shardId, diff);
+            pieceMin = splitPoint;
+        }
+        _set(pieceMin, chunk.max, chunk.shardId, diff);
+    }
+
+    /**
+     * Moves the chunk starting at 'min' to 'toShard', without bumping the version of any chunk
+     * left on the donor.
+     */
+    void move(int min, const ShardId& toShard, std::vector<ChunkType>* diff) {
+        _version.incMajor();
+        _set(min, _chunks.at(min).max, toShard, diff);
+    }
+
+    /**
+     * Merges the chunks starting at 'min' up to the one ending at 'max' into one chunk on the
+     * shard of the first of them.
+     */
+    void merge(int min, int max, std::vector<ChunkType>* diff) {
+        const auto shardId = _chunks.at(min).shardId;
+        _chunks.erase(_chunks.upper_bound(min), _chunks.lower_bound(max));
+        _set(min, max, shardId, diff);
+    }
+
+    /**
+     * Checks that 'cm' routes exactly as the model does.
+     */
+    void assertMatches(const ChunkManager& cm) const {
+        ASSERT_EQ(_chunks.size(), static_cast<size_t>(cm.numChunks()));
+
+        std::map<ShardId, ChunkVersion> shardVersions;
+        ChunkVersion collectionVersion(0, 0, epoch());
+
+        auto expected = _chunks.begin();
+        for (const auto& chunk : cm.chunks()) {
+            ASSERT(expected != _chunks.end());
+            ASSERT_BSONOBJ_EQ(keyAt(expected->first), chunk->getMin());
+            ASSERT_BSONOBJ_EQ(keyAt(expected->second.max), chunk->getMax());
+            ASSERT_EQ(expected->second.shardId, chunk->getShardId());
+            ASSERT_EQ(expected->second.version, chunk->getLastmod());
+
+            auto& shardVersion =
+                shardVersions.emplace(chunk->getShardId(), ChunkVersion(0, 0, epoch()))
+                    .first->second;
+            if (chunk->getLastmod() > shardVersion) {
+                shardVersion = chunk->getLastmod();
+            }
+            if (chunk->getLastmod() > collectionVersion) {
+                collectionVersion = chunk->getLastmod();
+            }
+
+            ++expected;
+        }
+        ASSERT(expected == _chunks.end());
+
+        ASSERT_EQ(collectionVersion, cm.getVersion());
+        for (int i = 0; i <= kNumShards; i++) {
+            const auto it = shardVersions.find(shardAt(i));
+            ASSERT_EQ(it == shardVersions.end() ? ChunkVersion(0, 0, epoch()) : it->second,
+                      cm.getVersion(shardAt(i)));
+        }
+
+        std::set<ShardId> allShardIds;
+        cm.getAllShardIds(&allShardIds);
+        ASSERT_EQ(shardVersions.size(), allShardIds.size());
+
+        // Look up the first and last key of every chunk
+        for (const auto& entry : _chunks) {
+            const int firstKey = entry.first == kMinBound ? kMinBound + 1 : entry.first;
+            for (int key : {firstKey, entry.second.max - 1}) {
+                const auto chunk = cm.findIntersectingChunkWithSimpleCollation(keyAt(key));
+                ASSERT_BSONOBJ_EQ(keyAt(entry.first), chunk->getMin());
+                ASSERT_EQ(entry.second.shardId, chunk->getShardId());
+            }
+        }
+
+        // Target every window of a few neighbouring chunks, from the first key of the first to the
+        // last key of the last
+        const size_t kWindow = 4;
+        std::vector<std::pair<int, ModelChunk>> ordered(_chunks.begin(), _chunks.end());
+        for (size_t i = 0; i < ordered.size(); i++) {
+            std::set<ShardId> expectedShardIds;
+            const size_t last = std::min(i + kWindow, ordered.size()) - 1;
+            for (size_t j = i; j <= last; j++) {
+                expectedShardIds.insert(ordered[j].second.shardId);
+            }
+
+            std::set<ShardId> shardIds;
+            cm.getShardIdsForRange(keyAt(ordered[i].first), keyAt(ordered[last].second.max - 1),
+                                   &shardIds);
+            ASSERT(expectedShardIds == shardIds);
+        }
+    }
+
+private:
+    static ChunkType toChunkType(const std::pair<const int, ModelChunk>& entry) {
+        return ChunkType(kNss,
+                         ChunkRange{keyAt(entry.first), keyAt(entry.second.max)},
+                         entry.second.version,
+                         entry.second.shardId);
+    }
+
+    void _set(int min, int max, const ShardId& shardId, std::vector<ChunkType>* diff) {
+        _version.incMinor();
+        _chunks[min] = {max, shardId, _version};
+        diff->push_back(toChunkType(*_chunks.find(min)));
+    }
+
+    ChunkVersion _version;
+    std::map<int, ModelChunk> _chunks;
+};
+
+TEST(ChunkManagerRefresh, RandomSplitsAcrossTheTable) {
+    RoutingTableModel model(5000, 1 << 16);
+    auto cm = model.makeChunkManager();
+    model.assertMatches(*cm);
+
+    PseudoRandom random(1);
+    for (int refresh = 0; refresh < 40; refresh++) {
+        std::vector<ChunkType> diff;
+        for (int i = 0; i < 3; i++) {
+            const int min = model.chunkContaining(random.nextInt32(5000) << 16);
+            const int max = model.chunks().at(min).max;
+            if (min == kMinBound || max == kMaxBound || max - min < 4) {
+                continue;
+            }
+            model.split(min, {min + (max - min) / 4, min + (max - min) / 2}, &diff);
+        }
+
+        cm = cm->makeUpdated(diff);
+        model.assertMatches(*cm);
+    }
+}
+
+TEST(ChunkManagerRefresh, RepeatedSplitsInOneRangeSplitTheBlocks) {
+    RoutingTableModel model(5000, 1 << 16);
+    auto cm = model.makeChunkManager();
+
+    // Each refresh splits a chunk near the same key into ten, so the block holding that range
+    // grows past its maximum size and has to be split, while the later pieces of each split are
+    // applied to the block which the first piece already copied
+    PseudoRandom random(2);
+    for (int refresh = 0; refresh < 60; refresh++) {
+        int min;
+        int max;
+        do {
+            min = model.chunkContaining((2000 << 16) + random.nextInt32(4 << 16));
+            max = model.chunks().at(min).max;
+        } while (max - min < 10);
+
+        std::vector<int> splitPoints;
+        for (int i = 1; i < 10; i++) {
+            splitPoints.push_back(min + i * ((max - min) / 10));
+        }
+
+        std::vector<ChunkType> diff;
+        model.split(min, splitPoints, &diff);
+
+        const auto previous = cm;
+        cm = cm->makeUpdated(diff);
+        model.assertMatches(*cm);
+
+        // The previous routing table shares the untouched blocks and must not have changed
+        ASSERT_EQ(model.chunks().size() - 9, static_cast<size_t>(previous->numChunks()));
+    }
+}
+
+TEST(ChunkManagerRefresh, MergesAcrossBlocksAndAtTheEnds) {
+    RoutingTableModel model(5000, 1 << 16);
+    auto cm = model.makeChunkManager();
+
+    {
+        // Spans three blocks of the initial table
+        std::vector<ChunkType> diff;
+        model.merge(1000 << 16, 1400 << 16, &diff);
+        cm = cm->makeUpdated(diff);
+        model.assertMatches(*cm);
+    }
+
+    {
+        std::vector<ChunkType> diff;
+        model.merge(kMinBound, 50 << 16, &diff);
+        model.merge(4900 << 16, kMaxBound, &diff);
+        cm = cm->makeUpdated(diff);
+        model.assertMatches(*cm);
+    }
+}
+
+TEST(ChunkManagerRefresh, MovesJoinAndSplitShardRanges) {
+    RoutingTableModel model(2000, 1 << 16);
+    auto cm = model.makeChunkManager();
+
+    // Gather a run of neighbouring chunks on one shard, so that they form a single range which
+    // also joins the range of the chunk before them
+    {
+        std::vector<ChunkType> diff;
+        for (int i = 101; i < 140; i++) {
+            if (model.chunks().at(i << 16).shardId != shardAt(100 % kNumShards)) {
+                model.move(i << 16, shardAt(100 % kNumShards), &diff);
+            }
+        }
+        cm = cm->makeUpdated(diff);
+        model.assertMatches(*cm);
+    }
+
+    // Splitting a chunk inside the run keeps the range, moving one away cuts it in two
+    {
+        std::vector<ChunkType> diff;
+        model.split(110 << 16, {(110 << 16) + 100}, &diff);
+        cm = cm->makeUpdated(diff);
+        model.assertMatches(*cm);
+    }
+
+    {
+        std::vector<ChunkType> diff;
+        model.move(120 << 16, shardAt(kNumShards), &diff);
+        cm = cm->makeUpdated(diff);
+        model.assertMatches(*cm);
+    }
+
+    // Moving it back and merging across the run joins everything again
+    {
+        std::vector<ChunkType> diff;
+        model.move(120 << 16, shardAt(100 % kNumShards), &diff);
+        model.merge(105 << 16, 130 << 16, &diff);
+        cm = cm->makeUpdated(diff);
+        model.assertMatches(*cm);
+    }
+}
+
+TEST(ChunkManagerRefresh, MovesRecomputeShardVersions) {
+    RoutingTableModel model(2000, 1 << 16);
+    auto cm = model.makeChunkManager();
+
+    // Move the chunk carrying shard0's version away. The donor's version has to be recomputed
+    // from the chunks it still owns.
+    int newestOnShard0 = kMinBound;
+    for (const auto& entry : model.chunks()) {
+        if (entry.second.shardId == shardAt(0) &&
+            entry.second.version > model.chunks().at(newestOnShard0).version) {
+            newestOnShard0 = entry.first;
+        }
+    }
+
+    {
+        std::vector<ChunkType> diff;
+        model.move(newestOnShard0, shardAt(1), &diff);
+        cm = cm->makeUpdated(diff);
+        model.assertMatches(*cm);
+    }
+
+    // Give a new shard a few chunks and then move all of them away again, in the same refresh as
+    // a split of one of them
+    const std::vector<int> chunksForNewShard = {100 << 16, 1500 << 16, 1999 << 16};
+    {
+        std::vector<ChunkType> diff;
+        for (int min : chunksForNewShard) {
+            model.move(min, shardAt(kNumShards), &diff);
+        }
+        cm = cm->makeUpdated(diff);
+        model.assertMatches(*cm);
+        ASSERT(cm->getVersion(shardAt(kNumShards)).isSet());
+    }
+
+    {
+        std::vector<ChunkType> diff;
+        model.split(chunksForNewShard[0], {chunksForNewShard[0] + 100}, &diff);
+        model.move(chunksForNewShard[0], shardAt(2), &diff);
+        model.move(chunksForNewShard[0] + 100, shardAt(2), &diff);
+        model.move(chunksForNewShard[1], shardAt(3), &diff);
+        model.move(chunksForNewShard[2], shardAt(0), &diff);
+        cm = cm->makeUpdated(diff);
+        model.assertMatches(*cm);
+        ASSERT_EQ(ChunkVersion(0, 0, model.epoch()), cm->getVersion(shardAt(kNumShards)));
+    }
+}
+
+}  // namespace
+}  // namespace mongo
@@ -38,6 +38,8 @@
 #include "mongo/db/query/cursor_response.h"
 #include "mongo/db/query/getmore_request.h"
 #include "mongo/db/query/killcursors_request.h"
+#include "mongo/db/query/query_request.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/executor/remote_command_request.h"
 #include "mongo/executor/remote_command_response.h"
 #include "mongo/s/client/shard_registry.h"
@@ -51,6 +53,19 @@ namespace {
 // Maximum number of retries for network and replication notMaster errors (per host).
 const int kMaxNumFailedHostRetryAttempts = 3;
 
+// The most fields of a sort pattern that an Ordering can describe. Sort keys for longer patterns
+// are compared as BSON instead of being encoded as KeyStrings.
+const int kMaxOrderingFields = 32;
+
+// In a sorted merge, the next batch is requested from a remote once the number of its buffered
+// results falls to this fraction of the size of the last batch received from it. Zero requests
+// the next batch only once the buffer is empty.
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryMergePrefetchRatio, double, 0.25);
+
+// Upper bound on the getMore batchSize that a sorted merge requests from each remote when the
+// client did not specify one. Zero leaves such getMore batches unbounded.
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryMergeMaxBatchSize, int, 16 * 1024);
+
 /**
  * Returns the sort key out of the $sortKey metadata field in 'obj'. This object is of the form
  * {'': 'firstSortKey', '': 'secondSortKey', ...}.
@@ -72,6 +87,17 @@ int compareSortKeys(BSONObj leftSortKey, BSONObj rightSortKey, BSONObj sortKeyPa
     return leftSortKey.woCompare(rightSortKey, sortKeyPattern, considerFieldName);
 }
 
+/**
+ * Returns the Ordering used to encode sort keys for 'sortKeyPattern', or boost::none if there is no
+ * sort or the pattern has too many fields.
+ */
+boost::optional<Ordering> makeSortKeyOrdering(const BSONObj& sortKeyPattern) {
+    if (sortKeyPattern.isEmpty() || sortKeyPattern.nFields() > kMaxOrderingFields) {
+        return boost::none;
+    }
+    return Ordering::make(sortKeyPattern);
+}
+
 }  // namespace
 
 AsyncResultsMerger::AsyncResultsMerger(OperationContext* opCtx,
@@ -80,7 +106,11 @@ AsyncResultsMerger::AsyncResultsMerger(OperationContext* opCtx,
     : _opCtx(opCtx),
       _executor(executor),
       _params(params),
-      _mergeQueue(MergingComparator(_remotes, _params->sort)) {
+      _sortKeyOrdering(makeSortKeyOrdering(_params->sort)),
+      _sortKeyBuilder(KeyString::Version::V1),
+      _mergeTree(_remotes, _params->sort, static_cast<bool>(_sortKeyOrdering)) {
+    _mergeTree.reset(_params->remotes.size());
+
     size_t remoteIndex = 0;
     for (const auto& remote : _params->remotes) {
         _remotes.emplace_back(remote.hostAndPort,
@@ -170,6 +200,7 @@ void AsyncResultsMerger::addNewShardCursors(
                               remote.cursorResponse.getNSS(),
                               remote.cursorResponse.getCursorId());
     }
+    _mergeTree.reset(_remotes.size());
 }
 
 bool AsyncResultsMerger::_ready(WithLock lk) {
@@ -212,12 +243,12 @@ bool AsyncResultsMerger::_readySorted(WithLock lk) {
 }
 
 bool AsyncResultsMerger::_readySortedTailable(WithLock) {
-    if (_mergeQueue.empty()) {
+    if (_mergeTree.empty()) {
         return false;
     }
 
-    auto smallestRemote = _mergeQueue.top();
-    auto smallestResult = _remotes[smallestRemote].docBuffer.front();
+    auto smallestRemote = _mergeTree.top();
+    const auto& smallestResult = _remotes[smallestRemote].docBuffer.front().result;
     auto keyWeWantToReturn = extractSortKey(*smallestResult.getResult());
     for (const auto& remote : _remotes) {
         if (!remote.promisedMinSortKey) {
@@ -268,29 +299,28 @@ StatusWith<ClusterQueryResult> AsyncResultsMerger::nextReady() {
     return hasSort ? _nextReadySorted(lk) : _nextReadyUnsorted(lk);
 }
 
-ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock) {
+ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock lk) {
     // Tailable non-awaitData cursors cannot have a sort.
     invariant(_params->tailableMode != TailableMode::kTailable);
 
-    if (_mergeQueue.empty()) {
+    if (_mergeTree.empty()) {
         return {};
     }
 
-    size_t smallestRemote = _mergeQueue.top();
-    _mergeQueue.pop();
+    size_t smallestRemote = _mergeTree.top();
+    auto& remote = _remotes[smallestRemote];
 
-    invariant(!_remotes[smallestRemote].docBuffer.empty());
-    invariant(_remotes[smallestRemote].status.isOK());
+    invariant(!remote.docBuffer.empty());
+    invariant(remote.status.isOK());
 
-    ClusterQueryResult front = _remotes[smallestRemote].docBuffer.front();
-    _remotes[smallestRemote].docBuffer.pop();
+    ClusterQueryResult front = std::move(remote.docBuffer.front().result);
+    remote.docBuffer.pop();
 
-    // Re-populate the merging queue with the next result from 'smallestRemote', if it has a
-    // next result.
-    if (!_remotes[smallestRemote].docBuffer.empty()) {
-        _mergeQueue.push(smallestRemote);
-    }
+    // Replay 'smallestRemote' against the rest of the merge tree with its next result, if it has
+    // a next result.
+    _mergeTree.update(smallestRemote);
 
+    _prefetchIfNeeded(lk, smallestRemote);
     return front;
 }
 
@@ -301,7 +331,8 @@ ClusterQueryResult AsyncResultsMerger::_nextReadyUnsorted(WithLock) {
         invariant(_remotes[_gettingFromRemote].status.isOK());
 
         if (_remotes[_gettingFromRemote].hasNext()) {
-            ClusterQueryResult front = _remotes[_gettingFromRemote].docBuffer.front();
+            ClusterQueryResult front =
+                std::move(_remotes[_gettingFromRemote].docBuffer.front().result);
             _remotes[_gettingFromRemote].docBuffer.pop();
 
             if (_params->tailableMode == TailableMode::kTailable &&
@@ -339,6 +370,13 @@ Status AsyncResultsMerger::_askForNextBatch(WithLock, size_t remoteIndex) {
         adjustedBatchSize = *_params->batchSize - remote.fetchedCount;
     }
 
+    // Without a batchSize from the client, a sorted merge bounds each getMore by the batchSize it
+    // has adapted for this remote, rather than buffering up to 16MB from every shard.
+    const long long maxBatchSize = internalQueryMergeMaxBatchSize.load();
+    if (!_params->batchSize && _isStreamingSortedMerge() && maxBatchSize > 0) {
+        adjustedBatchSize = std::min(remote.adaptiveBatchSize, maxBatchSize);
+    }
+
     BSONObj cmdObj = GetMoreRequest(remote.cursorNss,
                                     remote.cursorId,
                                     adjustedBatchSize,
@@ -361,9 +399,29 @@ Status AsyncResultsMerger::_askForNextBatch(WithLock, size_t remoteIndex) {
     }
 
     remote.cbHandle = callbackStatus.getValue();
+    remote.bufferedAtRequest = remote.docBuffer.size();
     return Status::OK();
 }
 
+void AsyncResultsMerger::_prefetchIfNeeded(WithLock lk, size_t remoteIndex) {
+    auto& remote = _remotes[remoteIndex];
+    if (!_isStreamingSortedMerge() || _lifecycleState != kAlive || !remote.status.isOK() ||
+        remote.exhausted() || remote.cbHandle.isValid()) {
+        return;
+    }
+
+    const double prefetchRatio = std::max(internalQueryMergePrefetchRatio.load(), 0.0);
+    if (remote.docBuffer.size() > prefetchRatio * remote.lastBatchSize) {
+        return;
+    }
+
+    remote.status = _askForNextBatch(lk, remoteIndex);
+}
+
+bool AsyncResultsMerger::_isStreamingSortedMerge() const {
+    return !_params->sort.isEmpty() && _params->tailableMode == TailableMode::kNormal;
+}
+
 /*
  * Note: When nextEvent() is called to do retries, only the remotes with retriable errors will
  * be rescheduled because:
@@ -531,9 +589,13 @@ void AsyncResultsMerger::_cleanUpFailedBatch(WithLock lk, Status status, size_t
         remote.status = Status::OK();
 
         // Clear the results buffer and cursor id.
-        std::queue<ClusterQueryResult> emptyBuffer;
+        std::queue<BufferedResult> emptyBuffer;
         std::swap(remote.docBuffer, emptyBuffer);
         remote.cursorId = 0;
+
+        if (!_params->sort.isEmpty()) {
+            _mergeTree.update(remoteIndex);
+        }
     }
 }
 
@@ -556,6 +618,22 @@ void AsyncResultsMerger::_processBatchResults(WithLock lk,
     // Update the cursorId; it is sent as '0' when the cursor has been exhausted on the shard.
     remote.cursorId = cursorResponse.getCursorId();
 
+    // Adapt the batchSize of this remote's next getMore to how quickly the merge consumed its
+    // results while this batch was in flight: double it if the buffer ran dry and the merge had to
+    // wait on this remote, and halve it if little of what was buffered got consumed.
+    const long long maxBatchSize = internalQueryMergeMaxBatchSize.load();
+    if (_isStreamingSortedMerge() && maxBatchSize > 0) {
+        const size_t consumed = remote.bufferedAtRequest - remote.docBuffer.size();
+        if (remote.docBuffer.empty()) {
+            remote.adaptiveBatchSize =
+                std::min(remote.adaptiveBatchSize * 2,
+                         std::max(maxBatchSize, QueryRequest::kDefaultBatchSize));
+        } else if (consumed * 4 < remote.bufferedAtRequest) {
+            remote.adaptiveBatchSize =
+                std::max(remote.adaptiveBatchSize / 2, QueryRequest::kDefaultBatchSize);
+        }
+    }
+
     // Save the batch in the remote's buffer.
     if (!_addBatchToBuffer(lk, remoteIndex, cursorResponse)) {
         return;
@@ -594,15 +672,24 @@ bool AsyncResultsMerger::_addBatchToBuffer(WithLock lk,
             return false;
         }
 
-        ClusterQueryResult result(obj);
-        remote.docBuffer.push(result);
+        BufferedResult buffered{ClusterQueryResult(obj), std::string()};
+        if (_sortKeyOrdering) {
+            _sortKeyBuilder.resetToKey(extractSortKey(obj), *_sortKeyOrdering);
+            buffered.sortKey.assign(_sortKeyBuilder.getBuffer(), _sortKeyBuilder.getSize());
+        }
+        remote.docBuffer.push(std::move(buffered));
         ++remote.fetchedCount;
     }
 
-    // If we're doing a sorted merge, then we have to make sure to put this remote onto the
-    // merge queue.
-    if (!_params->sort.isEmpty() && !response.getBatch().empty()) {
-        _mergeQueue.push(remoteIndex);
+    if (response.getBatch().empty()) {
+        return true;
+    }
+    remote.lastBatchSize = response.getBatch().size();
+
+    // If we're doing a sorted merge, then we have to make sure that this remote's leaf in the merge
+    // tree reflects the front of its buffer.
+    if (!_params->sort.isEmpty()) {
+        _mergeTree.update(remoteIndex);
     }
     return true;
 }
@@ -689,7 +776,8 @@ AsyncResultsMerger::RemoteCursorData::RemoteCursorData(HostAndPort hostAndPort,
                                                        CursorId establishedCursorId)
     : cursorId(establishedCursorId),
       cursorNss(std::move(cursorNss)),
-      shardHostAndPort(std::move(hostAndPort)) {}
+      shardHostAndPort(std::move(hostAndPort)),
+      adaptiveBatchSize(QueryRequest::kDefaultBatchSize) {}
 
 const HostAndPort& AsyncResultsMerger::RemoteCursorData::getTargetHost() const {
     return shardHostAndPort;
@@ -708,16 +796,54 @@ std::shared_ptr<Shard> AsyncResultsMerger::RemoteCursorData::getShard() {
 }
 
 //
-// AsyncResultsMerger::MergingComparator
+// AsyncResultsMerger::MergeTree
 //
 
-bool AsyncResultsMerger::MergingComparator::operator()(const size_t& lhs, const size_t& rhs) {
-    const ClusterQueryResult& leftDoc = _remotes[lhs].docBuffer.front();
-    const ClusterQueryResult& rightDoc = _remotes[rhs].docBuffer.front();
+constexpr size_t AsyncResultsMerger::MergeTree::kNoRemote;
+
+void AsyncResultsMerger::MergeTree::reset(size_t numRemotes) {
+    _numLeaves = 1;
+    while (_numLeaves < numRemotes) {
+        _numLeaves *= 2;
+    }
+
+    _nodes.assign(2 * _numLeaves, kNoRemote);
+    for (size_t i = 0; i < numRemotes && i < _remotes.size(); ++i) {
+        if (_remotes[i].hasNext()) {
+            _nodes[_numLeaves + i] = i;
+        }
+    }
+
+    for (size_t node = _numLeaves - 1; node > 0; --node) {
+        _nodes[node] = _winner(_nodes[2 * node], _nodes[2 * node + 1]);
+    }
+}
+
+void AsyncResultsMerger::MergeTree::update(size_t remoteIndex) {
+    invariant(remoteIndex < _numLeaves);
+
+    size_t node = _numLeaves + remoteIndex;
+    _nodes[node] = _remotes[remoteIndex].hasNext() ? remoteIndex : kNoRemote;
+    for (node /= 2; node > 0; node /= 2) {
+        _nodes[node] = _winner(_nodes[2 * node], _nodes[2 * node + 1]);
+    }
+}
+
+size_t AsyncResultsMerger::MergeTree::_winner(size_t lhs, size_t rhs) const {
+    if (lhs == kNoRemote || rhs == kNoRemote) {
+        return lhs == kNoRemote ? rhs : lhs;
+    }
+
+    const BufferedResult& leftDoc = _remotes[lhs].docBuffer.front();
+    const BufferedResult& rightDoc = _remotes[rhs].docBuffer.front();
 
-    return compareSortKeys(extractSortKey(*leftDoc.getResult()),
-                           extractSortKey(*rightDoc.getResult()),
-                           _sort) > 0;
+    // Ties go to 'lhs', the remote with the lower index.
+    const int cmp = _keysEncoded
+        ? rightDoc.sortKey.compare(leftDoc.sortKey)
+        : compareSortKeys(extractSortKey(*rightDoc.result.getResult()),
+                          extractSortKey(*leftDoc.result.getResult()),
+                          _sort);
+    return cmp < 0 ? rhs : lhs;
 }
 
 }  // namespace mongo
@@ -29,13 +29,17 @@
 #pragma once
 
 #include <boost/optional.hpp>
+#include <limits>
 #include <queue>
+#include <string>
 #include <vector>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/base/status_with.h"
 #include "mongo/bson/bsonobj.h"
+#include "mongo/bson/ordering.h"
 #include "mongo/db/cursor_id.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/executor/task_executor.h"
 #include "mongo/s/query/cluster_client_cursor_params.h"
 #include "mongo/s/query/cluster_query_result.h"
@@ -80,8 +84,8 @@ public:
      * the hosts on which they exist in _remotes.
      *
      * Additionally copies each remote's first batch of results, if one exists, into that remote's
-     * docBuffer. If a sort is specified in the ClusterClientCursorParams, places the remotes with
-     * buffered results onto _mergeQueue.
+     * docBuffer. If a sort is specified in the ClusterClientCursorParams, enters the remotes with
+     * buffered results into _mergeTree.
      *
      * The TaskExecutor* must remain valid for the lifetime of the ARM.
      *
@@ -203,6 +207,18 @@ public:
     executor::TaskExecutor::EventHandle kill(OperationContext* opCtx);
 
 private:
+    /**
+     * A result buffered from a remote, along with its sort key pre-encoded as a KeyString so that
+     * merging sorted streams compares sort keys with memcmp rather than BSON woCompare.
+     */
+    struct BufferedResult {
+        ClusterQueryResult result;
+
+        // The KeyString encoding of the result's $sortKey under the sort pattern's ordering. Empty
+        // if there is no sort, or if the sort pattern has too many fields to be encoded.
+        std::string sortKey;
+    };
+
     /**
      * We instantiate one of these per remote host. It contains the buffer of results we've
      * retrieved from the host but not yet returned, as well as the cursor id, and any error
@@ -253,7 +269,7 @@ private:
         HostAndPort shardHostAndPort;
 
         // The buffer of results that have been retrieved but not yet returned to the caller.
-        std::queue<ClusterQueryResult> docBuffer;
+        std::queue<BufferedResult> docBuffer;
 
         // Is valid if there is currently a pending request to this remote.
         executor::TaskExecutor::CallbackHandle cbHandle;
@@ -265,19 +281,73 @@ private:
         // Count of fetched docs during ARM processing of the current batch. Used to reduce the
         // batchSize in getMore when mongod returned less docs than the requested batchSize.
         long long fetchedCount = 0;
+
+        // Number of results in the last non-empty batch received from this remote. A sorted merge
+        // requests the next batch once the buffer drains below a fraction of this.
+        size_t lastBatchSize = 0;
+
+        // Number of results that were buffered when the outstanding getMore was scheduled. Compared
+        // against the buffer on arrival to tell how fast this remote's results are being consumed.
+        size_t bufferedAtRequest = 0;
+
+        // The batchSize requested from this remote when the client did not specify one, adapted to
+        // the rate at which the merge consumes this remote's results.
+        long long adaptiveBatchSize;
     };
 
-    class MergingComparator {
+    /**
+     * A tournament tree over the remotes, used to merge sorted streams. Each leaf is a remote and
+     * each internal node holds the index of the remote whose next buffered result sorts first in
+     * its subtree, or kNoRemote if no remote in the subtree has buffered results. Replaying a
+     * single leaf after its buffer changes costs one comparison per level.
+     */
+    class MergeTree {
     public:
-        MergingComparator(const std::vector<RemoteCursorData>& remotes, const BSONObj& sort)
-            : _remotes(remotes), _sort(sort) {}
+        static constexpr size_t kNoRemote = std::numeric_limits<size_t>::max();
+
+        MergeTree(const std::vector<RemoteCursorData>& remotes,
+                  const BSONObj& sort,
+                  bool keysEncoded)
+            : _remotes(remotes), _sort(sort), _keysEncoded(keysEncoded) {}
+
+        /**
+         * Rebuilds the tree with a leaf for each of the first 'numRemotes' remotes.
+         */
+        void reset(size_t numRemotes);
+
+        /**
+         * Replays the leaf for 'remoteIndex' after the front of its buffer has changed.
+         */
+        void update(size_t remoteIndex);
+
+        bool empty() const {
+            return _nodes.empty() || _nodes[1] == kNoRemote;
+        }
 
-        bool operator()(const size_t& lhs, const size_t& rhs);
+        /**
+         * Returns the index of the remote with the next result in sort order. Invalid to call if
+         * empty().
+         */
+        size_t top() const {
+            return _nodes[1];
+        }
 
     private:
+        size_t _winner(size_t lhs, size_t rhs) const;
+
         const std::vector<RemoteCursorData>& _remotes;
 
         const BSONObj& _sort;
+
+        // False if the sort keys could not be encoded as KeyStrings, in which case the BSON sort
+        // keys are compared instead.
+        const bool _keysEncoded;
+
+        size_t _numLeaves = 0;
+
+        // Node 1 is the root, the children of node n are 2n and 2n + 1, and the leaf for remote i
+        // is node _numLeaves + i.
+        std::vector<size_t> _nodes;
     };
 
     enum LifecycleState { kAlive, kKillStarted, kKillComplete };
@@ -300,6 +370,19 @@ private:
      */
     Status _askForNextBatch(WithLock, size_t remoteIndex);
 
+    /**
+     * For a sorted merge, schedules the next batch from the remote at 'remoteIndex' once its
+     * buffer has drained below the prefetch watermark, so that the getMore round trip overlaps
+     * with consumption of the results which are still buffered.
+     */
+    void _prefetchIfNeeded(WithLock, size_t remoteIndex);
+
+    /**
+     * Returns true if this is a sorted, non-tailable merge, which prefetches and sizes getMore
+     * batches adaptively.
+     */
+    bool _isStreamingSortedMerge() const;
+
     /**
      * Checks whether or not the remote cursors are all exhausted.
      */
@@ -392,9 +475,16 @@ private:
     // Data tracking the state of our communication with each of the remote nodes.
     std::vector<RemoteCursorData> _remotes;
 
-    // The top of this priority queue is the index into '_remotes' for the remote host that has the
-    // next document to return, according to the sort order. Used only if there is a sort.
-    std::priority_queue<size_t, std::vector<size_t>, MergingComparator> _mergeQueue;
+    // Ordering of the sort pattern, used to encode the sort keys of buffered results. Not set if
+    // there is no sort, or if the sort pattern has more fields than an Ordering can describe.
+    boost::optional<Ordering> _sortKeyOrdering;
+
+    // Reused to encode the sort keys of buffered results.
+    KeyString _sortKeyBuilder;
+
+    // The top of this tree is the index into '_remotes' for the remote host that has the next
+    // document to return, according to the sort order. Used only if there is a sort.
+    MergeTree _mergeTree;
 
     // The index into '_remotes' for the remote from which we are currently retrieving results.
     // Used only if there is *not* a sort.
@@ -596,6 +596,115 @@ TEST_F(AsyncResultsMergerTest, CompoundSortKey) {
     ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
 }
 
+TEST_F(AsyncResultsMergerTest, SortedMergeComparesMixedNumericTypes) {
+    BSONObj findCmd = fromjson("{find: 'testcoll', sort: {a: 1}}");
+    std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
+    cursors.emplace_back(kTestShardIds[0], kTestShardHosts[0], CursorResponse(_nss, 5, {}));
+    cursors.emplace_back(kTestShardIds[1], kTestShardHosts[1], CursorResponse(_nss, 6, {}));
+    cursors.emplace_back(kTestShardIds[2], kTestShardHosts[2], CursorResponse(_nss, 7, {}));
+    makeCursorFromExistingCursors(std::move(cursors), findCmd);
+
+    ASSERT_FALSE(arm->ready());
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+    ASSERT_FALSE(arm->ready());
+
+    // The sort keys are compared in their KeyString encoding, which must order numbers of
+    // different types by value and place them before strings.
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch1 = {fromjson("{$sortKey: {'': 1}}"),
+                                   fromjson("{$sortKey: {'': 2.5}}"),
+                                   fromjson("{$sortKey: {'': 'abc'}}")};
+    responses.emplace_back(_nss, CursorId(0), batch1);
+    std::vector<BSONObj> batch2 = {fromjson("{$sortKey: {'': NumberLong(2)}}"),
+                                   fromjson("{$sortKey: {'': 3}}")};
+    responses.emplace_back(_nss, CursorId(0), batch2);
+    std::vector<BSONObj> batch3 = {fromjson("{$sortKey: {'': -1.5}}"),
+                                   fromjson("{$sortKey: {'': 2.75}}"),
+                                   fromjson("{$sortKey: {'': 'abd'}}")};
+    responses.emplace_back(_nss, CursorId(0), batch3);
+    scheduleNetworkResponses(std::move(responses),
+                             CursorResponse::ResponseType::SubsequentResponse);
+    executor()->waitForEvent(readyEvent);
+
+    std::vector<BSONObj> expected = {fromjson("{$sortKey: {'': -1.5}}"),
+                                     fromjson("{$sortKey: {'': 1}}"),
+                                     fromjson("{$sortKey: {'': NumberLong(2)}}"),
+                                     fromjson("{$sortKey: {'': 2.5}}"),
+                                     fromjson("{$sortKey: {'': 2.75}}"),
+                                     fromjson("{$sortKey: {'': 3}}"),
+                                     fromjson("{$sortKey: {'': 'abc'}}"),
+                                     fromjson("{$sortKey: {'': 'abd'}}")};
+    for (const auto& obj : expected) {
+        ASSERT_TRUE(arm->ready());
+        ASSERT_BSONOBJ_EQ(obj, *unittest::assertGet(arm->nextReady()).getResult());
+    }
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+}
+
+TEST_F(AsyncResultsMergerTest, SortedMergePrefetchesBeforeBufferIsEmpty) {
+    BSONObj findCmd = fromjson("{find: 'testcoll', sort: {_id: 1}}");
+    std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
+    cursors.emplace_back(kTestShardIds[0], kTestShardHosts[0], CursorResponse(_nss, 5, {}));
+    makeCursorFromExistingCursors(std::move(cursors), findCmd);
+
+    ASSERT_FALSE(arm->ready());
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+
+    // Without a batchSize from the client, the getMore asks for the default batch size.
+    auto request = GetMoreRequest::parseFromBSON("anydbname", getFirstPendingRequest().cmdObj);
+    ASSERT_OK(request.getStatus());
+    ASSERT_EQ(*request.getValue().batchSize, QueryRequest::kDefaultBatchSize);
+
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch1 = {fromjson("{$sortKey: {'': 1}}"),
+                                   fromjson("{$sortKey: {'': 2}}"),
+                                   fromjson("{$sortKey: {'': 3}}"),
+                                   fromjson("{$sortKey: {'': 4}}")};
+    responses.emplace_back(_nss, CursorId(5), batch1);
+    scheduleNetworkResponses(std::move(responses),
+                             CursorResponse::ResponseType::SubsequentResponse);
+    executor()->waitForEvent(readyEvent);
+
+    // No getMore is scheduled while more than a quarter of the batch remains buffered.
+    ASSERT_BSONOBJ_EQ(fromjson("{$sortKey: {'': 1}}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_BSONOBJ_EQ(fromjson("{$sortKey: {'': 2}}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    network()->enterNetwork();
+    ASSERT_FALSE(network()->hasReadyRequests());
+    network()->exitNetwork();
+
+    // Draining the buffer down to the watermark schedules the next getMore while results are
+    // still available. The merge had to wait on this remote for the first batch, so the batch
+    // size is doubled.
+    ASSERT_BSONOBJ_EQ(fromjson("{$sortKey: {'': 3}}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(arm->ready());
+    auto prefetchRequest =
+        GetMoreRequest::parseFromBSON("anydbname", getFirstPendingRequest().cmdObj);
+    ASSERT_OK(prefetchRequest.getStatus());
+    ASSERT_EQ(prefetchRequest.getValue().cursorid, 5LL);
+    ASSERT_EQ(*prefetchRequest.getValue().batchSize, 2 * QueryRequest::kDefaultBatchSize);
+
+    responses.clear();
+    std::vector<BSONObj> batch2 = {fromjson("{$sortKey: {'': 5}}"),
+                                   fromjson("{$sortKey: {'': 6}}")};
+    responses.emplace_back(_nss, CursorId(0), batch2);
+    scheduleNetworkResponses(std::move(responses),
+                             CursorResponse::ResponseType::SubsequentResponse);
+
+    for (int i = 4; i <= 6; ++i) {
+        ASSERT_TRUE(arm->ready());
+        ASSERT_BSONOBJ_EQ(BSON(ClusterClientCursorParams::kSortKeyField << BSON("" << i)),
+                          *unittest::assertGet(arm->nextReady()).getResult());
+    }
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+}
+
 TEST_F(AsyncResultsMergerTest, SortedButNoSortKey) {
     BSONObj findCmd = fromjson("{find: 'testcoll', sort: {a: -1, b: 1}}");
     std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
@@ -99,6 +99,11 @@ MONGO_EXPORT_STARTUP_SERVER_PARAMETER(ShardingTaskExecutorPoolRefreshTimeoutMS,
                                       int,
                                       ConnectionPool::kDefaultRefreshTimeout.count());
 
+// Keep enough connections open to each shard host to serve its recent request rate, so that
+// traffic spikes do not turn into storms of new connections against the shards. Off by default,
+// which keeps the fixed minimum pool size.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(ShardingTaskExecutorPoolAdaptiveSizing, bool, false);
+
 namespace {
 
 using executor::NetworkInterface;
@@ -209,6 +214,7 @@ Status initializeGlobalShardingState(OperationContext* opCtx,
     connPoolOptions.minConnections = ShardingTaskExecutorPoolMinSize;
     connPoolOptions.refreshRequirement = Milliseconds(ShardingTaskExecutorPoolRefreshRequirementMS);
     connPoolOptions.refreshTimeout = Milliseconds(ShardingTaskExecutorPoolRefreshTimeoutMS);
+    connPoolOptions.adaptiveSizing = ShardingTaskExecutorPoolAdaptiveSizing;
 
     if (connPoolOptions.refreshRequirement <= connPoolOptions.refreshTimeout) {
         auto newRefreshTimeout = connPoolOptions.refreshRequirement - Milliseconds(1);
@@ -32,12 +32,18 @@
 
 #include "mongo/s/write_ops/batch_write_exec.h"
 
+#include <deque>
+#include <memory>
+
 #include "mongo/base/error_codes.h"
 #include "mongo/base/owned_pointer_map.h"
 #include "mongo/base/status.h"
 #include "mongo/bson/util/builder.h"
 #include "mongo/client/connection_string.h"
 #include "mongo/client/remote_command_targeter.h"
+#include "mongo/db/commands/server_status.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/stats/operation_latency_histogram.h"
 #include "mongo/executor/task_executor_pool.h"
 #include "mongo/s/async_requests_sender.h"
 #include "mongo/s/client/shard_registry.h"
@@ -45,6 +51,7 @@
 #include "mongo/s/write_ops/batch_write_op.h"
 #include "mongo/s/write_ops/write_error_detail.h"
 #include "mongo/util/log.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 namespace {
@@ -81,6 +88,86 @@ void noteStaleResponses(const std::vector<ShardError*>& staleErrors, NSTargeter*
 // applies when no writes are occurring and metadata is not changing on reload.
 const int kMaxRoundsWithoutProgress(5);
 
+// The number of child batches of an unordered write which may be outstanding against the same
+// shard at once. The next child batch for a shard is sent as soon as a previous one completes.
+MONGO_EXPORT_SERVER_PARAMETER(internalMaxInFlightWriteBatchesPerShard, int, 2);
+
+// A child batch which has been sent, along with the time since it was sent.
+struct PendingBatch {
+    TargetedWriteBatch* batch;
+    Timer timer;
+};
+
+// Serializes the command for 'targetedBatch', including the session information of 'opCtx'.
+BSONObj buildShardRequest(OperationContext* opCtx,
+                          const BatchWriteOp& batchOp,
+                          const TargetedWriteBatch& targetedBatch) {
+	//targetedBatchɵshardBatchedCommandRequest
+    const auto shardBatchRequest(batchOp.buildBatchRequest(targetedBatch));
+
+    BSONObjBuilder requestBuilder;
+    shardBatchRequest.serialize(&requestBuilder);
+
+    {
+        OperationSessionInfo sessionInfo;
+        if (opCtx->getLogicalSessionId()) {
+            sessionInfo.setSessionId(*opCtx->getLogicalSessionId());
+        }
+
+        sessionInfo.setTxnNumber(opCtx->getTxnNumber());
+        sessionInfo.serialize(&requestBuilder);
+    }
+
+    return requestBuilder.obj();
+}
+
+/**
+ * Latency histograms of the child write batches sent by this mongos, by shard. Reported through
+ * db.serverStatus().shardWriteLatencies.
+ */
+class ShardWriteLatencyStats {
+public:
+    void record(const ShardId& shardId, Microseconds latency) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _histograms[shardId].increment(durationCount<Microseconds>(latency),
+                                       Command::ReadWriteType::kWrite);
+    }
+
+    BSONObj toBSON(bool includeHistograms) const {
+        BSONObjBuilder builder;
+
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        for (const auto& entry : _histograms) {
+            BSONObjBuilder histogramBuilder;
+            entry.second.append(includeHistograms, &histogramBuilder);
+            builder.append(entry.first.toString(), histogramBuilder.obj()["writes"].Obj());
+        }
+        return builder.obj();
+    }
+
+private:
+    mutable stdx::mutex _mutex;
+    std::map<ShardId, OperationLatencyHistogram> _histograms;
+} shardWriteLatencyStats;
+
+class ShardWriteLatenciesServerStatusSection final : public ServerStatusSection {
+public:
+    ShardWriteLatenciesServerStatusSection() : ServerStatusSection("shardWriteLatencies") {}
+
+    bool includeByDefault() const override {
+        return true;
+    }
+
+    BSONObj generateSection(OperationContext* opCtx,
+                            const BSONElement& configElem) const override {
+        bool includeHistograms = false;
+        if (configElem.type() == BSONType::Object) {
+            includeHistograms = configElem.Obj()["histograms"].trueValue();
+        }
+        return shardWriteLatencyStats.toBSON(includeHistograms);
+    }
+} shardWriteLatenciesServerStatusSection;
+
 }  // namespace
 
 //ClusterWriter::writeеִ  ȷݷ͵ǸƬ
@@ -131,219 +218,222 @@ void BatchWriteExec::executeBatch(OperationContext* opCtx,
         //    exactly when the metadata changed.
         //
 
-        OwnedPointerMap<ShardId, TargetedWriteBatch> childBatchesOwned;
-        std::map<ShardId, TargetedWriteBatch*>& childBatches = childBatchesOwned.mutableMap();
+        const bool ordered = clientRequest.getWriteCommandBase().getOrdered();
+
+        // Owns the child batches targeted in this round.
+        std::vector<std::unique_ptr<TargetedWriteBatch>> childBatchesOwned;
+
+        // Child batches which have been targeted but not yet sent, by shard.
+        std::map<ShardId, std::deque<TargetedWriteBatch*>> unsentBatches;
 
         // If we've already had a targeting error, we've refreshed the metadata once and can
         // record target errors definitively.
         bool recordTargetErrors = refreshedTargeter;
-		//BatchWriteOp::targetBatch ȡBatchWriteOpӦchildBatches
-		//ҲȷBatchWriteOpӦĵӦ÷͵ЩmongodƬ(·ɼ¼childBatches)
-		//д룬Ҫд뵽ͬһshardװһͨchildBatches
-        Status targetStatus = batchOp.targetBatch(targeter, recordTargetErrors, &childBatches);
-        if (!targetStatus.isOK()) {
-            // Don't do anything until a targeter refresh
-            //ˢ·ɵı
-            targeter.noteCouldNotTarget();
-            refreshedTargeter = true;
-            ++stats->numTargetErrors;
-            dassert(childBatches.size() == 0u);
-        }
 
-        //
-        // Send all child batches
-        //
-
-        size_t numSent = 0;
-        size_t numToSend = childBatches.size();
-        while (numSent != numToSend) {
-            // Collect batches out on the network, mapped by endpoint
-            OwnedShardBatchMap ownedPendingBatches;
-            OwnedShardBatchMap::MapType& pendingBatches = ownedPendingBatches.mutableMap();
-
-            //
-            // Construct the requests.
-            //
+        // An ordered batch can only be targeted up to the first write which needs a different
+        // shard, but an unordered batch is targeted through to the end up front, so that each shard
+        // can be sent its next child batch as soon as it has responded to a previous one.
+        do {
+            std::map<ShardId, TargetedWriteBatch*> childBatches;
+
+			//BatchWriteOp::targetBatch ȡBatchWriteOpӦchildBatches
+			//ҲȷBatchWriteOpӦĵӦ÷͵ЩmongodƬ(·ɼ¼childBatches)
+			//д룬Ҫд뵽ͬһshardװһͨchildBatches
+            Status targetStatus = batchOp.targetBatch(targeter, recordTargetErrors, &childBatches);
+            if (!targetStatus.isOK()) {
+                // Don't do anything until a targeter refresh
+                //ˢ·ɵı
+                targeter.noteCouldNotTarget();
+                refreshedTargeter = true;
+                ++stats->numTargetErrors;
+                dassert(childBatches.size() == 0u);
+                break;
+            }
 
-			//Ҫתͬһshardӵ飬ÿԱӦһƬҪת÷Ƭ
-            std::vector<AsyncRequestsSender::Request> requests;
+            if (childBatches.empty()) {
+                break;
+            }
 
-            // Get as many batches as we can at once
             for (auto& childBatch : childBatches) {
-                TargetedWriteBatch* const nextBatch = childBatch.second;
-
-                // If the batch is nullptr, we sent it previously, so skip
-                if (!nextBatch)
-                    continue;
-
-                // If we already have a batch for this shard, wait until the next time
-                ShardId targetShardId = nextBatch->getEndpoint().shardName;  //ӦƬ
-
-                OwnedShardBatchMap::MapType::iterator pendingIt =
-                    pendingBatches.find(targetShardId);
-                if (pendingIt != pendingBatches.end()) //ظ
-                    continue;
-
-				//лת˵д
-                const auto request = [&] {
-					//BatchedCommandRequest
-					////targetedBatchɵshardBatchedCommandRequest
-                    const auto shardBatchRequest(batchOp.buildBatchRequest(*nextBatch));
-
-                    BSONObjBuilder requestBuilder;
-					//BatchedCommandRequest::serialize
-					//лװ
-                    shardBatchRequest.serialize(&requestBuilder);
-
-                    {
-                        OperationSessionInfo sessionInfo;
-						//sessionID 
-                        if (opCtx->getLogicalSessionId()) {
-							//OperationSessionInfo::setSessionId
-                            sessionInfo.setSessionId(*opCtx->getLogicalSessionId());
-                        }
-
-						//OperationSessionInfo::setTxnNumber
-                        sessionInfo.setTxnNumber(opCtx->getTxnNumber());
-						//OperationSessionInfo::serialize
-                        sessionInfo.serialize(&requestBuilder);
-                    }
+                childBatchesOwned.emplace_back(childBatch.second);
+                unsentBatches[childBatch.first].push_back(childBatch.second);
+            }
+        } while (!ordered);
+
+        //
+        // Send all child batches
+        //
 
-                    return requestBuilder.obj(); 
-                }();
+        // A shard runs only one command at a time for a session, so retryable writes keep a single
+        // child batch in flight per shard.
+        const int maxInFlightPerShard = opCtx->getTxnNumber()
+            ? 1
+            : std::max(1, internalMaxInFlightWriteBatchesPerShard.load());
+
+        // The child batches sent so far, in the order in which they were given to the
+        // AsyncRequestsSender, so that the requestIndex of a response identifies its batch.
+        std::vector<PendingBatch> pendingBatches;
+        std::map<ShardId, int> numInFlight;
+
+        // Appends requests for the next child batches to 'shardId', up to its in-flight window.
+        auto takeRequests = [&](const ShardId& shardId,
+                                std::vector<AsyncRequestsSender::Request>* requests) {
+            auto& batches = unsentBatches[shardId];
+            auto& inFlight = numInFlight[shardId];
+            for (; !batches.empty() && inFlight < maxInFlightPerShard; ++inFlight) {
+                TargetedWriteBatch* const nextBatch = batches.front();
+                batches.pop_front();
+
+                const auto request = buildShardRequest(opCtx, batchOp, *nextBatch);
+
+                LOG(4) << "Sending write batch to " << shardId << ": " << redact(request);
+                requests->emplace_back(shardId, request);
+                pendingBatches.push_back({nextBatch, Timer()});
+            }
+        };
 
-                LOG(4) << "Sending write batch to " << targetShardId << ": " << redact(request);
-				//requesҪתtargetShardIdƬ
-                requests.emplace_back(targetShardId, request);  
+		//Ҫתͬһshardӵ飬ÿԱӦһƬҪת÷Ƭ
+        std::vector<AsyncRequestsSender::Request> requests;
+        for (const auto& shardBatches : unsentBatches) {
+            takeRequests(shardBatches.first, &requests);
+        }
 
-                // Indicate we're done by setting the batch to nullptr. We'll only get duplicate
-                // hostEndpoints if we have broadcast and non-broadcast endpoints for the same host,
-                // so this should be pretty efficient without moving stuff around.
-                childBatch.second = nullptr;
+		//AsyncRequestsSender::AsyncRequestsSender
+		//Ҫ͵˵requestsתָƬ
+        AsyncRequestsSender ars(opCtx,
+                                Grid::get(opCtx)->getExecutorPool()->getArbitraryExecutor(), //ѯGrid::_executorPool
+                                clientRequest.getTargetingNS().db().toString(),
+                                requests,
+                                kPrimaryOnlyReadPreference, //дֻ
+                                opCtx->getTxnNumber() ? Shard::RetryPolicy::kIdempotent
+                                                      : Shard::RetryPolicy::kNoRetry);
 
-                // Recv-side is responsible for cleaning up the nextBatch when used
-                //
-                pendingBatches.insert(std::make_pair(targetShardId, nextBatch));
-            }
+        //
+        // Receive the responses.
+        //
 
-			//AsyncRequestsSender::AsyncRequestsSender
-			//Ҫ͵˵requestsתָƬ
-            AsyncRequestsSender ars(opCtx,
-                                    Grid::get(opCtx)->getExecutorPool()->getArbitraryExecutor(), //ѯGrid::_executorPool
-                                    clientRequest.getTargetingNS().db().toString(),
-                                    requests,
-                                    kPrimaryOnlyReadPreference, //дֻ
-                                    opCtx->getTxnNumber() ? Shard::RetryPolicy::kIdempotent
-                                                          : Shard::RetryPolicy::kNoRetry);
-            numSent += pendingBatches.size();
-
-            //
-            // Receive the responses.
-            //
-
-
-			//ȴзƬ
-            while (!ars.done()) { //AsyncRequestsSender::done
-                // Block until a response is available.
-                auto response = ars.next();//AsyncRequestsSender::next
-
-                // Get the TargetedWriteBatch to find where to put the response
-                dassert(pendingBatches.find(response.shardId) != pendingBatches.end());
-                TargetedWriteBatch* batch = pendingBatches.find(response.shardId)->second;
-
-                // First check if we were able to target a shard host.
-                //AsyncRequestsSender::Response
-                //response.shardHostAndPortԴοAsyncRequestsSender::_ready()
-                //˷Ƭûڵ㣬
-                if (!response.shardHostAndPort) {
-                    invariant(!response.swResponse.isOK());
-
-                    // Record a resolve failure
-                    batchOp.noteBatchError(*batch,
-                                           errorFromStatus(response.swResponse.getStatus()));
-
-                    // TODO: It may be necessary to refresh the cache if stale, or maybe just cancel
-                    // and retarget the batch
-                    LOG(4) << "Unable to send write batch to " << batch->getEndpoint().shardName
-                           << causedBy(response.swResponse.getStatus());
-
-                    // We're done with this batch. Clean up when we can't resolve a host.
-                    auto it = childBatches.find(batch->getEndpoint().shardName);
-                    invariant(it != childBatches.end());
-                    delete it->second;
-                    it->second = nullptr;
-                    continue;
+		//ȴзƬ
+        while (!ars.done()) { //AsyncRequestsSender::done
+            // Block until a response is available.
+            auto response = ars.next();//AsyncRequestsSender::next
+
+            // Get the TargetedWriteBatch to find where to put the response
+            invariant(response.requestIndex < pendingBatches.size());
+            TargetedWriteBatch* batch = pendingBatches[response.requestIndex].batch;
+            const Microseconds latency(pendingBatches[response.requestIndex].timer.micros());
+            const ShardId& shardId = batch->getEndpoint().shardName;
+
+            // Sends the shard its next child batches, unless this response showed that they were
+            // targeted with stale routing info.
+            --numInFlight[shardId];
+            auto sendNextBatches = [&] {
+                std::vector<AsyncRequestsSender::Request> nextRequests;
+                takeRequests(shardId, &nextRequests);
+                if (!nextRequests.empty()) {
+                    ars.addRequests(nextRequests);
                 }
+            };
+
+            // First check if we were able to target a shard host.
+            //AsyncRequestsSender::Response
+            //response.shardHostAndPortԴοAsyncRequestsSender::_ready()
+            //˷Ƭûڵ㣬
+            if (!response.shardHostAndPort) {
+                invariant(!response.swResponse.isOK());
+
+                // Record a resolve failure
+                batchOp.noteBatchError(*batch,
+                                       errorFromStatus(response.swResponse.getStatus()));
+
+                // TODO: It may be necessary to refresh the cache if stale, or maybe just cancel
+                // and retarget the batch
+                LOG(4) << "Unable to send write batch to " << batch->getEndpoint().shardName
+                       << causedBy(response.swResponse.getStatus());
+
+                sendNextBatches();
+                continue;
+            }
 
-                const auto shardHost(std::move(*response.shardHostAndPort)); //AsyncRequestsSender::Response::shardHostAndPort
+            const auto shardHost(std::move(*response.shardHostAndPort)); //AsyncRequestsSender::Response::shardHostAndPort
+            shardWriteLatencyStats.record(shardId, latency);
 
-                // Then check if we successfully got a response.
-                //ȡϢ
-                Status responseStatus = response.swResponse.getStatus();
-                BatchedCommandResponse batchedCommandResponse;
-                if (responseStatus.isOK()) {
-                    std::string errMsg;
+            // Then check if we successfully got a response.
+            //ȡϢ
+            Status responseStatus = response.swResponse.getStatus();
+            BatchedCommandResponse batchedCommandResponse;
+            if (responseStatus.isOK()) {
+                std::string errMsg;
 					//ӦϢerrϢ
-                    if (!batchedCommandResponse.parseBSON(response.swResponse.getValue().data,
-                                                          &errMsg) ||
-                        !batchedCommandResponse.isValid(&errMsg)) {
-                        responseStatus = {ErrorCodes::FailedToParse, errMsg};
-                    }
+                if (!batchedCommandResponse.parseBSON(response.swResponse.getValue().data,
+                                                      &errMsg) ||
+                    !batchedCommandResponse.isValid(&errMsg)) {
+                    responseStatus = {ErrorCodes::FailedToParse, errMsg};
                 }
+            }
 
 				//ӦϢɹ
-                if (responseStatus.isOK()) {
-                    TrackedErrors trackedErrors;
-                    trackedErrors.startTracking(ErrorCodes::StaleShardVersion);
+            if (responseStatus.isOK()) {
+                TrackedErrors trackedErrors;
+                trackedErrors.startTracking(ErrorCodes::StaleShardVersion);
 					//D SHARDING [conn----yangtest1] Write results received from 172.23.240.29:28018: { ok: 1, n: 1, opTime: { ts: Timestamp(1552560582, 2), t: 12 }, electionId: ObjectId('7fffffff000000000000000c') }
-                    LOG(4) << "Write results received from " << shardHost.toString() << ": "
-                           << redact(batchedCommandResponse.toString());
-
-                    // Dispatch was ok, note response
-                    //BatchWriteOp::noteBatchResponse  һЩͳϢ
-                    //д˵״̬¼Ӧ·ɰ汾ȱػߣˢ·ɻȡ·ɺضµķƬ
-                    
-                    batchOp.noteBatchResponse(*batch, batchedCommandResponse, &trackedErrors);
-
-                    // Note if anything was stale
-                    const auto& staleErrors =
-                        trackedErrors.getErrors(ErrorCodes::StaleShardVersion);
+                LOG(4) << "Write results received from " << shardHost.toString() << ": "
+                       << redact(batchedCommandResponse.toString());
+
+                // Dispatch was ok, note response
+                //BatchWriteOp::noteBatchResponse  һЩͳϢ
+                //д˵״̬¼Ӧ·ɰ汾ȱػߣˢ·ɻȡ·ɺضµķƬ
+                
+                batchOp.noteBatchResponse(*batch, batchedCommandResponse, &trackedErrors);
+
+                // Note if anything was stale
+                const auto& staleErrors =
+                    trackedErrors.getErrors(ErrorCodes::StaleShardVersion);
 					//ɾĲCmdInsert::runImpl CmdUpdate::runImpl CmdDelete::runImplserializeReply,Ȼ
 					//  ׷ErrorCodes::StaleShardVersion汾쳣ϢظͻˡյĴϢBatchWriteExec::executeBatch
 					//  д
-                    if (staleErrors.size() > 0) {
+                if (staleErrors.size() > 0) {
 						//עerrorCodeΪErrorCodes::StaleShardVersion
 						//shard version汾ˢ·ںrefreshIfNeeded
-                        noteStaleResponses(staleErrors, &targeter);
-                        ++stats->numStaleBatches;
+                    noteStaleResponses(staleErrors, &targeter);
+                    ++stats->numStaleBatches;
+
+                    // The child batches still queued for this shard were targeted with the same
+                    // stale routing info. Fail them with the stale error instead of sending them,
+                    // so that their writes are retargeted after the refresh.
+                    auto& queuedBatches = unsentBatches[shardId];
+                    for (auto queuedBatch : queuedBatches) {
+                        batchOp.noteBatchError(*queuedBatch, staleErrors.front()->error);
                     }
+                    queuedBatches.clear();
+                }
 
-                    // Remember that we successfully wrote to this shard
-                    // NOTE: This will record lastOps for shards where we actually didn't update
-                    // or delete any documents, which preserves old behavior but is conservative
-                    stats->noteWriteAt(shardHost,
-                                       batchedCommandResponse.isLastOpSet()
-                                           ? batchedCommandResponse.getLastOp()
-                                           : repl::OpTime(),
-                                       batchedCommandResponse.isElectionIdSet()
-                                           ? batchedCommandResponse.getElectionId()
-                                           : OID());
+                // Remember that we successfully wrote to this shard
+                // NOTE: This will record lastOps for shards where we actually didn't update
+                // or delete any documents, which preserves old behavior but is conservative
+                stats->noteWriteAt(shardHost,
+                                   batchedCommandResponse.isLastOpSet()
+                                       ? batchedCommandResponse.getLastOp()
+                                       : repl::OpTime(),
+                                   batchedCommandResponse.isElectionIdSet()
+                                       ? batchedCommandResponse.getElectionId()
+                                       : OID());
 					
-                } else {
-                //˷쳣
-                    // Error occurred dispatching, note it
-                    const Status status(responseStatus.code(),
-                                        str::stream() << "Write results unavailable from "
-                                                      << shardHost
-                                                      << " due to "
-                                                      << responseStatus.reason());
-
-                    batchOp.noteBatchError(*batch, errorFromStatus(status));
-
-                    LOG(4) << "Unable to receive write results from " << shardHost
-                           << causedBy(redact(status));
-                }
+            } else {
+            //˷쳣
+                // Error occurred dispatching, note it
+                const Status status(responseStatus.code(),
+                                    str::stream() << "Write results unavailable from "
+                                                  << shardHost
+                                                  << " due to "
+                                                  << responseStatus.reason());
+
+                batchOp.noteBatchError(*batch, errorFromStatus(status));
+
+                LOG(4) << "Unable to receive write results from " << shardHost
+                       << causedBy(redact(status));
             }
+
+            sendNextBatches();
         }
 
         ++rounds;
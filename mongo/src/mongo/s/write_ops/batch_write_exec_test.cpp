@@ -263,6 +263,46 @@ TEST_F(BatchWriteExecTest, MultiOpLarge) {
     future.timed_get(kFutureTimeout);
 }
 
+TEST_F(BatchWriteExecTest, MultiOpLargeUnorderedPipelinesChildBatches) {
+    const int kNumDocsToInsert = 100'000;
+    const std::string kDocValue(200, 'x');
+
+    std::vector<BSONObj> docsToInsert;
+    docsToInsert.reserve(kNumDocsToInsert);
+    for (int i = 0; i < kNumDocsToInsert; i++) {
+        docsToInsert.push_back(BSON("_id" << i << "someLargeKeyToWasteSpace" << kDocValue));
+    }
+
+    BatchedCommandRequest request([&] {
+        write_ops::Insert insertOp(nss);
+        insertOp.setWriteCommandBase([] {
+            write_ops::WriteCommandBase writeCommandBase;
+            writeCommandBase.setOrdered(false);
+            return writeCommandBase;
+        }());
+        insertOp.setDocuments(docsToInsert);
+        return insertOp;
+    }());
+    request.setWriteConcern(BSONObj());
+
+    auto future = launchAsync([&] {
+        BatchedCommandResponse response;
+        BatchWriteExecStats stats;
+        BatchWriteExec::executeBatch(operationContext(), nsTargeter, request, &response, &stats);
+
+        ASSERT(response.getOk());
+        ASSERT_EQUALS(response.getN(), kNumDocsToInsert);
+
+        // Both child batches are targeted up front and sent to the shard in the same round.
+        ASSERT_EQUALS(stats.numRounds, 1);
+    });
+
+    expectInsertsReturnSuccess(docsToInsert.begin(), docsToInsert.begin() + 66576);
+    expectInsertsReturnSuccess(docsToInsert.begin() + 66576, docsToInsert.end());
+
+    future.timed_get(kFutureTimeout);
+}
+
 TEST_F(BatchWriteExecTest, SingleOpError) {
     BatchedCommandResponse errResponse;
     errResponse.setOk(false);
@@ -369,6 +409,51 @@ TEST_F(BatchWriteExecTest, MultiStaleOp) {
     future.timed_get(kFutureTimeout);
 }
 
+TEST_F(BatchWriteExecTest, StaleOpCancelsQueuedChildBatchesForShard) {
+    const int kNumDocsToInsert = 150'000;
+    const std::string kDocValue(200, 'x');
+
+    std::vector<BSONObj> docsToInsert;
+    docsToInsert.reserve(kNumDocsToInsert);
+    for (int i = 0; i < kNumDocsToInsert; i++) {
+        docsToInsert.push_back(BSON("_id" << i << "someLargeKeyToWasteSpace" << kDocValue));
+    }
+
+    BatchedCommandRequest request([&] {
+        write_ops::Insert insertOp(nss);
+        insertOp.setWriteCommandBase([] {
+            write_ops::WriteCommandBase writeCommandBase;
+            writeCommandBase.setOrdered(false);
+            return writeCommandBase;
+        }());
+        insertOp.setDocuments(docsToInsert);
+        return insertOp;
+    }());
+    request.setWriteConcern(BSONObj());
+
+    auto future = launchAsync([&] {
+        BatchedCommandResponse response;
+        BatchWriteExecStats stats;
+        BatchWriteExec::executeBatch(operationContext(), nsTargeter, request, &response, &stats);
+
+        ASSERT(response.getOk());
+        ASSERT_EQUALS(response.getN(), kNumDocsToInsert);
+        ASSERT_EQUALS(stats.numRounds, 2);
+        ASSERT_EQUALS(stats.numStaleBatches, 1);
+    });
+
+    // The first two child batches are sent together. The stale reply to the first one cancels the
+    // third child batch still queued for the shard, so it is only sent after retargeting.
+    expectInsertsReturnStaleVersionErrors(
+        std::vector<BSONObj>(docsToInsert.begin(), docsToInsert.begin() + 66576));
+    expectInsertsReturnSuccess(docsToInsert.begin() + 66576, docsToInsert.begin() + 133152);
+
+    expectInsertsReturnSuccess(docsToInsert.begin(), docsToInsert.begin() + 66576);
+    expectInsertsReturnSuccess(docsToInsert.begin() + 133152, docsToInsert.end());
+
+    future.timed_get(kFutureTimeout);
+}
+
 TEST_F(BatchWriteExecTest, TooManyStaleOp) {
     // Retry op in exec too many times (without refresh) b/c of stale config (the mock nsTargeter
     // doesn't report progress on refresh). We should report a no progress error for everything in
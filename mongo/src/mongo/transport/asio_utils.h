@@ -29,10 +29,12 @@
 #pragma once
 
 #include "mongo/base/status.h"
+#include "mongo/base/system_error.h"
 #include "mongo/util/net/hostandport.h"
 #include "mongo/util/net/sockaddr.h"
 
 #include <asio.hpp>
+#include <vector>
 
 namespace mongo {
 namespace transport {
@@ -64,5 +66,32 @@ inline Status errorCodeToStatus(const std::error_code& ec) {
     return {errorCode, ec.message()};
 }
 
+/**
+ * Returns 'buffers' with the first 'bytes' bytes consumed, for resuming a partially completed
+ * read or write.
+ */
+template <typename BufferSequence>
+BufferSequence advanceBuffers(const BufferSequence& buffers, size_t bytes) {
+    BufferSequence out(buffers);
+    out += bytes;
+    return out;
+}
+
+inline std::vector<asio::const_buffer> advanceBuffers(
+    const std::vector<asio::const_buffer>& buffers, size_t bytes) {
+    std::vector<asio::const_buffer> out;
+    out.reserve(buffers.size());
+    for (const auto& buffer : buffers) {
+        const auto size = asio::buffer_size(buffer);
+        if (bytes >= size) {
+            bytes -= size;
+            continue;
+        }
+        out.push_back(buffer + bytes);
+        bytes = 0;
+    }
+    return out;
+}
+
 }  // namespace transport
 }  // namespace mongo
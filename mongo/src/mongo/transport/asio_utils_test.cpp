@@ -0,0 +1,145 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/asio_utils.h"
+
+#include <string>
+#include <vector>
+
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace transport {
+namespace {
+
+std::string toString(const std::vector<asio::const_buffer>& buffers) {
+    std::string out;
+    for (const auto& buffer : buffers) {
+        out.append(asio::buffer_cast<const char*>(buffer), asio::buffer_size(buffer));
+    }
+    return out;
+}
+
+TEST(AdvanceBuffers, SingleBuffer) {
+    const std::string data = "0123456789";
+    const auto buffer = asio::buffer(data);
+
+    auto advanced = advanceBuffers(buffer, 0);
+    ASSERT_EQ(data.size(), asio::buffer_size(advanced));
+
+    advanced = advanceBuffers(buffer, 4);
+    ASSERT_EQ("456789",
+              std::string(asio::buffer_cast<const char*>(advanced), asio::buffer_size(advanced)));
+
+    advanced = advanceBuffers(buffer, data.size());
+    ASSERT_EQ(0U, asio::buffer_size(advanced));
+}
+
+TEST(AdvanceBuffers, BufferSequence) {
+    const std::string a = "abcde";
+    const std::string b = "fgh";
+    const std::string c = "ijkl";
+    const std::vector<asio::const_buffer> buffers{
+        asio::buffer(a), asio::buffer(b), asio::buffer(c)};
+    const std::string all = a + b + c;
+
+    for (size_t bytes = 0; bytes <= all.size(); bytes++) {
+        const auto advanced = advanceBuffers(buffers, bytes);
+        ASSERT_EQ(all.substr(bytes), toString(advanced));
+
+        // Fully consumed buffers are dropped, so a resumed write never sees empty buffers
+        for (const auto& buffer : advanced) {
+            ASSERT_GT(asio::buffer_size(buffer), 0U);
+        }
+    }
+
+    // A partially consumed buffer still points into the caller's memory
+    const auto advanced = advanceBuffers(buffers, 6);
+    ASSERT_EQ(2U, advanced.size());
+    ASSERT_EQ(static_cast<const void*>(b.data() + 1),
+              asio::buffer_cast<const void*>(advanced.front()));
+    ASSERT_EQ(static_cast<const void*>(c.data()), asio::buffer_cast<const void*>(advanced.back()));
+}
+
+#ifdef ASIO_HAS_LOCAL_SOCKETS
+// Resumes a vectored write into a non-blocking socket whose send buffer fills up, the same way
+// the ASIO session resumes an opportunistic write with async_write.
+TEST(AdvanceBuffers, ResumesPartialVectoredWrite) {
+    asio::io_context ioContext;
+    asio::local::stream_protocol::socket writer(ioContext);
+    asio::local::stream_protocol::socket reader(ioContext);
+    asio::local::connect_pair(writer, reader);
+    writer.non_blocking(true);
+
+    const std::string header(16, 'h');
+    std::string large(3 * 1024 * 1024 + 7, '\0');
+    for (size_t i = 0; i < large.size(); i++) {
+        large[i] = static_cast<char>(i % 251);
+    }
+    const std::string trailer(5, 't');
+    const std::vector<asio::const_buffer> buffers{
+        asio::buffer(header), asio::buffer(large), asio::buffer(trailer)};
+    const std::string expected = toString(buffers);
+
+    std::string received;
+    auto readAvailable = [&] {
+        char chunk[64 * 1024];
+        const auto size = reader.read_some(asio::buffer(chunk));
+        received.append(chunk, size);
+    };
+
+    size_t written = 0;
+    int partialWrites = 0;
+    auto remaining = buffers;
+    while (!remaining.empty()) {
+        std::error_code ec;
+        written += asio::write(writer, remaining, ec);
+        if (ec == asio::error::would_block || ec == asio::error::try_again) {
+            partialWrites++;
+            readAvailable();
+        } else {
+            ASSERT_FALSE(ec) << ec.message();
+        }
+        remaining = advanceBuffers(buffers, written);
+    }
+
+    while (received.size() < expected.size()) {
+        readAvailable();
+    }
+
+    ASSERT_GT(partialWrites, 0);
+    ASSERT_EQ(expected.size(), written);
+    ASSERT(expected == received);
+}
+#endif
+
+}  // namespace
+}  // namespace transport
+}  // namespace mongo
@@ -40,6 +40,8 @@ enum class MessageCompressor : uint8_t {
     kNoop = 0,
     kSnappy = 1,
     kZlib = 2,
+    kZstd = 3,
+    kLz4 = 4,
     kExtended = 255,
 };
 
@@ -114,6 +116,19 @@ public:
         return _decompressBytesOut.loadRelaxed();
     }
 
+    /*
+     * This returns the number of microseconds spent in compressData
+     */
+    int64_t getCompressorMicros() const {
+        return _compressMicros.loadRelaxed();
+    }
+
+    /*
+     * This returns the number of microseconds spent in decompressData
+     */
+    int64_t getDecompressorMicros() const {
+        return _decompressMicros.loadRelaxed();
+    }
 
 protected:
     /*
@@ -140,6 +155,18 @@ protected:
     }
 
 private:
+    // The MessageCompressorManager is the only caller of compressData/decompressData, so it
+    // times those calls on behalf of every compressor.
+    friend class MessageCompressorManager;
+
+    void counterHitCompressTime(int64_t micros) {
+        _compressMicros.addAndFetch(micros);
+    }
+
+    void counterHitDecompressTime(int64_t micros) {
+        _decompressMicros.addAndFetch(micros);
+    }
+
     const MessageCompressorId _id;
     const std::string _name;
 
@@ -148,5 +175,8 @@ private:
 
     AtomicInt64 _decompressBytesIn;
     AtomicInt64 _decompressBytesOut;
+
+    AtomicInt64 _compressMicros;
+    AtomicInt64 _decompressMicros;
 };
 }  // namespace mongo
@@ -40,6 +40,7 @@
 #include "mongo/transport/session.h"
 #include "mongo/util/log.h"
 #include "mongo/util/net/message.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 namespace {
@@ -132,7 +133,9 @@ StatusWith<Message> MessageCompressorManager::compressMessage(
     compressionHeader.serialize(&output);
     ConstDataRange input(inputHeader.data(), inputHeader.data() + inputHeader.dataLen());
 
+    Timer compressTimer;
     auto sws = compressor->compressData(input, output);
+    compressor->counterHitCompressTime(compressTimer.micros());
 
     if (!sws.isOK())
         return sws.getStatus();
@@ -180,7 +183,9 @@ StatusWith<Message> MessageCompressorManager::decompressMessage(const Message& m
 
     DataRangeCursor output(outMessage.data(), outMessage.data() + outMessage.dataLen());
 
+    Timer decompressTimer;
     auto sws = compressor->decompressData(input, output);
+    compressor->counterHitDecompressTime(decompressTimer.micros());
 
     if (!sws.isOK())
         return sws.getStatus();
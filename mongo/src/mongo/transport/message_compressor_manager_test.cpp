@@ -31,12 +31,19 @@
 #include "mongo/platform/basic.h"
 
 #include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/config.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/transport/message_compressor_manager.h"
 #include "mongo/transport/message_compressor_noop.h"
 #include "mongo/transport/message_compressor_registry.h"
 #include "mongo/transport/message_compressor_snappy.h"
 #include "mongo/transport/message_compressor_zlib.h"
+#ifdef MONGO_CONFIG_HAVE_ZSTD
+#include "mongo/transport/message_compressor_zstd.h"
+#endif
+#ifdef MONGO_CONFIG_HAVE_LZ4
+#include "mongo/transport/message_compressor_lz4.h"
+#endif
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/log.h"
 #include "mongo/util/net/message.h"
@@ -241,6 +248,28 @@ TEST(ZlibMessageCompressor, Overflow) {
     checkOverflow(stdx::make_unique<ZlibMessageCompressor>());
 }
 
+#ifdef MONGO_CONFIG_HAVE_ZSTD
+TEST(ZstdMessageCompressor, Fidelity) {
+    auto testMessage = buildMessage();
+    checkFidelity(testMessage, stdx::make_unique<ZstdMessageCompressor>());
+}
+
+TEST(ZstdMessageCompressor, Overflow) {
+    checkOverflow(stdx::make_unique<ZstdMessageCompressor>());
+}
+#endif
+
+#ifdef MONGO_CONFIG_HAVE_LZ4
+TEST(Lz4MessageCompressor, Fidelity) {
+    auto testMessage = buildMessage();
+    checkFidelity(testMessage, stdx::make_unique<Lz4MessageCompressor>());
+}
+
+TEST(Lz4MessageCompressor, Overflow) {
+    checkOverflow(stdx::make_unique<Lz4MessageCompressor>());
+}
+#endif
+
 TEST(MessageCompressorManager, SERVER_28008) {
 
     // Create a client and server that will negotiate the same compressors,
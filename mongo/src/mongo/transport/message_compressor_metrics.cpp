@@ -35,6 +35,7 @@ namespace mongo {
 namespace {
 const auto kBytesIn = "bytesIn"_sd;
 const auto kBytesOut = "bytesOut"_sd;
+const auto kMicros = "micros"_sd;
 }  // namespace
 
 void appendMessageCompressionStats(BSONObjBuilder* b) {
@@ -51,12 +52,14 @@ void appendMessageCompressionStats(BSONObjBuilder* b) {
 
         BSONObjBuilder compressorSection(base.subobjStart("compressor"));
         compressorSection << kBytesIn << compressor->getCompressorBytesIn() << kBytesOut
-                          << compressor->getCompressorBytesOut();
+                          << compressor->getCompressorBytesOut() << kMicros
+                          << compressor->getCompressorMicros();
         compressorSection.doneFast();
 
         BSONObjBuilder decompressorSection(base.subobjStart("decompressor"));
         decompressorSection << kBytesIn << compressor->getDecompressorBytesIn() << kBytesOut
-                            << compressor->getDecompressorBytesOut();
+                            << compressor->getDecompressorBytesOut() << kMicros
+                            << compressor->getDecompressorMicros();
         decompressorSection.doneFast();
         base.doneFast();
     }
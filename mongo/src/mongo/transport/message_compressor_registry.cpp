@@ -54,6 +54,10 @@ StringData getMessageCompressorName(MessageCompressor id) {
             return "snappy"_sd;
         case MessageCompressor::kZlib:
             return "zlib"_sd;
+        case MessageCompressor::kZstd:
+            return "zstd"_sd;
+        case MessageCompressor::kLz4:
+            return "lz4"_sd;
         default:
             fassert(40269, "Invalid message compressor ID");
     }
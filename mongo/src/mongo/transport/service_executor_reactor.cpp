@@ -0,0 +1,344 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kExecutor;
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/service_executor_reactor.h"
+
+#include "mongo/db/server_parameters.h"
+#include "mongo/transport/service_entry_point_utils.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/processinfo.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+namespace transport {
+namespace {
+
+// The number of reactors to run. -1 means one per available core.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(reactorServiceExecutorNumReactors, int, -1);
+
+MONGO_EXPORT_SERVER_PARAMETER(reactorServiceExecutorStuckThreadTimeoutMillis, int, 250);
+
+MONGO_EXPORT_SERVER_PARAMETER(reactorServiceExecutorMaxHelperThreads, int, 64);
+
+// Tasks scheduled with MayRecurse may be called recursively if the recursion depth is below this
+// value.
+MONGO_EXPORT_SERVER_PARAMETER(reactorServiceExecutorRecursionLimit, int, 8);
+
+constexpr auto kTotalQueued = "totalQueued"_sd;
+constexpr auto kTotalExecuted = "totalExecuted"_sd;
+constexpr auto kTasksQueued = "tasksQueued"_sd;
+constexpr auto kTotalTimeQueuedUs = "totalTimeQueuedMicros"_sd;
+constexpr auto kThreadsInUse = "threadsInUse"_sd;
+constexpr auto kThreadsRunning = "threadsRunning"_sd;
+constexpr auto kHelperThreadsRunning = "helperThreadsRunning"_sd;
+constexpr auto kReactors = "reactors"_sd;
+constexpr auto kExecutorLabel = "executor"_sd;
+constexpr auto kExecutorName = "reactor"_sd;
+
+int64_t ticksToMicros(TickSource::Tick ticks, TickSource* tickSource) {
+    invariant(tickSource->getTicksPerSecond() >= 1000000);
+    static const auto ticksPerMicro = tickSource->getTicksPerSecond() / 1000000;
+    return ticks / ticksPerMicro;
+}
+
+struct ServerParameterOptions : public ServiceExecutorReactor::Options {
+    int numReactors() const final {
+        int value = reactorServiceExecutorNumReactors;
+        if (value <= 0) {
+            ProcessInfo pi;
+            value = static_cast<int>(pi.getNumAvailableCores().value_or(pi.getNumCores()));
+            value = std::max(value, 1);
+            log() << "No reactor count configured for executor. Using number of cores: " << value;
+        }
+        return value;
+    }
+
+    Milliseconds stuckThreadTimeout() const final {
+        return Milliseconds{reactorServiceExecutorStuckThreadTimeoutMillis.load()};
+    }
+
+    int maxHelperThreads() const final {
+        return reactorServiceExecutorMaxHelperThreads.load();
+    }
+
+    int recursionLimit() const final {
+        return reactorServiceExecutorRecursionLimit.load();
+    }
+};
+
+}  // namespace
+
+thread_local ServiceExecutorReactor::Reactor* ServiceExecutorReactor::_localReactor = nullptr;
+thread_local int ServiceExecutorReactor::_localRecursionDepth = 0;
+
+ServiceExecutorReactor::ServiceExecutorReactor(ServiceContext* ctx)
+    : ServiceExecutorReactor(ctx, stdx::make_unique<ServerParameterOptions>()) {}
+
+ServiceExecutorReactor::ServiceExecutorReactor(ServiceContext* ctx,
+                                               std::unique_ptr<Options> config)
+    : _config(std::move(config)), _tickSource(ctx->getTickSource()) {
+    const int numReactors = _config->numReactors();
+    invariant(numReactors > 0);
+
+    for (int i = 0; i < numReactors; i++) {
+        _reactors.emplace_back(stdx::make_unique<Reactor>(this, i));
+    }
+}
+
+ServiceExecutorReactor::~ServiceExecutorReactor() {
+    invariant(!_isRunning.load());
+}
+
+Status ServiceExecutorReactor::start() {
+    invariant(!_isRunning.load());
+    _isRunning.store(true);
+
+    for (auto& reactor : _reactors) {
+        _startThread(reactor.get(), false);
+    }
+
+    _controllerThread = stdx::thread(&ServiceExecutorReactor::_controllerThreadRoutine, this);
+
+    return Status::OK();
+}
+
+Status ServiceExecutorReactor::shutdown(Milliseconds timeout) {
+    if (!_isRunning.load())
+        return Status::OK();
+
+    _isRunning.store(false);
+
+    _controllerCondition.notify_one();
+    _controllerThread.join();
+
+    stdx::unique_lock<stdx::mutex> lk(_threadsMutex);
+    for (auto& reactor : _reactors) {
+        reactor->ioContext.stop();
+    }
+
+    bool result = _deathCondition.wait_for(
+        lk, timeout.toSystemDuration(), [&] { return _threadsRunning == 0; });
+
+    return result
+        ? Status::OK()
+        : Status(ErrorCodes::Error::ExceededTimeLimit,
+                 "reactor executor couldn't shutdown all reactor threads within time limit.");
+}
+
+Status ServiceExecutorReactor::schedule(Task task, ScheduleFlags flags) {
+    if (!_isRunning.load()) {
+        return {ErrorCodes::ShutdownInProgress, "Executor is not running"};
+    }
+
+    const auto scheduleTime = _tickSource->getTicks();
+
+    // Tasks scheduled from a reactor belong to a connection bound to it. Connections are started
+    // from the reactor their socket is bound to, so this includes their first task.
+    Reactor* reactor = (_localReactor && _localReactor->executor == this) ? _localReactor
+                                                                          : _nextReactor();
+
+    _tasksQueued.addAndFetch(1);
+
+    auto wrappedTask = [ this, reactor, task = std::move(task), scheduleTime ] {
+        _tasksQueued.subtractAndFetch(1);
+        const auto start = _tickSource->getTicks();
+        _totalSpentQueued.addAndFetch(start - scheduleTime);
+
+        if (_localRecursionDepth++ == 0) {
+            reactor->threadsInUse.addAndFetch(1);
+            reactor->lastProgress.store(start);
+        }
+
+        const auto guard = MakeGuard([this, reactor] {
+            if (--_localRecursionDepth == 0) {
+                reactor->lastProgress.store(_tickSource->getTicks());
+                reactor->threadsInUse.subtractAndFetch(1);
+            }
+            _totalExecuted.addAndFetch(1);
+        });
+
+        task();
+    };
+
+    if ((flags & kMayRecurse) && (reactor == _localReactor) &&
+        (_localRecursionDepth + 1 < _config->recursionLimit())) {
+        reactor->ioContext.dispatch(std::move(wrappedTask));
+    } else {
+        reactor->ioContext.post(std::move(wrappedTask));
+    }
+
+    _totalQueued.addAndFetch(1);
+
+    return Status::OK();
+}
+
+asio::io_context& ServiceExecutorReactor::getIOContextForNewSession() {
+    return _nextReactor()->ioContext;
+}
+
+ServiceExecutorReactor::Reactor* ServiceExecutorReactor::_nextReactor() {
+    return _reactors[_nextReactorIndex.fetchAndAdd(1) % _reactors.size()].get();
+}
+
+bool ServiceExecutorReactor::_isStuck(const Reactor& reactor) const {
+    if (reactor.threadsInUse.load() < reactor.threadsRunning.load())
+        return false;
+
+    const auto sinceProgress = _tickSource->getTicks() - reactor.lastProgress.load();
+    return sinceProgress / (_tickSource->getTicksPerSecond() / 1000) >=
+        _config->stuckThreadTimeout().count();
+}
+
+void ServiceExecutorReactor::_controllerThreadRoutine() {
+    setThreadName("reactor-controller"_sd);
+
+    stdx::mutex fakeMutex;
+    stdx::unique_lock<stdx::mutex> fakeLk(fakeMutex);
+
+    while (_isRunning.load()) {
+        _controllerCondition.wait_for(fakeLk, _config->stuckThreadTimeout().toSystemDuration());
+
+        if (!_isRunning.load())
+            break;
+
+        for (auto& reactor : _reactors) {
+            if (!_isStuck(*reactor))
+                continue;
+
+            if (_helperThreadsRunning.load() >= _config->maxHelperThreads()) {
+                LOG(1) << "Reactor " << reactor->id << " is blocked, but the maximum number of "
+                       << "helper threads is already running";
+                break;
+            }
+
+            log() << "Detected blocked reactor " << reactor->id
+                  << ", starting a helper thread to unblock its connections";
+            _startThread(reactor.get(), true);
+        }
+    }
+}
+
+void ServiceExecutorReactor::_startThread(Reactor* reactor, bool isHelper) {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_threadsMutex);
+        _threadsRunning++;
+    }
+    reactor->threadsRunning.addAndFetch(1);
+    if (isHelper) {
+        _helperThreadsRunning.addAndFetch(1);
+    }
+
+    const auto launchResult =
+        launchServiceWorkerThread([this, reactor, isHelper] { _threadRoutine(reactor, isHelper); });
+
+    if (!launchResult.isOK()) {
+        warning() << "Failed to launch new reactor thread: " << launchResult;
+
+        if (isHelper) {
+            _helperThreadsRunning.subtractAndFetch(1);
+        }
+        reactor->threadsRunning.subtractAndFetch(1);
+        stdx::lock_guard<stdx::mutex> lk(_threadsMutex);
+        _threadsRunning--;
+    }
+}
+
+void ServiceExecutorReactor::_threadRoutine(Reactor* reactor, bool isHelper) {
+    _localReactor = reactor;
+    setThreadName(str::stream() << (isHelper ? "reactor-helper-" : "reactor-") << reactor->id);
+
+    const auto guard = MakeGuard([this, reactor, isHelper] {
+        if (isHelper) {
+            _helperThreadsRunning.subtractAndFetch(1);
+        }
+        reactor->threadsRunning.subtractAndFetch(1);
+
+        stdx::lock_guard<stdx::mutex> lk(_threadsMutex);
+        _threadsRunning--;
+        _deathCondition.notify_one();
+    });
+
+    while (_isRunning.load()) {
+        try {
+            asio::io_context::work work(reactor->ioContext);
+
+            if (isHelper) {
+                reactor->ioContext.run_for(_config->stuckThreadTimeout().toSystemDuration());
+            } else {
+                reactor->ioContext.run();
+            }
+
+            if (reactor->ioContext.stopped())
+                reactor->ioContext.restart();
+        } catch (std::exception& e) {
+            log() << "Exception escaped reactor thread: " << e.what();
+        } catch (...) {
+            log() << "Unknown exception escaped reactor thread";
+        }
+
+        // Helpers exit as soon as some other thread of their reactor is available again
+        if (isHelper && (reactor->threadsInUse.load() < reactor->threadsRunning.load() - 1)) {
+            break;
+        }
+    }
+}
+
+void ServiceExecutorReactor::appendStats(BSONObjBuilder* bob) const {
+    int threadsInUse = 0;
+    for (const auto& reactor : _reactors) {
+        threadsInUse += reactor->threadsInUse.load();
+    }
+
+    int threadsRunning;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_threadsMutex);
+        threadsRunning = _threadsRunning;
+    }
+
+    BSONObjBuilder section(bob->subobjStart("serviceExecutorTaskStats"));
+
+    section << kExecutorLabel << kExecutorName                                             //
+            << kTotalQueued << _totalQueued.load()                                         //
+            << kTotalExecuted << _totalExecuted.load()                                     //
+            << kTasksQueued << _tasksQueued.load()                                         //
+            << kThreadsInUse << threadsInUse                                               //
+            << kTotalTimeQueuedUs << ticksToMicros(_totalSpentQueued.load(), _tickSource)  //
+            << kThreadsRunning << threadsRunning                                           //
+            << kHelperThreadsRunning << _helperThreadsRunning.load()                       //
+            << kReactors << static_cast<int>(_reactors.size());
+    section.doneFast();
+}
+
+}  // namespace transport
+}  // namespace mongo
@@ -0,0 +1,161 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "mongo/db/service_context.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/transport/service_executor.h"
+#include "mongo/util/tick_source.h"
+
+#include <asio.hpp>
+
+namespace mongo {
+namespace transport {
+
+/**
+ * This is an ASIO-based ServiceExecutor which runs one reactor, an io_context with its own thread,
+ * per core. Each connection is bound to one reactor when it is accepted, and the network events
+ * and tasks of that connection are handled by that reactor's thread, which keeps a connection's
+ * state in the caches of one core.
+ *
+ * A task which runs for a long time, such as a slow operation, blocks the other connections of its
+ * reactor. When all threads of a reactor have been busy for longer than the stuck thread timeout,
+ * the executor starts a helper thread from a bounded pool to run that reactor's io_context next
+ * to the blocked thread until it is available again.
+ */
+class ServiceExecutorReactor final : public ServiceExecutor {
+public:
+    struct Options {
+        virtual ~Options() = default;
+
+        // The number of reactors, and therefore of dedicated threads, to run.
+        virtual int numReactors() const = 0;
+
+        // The amount of time all threads of a reactor may be executing tasks before a helper
+        // thread is started for it.
+        virtual Milliseconds stuckThreadTimeout() const = 0;
+
+        // The maximum number of helper threads running at once across all reactors.
+        virtual int maxHelperThreads() const = 0;
+
+        // The maximum allowable depth of recursion for tasks scheduled with the MayRecurse flag
+        // before stack unwinding is forced.
+        virtual int recursionLimit() const = 0;
+    };
+
+    explicit ServiceExecutorReactor(ServiceContext* ctx);
+    ServiceExecutorReactor(ServiceContext* ctx, std::unique_ptr<Options> config);
+
+    ~ServiceExecutorReactor();
+
+    Status start() override;
+    Status shutdown(Milliseconds timeout) override;
+    Status schedule(Task task, ScheduleFlags flags) override;
+
+    Mode transportMode() const override {
+        return Mode::kAsynchronous;
+    }
+
+    void appendStats(BSONObjBuilder* bob) const override;
+
+    /**
+     * Returns the io_context of the reactor a newly accepted connection should be bound to.
+     * Reactors are assigned in round-robin order. The connection must be started from a thread
+     * running that io_context, so that its tasks are scheduled on the same reactor.
+     */
+    asio::io_context& getIOContextForNewSession();
+
+private:
+    struct Reactor {
+        Reactor(ServiceExecutorReactor* executor, int id) : executor(executor), id(id) {}
+
+        ServiceExecutorReactor* const executor;
+        const int id;
+
+        asio::io_context ioContext;
+
+        // Number of threads running ioContext, which is the reactor thread plus any helpers
+        AtomicWord<int> threadsRunning{0};
+
+        // Number of those threads, which are currently executing a task
+        AtomicWord<int> threadsInUse{0};
+
+        // Tick at which a task last started or finished executing on this reactor
+        AtomicWord<TickSource::Tick> lastProgress{0};
+    };
+
+    Reactor* _nextReactor();
+
+    void _startThread(Reactor* reactor, bool isHelper);
+    void _threadRoutine(Reactor* reactor, bool isHelper);
+    void _controllerThreadRoutine();
+
+    /**
+     * Returns whether all threads of the reactor have been executing tasks for at least the stuck
+     * thread timeout.
+     */
+    bool _isStuck(const Reactor& reactor) const;
+
+    // Reactor of the current thread, if it runs one of the reactors
+    static thread_local Reactor* _localReactor;
+
+    static thread_local int _localRecursionDepth;
+
+    const std::unique_ptr<Options> _config;
+    TickSource* const _tickSource;
+
+    std::vector<std::unique_ptr<Reactor>> _reactors;
+    AtomicWord<unsigned> _nextReactorIndex{0};
+
+    AtomicWord<bool> _isRunning{false};
+
+    // Protects _threadsRunning and is used to wait for all threads to exit on shutdown
+    mutable stdx::mutex _threadsMutex;
+    int _threadsRunning{0};
+    stdx::condition_variable _deathCondition;
+
+    stdx::thread _controllerThread;
+    stdx::condition_variable _controllerCondition;
+
+    AtomicWord<int> _helperThreadsRunning{0};
+
+    AtomicWord<int> _tasksQueued{0};
+    AtomicWord<int64_t> _totalQueued{0};
+    AtomicWord<int64_t> _totalExecuted{0};
+    AtomicWord<TickSource::Tick> _totalSpentQueued{0};
+};
+
+}  // namespace transport
+}  // namespace mongo
@@ -34,6 +34,7 @@
 
 #include "mongo/db/service_context_noop.h"
 #include "mongo/transport/service_executor_adaptive.h"
+#include "mongo/transport/service_executor_reactor.h"
 #include "mongo/transport/service_executor_synchronous.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/log.h"
@@ -145,6 +146,140 @@ TEST_F(ServiceExecutorSynchronousFixture, ScheduleFailsBeforeStartup) {
     scheduleBasicTask(executor.get(), false);
 }
 
+struct ReactorTestOptions : public ServiceExecutorReactor::Options {
+    int numReactors() const final {
+        return 2;
+    }
+
+    Milliseconds stuckThreadTimeout() const final {
+        return Milliseconds{100};
+    }
+
+    int maxHelperThreads() const final {
+        return 2;
+    }
+
+    int recursionLimit() const final {
+        return 0;
+    }
+};
+
+class ServiceExecutorReactorFixture : public unittest::Test {
+protected:
+    void setUp() override {
+        auto scOwned = stdx::make_unique<ServiceContextNoop>();
+        setGlobalServiceContext(std::move(scOwned));
+
+        executor = stdx::make_unique<ServiceExecutorReactor>(
+            getGlobalServiceContext(), stdx::make_unique<ReactorTestOptions>());
+    }
+
+    std::unique_ptr<ServiceExecutorReactor> executor;
+};
+
+TEST_F(ServiceExecutorReactorFixture, BasicTaskRuns) {
+    ASSERT_OK(executor->start());
+    auto guard = MakeGuard([this] { ASSERT_OK(executor->shutdown(Milliseconds{500})); });
+
+    scheduleBasicTask(executor.get(), true);
+}
+
+TEST_F(ServiceExecutorReactorFixture, ScheduleFailsBeforeStartup) {
+    scheduleBasicTask(executor.get(), false);
+}
+
+TEST_F(ServiceExecutorReactorFixture, TasksStayOnTheirReactor) {
+    ASSERT_OK(executor->start());
+    auto guard = MakeGuard([this] { ASSERT_OK(executor->shutdown(Milliseconds{500})); });
+
+    stdx::mutex mutex;
+    stdx::condition_variable cond;
+    std::vector<stdx::thread::id> threadIds;
+
+    stdx::function<void()> task = [&] {
+        stdx::lock_guard<stdx::mutex> lk(mutex);
+        threadIds.push_back(stdx::this_thread::get_id());
+        if (threadIds.size() < 10) {
+            ASSERT_OK(executor->schedule(task, ServiceExecutor::kEmptyFlags));
+        }
+        cond.notify_all();
+    };
+
+    stdx::unique_lock<stdx::mutex> lk(mutex);
+    ASSERT_OK(executor->schedule(task, ServiceExecutor::kEmptyFlags));
+    cond.wait(lk, [&] { return threadIds.size() == 10; });
+
+    for (const auto& threadId : threadIds) {
+        ASSERT(threadId == threadIds.front());
+    }
+}
+
+TEST_F(ServiceExecutorReactorFixture, SessionTasksRunOnTheReactorOfItsSocket) {
+    ASSERT_OK(executor->start());
+    auto guard = MakeGuard([this] { ASSERT_OK(executor->shutdown(Milliseconds{500})); });
+
+    // Each session is started from the io_context its socket is bound to, as TransportLayerASIO
+    // does, and its first task must run on the thread delivering that socket's network events.
+    for (int session = 0; session < 4; ++session) {
+        asio::io_context& socketIOContext = executor->getIOContextForNewSession();
+
+        stdx::mutex mutex;
+        stdx::condition_variable cond;
+        boost::optional<stdx::thread::id> socketThreadId;
+        boost::optional<stdx::thread::id> taskThreadId;
+
+        asio::post(socketIOContext, [&] {
+            {
+                stdx::lock_guard<stdx::mutex> lk(mutex);
+                socketThreadId = stdx::this_thread::get_id();
+            }
+            ASSERT_OK(executor->schedule(
+                [&] {
+                    stdx::lock_guard<stdx::mutex> lk(mutex);
+                    taskThreadId = stdx::this_thread::get_id();
+                    cond.notify_all();
+                },
+                ServiceExecutor::kEmptyFlags));
+        });
+
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        ASSERT(cond.wait_for(
+            lk, Seconds(10).toSystemDuration(), [&] { return taskThreadId.is_initialized(); }));
+        ASSERT(*socketThreadId == *taskThreadId);
+    }
+}
+
+TEST_F(ServiceExecutorReactorFixture, BlockedReactorGetsHelperThread) {
+    ASSERT_OK(executor->start());
+    auto guard = MakeGuard([this] { ASSERT_OK(executor->shutdown(Milliseconds{500})); });
+
+    stdx::mutex mutex;
+    stdx::condition_variable cond;
+    bool blockedTaskDone = false;
+    bool queuedTaskDone = false;
+
+    // The blocked task waits for a task queued behind it on its own reactor, which can only run
+    // once a helper thread is started for that reactor
+    auto queuedTask = [&] {
+        stdx::lock_guard<stdx::mutex> lk(mutex);
+        queuedTaskDone = true;
+        cond.notify_all();
+    };
+
+    auto blockedTask = [&] {
+        ASSERT_OK(executor->schedule(queuedTask, ServiceExecutor::kEmptyFlags));
+
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        cond.wait(lk, [&] { return queuedTaskDone; });
+        blockedTaskDone = true;
+        cond.notify_all();
+    };
+
+    stdx::unique_lock<stdx::mutex> lk(mutex);
+    ASSERT_OK(executor->schedule(blockedTask, ServiceExecutor::kEmptyFlags));
+    ASSERT(cond.wait_for(lk, Seconds(10).toSystemDuration(), [&] { return blockedTaskDone; }));
+}
+
 
 }  // namespace
 }  // namespace mongo
@@ -562,7 +562,8 @@ void ServiceStateMachine::_processMessage(ThreadGuard guard) {
         networkCounter.hitLogicalOut(toSink.size());
 
         if (_compressorId) {
-            auto swm = compressorMgr.compressMessage(toSink, &_compressorId.value());
+            // Compression reads the message as one buffer, so gather any referenced data first.
+            auto swm = compressorMgr.compressMessage(toSink.flatten(), &_compressorId.value());
             uassertStatusOK(swm.getStatus());
             toSink = swm.getValue();
         }
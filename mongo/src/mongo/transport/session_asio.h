@@ -250,10 +250,7 @@ private:
             // asio::write is a loop internally, so some of buffers may have been read into already.
             // So we need to adjust the buffers passed into async_write to be offset by size, if
             // size is > 0.
-            ConstBufferSequence asyncBuffers(buffers);
-            if (size > 0) {
-                asyncBuffers += size;
-                }
+            ConstBufferSequence asyncBuffers = advanceBuffers(buffers, size);
             //LOG(0) << "yang test ......... opportunisticWrite";
             //ݵöȡhandlerصִмasiowrite_op::operator
             asio::async_write(stream, asyncBuffers, std::forward<CompleteHandler>(handler));
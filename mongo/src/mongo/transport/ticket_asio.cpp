@@ -197,6 +197,17 @@ void TransportLayerASIO::ASIOSinkTicket::fillImpl() {
     if (!session)
         return;
 
+    if (_msgToSend.hasReferencedData()) {
+        // The reply shares documents it did not copy; gather them in one vectored write.
+        std::vector<asio::const_buffer> buffers;
+        _msgToSend.forEachWireSegment(
+            [&](const char* data, size_t size) { buffers.emplace_back(data, size); });
+        session->write(isSync(), buffers, [this](const std::error_code& ec, size_t size) {
+            _sinkCallback(ec, size);
+        });
+        return;
+    }
+
 	// TransportLayerASIO::ASIOSession::write
     session->write(isSync(),
 	   asio::buffer(_msgToSend.buf(), _msgToSend.size()),
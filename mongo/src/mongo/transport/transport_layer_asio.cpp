@@ -379,6 +379,11 @@ const std::shared_ptr<asio::io_context>& TransportLayerASIO::getIOContext() {
     return _workerIOContext; 
 }
 
+void TransportLayerASIO::setSessionIOContextPicker(IOContextPicker picker) {
+    invariant(!_running.load());
+    _sessionIOContextPicker = std::move(picker);
+}
+
 //TransportLayerASIO::start  acceptorTransportLayerASIO::startе_acceptorIOContextǹ
 void TransportLayerASIO::_acceptConnection(GenericAcceptor& acceptor) {
 	//ӵʱĻص
@@ -394,8 +399,21 @@ void TransportLayerASIO::_acceptConnection(GenericAcceptor& acceptor) {
         }
 
 		//ÿµӶnewһµASIOSession
+        auto& sessionIOContext = peerSocket.get_executor().context();
         std::shared_ptr<ASIOSession> session(new ASIOSession(this, std::move(peerSocket)));
 
+        if (_sessionIOContextPicker) {
+            // Start the session from the io_context its socket is bound to, so that the service
+            // executor schedules its first task where the rest of its tasks will run.
+            asio::post(sessionIOContext, [this, session]() mutable {
+                if (_running.load()) {
+                    _sep->startSession(std::move(session));
+                }
+            });
+            _acceptConnection(acceptor);
+            return;
+        }
+
 		//µӴServiceEntryPointImpl::startSessionServiceEntryPointImplϵ
         _sep->startSession(std::move(session));
         _acceptConnection(acceptor); //ݹ飬֪еaccept¼
@@ -407,7 +425,9 @@ void TransportLayerASIO::_acceptConnection(GenericAcceptor& acceptor) {
 
 	//ӵյacceptCbTransportLayerASIO::start  listen߳
 	//basic_socket_acceptor::async_acceptacceptCbصTransportLayerASIO::start ->io_context::run
-    acceptor.async_accept(*_workerIOContext, std::move(acceptCb)); //첽մӵlisten̵߳acceptCbص
+    auto& sessionIOContext =
+        _sessionIOContextPicker ? _sessionIOContextPicker() : *_workerIOContext;
+    acceptor.async_accept(sessionIOContext, std::move(acceptCb)); //첽մӵlisten̵߳acceptCbص
 }
 
 #ifdef MONGO_CONFIG_SSL
@@ -116,6 +116,16 @@ public:
 
     const std::shared_ptr<asio::io_context>& getIOContext();
 
+    using IOContextPicker = std::function<asio::io_context&()>;
+
+    /**
+     * Sets the function which chooses the io_context a newly accepted connection is bound to, and
+     * therefore the threads its network events are delivered to. Such connections are also started
+     * from a thread of that io_context. By default every connection is bound to the io_context
+     * returned by getIOContext(). Must be called before start().
+     */
+    void setSessionIOContextPicker(IOContextPicker picker);
+
 private:
     class ASIOSession;
     class ASIOTicket;
@@ -197,6 +207,9 @@ private:
     // ЧµӼTransportLayerASIO::start    
     //_acceptorIOContext_acceptorsTransportLayerASIO::setup 
     std::unique_ptr<asio::io_context> _acceptorIOContext;  
+
+    // Chooses the io_context for new connections instead of _workerIOContext, if set
+    IOContextPicker _sessionIOContextPicker;
     
 
 #ifdef MONGO_CONFIG_SSL
@@ -163,7 +163,8 @@ Ticket TransportLayerLegacy::sinkMessage(const SessionHandle& session,
                                          Date_t expiration) {
     auto sinkCb = [&message](AbstractMessagingPort* amp) -> Status {
         try {
-            amp->say(message);
+            // Sockets here take a single buffer, so gather any referenced data first.
+            amp->say(message.flatten());
             networkCounter.hitPhysicalOut(message.size());
 
             return Status::OK();
@@ -35,6 +35,7 @@
 #include "mongo/db/service_context.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/transport/service_executor_adaptive.h"
+#include "mongo/transport/service_executor_reactor.h"
 #include "mongo/transport/service_executor_synchronous.h"
 #include "mongo/transport/session.h"
 #include "mongo/transport/transport_layer_asio.h"
@@ -157,6 +158,8 @@ std::unique_ptr<TransportLayer> TransportLayerManager::createWithConfig(
         if (config->serviceExecutor == "adaptive") {
 			//̬̳߳ģ,Ҳ첽ģʽ
             opts.transportMode = transport::Mode::kAsynchronous;
+        } else if (config->serviceExecutor == "reactor") {
+            opts.transportMode = transport::Mode::kAsynchronous;
         } else if (config->serviceExecutor == "synchronous") {
             //һһ߳ģͣҲͬģʽ
             opts.transportMode = transport::Mode::kSynchronous;
@@ -172,6 +175,16 @@ std::unique_ptr<TransportLayer> TransportLayerManager::createWithConfig(
 			//춯̬߳ģͶӦִServiceExecutorAdaptive
             ctx->setServiceExecutor(stdx::make_unique<ServiceExecutorAdaptive>(
                 ctx, transportLayerASIO->getIOContext()));
+        } else if (config->serviceExecutor == "reactor") {
+            // Bind every new connection to one of the executor's reactors, rather than to the
+            // shared worker io_context
+            auto executor = stdx::make_unique<ServiceExecutorReactor>(ctx);
+            auto executorPtr = executor.get();
+            transportLayerASIO->setSessionIOContextPicker(
+                [executorPtr]() -> asio::io_context& {
+                    return executorPtr->getIOContextForNewSession();
+                });
+            ctx->setServiceExecutor(std::move(executor));
         } else if (config->serviceExecutor == "synchronous") { //ͬʽ
         	//һһ߳ģͶӦִServiceExecutorSynchronous
             ctx->setServiceExecutor(stdx::make_unique<ServiceExecutorSynchronous>(ctx));
@@ -30,6 +30,8 @@
 
 #include "mongo/util/net/message.h"
 
+#include <cstring>
+
 #include "mongo/platform/atomic_word.h"
 
 namespace mongo {
@@ -42,4 +44,27 @@ int32_t nextMessageId() {
     return NextMsgId.fetchAndAdd(1);
 }
 
+int Message::_bufLen() const {
+    int len = size();
+    for (const auto& ref : _referenced) {
+        len -= ref.size - ref.placeholderSize;
+    }
+    return len;
+}
+
+Message Message::flatten() const {
+    if (_referenced.empty())
+        return *this;
+
+    const int len = size();
+    auto flat = SharedBuffer::allocate(len);
+    char* out = flat.get();
+    forEachWireSegment([&](const char* data, size_t size) {
+        memcpy(out, data, size);
+        out += size;
+    });
+    invariant(out == flat.get() + len);
+    return Message(std::move(flat));
+}
+
 }  // namespace mongo
@@ -29,12 +29,14 @@
 #pragma once
 
 #include <cstdint>
+#include <vector>
 
 #include "mongo/base/data_type_endian.h"
 #include "mongo/base/data_view.h"
 #include "mongo/base/encoded_value_storage.h"
 #include "mongo/base/static_assert.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/shared_buffer.h"
 
 namespace mongo {
 
@@ -452,6 +454,20 @@ inline int ConstView::dataLen() const {
 //DbMessage._msgԱ  messageOpMsgRequest ReplyInterface  ReplyBuilderInterfaceȵĹϵԲοfactory.cppʵ
 class Message {
 public:
+    /**
+     * Bytes which are part of this message on the wire but are not stored in its buffer. The
+     * 'placeholderSize' bytes at 'offset' in the buffer stand in for them; the header's
+     * messageLength already accounts for the difference. 'holder' keeps 'data' alive for as long
+     * as the message is.
+     */
+    struct ReferencedData {
+        int offset;
+        int placeholderSize;
+        ConstSharedBuffer holder;
+        const char* data;
+        int size;
+    };
+
     Message() = default;
     explicit Message(SharedBuffer data) : _buf(std::move(data)) {}
     //ͷheader
@@ -466,7 +482,7 @@ public:
     }
 
     MsgData::View singleData() const {
-        massert(13273, "single data buffer expected", _buf);
+        massert(13273, "single data buffer expected", _buf && _referenced.empty());
         return header();
     }
 
@@ -490,6 +506,7 @@ public:
     //buf
     void reset() {
         _buf = {};
+        _referenced.clear();
     }
 
     // use to set first buffer if empty
@@ -530,9 +547,55 @@ public:
         return _buf;
     }
 
+    /**
+     * True if some of this message's bytes live outside of buf(). Such a message may only be
+     * handed to code that walks it with forEachWireSegment(); everything else must use flatten().
+     */
+    bool hasReferencedData() const {
+        return !_referenced.empty();
+    }
+
+    /**
+     * Attaches out-of-line data to a message whose header already describes the full wire size.
+     * 'referenced' must be sorted by offset and must not overlap.
+     */
+    void setReferencedData(std::vector<ReferencedData> referenced) {
+        verify(!empty());
+        _referenced = std::move(referenced);
+    }
+
+    /**
+     * Calls 'cb(const char* data, size_t size)' for each contiguous piece of the wire image, in
+     * order, so that the message can be sent with a single vectored write.
+     */
+    template <typename Callback>
+    void forEachWireSegment(Callback&& cb) const {
+        const char* const base = _buf.get();
+        int pos = 0;
+        for (const auto& ref : _referenced) {
+            if (ref.offset > pos)
+                cb(base + pos, size_t(ref.offset - pos));
+            cb(ref.data, size_t(ref.size));
+            pos = ref.offset + ref.placeholderSize;
+        }
+        const int bufLen = _bufLen();
+        if (bufLen > pos)
+            cb(base + pos, size_t(bufLen - pos));
+    }
+
+    /**
+     * Returns this message with all referenced data copied into a single buffer. Returns the
+     * message itself if it has no referenced data.
+     */
+    Message flatten() const;
+
 private:
+    // Number of wire bytes held in _buf, which is less than size() when there is referenced data.
+    int _bufLen() const;
+
     //Žݵbuf
     SharedBuffer _buf;
+    std::vector<ReferencedData> _referenced;
 };
 
 /**
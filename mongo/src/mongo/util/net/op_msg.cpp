@@ -256,6 +256,29 @@ BSONObjBuilder OpMsgBuilder::resumeBody() {
     return BSONObjBuilder(BSONObjBuilder::ResumeBuildingTag(), _buf, _bodyStart);
 }
 
+void OpMsgBuilder::appendReferencedObject(BSONArrayBuilder* array, const BSONObj& obj) {
+    invariant(_state == kBody);
+    invariant(isBuildingInto(array->bb()));
+    invariant(obj.isOwned());
+
+    array->append(BSONObj());
+    _references.push_back({_buf.len() - BSONObj::kMinBSONLength, obj});
+}
+
+void OpMsgBuilder::discardReferencesFrom(int offset) {
+    // References are kept in buffer order, so the ones to drop are a suffix.
+    _references.erase(
+        std::find_if(_references.begin(),
+                     _references.end(),
+                     [&](const ReferencedObject& ref) { return ref.offset >= offset; }),
+        _references.end());
+    _referencingContainers.erase(
+        std::remove_if(_referencingContainers.begin(),
+                       _referencingContainers.end(),
+                       [&](int lengthOffset) { return lengthOffset >= offset; }),
+        _referencingContainers.end());
+}
+
 AtomicBool OpMsgBuilder::disableDupeFieldCheck_forTest{false};
 
 //message
@@ -276,13 +299,43 @@ Message OpMsgBuilder::finish() {
     invariant(!_openBuilder);
     _state = kDone;
 
-    const auto size = _buf.len();
+    // Referenced objects are represented in the buffer by empty placeholder objects, so each
+    // enclosing length only counts the placeholders. Grow them by what the objects add on the wire.
+    std::vector<Message::ReferencedData> referenced;
+    int referencedBytes = 0;
+    if (!_references.empty()) {
+        _referencingContainers.push_back(_bodyStart);
+        for (int lengthOffset : _referencingContainers) {
+            const int bufLen = ConstDataView(_buf.buf()).read<LittleEndian<int32_t>>(lengthOffset);
+            int extra = 0;
+            for (const auto& ref : _references) {
+                if (ref.offset > lengthOffset && ref.offset < lengthOffset + bufLen)
+                    extra += ref.obj.objsize() - BSONObj::kMinBSONLength;
+            }
+            DataView(_buf.buf()).write(tagLittleEndian<int32_t>(bufLen + extra), lengthOffset);
+        }
+
+        referenced.reserve(_references.size());
+        for (const auto& ref : _references) {
+            referenced.push_back({ref.offset,
+                                  BSONObj::kMinBSONLength,
+                                  ref.obj.sharedBuffer(),
+                                  ref.obj.objdata(),
+                                  ref.obj.objsize()});
+            referencedBytes += ref.obj.objsize() - BSONObj::kMinBSONLength;
+        }
+    }
+
+    const auto size = _buf.len() + referencedBytes;
     MSGHEADER::View header(_buf.buf());
     header.setMessageLength(size);
     // header.setRequestMsgId(...); // These are currently filled in by the networking layer.
     // header.setResponseToMsgId(...);
     header.setOpCode(dbMsg);
-    return Message(_buf.release());
+    Message message(_buf.release());
+    if (!referenced.empty())
+        message.setReferencedData(std::move(referenced));
+    return message;
 }
 
 }  // namespace mongo
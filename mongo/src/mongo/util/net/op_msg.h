@@ -208,6 +208,39 @@ public:
         resumeBody().appendElements(body);
     }
 
+    /**
+     * Returns true if 'bb' is the buffer this message is being built in, which is the case for
+     * every builder derived from beginBody() or resumeBody().
+     */
+    bool isBuildingInto(const BufBuilder& bb) const {
+        return &bb == &_buf;
+    }
+
+    /**
+     * Appends 'obj' as the next element of 'array' without copying its bytes into this message.
+     * The finished Message shares ownership of 'obj' and sends it with a vectored write. 'obj'
+     * must be owned and 'array' must be building into this message's body.
+     *
+     * Until finish(), the body holds an empty object in place of 'obj', so it stays valid BSON for
+     * anyone who inspects it. Every object or array enclosing 'array', other than the body itself,
+     * must be passed to addReferencingContainer() so that its length can be corrected.
+     */
+    void appendReferencedObject(BSONArrayBuilder* array, const BSONObj& obj);
+
+    /**
+     * Registers the object or array whose length is stored at 'lengthOffset' in the buffer as
+     * containing referenced objects.
+     */
+    void addReferencingContainer(int lengthOffset) {
+        _referencingContainers.push_back(lengthOffset);
+    }
+
+    /**
+     * Forgets referenced objects and containers at or after 'offset'. Callers that truncate the
+     * buffer with BufBuilder::setlen() must call this with the new length.
+     */
+    void discardReferencesFrom(int offset);
+
     /**
      * Finish building and return a Message ready to give to the networking layer for transmission.
      * It is illegal to call any methods on this object after calling this.
@@ -225,6 +258,8 @@ public:
         _bodyStart = 0;
         _state = kEmpty;
         _openBuilder = false;
+        _references.clear();
+        _referencingContainers.clear();
     }
 
     /**
@@ -245,6 +280,11 @@ private:
         kDone,
     };
 
+    struct ReferencedObject {
+        int offset;  // Of the placeholder in _buf.
+        BSONObj obj;
+    };
+
     void finishDocumentStream(DocSequenceBuilder* docSequenceBuilder);
 
     void skipHeaderAndFlags() {
@@ -257,6 +297,8 @@ private:
     int _bodyStart = 0;
     State _state = kEmpty;
     bool _openBuilder = false;
+    std::vector<ReferencedObject> _references;
+    std::vector<int> _referencingContainers;
 };
 
 /**
@@ -824,6 +824,83 @@ TEST(OpMsgSerializer, SetFlagWorks) {
     }
 }
 
+TEST(OpMsgSerializer, ReferencedObjectsAreNotCopied) {
+    const BSONObj big = BSON("x" << std::string(1000, 'a'));
+    const BSONObj small = BSON("y" << 1);
+
+    OpMsgBuilder builder;
+    {
+        auto body = builder.beginBody();
+        body.append("a", 1);
+        {
+            BSONObjBuilder cursor(body.subobjStart("cursor"));
+            const int cursorLengthOffset = body.bb().len() - 4;
+            BSONArrayBuilder batch(cursor.subarrayStart("batch"));
+            const int batchLengthOffset = body.bb().len() - 4;
+            ASSERT(builder.isBuildingInto(batch.bb()));
+
+            builder.appendReferencedObject(&batch, big);
+            batch.append(small);
+            builder.appendReferencedObject(&batch, big);
+            batch.doneFast();
+            cursor.append("id", 0LL);
+            cursor.doneFast();
+
+            // The body remains valid BSON while it is being built.
+            const auto placeholders = BSON_ARRAY(BSONObj() << small << BSONObj());
+            ASSERT_BSONOBJ_EQ(
+                body.asTempObj(),
+                BSON("a" << 1 << "cursor" << BSON("batch" << placeholders << "id" << 0LL)));
+
+            builder.addReferencingContainer(batchLengthOffset);
+            builder.addReferencingContainer(cursorLengthOffset);
+        }
+        body.append("b", 2);
+    }
+    auto msg = builder.finish();
+    ASSERT(msg.hasReferencedData());
+
+    // Each referenced object is a separate segment pointing at the object's own bytes.
+    std::vector<std::pair<const char*, size_t>> segments;
+    msg.forEachWireSegment(
+        [&](const char* data, size_t size) { segments.emplace_back(data, size); });
+    ASSERT_EQ(segments.size(), 5u);
+    ASSERT_EQ(static_cast<const void*>(segments[1].first), big.objdata());
+    ASSERT_EQ(static_cast<const void*>(segments[3].first), big.objdata());
+    size_t total = 0;
+    for (const auto& segment : segments) {
+        total += segment.second;
+    }
+    ASSERT_EQ(total, size_t(msg.size()));
+
+    auto flat = msg.flatten();
+    ASSERT_FALSE(flat.hasReferencedData());
+    ASSERT_EQ(flat.size(), msg.size());
+    ASSERT_BSONOBJ_EQ(OpMsg::parse(flat).body,
+                      BSON("a" << 1 << "cursor"
+                               << BSON("batch" << BSON_ARRAY(big << small << big) << "id" << 0LL)
+                               << "b"
+                               << 2));
+}
+
+TEST(OpMsgSerializer, ResetDiscardsReferencedObjects) {
+    const BSONObj big = BSON("x" << std::string(1000, 'a'));
+
+    OpMsgBuilder builder;
+    {
+        auto body = builder.beginBody();
+        BSONArrayBuilder batch(body.subarrayStart("batch"));
+        builder.appendReferencedObject(&batch, big);
+    }
+    builder.reset();
+    builder.setBody(BSON("ok" << 1));
+
+    auto msg = builder.finish();
+    ASSERT_FALSE(msg.hasReferencedData());
+    ASSERT_EQ(static_cast<const void*>(msg.flatten().buf()), static_cast<const void*>(msg.buf()));
+    ASSERT_BSONOBJ_EQ(OpMsg::parse(msg).body, BSON("ok" << 1));
+}
+
 TEST(OpMsgRequest, GetDatabaseWorks) {
     OpMsgRequest msg;
     msg.body = fromjson("{$db: 'foo'}");